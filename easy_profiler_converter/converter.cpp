@@ -42,123 +42,347 @@ The Apache License, Version 2.0 (the "License");
 
 #include "converter.h"
 #include <fstream>
+#include <limits>
 
-void JsonExporter::convert(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** Writes blocks as soon as they are read by readBlocksFromFile(), so the whole file is never kept in memory.
+
+Layout is the same as nlohmann::json::dump() with indent 1 produces, except the order of top-level keys:
+blocks descriptions are written after threads because runtime names of blocks are known only by then.
+*/
+class JsonWriter EASY_FINAL : public profiler::BlocksVisitor
 {
-    if (node.info.descriptor != nullptr)
+    using descriptors_list_t = profiler::reader::descriptors_list_t;
+
+    std::ostream&                  m_output;
+    descriptors_list_t        m_descriptors; ///< File descriptions followed by descriptions created for runtime names
+    std::vector<std::string>        m_names; ///< Escaped names of blocks by block id
+    std::vector<bool>         m_hasChildren; ///< For the thread and each open block: if "children" array is started
+    profiler::bookmarks_t       m_bookmarks;
+    std::string                    m_spaces;
+    std::string              m_threadName; ///< Escaped name of the current thread
+    uint32_t        m_fileDescriptorsCount;
+    uint32_t               m_threadsNumber;
+
+public:
+
+    explicit JsonWriter(std::ostream& _output)
+        : m_output(_output)
+        , m_fileDescriptorsCount(0)
+        , m_threadsNumber(0)
     {
-        json = {{"id", node.info.blockIndex},
-                {"name", node.info.descriptor->blockName},
-                {"start", node.info.beginTime},
-                {"stop", node.info.endTime},
-                {"descriptor", node.info.descriptor->id}};
     }
 
-    convertChildren(node, json);
-}
+    bool onHeader(uint32_t _version, profiler::processid_t, const profiler::BeginEndTime&) override
+    {
+        std::stringstream version;
+        version << ((_version & 0xff000000) >> 24) << "." << ((_version & 0x00ff0000) >> 16) << "." << (_version & 0x0000ffff);
 
-void JsonExporter::convertChildren(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const
-{
-    if (node.children.empty())
-        return;
+        m_output << "{\n";
+        key(1, "version") << escape(version.str()) << ",\n";
+        key(1, "timeUnits") << "\"ns\",\n";
+        key(1, "threads");
+
+        return true;
+    }
 
-    auto children = nlohmann::json::array();
-    for (const auto& child : node.children)
+    bool onDescriptors(const profiler::descriptors_list_t& _descriptors) override
     {
-        children.emplace_back();
-        convert(child, children.back());
+        m_fileDescriptorsCount = static_cast<uint32_t>(_descriptors.size());
+        m_descriptors.reserve(_descriptors.size());
+        m_names.reserve(_descriptors.size());
+
+        uint32_t descId = 0;
+        for (auto descriptor : _descriptors)
+        {
+            profiler::reader::BlockDescriptor desc;
+            desc.id = descId++;
+
+            if (descriptor != nullptr)
+            {
+                desc.parentId = descriptor->id();
+                desc.lineNumber = descriptor->line();
+                desc.argbColor = descriptor->color();
+                desc.blockType = static_cast<decltype(desc.blockType)>(descriptor->type());
+                desc.status = descriptor->status();
+
+                if (desc.parentId == desc.id) // compile time descriptor and name
+                    desc.blockName = descriptor->name();
+
+                desc.fileName = descriptor->file();
+            }
+            else
+            {
+                desc.parentId = desc.id;
+                desc.lineNumber = 0;
+                desc.argbColor = 0;
+                desc.blockType = 0;
+                desc.status = 0;
+            }
+
+            m_names.push_back(escape(desc.blockName));
+            m_descriptors.push_back(std::move(desc));
+        }
+
+        return true;
     }
 
-    json["children"] = children;
-}
+    bool onThreadBegin(profiler::thread_id_t, const char* _name) override
+    {
+        m_output << (m_threadsNumber++ == 0 ? "[\n" : ",\n");
+        indent(2) << "{";
 
-void JsonExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
-{
-    profiler::reader::FileReader fr;
-    if (fr.readFile(inputFile) == 0)
-        return;
+        m_threadName = escape(_name);
+        m_hasChildren.assign(1, false);
 
-    nlohmann::json json = {{"version", fr.getVersionString()}, {"timeUnits", "ns"}};
+        return true;
+    }
 
-    // convert descriptors
+    bool onBlockBegin(const profiler::StreamedBlock& _block) override
     {
-        auto descriptors = nlohmann::json::array();
-        const auto& block_descriptors = fr.getBlockDescriptors();
-        for (const auto& descriptor : block_descriptors)
+        const auto id = _block.node->id();
+        if (id >= m_fileDescriptorsCount && (id >= m_descriptors.size() || m_descriptors[id].id != id))
+        {
+            // New id generated for a runtime name: description is copied from the block's one.
+            // Ids are generated in the file order, which differs from the order of blocks beginnings.
+            if (id >= m_descriptors.size())
+            {
+                profiler::reader::BlockDescriptor empty;
+                empty.id = std::numeric_limits<uint32_t>::max();
+                m_descriptors.resize(id + 1, empty);
+                m_names.resize(id + 1);
+            }
+
+            auto& desc = m_descriptors[id];
+            desc = m_descriptors[_block.descriptor_id];
+            desc.parentId = desc.id;
+            desc.id = id;
+            desc.blockName = _block.node->name();
+
+            m_names[id] = escape(desc.blockName);
+        }
+
+        const uint32_t element_indent = 4 + 2 * _block.depth;
+
+        auto&& parentHasChildren = m_hasChildren.back();
+        if (!parentHasChildren)
+        {
+            m_output << "\n";
+            key(element_indent - 1, "children") << "[\n";
+            parentHasChildren = true;
+        }
+        else
         {
-            descriptors.emplace_back();
+            m_output << ",\n";
+        }
+
+        indent(element_indent) << "{";
+        m_hasChildren.push_back(false);
 
-            std::stringstream stream;
-            stream << "0x" << std::hex << descriptor.argbColor;
+        return true;
+    }
 
-            auto& desc = descriptors.back();
+    bool onBlockEnd(const profiler::StreamedBlock& _block) override
+    {
+        const uint32_t element_indent = 4 + 2 * _block.depth;
+        const auto key_indent = element_indent + 1;
 
-            desc["id"] = descriptor.id;
-            if (descriptor.parentId != descriptor.id)
-                desc["parentId"] = descriptor.parentId;
+        closeChildren(key_indent);
 
-            desc["name"] = descriptor.blockName;
-            desc["type"] = descriptor.blockType;
-            desc["color"] = stream.str();
-            desc["sourceFile"] = descriptor.fileName;
-            desc["sourceLine"] = descriptor.lineNumber;
-        }
+        key(key_indent, "descriptor") << _block.node->id() << ",\n";
+        key(key_indent, "id") << _block.index << ",\n";
+        key(key_indent, "name") << m_names[_block.node->id()] << ",\n";
+        key(key_indent, "start") << _block.node->begin() << ",\n";
+        key(key_indent, "stop") << _block.node->end() << "\n";
+        indent(element_indent) << "}";
 
-        json["blockDescriptors"] = descriptors;
+        return true;
     }
 
-    // convert threads and blocks
+    bool onThreadEnd(profiler::thread_id_t _thread_id) override
     {
-        auto threads = nlohmann::json::array();
-        const auto& blocks_tree = fr.getBlocksTree();
-        for (const auto& kv : blocks_tree)
+        closeChildren(3);
+
+        key(3, "threadId") << _thread_id << ",\n";
+        key(3, "threadName") << m_threadName << "\n";
+        indent(2) << "}";
+
+        return true;
+    }
+
+    bool onBookmark(const profiler::Bookmark& _bookmark) override
+    {
+        m_bookmarks.push_back(_bookmark);
+        return true;
+    }
+
+    void finish()
+    {
+        if (m_threadsNumber != 0)
         {
-            threads.emplace_back();
+            m_output << "\n";
+            indent(1) << "]";
+        }
+        else
+        {
+            m_output << "[]";
+        }
+
+        m_output << ",\n";
+        key(1, "blockDescriptors");
+        writeDescriptors();
 
-            auto& thread = threads.back();
-            thread["threadId"] = kv.first;
-            thread["threadName"] = fr.getThreadName(kv.first);
+        m_output << ",\n";
+        key(1, "bookmarks");
+        writeBookmarks();
 
-            convertChildren(kv.second, thread);
+        m_output << "\n}";
+    }
+
+private:
+
+    static std::string escape(const std::string& _text)
+    {
+        return nlohmann::json(_text).dump();
+    }
+
+    static std::string color(uint32_t _color)
+    {
+        std::stringstream stream;
+        stream << "0x" << std::hex << _color;
+        return escape(stream.str());
+    }
+
+    std::ostream& indent(uint32_t _indent)
+    {
+        if (m_spaces.size() < _indent)
+            m_spaces.resize(_indent, ' ');
+        return m_output.write(m_spaces.data(), _indent);
+    }
+
+    std::ostream& key(uint32_t _indent, const char* _key)
+    {
+        return indent(_indent) << "\"" << _key << "\": ";
+    }
+
+    void closeChildren(uint32_t _keyIndent)
+    {
+        m_output << "\n";
+        if (m_hasChildren.back())
+        {
+            indent(_keyIndent) << "],\n";
         }
 
-        json["threads"] = threads;
+        m_hasChildren.pop_back();
     }
 
-    // convert bookmarks
+    void writeDescriptors()
     {
-        auto bookmarks = nlohmann::json::array();
-        const auto& bmarks = fr.getBookmarks();
-        for (const auto& mark : bmarks)
+        if (m_descriptors.empty())
         {
-            std::stringstream stream;
-            stream << "0x" << std::hex << mark.color;
+            m_output << "[]";
+            return;
+        }
 
-            bookmarks.emplace_back();
+        m_output << "[\n";
+        for (size_t i = 0; i < m_descriptors.size(); ++i)
+        {
+            const auto& descriptor = m_descriptors[i];
+
+            if (i != 0)
+                m_output << ",\n";
 
-            auto& bookmark = bookmarks.back();
-            bookmark["timestamp"] = mark.pos;
-            bookmark["color"] = stream.str();
-            bookmark["text"] = mark.text;
+            indent(2) << "{\n";
+            key(3, "color") << color(descriptor.argbColor) << ",\n";
+            key(3, "id") << descriptor.id << ",\n";
+            key(3, "name") << m_names[i] << ",\n";
+            if (descriptor.parentId != descriptor.id)
+                key(3, "parentId") << descriptor.parentId << ",\n";
+            key(3, "sourceFile") << escape(descriptor.fileName) << ",\n";
+            key(3, "sourceLine") << descriptor.lineNumber << ",\n";
+            key(3, "type") << static_cast<uint32_t>(descriptor.blockType) << "\n";
+            indent(2) << "}";
         }
 
-        json["bookmarks"] = bookmarks;
+        m_output << "\n";
+        indent(1) << "]";
     }
 
-    try
+    void writeBookmarks()
     {
-        if (!outputFile.empty())
+        if (m_bookmarks.empty())
         {
-            ::std::ofstream file(outputFile);
-            json.dump(file, true, 1);
+            m_output << "[]";
+            return;
         }
-        else
+
+        m_output << "[\n";
+        for (size_t i = 0; i < m_bookmarks.size(); ++i)
         {
-            json.dump(::std::cout, true, 1);
+            const auto& bookmark = m_bookmarks[i];
+
+            if (i != 0)
+                m_output << ",\n";
+
+            indent(2) << "{\n";
+            key(3, "color") << color(bookmark.color) << ",\n";
+            key(3, "text") << escape(bookmark.text) << ",\n";
+            key(3, "timestamp") << bookmark.pos << "\n";
+            indent(2) << "}";
+        }
+
+        m_output << "\n";
+        indent(1) << "]";
+    }
+
+}; // end of class JsonWriter.
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void JsonExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    ::std::ofstream file;
+    if (!outputFile.empty())
+    {
+        file.open(outputFile);
+        if (!file.is_open())
+        {
+            ::std::cerr << "Can not open file " << outputFile << "\n";
+            return;
         }
     }
-    catch (...)
+
+    JsonWriter writer(outputFile.empty() ? ::std::cout : file);
+    ::std::stringstream errorMessage;
+
+    bool ok = false;
+    if (inputFile == "-")
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        ok = readBlocksFromStream(::std::cin, writer, errorMessage);
+    }
+    else
     {
-        ::std::cout << "json.dump() error...";
+        ok = readBlocksFromFile(inputFile.c_str(), writer, errorMessage);
     }
+
+    if (!ok)
+    {
+        ::std::cerr << errorMessage.str() << "\n";
+        return;
+    }
+
+    writer.finish();
 }
@@ -60,12 +60,10 @@ class JsonExporter EASY_FINAL : public EasyProfilerExporter
 public:
 
     ~JsonExporter() override {}
-    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
-
-private:
 
-    void convert(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const;
-    void convertChildren(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const;
+    /** Convert .prof file (or stdin if inputFile is "-") to json file (or stdout if outputFile is empty).
+    */
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
 
 }; // end of class JsonExporter.
 
@@ -17,7 +17,7 @@ int main(int argc, char* argv[])
     {
         std::cout << "Usage: " << argv[0] << " INPUT_PROF_FILE [OUTPUT_JSON_FILE]\n"
                                              "where:\n"
-                                             "INPUT_PROF_FILE // Required\n"
+                                             "INPUT_PROF_FILE (\"-\" to read from stdin) // Required\n"
                                              "OUTPUT_JSON_FILE (if not specified output will be print in stdout) // Optional\n";
         return 1;
     }
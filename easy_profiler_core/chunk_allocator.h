@@ -44,8 +44,10 @@ The Apache License, Version 2.0 (the "License");
 #define EASY_PROFILER_CHUNK_ALLOCATOR_H
 
 #include <easy/details/easy_compiler_support.h>
+#include <atomic>
 #include <cstring>
 #include <ostream>
+#include <vector>
 #include "alignment_helpers.h"
 
 //////////////////////////////////////////////////////////////////////////
@@ -89,16 +91,17 @@ class chunk_allocator
 {
     static_assert(N != 0, "chunk_allocator<N> N must be a positive value");
 
-    struct chunk { EASY_ALIGNED(char, data[N], EASY_ALIGNMENT_SIZE); chunk* prev = nullptr; };
+    struct chunk { EASY_ALIGNED(char, data[N], EASY_ALIGNMENT_SIZE); chunk* prev = nullptr; uint64_t index = 0; uint16_t used = 0; };
 
     struct chunk_list
     {
-        chunk* last;
+        chunk*        last;
+        uint64_t chunksCount; ///< Number of chunks ever allocated (used as unique index of the chunk)
 
         chunk_list(const chunk_list&) = delete;
         chunk_list(chunk_list&&) = delete;
 
-        chunk_list() : last(nullptr)
+        chunk_list() : last(nullptr), chunksCount(0)
         {
             static_assert(sizeof(char) == 1, "easy_profiler logic error: sizeof(char) != 1 for this platform! Please, contact easy_profiler authors to resolve your problem.");
             emplace_back();
@@ -121,9 +124,24 @@ class chunk_allocator
             auto prev = last;
             last = ::new (EASY_MALLOC(sizeof(chunk), EASY_ALIGNMENT_SIZE)) chunk();
             last->prev = prev;
+            last->index = ++chunksCount;
             zero_last_chunk_size();
         }
 
+        /** Free all chunks which are older than _first.
+        */
+        static void free_older(chunk* _first)
+        {
+            auto current = _first->prev;
+            _first->prev = nullptr;
+            while (current != nullptr)
+            {
+                auto p = current->prev;
+                EASY_FREE(current);
+                current = p;
+            }
+        }
+
         /** Invert current chunks list to enable to iterate over chunks list in direct order.
 
         This method is used by serialize().
@@ -162,24 +180,65 @@ class chunk_allocator
         }
     };
 
-    // Used in serialize(): workaround for no constexpr support in MSVC 2013.
-    EASY_STATIC_CONSTEXPR int_fast32_t MaxChunkOffset = N - sizeof(uint16_t);
+    // Used in allocate(): workaround for no constexpr support in MSVC 2013.
     EASY_STATIC_CONSTEXPR uint16_t OneBeforeN = static_cast<uint16_t>(N - 1);
 
-    chunk_list          m_chunks; ///< List of chunks.
-    chunk*         m_markedChunk; ///< Chunk marked by last closed frame
-    uint32_t              m_size; ///< Number of elements stored(# of times allocate() has been called.)
-    uint32_t        m_markedSize; ///< Number of elements to the moment when put_mark() has been called.
-    uint16_t       m_chunkOffset; ///< Number of bytes used in the current chunk.
-    uint16_t m_markedChunkOffset; ///< Last byte in marked chunk for serializing.
+    chunk_list                     m_chunks; ///< List of chunks.
+    chunk*                    m_markedChunk; ///< Chunk marked by last closed frame
+    uint64_t                         m_size; ///< Number of elements stored(# of times allocate() has been called.)
+    uint64_t                   m_markedSize; ///< Number of elements to the moment when put_mark() has been called.
+    uint16_t                  m_chunkOffset; ///< Number of bytes used in the current chunk.
+    uint16_t            m_markedChunkOffset; ///< Last byte in marked chunk for serializing.
+    uint16_t             m_firstChunkOffset; ///< First byte in the oldest chunk for serializing (non-zero after drop_before()).
+    uint32_t                   m_generation; ///< Incremented on each clear(). Used by read_marked() to invalidate positions.
+    std::atomic<chunk*>    m_publishedChunk; ///< Copy of m_markedChunk for readers from other threads (see read_marked()).
+    std::atomic<uint16_t> m_publishedOffset; ///< Copy of m_markedChunkOffset for readers from other threads.
+    std::atomic<uint32_t>  m_publishedSeqNo; ///< Sequence number for consistent reading of m_publishedChunk and m_publishedOffset.
 
 public:
 
+    /** Position of the data which has been already read by read_marked().
+    */
+    struct position
+    {
+        uint64_t     chunk = 0; ///< Index of last visited chunk (0 means "from the beginning")
+        uint16_t    offset = 0; ///< Offset inside last visited chunk
+        uint32_t generation = 0; ///< Generation of the chunk_allocator (see clear())
+    };
+
+    /** End of the closed (marked) data published for readers from other threads (see published_mark()).
+    */
+    struct marked_end
+    {
+        const void* chunk = nullptr; ///< Last marked chunk
+        uint16_t   offset = 0; ///< Offset of the mark inside last marked chunk
+    };
+
+    /** Position of the mark. Used to drop old data (see drop_before()).
+    */
+    struct checkpoint
+    {
+        void*          chunk = nullptr; ///< Marked chunk
+        uint64_t        size = 0; ///< Number of marked elements
+        uint32_t  generation = 0; ///< Generation of the chunk_allocator (see clear())
+        uint16_t      offset = 0; ///< Offset of the mark inside marked chunk
+    };
+
     chunk_allocator(const chunk_allocator&) = delete;
     chunk_allocator(chunk_allocator&&) = delete;
 
-    chunk_allocator() : m_markedChunk(nullptr), m_size(0), m_markedSize(0), m_chunkOffset(0), m_markedChunkOffset(0)
+    chunk_allocator()
+        : m_markedChunk(nullptr)
+        , m_size(0)
+        , m_markedSize(0)
+        , m_chunkOffset(0)
+        , m_markedChunkOffset(0)
+        , m_firstChunkOffset(0)
+        , m_generation(0)
     {
+        m_publishedChunk = ATOMIC_VAR_INIT(nullptr);
+        m_publishedOffset = ATOMIC_VAR_INIT(0);
+        m_publishedSeqNo = ATOMIC_VAR_INIT(0);
     }
 
     /** Allocate n bytes.
@@ -210,6 +269,7 @@ public:
             return data;
         }
 
+        m_chunks.last->used = m_chunkOffset; // Remember the end of data for serialize()
         m_chunkOffset = n + sizeof(uint16_t);
         m_chunks.emplace_back();
 
@@ -230,7 +290,7 @@ public:
         return (m_chunkOffset + n + sizeof(uint16_t)) > N;
     }
 
-    uint32_t size() const
+    uint64_t size() const
     {
         return m_size;
     }
@@ -240,7 +300,7 @@ public:
         return m_size == 0;
     }
 
-    uint32_t markedSize() const
+    uint64_t markedSize() const
     {
         return m_markedSize;
     }
@@ -255,49 +315,41 @@ public:
         m_size = 0;
         m_markedSize = 0;
         m_chunkOffset = 0;
+        m_firstChunkOffset = 0;
         m_markedChunk = nullptr;
+        ++m_generation;
+        publish_mark();
         m_chunks.clear_all_except_last(); // There is always at least one chunk
     }
 
-    /** Serialize data to stream.
+    /** Serialize data.
+
+    Elements are stored in chunks exactly as they should be serialized: [uint16_t size][payload][uint16_t size][payload]...
+    So the used part of each chunk is passed to _write(const char* data, uint16_t size) as one span
+    directly from the chunk memory without copying.
 
     \warning Data will be cleared after serialization.
     */
-    void serialize(std::ostream& _outputStream)
+    template <class TWriter>
+    void serialize(TWriter _write)
     {
         // Chunks are stored in reversed order (stack).
         // To be able to iterate them in direct order we have to invert the chunks list.
         m_chunks.invert();
 
-        // Each chunk is an array of N bytes that can hold between
-        // 1(if the list isn't empty) and however many elements can fit in a chunk,
-        // where an element consists of a payload size + a payload as follows:
-        // elementStart[0..1]: size as a uint16_t
-        // elementStart[2..size-1]: payload.
-        
-        // The maximum chunk offset is N-sizeof(uint16_t) b/c, if we hit that (or go past),
-        // there is either no space left, 1 byte left, or 2 bytes left, all of which are
-        // too small to cary more than a zero-sized element.
-
         chunk* current = m_chunks.last;
         bool isMarked;
         do {
 
             isMarked = (current == m_markedChunk);
-            const char* data = current->data;
 
-            const int_fast32_t maxOffset = isMarked ? m_markedChunkOffset : MaxChunkOffset;
-            int_fast32_t chunkOffset = 0; // signed int so overflow is not checked.
-            auto payloadSize = unaligned_load16<uint16_t>(data);
+            // The oldest chunk may contain dropped data at the beginning (see drop_before()).
+            // The newest chunk (the last one after invert) is still being filled, so it's end is m_chunkOffset.
+            const uint16_t begin = current == m_chunks.last ? m_firstChunkOffset : static_cast<uint16_t>(0);
+            const uint16_t end = isMarked ? m_markedChunkOffset : (current->prev == nullptr ? m_chunkOffset : current->used);
 
-            while (chunkOffset < maxOffset && payloadSize != 0)
-            {
-                const uint16_t chunkSize = sizeof(uint16_t) + payloadSize;
-                _outputStream.write(data, chunkSize);
-                data += chunkSize;
-                chunkOffset += chunkSize;
-                unaligned_load16(data, &payloadSize);
-            }
+            if (end > begin)
+                _write(current->data + begin, static_cast<uint16_t>(end - begin));
 
             current = current->prev;
 
@@ -311,6 +363,134 @@ public:
         m_markedChunk = m_chunks.last;
         m_markedSize = m_size;
         m_markedChunkOffset = m_chunkOffset;
+        publish_mark();
+    }
+
+    /** Returns end of the closed (marked) data.
+
+    \note Can be invoked from another thread concurrently with allocate() and put_mark().
+    */
+    marked_end published_mark() const
+    {
+        // This is a sequence lock reader side.
+        marked_end end;
+        for (;;)
+        {
+            const auto seqNo = m_publishedSeqNo.load(std::memory_order_acquire);
+            if (seqNo & 1)
+                continue; // Mark is being updated right now
+
+            end.chunk = m_publishedChunk.load(std::memory_order_relaxed);
+            end.offset = m_publishedOffset.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_publishedSeqNo.load(std::memory_order_relaxed) == seqNo)
+                return end;
+        }
+    }
+
+    /** Visit closed (marked) data which has been added since _pos up to _end.
+
+    Calls _func(const char* data, size_t size) for each contiguous span of serialized elements
+    in direct order and moves _pos to the end of visited data.
+    Data is not cleared, so it will be serialized by serialize() as usual.
+
+    \note Can be invoked from another thread concurrently with allocate() and put_mark()
+    but must not be invoked concurrently with serialize(), clear() and marked_allocate().
+
+    \param _end Mark loaded by published_mark() after the last clear().
+    \param _chunks Temporary buffer for chunks list (to avoid allocations on each call).
+    */
+    template <class TFunc>
+    void read_marked(position& _pos, const marked_end& _end, std::vector<const void*>& _chunks, TFunc _func) const
+    {
+        if (_pos.generation != m_generation)
+        {
+            _pos = position();
+            _pos.generation = m_generation;
+        }
+
+        const auto last = static_cast<const chunk*>(_end.chunk);
+        const uint16_t lastOffset = _end.offset;
+
+        if (last == nullptr || (last->index == _pos.chunk && lastOffset <= _pos.offset))
+            return;
+
+        // Chunks are stored in reversed order (stack). Collect chunks from the last
+        // marked chunk down to the previously visited chunk to iterate them in direct order.
+        _chunks.clear();
+        for (const chunk* current = last; current != nullptr && current->index >= _pos.chunk; current = current->prev)
+            _chunks.push_back(current);
+
+        for (auto it = _chunks.rbegin(); it != _chunks.rend(); ++it)
+        {
+            const auto current = static_cast<const chunk*>(*it);
+
+            // If previously visited chunk has been dropped (see drop_before()) then start from the oldest chunk
+            int_fast32_t beginOffset = current->index == _pos.chunk ? _pos.offset : 0;
+            if (current->prev == nullptr && beginOffset < m_firstChunkOffset)
+                beginOffset = m_firstChunkOffset;
+
+            const int_fast32_t endOffset = current == last ? lastOffset : current->used;
+
+            if (endOffset > beginOffset)
+                _func(current->data + beginOffset, static_cast<size_t>(endOffset - beginOffset));
+        }
+
+        _pos.chunk = last->index;
+        _pos.offset = lastOffset;
+    }
+
+    /** Returns position of the last mark.
+    */
+    checkpoint mark_checkpoint() const
+    {
+        checkpoint cp;
+        cp.chunk = m_markedChunk;
+        cp.size = m_markedSize;
+        cp.generation = m_generation;
+        cp.offset = m_markedChunkOffset;
+        return cp;
+    }
+
+    /** Returns position of the end of all stored data (including data after the last mark).
+
+    Used for lists which are serialized without marks (context switches).
+    */
+    checkpoint end_checkpoint() const
+    {
+        checkpoint cp;
+        cp.chunk = m_chunks.last;
+        cp.size = m_size;
+        cp.generation = m_generation;
+        cp.offset = m_chunkOffset;
+        return cp;
+    }
+
+    /** Drop all elements which have been stored before the checkpoint _cp.
+
+    Used to keep only recent history of blocks. Chunks before the checkpoint are freed.
+
+    \note Must be invoked by the owner thread (the one which invokes allocate()) or under the lock protecting allocate(),
+    and must not be invoked concurrently with serialize() and read_marked().
+
+    \retval Number of dropped elements.
+    */
+    uint64_t drop_before(const checkpoint& _cp)
+    {
+        if (_cp.chunk == nullptr || _cp.generation != m_generation || _cp.size > m_size)
+            return 0;
+
+        // Marked chunk must not be freed
+        if (m_markedChunk != nullptr && _cp.size > m_markedSize)
+            return 0;
+
+        chunk_list::free_older(static_cast<chunk*>(_cp.chunk));
+        m_firstChunkOffset = _cp.offset;
+        m_size -= _cp.size;
+        m_markedSize = m_markedSize > _cp.size ? m_markedSize - _cp.size : 0;
+
+        return _cp.size;
     }
 
     void* marked_allocate(uint16_t n)
@@ -347,6 +527,7 @@ public:
             return data;
         }
 
+        marked->used = m_markedChunkOffset; // Data after the mark is not used anymore
         chunkOffset = n + sizeof(uint16_t);
         m_markedChunkOffset = chunkOffset;
 
@@ -374,6 +555,20 @@ public:
         return data;
     }
 
+private:
+
+    /** Publish current mark for readers from other threads (sequence lock writer side).
+    */
+    void publish_mark()
+    {
+        const auto seqNo = m_publishedSeqNo.load(std::memory_order_relaxed);
+        m_publishedSeqNo.store(seqNo + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_publishedChunk.store(m_markedChunk, std::memory_order_relaxed);
+        m_publishedOffset.store(m_markedChunkOffset, std::memory_order_relaxed);
+        m_publishedSeqNo.store(seqNo + 2, std::memory_order_release);
+    }
+
 }; // END of class chunk_allocator.
 
 //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,1256 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "compression.h"
+#include <easy/decompressor.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if EASY_OPTION_ZLIB_COMPRESSION_ENABLED != 0
+# include <zlib.h>
+#endif
+
+extern const uint32_t EASY_PROFILER_COMPRESSED_SIGNATURE;
+extern const uint32_t EASY_PROFILER_VERSION;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+// LZ4 block format: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+
+EASY_CONSTEXPR int      LZ4_HASH_LOG      = 16;
+EASY_CONSTEXPR uint64_t LZ4_MIN_MATCH     = 4;
+EASY_CONSTEXPR uint64_t LZ4_LAST_LITERALS = 5; ///< Last 5 bytes of the block are always literals
+EASY_CONSTEXPR uint64_t LZ4_MF_LIMIT      = 12; ///< Last match must start at least 12 bytes before the end of the block
+EASY_CONSTEXPR uint64_t LZ4_MAX_OFFSET    = 65535;
+
+inline uint32_t read32(const uint8_t* _ptr)
+{
+    uint32_t value;
+    memcpy(&value, _ptr, sizeof(value));
+    return value;
+}
+
+inline uint32_t lz4Hash(uint32_t _sequence)
+{
+    return (_sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+EASY_CONSTEXPR_FCN uint64_t lz4Bound(uint64_t _size)
+{
+    return _size + _size / 255 + 16;
+}
+
+uint8_t* lz4WriteLength(uint8_t* _output, uint64_t _length)
+{
+    for (; _length >= 255; _length -= 255)
+        *_output++ = 255;
+    *_output++ = static_cast<uint8_t>(_length);
+    return _output;
+}
+
+uint8_t* lz4WriteLiterals(uint8_t* _output, const uint8_t* _literals, uint64_t _length, uint8_t*& _token)
+{
+    _token = _output++;
+    *_token = static_cast<uint8_t>(std::min(_length, static_cast<uint64_t>(15)) << 4);
+    if (_length >= 15)
+        _output = lz4WriteLength(_output, _length - 15);
+    memcpy(_output, _literals, _length);
+    return _output + _length;
+}
+
+/** Greedy single-pass compressor.
+
+\param _output Must have at least lz4Bound(_size) bytes.
+
+\retval Packed size.
+*/
+uint64_t lz4Compress(const char* _input, uint64_t _size, char* _output, std::vector<uint32_t>& _table)
+{
+    const auto base = reinterpret_cast<const uint8_t*>(_input);
+    const auto end = base + _size;
+    auto ip = base;
+    auto anchor = base;
+    auto op = reinterpret_cast<uint8_t*>(_output);
+    uint8_t* token = nullptr;
+
+    if (_size > LZ4_MF_LIMIT)
+    {
+        const auto mflimit = end - LZ4_MF_LIMIT;
+        const auto matchlimit = end - LZ4_LAST_LITERALS;
+        _table.assign(static_cast<size_t>(1) << LZ4_HASH_LOG, 0);
+
+        while (ip < mflimit)
+        {
+            const auto sequence = read32(ip);
+            auto& slot = _table[lz4Hash(sequence)];
+            auto ref = base + slot;
+            slot = static_cast<uint32_t>(ip - base);
+
+            if (ref >= ip || static_cast<uint64_t>(ip - ref) > LZ4_MAX_OFFSET || read32(ref) != sequence)
+            {
+                // Skip faster through incompressible data
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+
+            auto matchEnd = ip + LZ4_MIN_MATCH;
+            auto refEnd = ref + LZ4_MIN_MATCH;
+            while (matchEnd < matchlimit && *matchEnd == *refEnd)
+            {
+                ++matchEnd;
+                ++refEnd;
+            }
+
+            op = lz4WriteLiterals(op, anchor, static_cast<uint64_t>(ip - anchor), token);
+
+            const auto offset = static_cast<uint16_t>(ip - ref);
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+
+            const auto matchLength = static_cast<uint64_t>(matchEnd - ip) - LZ4_MIN_MATCH;
+            *token |= static_cast<uint8_t>(std::min(matchLength, static_cast<uint64_t>(15)));
+            if (matchLength >= 15)
+                op = lz4WriteLength(op, matchLength - 15);
+
+            ip = anchor = matchEnd;
+        }
+    }
+
+    op = lz4WriteLiterals(op, anchor, static_cast<uint64_t>(end - anchor), token);
+
+    return static_cast<uint64_t>(op - reinterpret_cast<uint8_t*>(_output));
+}
+
+bool lz4ReadLength(const uint8_t*& _input, const uint8_t* _end, uint64_t& _length)
+{
+    uint8_t byte = 0;
+    do {
+        if (_input == _end)
+            return false;
+        byte = *_input++;
+        _length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/** Decompressor checking all bounds (packed data could be corrupted).
+*/
+bool lz4Decompress(const char* _input, uint64_t _size, char* _output, uint64_t _outputSize)
+{
+    auto ip = reinterpret_cast<const uint8_t*>(_input);
+    const auto iend = ip + _size;
+    const auto obegin = reinterpret_cast<uint8_t*>(_output);
+    const auto oend = obegin + _outputSize;
+    auto op = obegin;
+
+    while (ip < iend)
+    {
+        const auto token = *ip++;
+
+        uint64_t literals = token >> 4;
+        if (literals == 15 && !lz4ReadLength(ip, iend, literals))
+            return false;
+
+        if (literals > static_cast<uint64_t>(iend - ip) || literals > static_cast<uint64_t>(oend - op))
+            return false;
+
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        if (ip == iend)
+            break; // Last sequence has no match
+
+        if (iend - ip < 2)
+            return false;
+
+        const uint64_t offset = static_cast<uint64_t>(ip[0]) | (static_cast<uint64_t>(ip[1]) << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<uint64_t>(op - obegin))
+            return false;
+
+        uint64_t matchLength = token & 15;
+        if (matchLength == 15 && !lz4ReadLength(ip, iend, matchLength))
+            return false;
+        matchLength += LZ4_MIN_MATCH;
+
+        if (matchLength > static_cast<uint64_t>(oend - op))
+            return false;
+
+        const uint8_t* match = op - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        }
+        else
+        {
+            // Overlapping copy repeats last offset bytes
+            for (const auto mend = op + matchLength; op != mend;)
+                *op++ = *match++;
+        }
+    }
+
+    return op == oend;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool pack(profiler::CompressionCodec _codec, const std::vector<char>& _raw, std::vector<char>& _packed)
+{
+    switch (_codec)
+    {
+        case profiler::CompressionCodec::LZ4:
+        {
+            std::vector<uint32_t> table;
+            _packed.resize(static_cast<size_t>(lz4Bound(_raw.size())));
+            _packed.resize(static_cast<size_t>(lz4Compress(_raw.data(), _raw.size(), _packed.data(), table)));
+            return true;
+        }
+
+#if EASY_OPTION_ZLIB_COMPRESSION_ENABLED != 0
+        case profiler::CompressionCodec::Zlib:
+        {
+            auto packedSize = compressBound(static_cast<uLong>(_raw.size()));
+            _packed.resize(static_cast<size_t>(packedSize));
+            const auto result = compress2(reinterpret_cast<Bytef*>(_packed.data()), &packedSize,
+                                          reinterpret_cast<const Bytef*>(_raw.data()),
+                                          static_cast<uLong>(_raw.size()), Z_DEFAULT_COMPRESSION);
+            if (result != Z_OK)
+                return false;
+            _packed.resize(static_cast<size_t>(packedSize));
+            return true;
+        }
+#endif
+
+        default:
+            return false;
+    }
+}
+
+bool unpack(profiler::CompressionCodec _codec, const std::vector<char>& _packed, std::vector<char>& _raw)
+{
+    switch (_codec)
+    {
+        case profiler::CompressionCodec::None:
+        {
+            if (_packed.size() != _raw.size())
+                return false;
+            memcpy(_raw.data(), _packed.data(), _raw.size());
+            return true;
+        }
+
+        case profiler::CompressionCodec::LZ4:
+            return lz4Decompress(_packed.data(), _packed.size(), _raw.data(), _raw.size());
+
+#if EASY_OPTION_ZLIB_COMPRESSION_ENABLED != 0
+        case profiler::CompressionCodec::Zlib:
+        {
+            auto rawSize = static_cast<uLongf>(_raw.size());
+            const auto result = uncompress(reinterpret_cast<Bytef*>(_raw.data()), &rawSize,
+                                           reinterpret_cast<const Bytef*>(_packed.data()),
+                                           static_cast<uLong>(_packed.size()));
+            return result == Z_OK && rawSize == _raw.size();
+        }
+#endif
+
+        default:
+            return false;
+    }
+}
+
+/** Header, descriptors, footer and each thread are always packed into separate blocks.
+*/
+profiler::SinkSection sectionGroup(profiler::SinkSection _section)
+{
+    switch (_section)
+    {
+        case profiler::SinkSection::ContextSwitches:
+        case profiler::SinkSection::Blocks:
+            return profiler::SinkSection::ThreadInfo;
+
+        default:
+            return _section;
+    }
+}
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler { namespace compression {
+
+bool isCodecAvailable(profiler::CompressionCodec _codec)
+{
+    switch (_codec)
+    {
+        case profiler::CompressionCodec::None:
+        case profiler::CompressionCodec::LZ4:
+            return true;
+
+#if EASY_OPTION_ZLIB_COMPRESSION_ENABLED != 0
+        case profiler::CompressionCodec::Zlib:
+            return true;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+profiler::CompressionCodec availableCodec(profiler::CompressionCodec _codec)
+{
+    return isCodecAvailable(_codec) ? _codec : profiler::CompressionCodec::LZ4;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CodecWorkers::CodecWorkers() : m_stopFlag(false)
+{
+    // Calling thread is busy with serialization/parsing, so leave one core for it
+    const unsigned concurrency = std::thread::hardware_concurrency();
+    const unsigned count = concurrency > 1 ? std::min(concurrency - 1, 8U) : 0U;
+
+    m_threads.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        m_threads.emplace_back(&CodecWorkers::worker, this);
+}
+
+CodecWorkers::~CodecWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopFlag = true;
+    }
+
+    m_cv.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+std::future<bool> CodecWorkers::async(std::function<bool()> _task)
+{
+    std::packaged_task<bool()> task(std::move(_task));
+    auto future = task.get_future();
+
+    if (m_threads.empty())
+    {
+        task();
+        return future;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace_back(std::move(task));
+    }
+
+    m_cv.notify_one();
+    return future;
+}
+
+size_t CodecWorkers::queueLimit() const
+{
+    return m_threads.size() * 2 + 1;
+}
+
+void CodecWorkers::worker()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return !m_tasks.empty() || m_stopFlag; });
+
+        if (m_stopFlag)
+            break; // Results of the rest tasks are not needed anymore
+
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        lock.unlock();
+
+        task();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ChunkedCompressor::ChunkedCompressor(profiler::CompressionCodec _codec, output_t _output, uint32_t _blockSize)
+    : m_output(std::move(_output))
+    , m_offset(0)
+    , m_rawOffset(0)
+    , m_blockSize(std::min(std::max(_blockSize, 4096U), MAX_BLOCK_SIZE))
+    , m_codec(availableCodec(_codec))
+    , m_started(false)
+{
+}
+
+ChunkedCompressor::~ChunkedCompressor()
+{
+}
+
+void ChunkedCompressor::write(profiler::SinkSection _section, profiler::thread_id_t _thread, const char* _data,
+                              uint64_t _size)
+{
+    if (m_current != nullptr && (m_current->header.thread != _thread ||
+        sectionGroup(static_cast<profiler::SinkSection>(m_current->header.section)) != sectionGroup(_section)))
+    {
+        seal();
+    }
+
+    while (_size != 0)
+    {
+        if (m_current == nullptr)
+        {
+            m_current.reset(new Block());
+            m_current->header.packed_size = 0;
+            m_current->header.raw_size = 0;
+            m_current->header.thread = _thread;
+            m_current->header.codec = static_cast<uint8_t>(m_codec);
+            m_current->header.section = static_cast<uint8_t>(_section);
+            m_current->header.reserved = 0;
+            m_current->rawOffset = m_rawOffset;
+        }
+
+        auto& raw = m_current->raw;
+        const auto size = std::min(_size, static_cast<uint64_t>(m_blockSize - raw.size()));
+        raw.insert(raw.end(), _data, _data + size);
+        _data += size;
+        _size -= size;
+
+        if (raw.size() == m_blockSize)
+            seal();
+    }
+}
+
+void ChunkedCompressor::seal()
+{
+    if (m_current == nullptr)
+        return;
+
+    auto block = m_current.get();
+    block->header.raw_size = static_cast<uint32_t>(block->raw.size());
+    m_rawOffset += block->raw.size();
+
+    block->result = m_workers.async([block] {
+        auto& header = block->header;
+        if (!pack(static_cast<profiler::CompressionCodec>(header.codec), block->raw, block->packed) ||
+            block->packed.size() >= block->raw.size())
+        {
+            // Incompressible data is stored as is
+            header.codec = static_cast<uint8_t>(profiler::CompressionCodec::None);
+            block->packed.swap(block->raw);
+        }
+
+        header.packed_size = static_cast<uint32_t>(block->packed.size());
+        std::vector<char>().swap(block->raw);
+
+        return true;
+    });
+
+    m_blocks.push_back(std::move(m_current));
+    flush(false);
+}
+
+void ChunkedCompressor::finish()
+{
+    seal();
+    flush(true);
+
+    if (!m_started)
+        return;
+
+    BlockHeader end;
+    memset(&end, 0, sizeof(end));
+    output(profiler::SinkSection::Footer, 0, reinterpret_cast<const char*>(&end), sizeof(end));
+
+    const auto tableOffset = m_offset;
+    const auto blocksCount = static_cast<uint32_t>(m_table.size());
+    output(profiler::SinkSection::Footer, 0, reinterpret_cast<const char*>(&blocksCount), sizeof(blocksCount));
+    if (!m_table.empty())
+    {
+        output(profiler::SinkSection::Footer, 0, reinterpret_cast<const char*>(m_table.data()),
+               m_table.size() * sizeof(BlockTableEntry));
+    }
+    output(profiler::SinkSection::Footer, 0, reinterpret_cast<const char*>(&tableOffset), sizeof(tableOffset));
+    output(profiler::SinkSection::Footer, 0, reinterpret_cast<const char*>(&EASY_PROFILER_COMPRESSED_SIGNATURE),
+           sizeof(EASY_PROFILER_COMPRESSED_SIGNATURE));
+
+    m_table.clear();
+    m_started = false;
+}
+
+uint64_t ChunkedCompressor::rawSize() const
+{
+    return m_rawOffset + (m_current != nullptr ? m_current->raw.size() : 0);
+}
+
+uint64_t ChunkedCompressor::packedSize() const
+{
+    return m_offset;
+}
+
+void ChunkedCompressor::flush(bool _all)
+{
+    while (!m_blocks.empty())
+    {
+        auto& block = *m_blocks.front();
+
+        if (!_all && m_blocks.size() <= m_workers.queueLimit() &&
+            block.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            break;
+        }
+
+        block.result.get();
+
+        const auto section = static_cast<profiler::SinkSection>(block.header.section);
+        const BlockTableEntry entry = {m_offset + (m_started ? 0 : sizeof(ContainerHeader)), block.rawOffset};
+        m_table.push_back(entry);
+
+        output(section, block.header.thread, reinterpret_cast<const char*>(&block.header), sizeof(BlockHeader));
+        output(section, block.header.thread, block.packed.data(), block.packed.size());
+
+        m_blocks.pop_front();
+    }
+}
+
+void ChunkedCompressor::output(profiler::SinkSection _section, profiler::thread_id_t _thread, const char* _data,
+                               uint64_t _size)
+{
+    if (!m_started)
+    {
+        m_started = true;
+
+        ContainerHeader header;
+        header.signature = EASY_PROFILER_COMPRESSED_SIGNATURE;
+        header.version = EASY_PROFILER_VERSION;
+        header.max_block_size = m_blockSize;
+        header.reserved = 0;
+
+        m_output(profiler::SinkSection::Header, 0, reinterpret_cast<const char*>(&header), sizeof(header));
+        m_offset += sizeof(header);
+    }
+
+    m_output(_section, _thread, _data, _size);
+    m_offset += _size;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CompressingStreamBuf::CompressingStreamBuf(std::ostream& _target, profiler::CompressionCodec _codec)
+    : m_compressor(_codec, [&_target](profiler::SinkSection, profiler::thread_id_t, const char* _data, uint64_t _size) {
+        _target.write(_data, static_cast<std::streamsize>(_size));
+    })
+    , m_buffer(64 * 1024)
+    , m_section(profiler::SinkSection::Header)
+    , m_thread(0)
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+void CompressingStreamBuf::beginSection(profiler::SinkSection _section, profiler::thread_id_t _thread)
+{
+    flushBuffer();
+    m_section = _section;
+    m_thread = _thread;
+}
+
+void CompressingStreamBuf::finish()
+{
+    flushBuffer();
+    m_compressor.finish();
+}
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type _ch)
+{
+    flushBuffer();
+
+    if (!traits_type::eq_int_type(_ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(_ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(_ch);
+}
+
+std::streamsize CompressingStreamBuf::xsputn(const char* _data, std::streamsize _size)
+{
+    if (static_cast<size_t>(_size) >= m_buffer.size())
+    {
+        flushBuffer();
+        m_compressor.write(m_section, m_thread, _data, static_cast<uint64_t>(_size));
+        return _size;
+    }
+
+    std::streamsize written = 0;
+    while (written < _size)
+    {
+        const auto room = static_cast<std::streamsize>(epptr() - pptr());
+        if (room == 0)
+        {
+            flushBuffer();
+            continue;
+        }
+
+        const auto size = std::min(room, _size - written);
+        memcpy(pptr(), _data + written, static_cast<size_t>(size));
+        pbump(static_cast<int>(size));
+        written += size;
+    }
+
+    return written;
+}
+
+int CompressingStreamBuf::sync()
+{
+    flushBuffer();
+    return 0;
+}
+
+void CompressingStreamBuf::flushBuffer()
+{
+    if (pptr() != pbase())
+        m_compressor.write(m_section, m_thread, pbase(), static_cast<uint64_t>(pptr() - pbase()));
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+CompressedOutputStream::CompressedOutputStream(std::ostream& _target, profiler::CompressionCodec _codec)
+    : std::ostream(nullptr)
+    , m_buffer(_target, _codec)
+{
+    rdbuf(&m_buffer);
+}
+
+void CompressedOutputStream::beginSection(profiler::SinkSection _section, profiler::thread_id_t _thread)
+{
+    m_buffer.beginSection(_section, _thread);
+}
+
+void CompressedOutputStream::finish()
+{
+    m_buffer.finish();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+DecompressingStreamBuf::DecompressingStreamBuf(std::istream& _source)
+    : m_source(_source)
+    , m_version(0)
+    , m_maxBlockSize(0)
+    , m_sourceEnd(false)
+{
+    setg(nullptr, nullptr, nullptr);
+}
+
+bool DecompressingStreamBuf::open()
+{
+    ContainerHeader header;
+    m_source.read(reinterpret_cast<char*>(&header) + sizeof(header.signature),
+                  sizeof(header) - sizeof(header.signature));
+    if (!m_source)
+    {
+        setError("Unexpected end of compressed file/stream");
+        return false;
+    }
+
+    if (header.max_block_size == 0 || header.max_block_size > MAX_BLOCK_SIZE)
+    {
+        setError("Wrong compressed block size.\nFile/Stream corrupted.");
+        return false;
+    }
+
+    m_version = header.version;
+    m_maxBlockSize = header.max_block_size;
+
+    readAhead();
+
+    return m_error.empty();
+}
+
+uint32_t DecompressingStreamBuf::version() const
+{
+    return m_version;
+}
+
+const std::string& DecompressingStreamBuf::error() const
+{
+    return m_error;
+}
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    readAhead();
+
+    if (m_blocks.empty())
+        return traits_type::eof();
+
+    std::unique_ptr<Block> block(std::move(m_blocks.front()));
+    m_blocks.pop_front();
+
+    if (!block->result.get())
+    {
+        setError("Can not decompress block.\nFile/Stream corrupted.");
+        m_blocks.clear();
+        m_sourceEnd = true;
+        return traits_type::eof();
+    }
+
+    m_current.swap(block->raw);
+
+    // Keep workers busy while the caller is parsing current block
+    readAhead();
+
+    setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+void DecompressingStreamBuf::readAhead()
+{
+    while (!m_sourceEnd && m_error.empty() && m_blocks.size() < m_workers.queueLimit())
+    {
+        std::unique_ptr<Block> block(new Block());
+        auto& header = block->header;
+
+        m_source.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!m_source)
+        {
+            setError("Unexpected end of compressed file/stream");
+            return;
+        }
+
+        if (header.raw_size == 0)
+        {
+            // End of blocks. Block table is not needed for sequential reading.
+            m_sourceEnd = true;
+            return;
+        }
+
+        const auto codec = static_cast<profiler::CompressionCodec>(header.codec);
+        if (!isCodecAvailable(codec))
+        {
+            setError("Unsupported compression codec.\nRebuild easy_profiler with zlib to read this file/stream.");
+            return;
+        }
+
+        if (header.raw_size > m_maxBlockSize || header.packed_size > header.raw_size)
+        {
+            setError("Wrong compressed block size.\nFile/Stream corrupted.");
+            return;
+        }
+
+        block->packed.resize(header.packed_size);
+        m_source.read(block->packed.data(), header.packed_size);
+        if (!m_source)
+        {
+            setError("Unexpected end of compressed file/stream");
+            return;
+        }
+
+        auto ptr = block.get();
+        block->result = m_workers.async([ptr, codec] {
+            ptr->raw.resize(ptr->header.raw_size);
+            const bool result = unpack(codec, ptr->packed, ptr->raw);
+            std::vector<char>().swap(ptr->packed);
+            return result;
+        });
+
+        m_blocks.push_back(std::move(block));
+    }
+}
+
+void DecompressingStreamBuf::setError(const char* _message)
+{
+    if (m_error.empty())
+        m_error = _message;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ChunkedDecompressor::ChunkedDecompressor(output_t _output)
+    : m_output(std::move(_output))
+    , m_maxBlockSize(0)
+    , m_state(State::Signature)
+{
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+bool ChunkedDecompressor::write(const char* _data, uint64_t _size)
+{
+    while (_size != 0)
+    {
+        switch (m_state)
+        {
+            case State::Plain:
+                m_output(_data, _size);
+                return true;
+
+            case State::Table:
+                return true;
+
+            case State::Failed:
+                return false;
+
+            default:
+                break;
+        }
+
+        const auto size = std::min(_size, expectedSize() - m_pending.size());
+        m_pending.insert(m_pending.end(), _data, _data + size);
+        _data += size;
+        _size -= size;
+
+        if (m_pending.size() == expectedSize())
+            process();
+    }
+
+    flush(false);
+
+    return m_state != State::Failed;
+}
+
+bool ChunkedDecompressor::finish()
+{
+    flush(true);
+
+    switch (m_state)
+    {
+        case State::Signature:
+            if (!m_pending.empty())
+            {
+                // Too short to be a compressed container
+                m_output(m_pending.data(), m_pending.size());
+                m_pending.clear();
+            }
+            break;
+
+        case State::Header:
+        case State::BlockHeader:
+        case State::BlockData:
+            setError("Unexpected end of compressed stream");
+            break;
+
+        default:
+            break;
+    }
+
+    return m_state != State::Failed;
+}
+
+const std::string& ChunkedDecompressor::error() const
+{
+    return m_error;
+}
+
+uint64_t ChunkedDecompressor::expectedSize() const
+{
+    switch (m_state)
+    {
+        case State::Signature: return sizeof(uint32_t);
+        case State::Header: return sizeof(ContainerHeader);
+        case State::BlockHeader: return sizeof(BlockHeader);
+        case State::BlockData: return m_header.packed_size;
+        default: return 0;
+    }
+}
+
+void ChunkedDecompressor::process()
+{
+    switch (m_state)
+    {
+        case State::Signature:
+        {
+            uint32_t signature = 0;
+            memcpy(&signature, m_pending.data(), sizeof(signature));
+            if (signature == EASY_PROFILER_COMPRESSED_SIGNATURE)
+            {
+                m_state = State::Header;
+                return;
+            }
+
+            m_state = State::Plain;
+            m_output(m_pending.data(), m_pending.size());
+            m_pending.clear();
+            return;
+        }
+
+        case State::Header:
+        {
+            ContainerHeader header;
+            memcpy(&header, m_pending.data(), sizeof(header));
+            m_pending.clear();
+
+            if (header.max_block_size == 0 || header.max_block_size > MAX_BLOCK_SIZE)
+            {
+                setError("Wrong compressed block size.\nStream corrupted.");
+                return;
+            }
+
+            m_maxBlockSize = header.max_block_size;
+            m_state = State::BlockHeader;
+            return;
+        }
+
+        case State::BlockHeader:
+        {
+            memcpy(&m_header, m_pending.data(), sizeof(m_header));
+            m_pending.clear();
+
+            if (m_header.raw_size == 0)
+            {
+                m_state = State::Table;
+                return;
+            }
+
+            if (!isCodecAvailable(static_cast<profiler::CompressionCodec>(m_header.codec)))
+            {
+                setError("Unsupported compression codec");
+                return;
+            }
+
+            if (m_header.raw_size > m_maxBlockSize || m_header.packed_size == 0 ||
+                m_header.packed_size > m_header.raw_size)
+            {
+                setError("Wrong compressed block size.\nStream corrupted.");
+                return;
+            }
+
+            m_pending.reserve(m_header.packed_size);
+            m_state = State::BlockData;
+            return;
+        }
+
+        case State::BlockData:
+        {
+            std::unique_ptr<Block> block(new Block());
+            block->header = m_header;
+            block->packed.swap(m_pending);
+
+            auto ptr = block.get();
+            block->result = m_workers.async([ptr] {
+                ptr->raw.resize(ptr->header.raw_size);
+                const bool result = unpack(static_cast<profiler::CompressionCodec>(ptr->header.codec), ptr->packed,
+                                           ptr->raw);
+                std::vector<char>().swap(ptr->packed);
+                return result;
+            });
+
+            m_blocks.push_back(std::move(block));
+            m_state = State::BlockHeader;
+
+            flush(false);
+            return;
+        }
+
+        default:
+            return;
+    }
+}
+
+void ChunkedDecompressor::flush(bool _all)
+{
+    while (!m_blocks.empty())
+    {
+        auto& block = *m_blocks.front();
+
+        if (!_all && m_blocks.size() <= m_workers.queueLimit() &&
+            block.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            break;
+        }
+
+        if (!block.result.get())
+        {
+            setError("Can not decompress block.\nStream corrupted.");
+            m_blocks.clear();
+            return;
+        }
+
+        m_output(block.raw.data(), block.raw.size());
+        m_blocks.pop_front();
+    }
+}
+
+void ChunkedDecompressor::setError(const char* _message)
+{
+    if (m_error.empty())
+        m_error = _message;
+    m_state = State::Failed;
+    m_pending.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CompressedInputStream::CompressedInputStream(std::istream& _source)
+    : std::istream(nullptr)
+    , m_buffer(_source)
+{
+    rdbuf(&m_buffer);
+    if (!m_buffer.open())
+        setstate(std::ios::failbit);
+}
+
+uint32_t CompressedInputStream::version() const
+{
+    return m_buffer.version();
+}
+
+const std::string& CompressedInputStream::error() const
+{
+    return m_buffer.error();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+BlockTableReader::BlockTableReader(std::istream& _source)
+    : m_source(_source)
+    , m_begin(_source.tellg())
+    , m_rawSize(0)
+    , m_blockIndex(0)
+{
+}
+
+bool BlockTableReader::open()
+{
+    m_source.seekg(0, std::ios::end);
+    const auto containerSize = static_cast<uint64_t>(m_source.tellg() - m_begin);
+
+    uint64_t tableOffset = 0;
+    uint32_t signature = 0;
+    if (!m_source || containerSize < sizeof(ContainerHeader) + sizeof(tableOffset) + sizeof(signature))
+    {
+        m_error = "Compressed container is too small";
+        return false;
+    }
+
+    m_source.seekg(m_begin + static_cast<std::streamoff>(containerSize - sizeof(tableOffset) - sizeof(signature)));
+    m_source.read(reinterpret_cast<char*>(&tableOffset), sizeof(tableOffset));
+    m_source.read(reinterpret_cast<char*>(&signature), sizeof(signature));
+    if (!m_source || signature != EASY_PROFILER_COMPRESSED_SIGNATURE || tableOffset >= containerSize)
+    {
+        m_error = "Bad compressed container footer";
+        return false;
+    }
+
+    uint32_t blocksCount = 0;
+    m_source.seekg(m_begin + static_cast<std::streamoff>(tableOffset));
+    m_source.read(reinterpret_cast<char*>(&blocksCount), sizeof(blocksCount));
+    if (!m_source || blocksCount == 0 || blocksCount > (containerSize - tableOffset) / sizeof(BlockTableEntry))
+    {
+        m_error = "Bad compressed container block table";
+        return false;
+    }
+
+    m_table.resize(blocksCount);
+    m_source.read(reinterpret_cast<char*>(m_table.data()), static_cast<std::streamsize>(blocksCount * sizeof(BlockTableEntry)));
+    if (!m_source || m_table.front().raw_offset != 0)
+    {
+        m_error = "Bad compressed container block table";
+        return false;
+    }
+
+    // Binary search in read() relies on strictly increasing raw offsets
+    for (size_t i = 1; i < m_table.size(); ++i)
+    {
+        if (m_table[i].raw_offset <= m_table[i - 1].raw_offset)
+        {
+            m_error = "Bad compressed container block table";
+            return false;
+        }
+    }
+
+    // Size of the unpacked data is known from the header of the last block
+    BlockHeader header;
+    m_source.seekg(m_begin + static_cast<std::streamoff>(m_table.back().offset));
+    m_source.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!m_source || header.raw_size == 0 || header.raw_size > MAX_BLOCK_SIZE)
+    {
+        m_error = "Bad compressed container block table";
+        return false;
+    }
+
+    m_rawSize = m_table.back().raw_offset + header.raw_size;
+    m_blockIndex = m_table.size();
+
+    return true;
+}
+
+uint64_t BlockTableReader::rawSize() const
+{
+    return m_rawSize;
+}
+
+const std::string& BlockTableReader::error() const
+{
+    return m_error;
+}
+
+bool BlockTableReader::read(uint64_t _offset, uint64_t _size, std::vector<char>& _output)
+{
+    _output.clear();
+
+    if (_offset > m_rawSize || _size > m_rawSize - _offset)
+    {
+        m_error = "Requested data is out of compressed container";
+        return false;
+    }
+
+    // Find the block containing the first requested byte
+    auto index = static_cast<size_t>(std::upper_bound(m_table.begin(), m_table.end(), _offset,
+        [] (uint64_t _value, const BlockTableEntry& _entry) { return _value < _entry.raw_offset; }) - m_table.begin());
+    if (index != 0)
+        --index;
+
+    _output.reserve(static_cast<size_t>(_size));
+    for (auto end = _offset + _size; _offset < end; ++index)
+    {
+        if (index >= m_table.size() || !unpackBlock(index))
+        {
+            if (m_error.empty())
+                m_error = "Bad block table of compressed container";
+            return false;
+        }
+
+        // Block must contain _offset, otherwise it would be read out of bounds or never advance
+        const auto skip = _offset - m_table[index].raw_offset;
+        if (skip >= m_block.size())
+        {
+            m_error = "Bad block table of compressed container";
+            return false;
+        }
+
+        const auto size = static_cast<size_t>(std::min(static_cast<uint64_t>(m_block.size() - skip), end - _offset));
+        const auto first = m_block.begin() + static_cast<std::ptrdiff_t>(skip);
+        _output.insert(_output.end(), first, first + static_cast<std::ptrdiff_t>(size));
+        _offset += size;
+    }
+
+    return true;
+}
+
+bool BlockTableReader::unpackBlock(size_t _index)
+{
+    if (_index == m_blockIndex)
+        return true;
+
+    m_blockIndex = m_table.size();
+
+    BlockHeader header;
+    m_source.clear();
+    m_source.seekg(m_begin + static_cast<std::streamoff>(m_table[_index].offset));
+    m_source.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!m_source || header.raw_size == 0 || header.raw_size > MAX_BLOCK_SIZE || header.packed_size > MAX_BLOCK_SIZE)
+    {
+        m_error = "Bad block header of compressed container";
+        return false;
+    }
+
+    std::vector<char> packed(header.packed_size);
+    m_source.read(packed.data(), static_cast<std::streamsize>(packed.size()));
+    m_block.resize(header.raw_size);
+    if (!m_source || !unpack(static_cast<profiler::CompressionCodec>(header.codec), packed, m_block))
+    {
+        m_error = "Can not unpack block of compressed container";
+        return false;
+    }
+
+    // Blocks must cover unpacked data without gaps
+    if (_index + 1 < m_table.size() && m_table[_index].raw_offset + header.raw_size != m_table[_index + 1].raw_offset)
+    {
+        m_error = "Bad block table of compressed container";
+        return false;
+    }
+
+    m_blockIndex = _index;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // END of namespace compression.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+Decompressor::Decompressor(output_callback_t _output)
+    : m_impl(new compression::ChunkedDecompressor(std::move(_output)))
+{
+}
+
+Decompressor::~Decompressor()
+{
+    delete m_impl;
+}
+
+bool Decompressor::write(const char* _data, uint64_t _size)
+{
+    return m_impl->write(_data, _size);
+}
+
+bool Decompressor::finish()
+{
+    return m_impl->finish();
+}
+
+const char* Decompressor::error() const
+{
+    return m_impl->error().c_str();
+}
+
+} // END of namespace profiler.
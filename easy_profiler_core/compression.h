@@ -0,0 +1,459 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_COMPRESSION_H
+#define EASY_PROFILER_COMPRESSION_H
+
+#include <easy/sink.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+/*
+Compressed .prof container.
+
+Unpacked contents of the container is exactly the plain .prof file. It is split into blocks
+which are compressed independently, so blocks could be packed and unpacked in parallel.
+Header, descriptors, footer and every thread section always start a new block, so one block
+never contains data of two different threads.
+
+Layout:
+    ContainerHeader
+    [BlockHeader][packed data]...
+    BlockHeader with raw_size == 0 (end of blocks)
+    uint32_t number of blocks
+    BlockTableEntry... (one entry for each block)
+    uint64_t offset of the number of blocks from the beginning of the container
+    uint32_t EASY_PROFILER_COMPRESSED_SIGNATURE
+*/
+
+namespace profiler { namespace compression {
+
+#pragma pack(push, 1)
+struct ContainerHeader
+{
+    uint32_t      signature; ///< EASY_PROFILER_COMPRESSED_SIGNATURE
+    uint32_t        version; ///< Version of the unpacked .prof file
+    uint32_t max_block_size; ///< Maximum unpacked size of one block
+    uint32_t       reserved;
+};
+
+struct BlockHeader
+{
+    uint32_t packed_size; ///< Size of the packed data following this header
+    uint32_t    raw_size; ///< Size of the unpacked data (0 for the end of blocks)
+    uint64_t      thread; ///< Id of the thread for thread sections (0 otherwise)
+    uint8_t        codec; ///< profiler::CompressionCodec
+    uint8_t      section; ///< profiler::SinkSection of the beginning of the block
+    uint16_t    reserved;
+};
+
+struct BlockTableEntry
+{
+    uint64_t     offset; ///< Offset of the BlockHeader from the beginning of the container
+    uint64_t raw_offset; ///< Offset of the unpacked data from the beginning of the unpacked .prof
+};
+#pragma pack(pop)
+
+EASY_CONSTEXPR uint32_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+EASY_CONSTEXPR uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+/** Returns true if easy_profiler was built with support of the codec.
+*/
+bool isCodecAvailable(profiler::CompressionCodec _codec);
+
+/** Returns fast codec if _codec is not available.
+*/
+profiler::CompressionCodec availableCodec(profiler::CompressionCodec _codec);
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Small pool packing and unpacking blocks.
+
+Runs tasks in the calling thread if there are no spare cores.
+*/
+class CodecWorkers EASY_FINAL
+{
+    std::vector<std::thread>              m_threads;
+    std::deque<std::packaged_task<bool()> > m_tasks;
+    std::mutex                              m_mutex;
+    std::condition_variable                    m_cv;
+    bool                                 m_stopFlag;
+
+public:
+
+    CodecWorkers(const CodecWorkers&) = delete;
+    CodecWorkers& operator = (const CodecWorkers&) = delete;
+
+    CodecWorkers();
+    ~CodecWorkers();
+
+    std::future<bool> async(std::function<bool()> _task);
+
+    /** Max number of blocks being processed at the same time.
+    */
+    size_t queueLimit() const;
+
+private:
+
+    void worker();
+
+}; // END of class CodecWorkers.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Splits .prof data into blocks and compresses them.
+
+Packed data is passed into output callback in the same order as it was written.
+*/
+class ChunkedCompressor EASY_FINAL
+{
+public:
+
+    using output_t = std::function<void(profiler::SinkSection _section, profiler::thread_id_t _thread,
+                                        const char* _data, uint64_t _size)>;
+
+private:
+
+    struct Block
+    {
+        std::vector<char>    raw;
+        std::vector<char> packed;
+        BlockHeader       header;
+        uint64_t       rawOffset;
+        std::future<bool> result;
+    };
+
+    std::vector<BlockTableEntry>   m_table;
+    std::deque<std::unique_ptr<Block> > m_blocks;
+    std::unique_ptr<Block>        m_current;
+    output_t                       m_output;
+    uint64_t                       m_offset; ///< Number of bytes passed to m_output
+    uint64_t                    m_rawOffset; ///< Number of unpacked bytes in all sealed blocks
+    const uint32_t              m_blockSize;
+    const profiler::CompressionCodec m_codec;
+    bool                          m_started;
+    CodecWorkers                  m_workers; // Must be destroyed first
+
+public:
+
+    ChunkedCompressor(const ChunkedCompressor&) = delete;
+    ChunkedCompressor& operator = (const ChunkedCompressor&) = delete;
+
+    ChunkedCompressor(profiler::CompressionCodec _codec, output_t _output, uint32_t _blockSize = DEFAULT_BLOCK_SIZE);
+    ~ChunkedCompressor();
+
+    /** Append unpacked data.
+
+    Starts new block if the thread or the section group (header, descriptors, thread, footer) changes.
+    */
+    void write(profiler::SinkSection _section, profiler::thread_id_t _thread, const char* _data, uint64_t _size);
+
+    /** Compress current block even if it is not full.
+    */
+    void seal();
+
+    /** Compress the rest of the data and write the block table.
+    */
+    void finish();
+
+    /** Number of unpacked bytes written.
+    */
+    uint64_t rawSize() const;
+
+    /** Number of packed bytes passed into output callback.
+    */
+    uint64_t packedSize() const;
+
+private:
+
+    void flush(bool _all);
+    void output(profiler::SinkSection _section, profiler::thread_id_t _thread, const char* _data, uint64_t _size);
+
+}; // END of class ChunkedCompressor.
+
+//////////////////////////////////////////////////////////////////////////
+
+class CompressingStreamBuf EASY_FINAL : public std::streambuf
+{
+    ChunkedCompressor       m_compressor;
+    std::vector<char>           m_buffer;
+    profiler::SinkSection      m_section;
+    profiler::thread_id_t       m_thread;
+
+public:
+
+    CompressingStreamBuf(std::ostream& _target, profiler::CompressionCodec _codec);
+
+    /** Start new block for the next section.
+    */
+    void beginSection(profiler::SinkSection _section, profiler::thread_id_t _thread);
+
+    void finish();
+
+protected:
+
+    int_type overflow(int_type _ch);
+    std::streamsize xsputn(const char* _data, std::streamsize _size);
+    int sync();
+
+private:
+
+    void flushBuffer();
+
+}; // END of class CompressingStreamBuf.
+
+/** Output stream writing compressed container into target stream.
+
+finish() must be called after writing all data.
+*/
+class CompressedOutputStream EASY_FINAL : public std::ostream
+{
+    CompressingStreamBuf m_buffer;
+
+public:
+
+    CompressedOutputStream(std::ostream& _target, profiler::CompressionCodec _codec);
+
+    void beginSection(profiler::SinkSection _section, profiler::thread_id_t _thread);
+    void finish();
+
+}; // END of class CompressedOutputStream.
+
+//////////////////////////////////////////////////////////////////////////
+
+class DecompressingStreamBuf EASY_FINAL : public std::streambuf
+{
+    struct Block
+    {
+        std::vector<char>    raw;
+        std::vector<char> packed;
+        BlockHeader       header;
+        std::future<bool> result;
+    };
+
+    std::deque<std::unique_ptr<Block> > m_blocks;
+    std::vector<char>         m_current;
+    std::string                 m_error;
+    std::istream&              m_source;
+    uint32_t                  m_version;
+    uint32_t             m_maxBlockSize;
+    bool                    m_sourceEnd;
+    CodecWorkers              m_workers; // Must be destroyed first
+
+public:
+
+    explicit DecompressingStreamBuf(std::istream& _source);
+
+    bool open();
+    uint32_t version() const;
+    const std::string& error() const;
+
+protected:
+
+    int_type underflow();
+
+private:
+
+    void readAhead();
+    void setError(const char* _message);
+
+}; // END of class DecompressingStreamBuf.
+
+/** Unpacks compressed container received in pieces of arbitrary size (from network, for example).
+
+Blocks are unpacked in parallel and passed into output callback in the original order.
+Data which is not a compressed container is passed into output as is.
+*/
+class ChunkedDecompressor EASY_FINAL
+{
+public:
+
+    using output_t = std::function<void(const char* _data, uint64_t _size)>;
+
+private:
+
+    enum class State : uint8_t
+    {
+        Signature = 0, ///< Waiting for the first 4 bytes
+        Header, ///< Waiting for the rest of ContainerHeader
+        BlockHeader,
+        BlockData,
+        Table, ///< End of blocks has been received, the rest is ignored
+        Plain, ///< Not a compressed container, passing data as is
+        Failed
+    };
+
+    struct Block
+    {
+        std::vector<char>    raw;
+        std::vector<char> packed;
+        BlockHeader       header;
+        std::future<bool> result;
+    };
+
+    std::deque<std::unique_ptr<Block> > m_blocks;
+    std::vector<char>         m_pending; ///< Incomplete header or block data
+    std::string                 m_error;
+    output_t                   m_output;
+    BlockHeader                m_header; ///< Header of the block being received
+    uint32_t             m_maxBlockSize;
+    State                       m_state;
+    CodecWorkers              m_workers; // Must be destroyed first
+
+public:
+
+    ChunkedDecompressor(const ChunkedDecompressor&) = delete;
+    ChunkedDecompressor& operator = (const ChunkedDecompressor&) = delete;
+
+    explicit ChunkedDecompressor(output_t _output);
+
+    /** Append next piece of received data.
+
+    \retval false if data is corrupted.
+    */
+    bool write(const char* _data, uint64_t _size);
+
+    /** Wait for all received blocks to be unpacked.
+
+    \retval false if data is corrupted or incomplete.
+    */
+    bool finish();
+
+    /** Description of the last error (empty if there were no errors).
+    */
+    const std::string& error() const;
+
+private:
+
+    uint64_t expectedSize() const;
+    void process();
+    void flush(bool _all);
+    void setError(const char* _message);
+
+}; // END of class ChunkedDecompressor.
+
+/** Input stream unpacking compressed container.
+
+\note Container signature must be already read from the source stream.
+*/
+class CompressedInputStream EASY_FINAL : public std::istream
+{
+    DecompressingStreamBuf m_buffer;
+
+public:
+
+    explicit CompressedInputStream(std::istream& _source);
+
+    /** Version of the unpacked .prof data.
+    */
+    uint32_t version() const;
+
+    /** Description of the last error (empty if there were no errors).
+    */
+    const std::string& error() const;
+
+}; // END of class CompressedInputStream.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Reads arbitrary ranges of unpacked data of compressed container using it's block table.
+
+Only blocks covering requested range are read and unpacked. The last unpacked block is cached,
+so reading of several small neighbour ranges unpacks each block once.
+
+\note Source stream must be seekable and positioned at the beginning of the container.
+*/
+class BlockTableReader EASY_FINAL
+{
+    std::istream&                   m_source;
+    std::vector<BlockTableEntry>     m_table;
+    std::vector<char>                m_block; ///< Data of the last unpacked block
+    std::string                      m_error;
+    std::streampos                   m_begin;
+    uint64_t                       m_rawSize;
+    size_t                      m_blockIndex; ///< Index of the last unpacked block in m_table
+
+public:
+
+    explicit BlockTableReader(std::istream& _source);
+
+    /** Read block table of the container.
+    */
+    bool open();
+
+    /** Size of the unpacked data.
+    */
+    uint64_t rawSize() const;
+
+    const std::string& error() const;
+
+    /** Unpack _size bytes starting from _offset of the unpacked data.
+    */
+    bool read(uint64_t _offset, uint64_t _size, std::vector<char>& _output);
+
+private:
+
+    bool unpackBlock(size_t _index);
+
+}; // END of class BlockTableReader.
+
+//////////////////////////////////////////////////////////////////////////
+
+} // END of namespace compression.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_COMPRESSION_H
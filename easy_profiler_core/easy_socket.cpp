@@ -313,11 +313,8 @@ int EasySocket::listen(int count)
     return res;
 }
 
-int EasySocket::accept()
+EasySocket::socket_t EasySocket::acceptConnection()
 {
-    if (!checkSocket(m_socket))
-        return -1;
-
     fd_set fdread;
     FD_ZERO (&fdread);
     FD_SET (m_socket, &fdread);
@@ -330,28 +327,66 @@ int EasySocket::accept()
     if (rc <= 0)
         return -1; // there is no connection for accept
 
-    m_replySocket = ::accept(m_socket, nullptr, nullptr);
-    checkResult((int)m_replySocket);
+    const socket_t s = ::accept(m_socket, nullptr, nullptr);
+    checkResult((int)s);
 
-    if (checkSocket(m_replySocket))
+    if (checkSocket(s))
     {
-        ::setsockopt(m_replySocket, SOL_SOCKET, SO_SNDBUF, (char*)&SEND_BUFFER_SIZE, sizeof(int));
+        ::setsockopt(s, SOL_SOCKET, SO_SNDBUF, (char*)&SEND_BUFFER_SIZE, sizeof(int));
         
         //const int flag = 1;
-        //const int result = setsockopt(m_replySocket,IPPROTO_TCP,TCP_NODELAY,(char *)&flag,sizeof(int));
+        //const int result = setsockopt(s,IPPROTO_TCP,TCP_NODELAY,(char *)&flag,sizeof(int));
 
 #if defined(__APPLE__)
         // Apple doesn't have MSG_NOSIGNAL, work around it
         const int value = 1;
-        ::setsockopt(m_replySocket, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+        ::setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
 #endif
 
-        //setBlocking(m_replySocket,true);
+        //setBlocking(s,true);
     }
 
+    return s;
+}
+
+int EasySocket::accept()
+{
+    if (!checkSocket(m_socket))
+        return -1;
+
+    const socket_t s = acceptConnection();
+    if ((int)s == -1)
+        return -1; // there is no connection for accept
+
+    m_replySocket = s;
+
     return (int)m_replySocket;
 }
 
+int EasySocket::accept(EasySocket& _session)
+{
+    if (!checkSocket(m_socket) || &_session == this)
+        return -1;
+
+    const socket_t s = acceptConnection();
+    if (!checkSocket(s))
+        return -1;
+
+    // The session socket is used only for sending and receiving data.
+    // Release it's own socket which has been created in init().
+    if (_session.m_socket != 0 && _session.m_socket != _session.m_replySocket)
+        closeSocket(_session.m_socket);
+
+    if (_session.m_replySocket != 0)
+        closeSocket(_session.m_replySocket);
+
+    _session.m_socket = 0;
+    _session.m_replySocket = s;
+    _session.m_state = ConnectionState::Connected;
+
+    return (int)s;
+}
+
 bool EasySocket::setAddress(const char* address, uint16_t port)
 {
     m_server = ::gethostbyname(address);
@@ -0,0 +1,346 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "file_index.h"
+#include "alignment_helpers.h"
+#include <cstring>
+
+extern const uint32_t EASY_PROFILER_INDEX_SIGNATURE;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+template <class T>
+void put(std::vector<char>& _output, const T& _value)
+{
+    const auto size = _output.size();
+    _output.resize(size + sizeof(T));
+    memcpy(_output.data() + size, &_value, sizeof(T));
+}
+
+/** Reads values from the index with bounds checking.
+*/
+class IndexParser EASY_FINAL
+{
+    const char* m_data;
+    uint64_t    m_size;
+    uint64_t    m_read;
+
+public:
+
+    IndexParser(const char* _data, uint64_t _size) : m_data(_data), m_size(_size), m_read(0)
+    {
+    }
+
+    template <class T>
+    bool get(T& _value)
+    {
+        return get(&_value, 1);
+    }
+
+    template <class T>
+    bool get(T* _values, uint64_t _number)
+    {
+        if (_number > (m_size - m_read) / sizeof(T))
+            return false;
+
+        const auto size = static_cast<size_t>(_number * sizeof(T));
+        if (size != 0)
+            memcpy(_values, m_data + m_read, size);
+        m_read += size;
+        return true;
+    }
+
+    bool finished() const
+    {
+        return m_read == m_size;
+    }
+
+}; // END of class IndexParser.
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler { namespace index {
+
+static_assert(sizeof(profiler::FileIndexCheckpoint) == 4 * sizeof(uint64_t), "FileIndexCheckpoint is stored as is");
+
+ThreadIndexBuilder::ThreadIndexBuilder(profiler::thread_id_t _id) : m_offset(0), m_blocksCount(0)
+{
+    m_index.thread_id = _id;
+}
+
+void ThreadIndexBuilder::skip(uint64_t _size)
+{
+    m_offset += _size;
+}
+
+void ThreadIndexBuilder::beginContextSwitches(uint64_t _number)
+{
+    m_index.cs_offset = m_offset;
+    m_index.cs_number = _number;
+    m_offset += sizeof(uint64_t);
+}
+
+void ThreadIndexBuilder::addContextSwitches(const char*, uint64_t _size)
+{
+    m_offset += _size;
+}
+
+void ThreadIndexBuilder::beginBlocks(uint64_t _number)
+{
+    m_index.blocks_offset = m_offset;
+    m_index.blocks_number = _number;
+    m_offset += sizeof(uint64_t);
+}
+
+void ThreadIndexBuilder::addBlocks(const char* _records, uint64_t _size)
+{
+    const char* const end = _records + _size;
+    while (_records < end)
+    {
+        const auto size = unaligned_load16<uint16_t>(_records);
+        const auto block = reinterpret_cast<const profiler::SerializedBlock*>(_records + sizeof(uint16_t));
+
+        const auto id = block->id();
+        if (id >= m_usage.size())
+            m_usage.resize(id + 1, 0);
+        ++m_usage[id];
+
+        profiler::FileIndexCheckpoint frame = {block->begin(), block->end(), m_offset, m_blocksCount};
+
+        // Top-level blocks which become children of this block are found in the same way as the reader does
+        // (see buildThreadTree()). The frame starts where the first of it's children starts.
+        if (!m_frames.empty() && frame.begin < m_frames.back().end)
+        {
+            do
+            {
+                frame.offset = m_frames.back().offset;
+                frame.block_number = m_frames.back().block_number;
+                m_frames.pop_back();
+            } while (!m_frames.empty() && m_frames.back().begin >= frame.begin);
+        }
+
+        m_frames.push_back(frame);
+
+        ++m_blocksCount;
+        _records += sizeof(uint16_t) + size;
+        m_offset += sizeof(uint16_t) + size;
+    }
+}
+
+void ThreadIndexBuilder::finish()
+{
+    // Neighbour frames are merged into one checkpoint to keep the index small for captures with lots of tiny frames
+    auto& checkpoints = m_index.checkpoints;
+    checkpoints.clear();
+    for (const auto& frame : m_frames)
+    {
+        if (checkpoints.empty() || frame.offset - checkpoints.back().offset >= MIN_CHECKPOINT_DISTANCE)
+            checkpoints.push_back(frame);
+        else
+            checkpoints.back().end = frame.end;
+    }
+
+    std::vector<profiler::FileIndexCheckpoint>().swap(m_frames);
+    m_index.end_offset = m_offset;
+}
+
+const profiler::FileThreadIndex& ThreadIndexBuilder::index() const
+{
+    return m_index;
+}
+
+const std::vector<uint64_t>& ThreadIndexBuilder::usage() const
+{
+    return m_usage;
+}
+
+uint64_t ThreadIndexBuilder::size() const
+{
+    return m_offset;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FileIndexBuilder::FileIndexBuilder() : m_offset(0)
+{
+}
+
+void FileIndexBuilder::skip(uint64_t _size)
+{
+    m_offset += _size;
+}
+
+void FileIndexBuilder::addThread(const ThreadIndexBuilder& _thread)
+{
+    m_index.threads.push_back(_thread.index());
+
+    auto& thread = m_index.threads.back();
+    thread.offset = m_offset;
+    thread.cs_offset += m_offset;
+    thread.blocks_offset += m_offset;
+    thread.end_offset += m_offset;
+    for (auto& checkpoint : thread.checkpoints)
+        checkpoint.offset += m_offset;
+
+    const auto& usage = _thread.usage();
+    auto& total = m_index.descriptors_usage;
+    if (total.size() < usage.size())
+        total.resize(usage.size(), 0);
+    for (size_t i = 0; i < usage.size(); ++i)
+        total[i] += usage[i];
+
+    m_offset += _thread.size();
+}
+
+uint64_t FileIndexBuilder::offset() const
+{
+    return m_offset;
+}
+
+void FileIndexBuilder::serialize(std::vector<char>& _output) const
+{
+    _output.clear();
+
+    put(_output, EASY_PROFILER_INDEX_SIGNATURE);
+    put(_output, static_cast<uint32_t>(m_index.threads.size()));
+
+    for (const auto& thread : m_index.threads)
+    {
+        ThreadEntry entry;
+        entry.thread_id = thread.thread_id;
+        entry.offset = thread.offset;
+        entry.cs_offset = thread.cs_offset;
+        entry.blocks_offset = thread.blocks_offset;
+        entry.end_offset = thread.end_offset;
+        entry.cs_number = thread.cs_number;
+        entry.blocks_number = thread.blocks_number;
+        entry.checkpoints_number = thread.checkpoints.size();
+        put(_output, entry);
+
+        for (const auto& checkpoint : thread.checkpoints)
+            put(_output, checkpoint);
+    }
+
+    put(_output, static_cast<uint32_t>(m_index.descriptors_usage.size()));
+    for (auto usage : m_index.descriptors_usage)
+        put(_output, usage);
+
+    Footer footer;
+    footer.offset = m_offset;
+    footer.signature = EASY_PROFILER_INDEX_SIGNATURE;
+    put(_output, footer);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool parse(const char* _data, uint64_t _size, uint64_t _offset, profiler::FileIndex& _index, std::ostream& _log)
+{
+    _index.threads.clear();
+    _index.descriptors_usage.clear();
+
+    IndexParser parser(_data, _size);
+
+    uint32_t signature = 0, threads_number = 0;
+    if (!parser.get(signature) || signature != EASY_PROFILER_INDEX_SIGNATURE || !parser.get(threads_number) ||
+        threads_number > _size / sizeof(ThreadEntry))
+    {
+        _log << "Bad index header";
+        return false;
+    }
+
+    _index.threads.reserve(threads_number);
+    for (uint32_t i = 0; i < threads_number; ++i)
+    {
+        ThreadEntry entry;
+        if (!parser.get(entry) || entry.offset > entry.cs_offset || entry.cs_offset > entry.blocks_offset ||
+            entry.blocks_offset > entry.end_offset || entry.end_offset > _offset)
+        {
+            _log << "Bad index of thread " << i;
+            return false;
+        }
+
+        _index.threads.emplace_back();
+        auto& thread = _index.threads.back();
+        thread.thread_id = entry.thread_id;
+        thread.offset = entry.offset;
+        thread.cs_offset = entry.cs_offset;
+        thread.blocks_offset = entry.blocks_offset;
+        thread.end_offset = entry.end_offset;
+        thread.cs_number = entry.cs_number;
+        thread.blocks_number = entry.blocks_number;
+
+        if (entry.checkpoints_number > entry.blocks_number)
+        {
+            _log << "Bad index of thread " << i << ": too many checkpoints";
+            return false;
+        }
+
+        thread.checkpoints.resize(static_cast<size_t>(entry.checkpoints_number));
+        if (!parser.get(thread.checkpoints.data(), entry.checkpoints_number))
+        {
+            _log << "Bad index of thread " << i << ": unexpected end of checkpoints";
+            return false;
+        }
+    }
+
+    uint32_t descriptors_number = 0;
+    if (!parser.get(descriptors_number) || descriptors_number > _size / sizeof(uint64_t))
+    {
+        _log << "Bad index: unexpected end of data";
+        return false;
+    }
+
+    _index.descriptors_usage.resize(descriptors_number);
+    if (!parser.get(_index.descriptors_usage.data(), descriptors_number) || !parser.finished())
+    {
+        _log << "Bad index: wrong size of descriptors usage";
+        return false;
+    }
+
+    return true;
+}
+
+} } // END of namespace profiler::index.
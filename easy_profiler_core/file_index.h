@@ -0,0 +1,182 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_FILE_INDEX_H
+#define EASY_PROFILER_FILE_INDEX_H
+
+#include <easy/reader.h>
+#include <ostream>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+/*
+Seekable index of .prof file.
+
+Index is written after all other data of the file, so readers which do not know about it just stop before it.
+For compressed files the index is a part of unpacked data and is packed into it's own blocks.
+
+Layout:
+    uint32_t EASY_PROFILER_INDEX_SIGNATURE
+    uint32_t number of threads
+    for each thread:
+        ThreadEntry
+        FileIndexCheckpoint... (ThreadEntry::checkpoints_number entries)
+    uint32_t number of descriptors
+    uint64_t number of blocks for each descriptor
+    Footer
+*/
+
+namespace profiler { namespace index {
+
+#pragma pack(push, 1)
+struct ThreadEntry
+{
+    uint64_t          thread_id;
+    uint64_t             offset;
+    uint64_t          cs_offset;
+    uint64_t      blocks_offset;
+    uint64_t         end_offset;
+    uint64_t          cs_number;
+    uint64_t      blocks_number;
+    uint64_t checkpoints_number;
+};
+
+struct Footer
+{
+    uint64_t    offset; ///< Offset of the index from the beginning of the file
+    uint32_t signature; ///< EASY_PROFILER_INDEX_SIGNATURE
+};
+#pragma pack(pop)
+
+EASY_CONSTEXPR auto SIDECAR_EXTENSION = ".idx"; ///< Extension of the index file created near .prof files without index
+EASY_CONSTEXPR uint64_t MIN_CHECKPOINT_DISTANCE = 64 * 1024; ///< Minimum distance (in bytes) between checkpoints of one thread
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Collects index of one thread section while the section is being serialized.
+
+Offsets are counted from the beginning of the section. Parts of the section must be passed in the file order.
+*/
+class ThreadIndexBuilder EASY_FINAL
+{
+    profiler::FileThreadIndex                  m_index;
+    std::vector<profiler::FileIndexCheckpoint> m_frames; ///< Top-level blocks found so far
+    std::vector<uint64_t>                       m_usage; ///< Number of blocks for each block id
+    uint64_t                                   m_offset; ///< Current offset from the beginning of the section
+    uint64_t                              m_blocksCount; ///< Number of block records added so far
+
+public:
+
+    explicit ThreadIndexBuilder(profiler::thread_id_t _id = 0);
+
+    /** Skip data which is not indexed (thread id and name).
+    */
+    void skip(uint64_t _size);
+
+    void beginContextSwitches(uint64_t _number);
+    void addContextSwitches(const char* _records, uint64_t _size);
+
+    void beginBlocks(uint64_t _number);
+
+    /** Add serialized block records ([uint16_t size][block data]...).
+    */
+    void addBlocks(const char* _records, uint64_t _size);
+
+    /** Turn found top-level blocks into checkpoints. Must be called after the last block.
+    */
+    void finish();
+
+    const profiler::FileThreadIndex& index() const;
+    const std::vector<uint64_t>& usage() const;
+
+    /** Size of the section.
+    */
+    uint64_t size() const;
+
+}; // END of class ThreadIndexBuilder.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Collects index of the whole file.
+*/
+class FileIndexBuilder EASY_FINAL
+{
+    profiler::FileIndex m_index;
+    uint64_t           m_offset; ///< Current offset from the beginning of the file
+
+public:
+
+    FileIndexBuilder();
+
+    /** Skip data which is not indexed (header, descriptors, bookmarks).
+    */
+    void skip(uint64_t _size);
+
+    /** Add thread section which starts at current offset.
+    */
+    void addThread(const ThreadIndexBuilder& _thread);
+
+    /** Serialize the index (including footer) which is written at current offset.
+    */
+    void serialize(std::vector<char>& _output) const;
+
+    /** Current offset from the beginning of the file.
+    */
+    uint64_t offset() const;
+
+}; // END of class FileIndexBuilder.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Parse the index.
+
+\param _data Serialized index without footer.
+\param _offset Offset of the index from the beginning of the file (from footer).
+*/
+bool parse(const char* _data, uint64_t _size, uint64_t _offset, profiler::FileIndex& _index, std::ostream& _log);
+
+} } // END of namespace profiler::index.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_FILE_INDEX_H
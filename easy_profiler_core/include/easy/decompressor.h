@@ -0,0 +1,99 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_DECOMPRESSOR_H
+#define EASY_PROFILER_DECOMPRESSOR_H
+
+#include <easy/details/profiler_public_types.h>
+#include <functional>
+
+namespace profiler { namespace compression { class ChunkedDecompressor; } }
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+    /** Incrementally unpacks compressed .prof data received in pieces of arbitrary size.
+
+    Used to unpack captures received over network while receiving the rest of data.
+    Blocks are unpacked in parallel and passed into output callback in the original order.
+    Plain (not compressed) .prof data is passed into output as is.
+
+    \sa CompressingSink, setDumpCompression
+    */
+    class PROFILER_API Decompressor EASY_FINAL
+    {
+        compression::ChunkedDecompressor* m_impl;
+
+    public:
+
+        using output_callback_t = std::function<void(const char* _data, uint64_t _size)>;
+
+        Decompressor(const Decompressor&) = delete;
+        Decompressor& operator = (const Decompressor&) = delete;
+
+        explicit Decompressor(output_callback_t _output);
+        ~Decompressor();
+
+        /** Append next piece of data.
+
+        \retval false if data is corrupted.
+        */
+        bool write(const char* _data, uint64_t _size);
+
+        /** Wait until all received data is unpacked and passed into output callback.
+
+        \retval false if data is corrupted or incomplete.
+        */
+        bool finish();
+
+        /** Description of the error (empty string if there were no errors).
+        */
+        const char* error() const;
+
+    }; // END of class Decompressor.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_DECOMPRESSOR_H
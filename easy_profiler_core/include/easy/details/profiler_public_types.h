@@ -71,6 +71,37 @@ namespace profiler {
         MICROSECONDS ///< Microseconds
     };
 
+    enum class TriggerType : uint8_t
+    {
+        None = 0,
+        FrameDuration, ///< Main thread frame duration (in microseconds) exceeds threshold
+        BlockDuration, ///< Duration of the block (in microseconds) exceeds threshold
+        Value, ///< Scalar arbitrary value (EASY_VALUE) exceeds threshold
+
+        TypesCount
+    };
+
+    /** Codec used for compressed .prof files.
+
+    Compressed file is split into independently compressed blocks which can be unpacked in parallel.
+    */
+    enum class CompressionCodec : uint8_t
+    {
+        None = 0, ///< Plain .prof file
+        LZ4, ///< Fast codec (LZ4 block format)
+        Zlib, ///< Higher compression ratio, slower (available only if easy_profiler was built with zlib)
+
+        TypesCount
+    };
+
+    /** Completion callback of dumpBlocksToFileAsync().
+
+    \param _filename Name of the written file.
+    \param _blocksCount Number of dumped blocks (0 if nothing was profiled or an error occurred).
+    \param _userData User pointer passed to dumpBlocksToFileAsync().
+    */
+    using dump_callback_t = void (*)(const char* _filename, uint64_t _blocksCount, void* _userData);
+
     //***********************************************
 
 #pragma pack(push,1)
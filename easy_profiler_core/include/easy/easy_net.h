@@ -77,6 +77,11 @@ enum class MessageType : uint8_t
 
     Request_MainThread_FPS,
     Reply_MainThread_FPS,
+
+    Request_Arm_Trigger,
+    Request_Disarm_Trigger,
+
+    Request_Blocks_Compression,
 };
 
 struct Message
@@ -152,6 +157,43 @@ struct TimestampMessage : public Message
     TimestampMessage() = default;
 };
 
+struct TriggerMessage : public Message
+{
+    uint32_t         id = 0; ///< Block id for TriggerType::BlockDuration and TriggerType::Value
+    double    threshold = 0; ///< Microseconds for durations or value threshold for TriggerType::Value
+    uint32_t history_ms = 0; ///< Duration of the history before the trigger to be captured (in milliseconds)
+    uint32_t   after_ms = 0; ///< Duration of capturing after the trigger (in milliseconds)
+    uint8_t trigger_type = 0; ///< profiler::TriggerType
+
+    explicit TriggerMessage(uint8_t _type, uint32_t _id, double _threshold, uint32_t _historyMs, uint32_t _afterMs)
+        : Message(MessageType::Request_Arm_Trigger)
+        , id(_id)
+        , threshold(_threshold)
+        , history_ms(_historyMs)
+        , after_ms(_afterMs)
+        , trigger_type(_type)
+    {
+    }
+
+    TriggerMessage() = default;
+};
+
+/** Sent by client right after Connection_Accepted if it can unpack compressed captures.
+
+Profiler which does not support compression ignores this message and keeps sending plain data.
+Compressed Reply_Blocks payload is a compressed .prof container (see profiler::Decompressor)
+split into several Reply_Blocks messages.
+*/
+struct CompressionMessage : public Message
+{
+    uint8_t codec = 0; ///< profiler::CompressionCodec preferred by client
+
+    explicit CompressionMessage(uint8_t _codec)
+        : Message(MessageType::Request_Blocks_Compression), codec(_codec) { }
+
+    CompressionMessage() = default;
+};
+
 #pragma pack(pop)
 
 }//net
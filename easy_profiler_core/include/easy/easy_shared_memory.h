@@ -0,0 +1,213 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+#ifndef EASY_PROFILER_SHARED_MEMORY_H
+#define EASY_PROFILER_SHARED_MEMORY_H
+
+#include <easy/serialized_block.h>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+
+//////////////////////////////////////////////////////////////////////////
+
+/*
+Shared memory transport.
+
+Profiled application exports closed blocks into a named shared memory segment
+(see profiler::startSharedMemoryExport()) and another process on the same machine
+reads them using SharedMemoryCollector without any network round-trips and
+without stopping the profiled application.
+
+Segment layout:
+
+    [Header]
+    [descriptors area: descriptors_capacity bytes]
+    [Ring 0][ring_size bytes of ring data]
+    [Ring 1][ring_size bytes of ring data]
+    ...
+
+Each thread owns one Ring. Ring data is a sequence of batches: [Batch][size bytes of blocks][padding to 8 bytes].
+Blocks are stored exactly as in .prof file: [uint16_t size][profiler::SerializedBlock].
+Positions in the ring are monotonic (never wrap), real offset is (position & (ring_size - 1)).
+Writer never waits for readers. If reader is too slow then old data is overwritten
+and reader detects it by comparing positions and batch sequence numbers.
+*/
+
+namespace profiler {
+
+    namespace shm {
+
+        EASY_CONSTEXPR uint32_t SIGNATURE = ('E' << 24) | ('S' << 16) | ('h' << 8) | 'm';
+        EASY_CONSTEXPR uint32_t VERSION = 1;
+        EASY_CONSTEXPR uint32_t DEFAULT_RING_SIZE = 2 << 20; ///< Default size of each thread ring (2 MiB)
+        EASY_CONSTEXPR uint32_t MIN_RING_SIZE = 256 << 10; ///< Minimum size of each thread ring (256 KiB)
+        EASY_CONSTEXPR uint32_t MAX_THREADS = 128; ///< Maximum number of threads that could be exported
+        EASY_CONSTEXPR uint32_t DESCRIPTORS_CAPACITY = 4 << 20; ///< Size of descriptors area (4 MiB)
+        EASY_CONSTEXPR uint16_t THREAD_NAME_SIZE = 64;
+
+#pragma pack(push, 8)
+        struct Header
+        {
+            uint32_t                            signature; ///< Always equal to SIGNATURE
+            uint32_t                              version; ///< Layout version (VERSION)
+            uint64_t                                  pid; ///< Profiled process id
+            int64_t                         cpu_frequency; ///< Number of ticks per second (the same as in .prof file header)
+            uint64_t                         segment_size; ///< Whole segment size in bytes
+            uint64_t                 descriptors_capacity; ///< Size of descriptors area in bytes
+            uint32_t                            ring_size; ///< Size of each ring data in bytes (power of 2)
+            uint32_t                          rings_count; ///< Number of rings in the segment
+            std::atomic<uint32_t>           threads_count; ///< Number of used rings
+            std::atomic<uint32_t>       descriptors_count; ///< Number of block descriptors written to descriptors area
+            std::atomic<uint64_t>        descriptors_size; ///< Number of bytes written to descriptors area
+            std::atomic<uint32_t>                   alive; ///< 0 when profiled application has stopped exporting
+            uint32_t                              padding;
+        };
+
+        struct Ring
+        {
+            uint64_t                            thread_id; ///< Id of thread which data is stored in this ring
+            char                 name[THREAD_NAME_SIZE]; ///< Thread name (null-terminated)
+            std::atomic<uint64_t>             write_begin; ///< Writer may be changing data up to this position right now
+            std::atomic<uint64_t>               write_end; ///< All batches before this position are complete
+            std::atomic<uint64_t>                 batches; ///< Number of written batches
+            uint64_t                          reserved[4];
+        };
+
+        struct Batch
+        {
+            uint64_t                             sequence; ///< Sequential number of the batch in the ring (starting from 0)
+            uint32_t                                 size; ///< Size of blocks data in bytes
+            uint32_t                         blocks_count; ///< Number of blocks in this batch
+        };
+#pragma pack(pop)
+
+        /** Default segment name for given process id.
+        */
+        inline void defaultName(char* _buffer, size_t _bufferSize, uint64_t _pid)
+        {
+            snprintf(_buffer, _bufferSize, "/easy_profiler.%llu", static_cast<unsigned long long>(_pid));
+        }
+
+    } // END of namespace shm.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Reads data exported by profiled application into shared memory segment.
+
+    \note Supported only on Unix systems with POSIX shared memory.
+    */
+    class PROFILER_API SharedMemoryCollector EASY_FINAL
+    {
+    public:
+
+        using descriptor_callback_t = std::function<void(const SerializedBlockDescriptor&)>;
+        using blocks_callback_t = std::function<void(thread_id_t _thread, const char* _threadName, const char* _data, uint64_t _size, uint32_t _blocksCount)>;
+
+    private:
+
+        char*            m_memory; ///< Mapped segment
+        uint64_t     m_memorySize;
+        uint64_t*     m_positions; ///< Read positions for each ring
+        uint64_t*     m_sequences; ///< Expected sequence numbers of next batches for each ring
+        char*            m_buffer; ///< Temporary buffer for copying ring data
+        uint64_t      m_lostBytes;
+        uint64_t    m_lostBatches;
+        uint64_t m_descriptorsRead; ///< Number of bytes of descriptors area which have been already read
+
+    public:
+
+        SharedMemoryCollector(const SharedMemoryCollector&) = delete;
+        SharedMemoryCollector& operator = (const SharedMemoryCollector&) = delete;
+
+        SharedMemoryCollector();
+        ~SharedMemoryCollector();
+
+        /** Open shared memory segment with given name.
+
+        \sa profiler::shm::defaultName
+        */
+        bool open(const char* _name);
+
+        void close();
+
+        bool isOpen() const;
+
+        /** Returns false if profiled application has stopped exporting data.
+        */
+        bool isAlive() const;
+
+        uint64_t pid() const;
+
+        int64_t cpuFrequency() const;
+
+        /** Read block descriptors which have been added since previous call.
+
+        \note Block ids are indices of descriptors in the order they are read.
+
+        \retval Number of read descriptors.
+        */
+        uint32_t readDescriptors(const descriptor_callback_t& _callback);
+
+        /** Read blocks of all threads which have been exported since previous call.
+
+        Callback receives serialized blocks in the same format as in .prof file: [uint16_t size][SerializedBlock].
+        Data pointer is valid only during callback invocation.
+
+        \retval Number of read bytes.
+        */
+        uint64_t readBlocks(const blocks_callback_t& _callback);
+
+        /** Number of bytes which have been overwritten by writer before they have been read.
+        */
+        uint64_t lostBytes() const;
+
+        /** Number of batches which have been overwritten by writer before they have been read.
+        */
+        uint64_t lostBatches() const;
+
+    }; // END of class SharedMemoryCollector.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_SHARED_MEMORY_H
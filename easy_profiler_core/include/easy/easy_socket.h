@@ -109,6 +109,16 @@ public:
     int accept();
     int bind(uint16_t portno);
 
+    /** Accept incoming connection and pass it to the _session socket.
+
+    Unlike accept(), the accepted connection is not stored inside this socket,
+    so this socket remains free for accepting next connections.
+    The _session socket releases it's own (unused) listening socket.
+
+    \retval Accepted socket descriptor or -1 if there is no connection to accept.
+    */
+    int accept(EasySocket& _session);
+
     bool setAddress(const char* serv, uint16_t port);
     int connect();
 
@@ -124,6 +134,7 @@ private:
     void checkResult(int result);
     bool checkSocket(socket_t s) const;
     void setBlocking(socket_t s, bool blocking);
+    socket_t acceptConnection();
 
 }; // end of class EasySocket.
 
@@ -448,6 +448,8 @@ namespace profiler {
 
     EASY_CONSTEXPR uint16_t DEFAULT_PORT = EASY_DEFAULT_PORT;
 
+    class Sink;
+
     //////////////////////////////////////////////////////////////////////
     // Core API
     // Note: It is better to use macros defined above than a direct calls to API.
@@ -575,7 +577,58 @@ namespace profiler {
 
         \ingroup profiler
         */
-        PROFILER_API uint32_t dumpBlocksToFile(const char* _filename);
+        PROFILER_API uint64_t dumpBlocksToFile(const char* _filename);
+
+        /** Pass all gathered blocks into the sink.
+
+        Sink receives the same data as would be written into .prof file by dumpBlocksToFile()
+        split into header, descriptors and per-thread spans of blocks (without copying).
+        Sink::complete() is called when all data has been written.
+
+        \note This also disables profiler.
+
+        \retval Number of dumped blocks. If 0 then nothing was profiled or an error occurred.
+
+        \sa Sink, FileSink, SocketSink, CallbackSink
+
+        \ingroup profiler
+        */
+        PROFILER_API uint64_t dumpBlocksToSink(Sink& _sink);
+
+        /** Save all gathered blocks into file in background thread.
+
+        Profiling is stopped immediately, while waiting for running blocks, serialization
+        and writing the file are performed by a separate thread, so the caller is not blocked.
+        _callback (if not null) is invoked from that thread when the file has been written.
+
+        Requests are processed one by one in the order of calls. Pending requests for the same
+        file name are coalesced into one dump (each callback is invoked).
+
+        \note This also disables profiler.
+
+        \retval false if _filename is null.
+
+        \ingroup profiler
+        */
+        PROFILER_API bool dumpBlocksToFileAsync(const char* _filename, dump_callback_t _callback = nullptr, void* _userData = nullptr);
+
+        /** Set compression of files written by dumpBlocksToFile() and dumpBlocksToFileAsync().
+
+        Compressed file is split into independently packed blocks which are unpacked in parallel
+        by fillTreesFromFile(), so loading of big captures is not slowed down.
+        CompressionCodec::None (default) writes plain .prof files readable by older versions.
+
+        \note If _codec is not available (zlib was not found at build time) then CompressionCodec::LZ4 is used.
+
+        \ingroup profiler
+        */
+        PROFILER_API void setDumpCompression(CompressionCodec _codec);
+
+        /** Returns compression of files written by dumpBlocksToFile().
+
+        \ingroup profiler
+        */
+        PROFILER_API CompressionCodec dumpCompression();
 
         /** Register current thread and give it a name.
 
@@ -666,6 +719,74 @@ namespace profiler {
         */
         PROFILER_API bool isListening();
 
+        /** Start exporting closed blocks into shared memory segment.
+
+        Launches a separate thread which periodically copies closed blocks of all threads
+        into per-thread ring buffers of the named shared memory segment. Another process on the same machine
+        can read them using profiler::SharedMemoryCollector (see easy/easy_shared_memory.h) without
+        stopping profiling session and without network round-trips.
+
+        \param _name Name of the segment. If nullptr then "/easy_profiler.<pid>" is used.
+        \param _ringSize Size of ring buffer for each thread in bytes. If 0 then default size (2 MiB) is used.
+
+        \note Supported only on Unix systems with POSIX shared memory. Context switch events are not exported.
+
+        \retval false if shared memory segment could not be created.
+
+        \ingroup profiler
+        */
+        PROFILER_API bool startSharedMemoryExport(const char* _name = nullptr, uint32_t _ringSize = 0);
+
+        /** Stops shared memory exporting thread and removes segment name.
+
+        \note This would be invoked automatically on application exit.
+
+        \ingroup profiler
+        */
+        PROFILER_API void stopSharedMemoryExport();
+
+        /** Check if shared memory exporting thread launched.
+
+        \ingroup profiler
+        */
+        PROFILER_API bool isSharedMemoryExportEnabled();
+
+        /** Arm a trigger for capturing rare events with the history preceding them.
+
+        Enables profiling and keeps only recent history of blocks (_historyMs milliseconds) in memory.
+        When trigger condition fires, profiler continues capturing for _afterMs milliseconds and then
+        dumps captured blocks (the history before the trigger and the blocks after it) into file _filename.
+        If _filename is nullptr then captured blocks are sent to network clients which have requested
+        capturing or armed a trigger (see startListen()).
+
+        The trigger fires only once. Profiling is disabled after the dump (the same as after dumpBlocksToFile()).
+
+        \param _type Trigger condition type.
+        \param _blockName Name of the block (for TriggerType::BlockDuration) or of the value (for TriggerType::Value).
+        Ignored for TriggerType::FrameDuration.
+        \param _threshold Threshold in microseconds for durations or value threshold for TriggerType::Value.
+
+        \retval false if _type is invalid.
+
+        \ingroup profiler
+        */
+        PROFILER_API bool armTrigger(TriggerType _type, const char* _blockName, double _threshold, uint32_t _historyMs,
+                                     uint32_t _afterMs, const char* _filename = nullptr);
+
+        /** Disarm the trigger armed by armTrigger().
+
+        Profiling is not disabled, but all recorded blocks are kept in memory from now on.
+
+        \ingroup profiler
+        */
+        PROFILER_API void disarmTrigger();
+
+        /** Check if the trigger is armed or has fired and is capturing blocks after the trigger.
+
+        \ingroup profiler
+        */
+        PROFILER_API bool isTriggerArmed();
+
         /** Returns current major version.
         
         \ingroup profiler
@@ -778,7 +899,11 @@ namespace profiler {
     inline void storeBlock(const BaseBlockDescriptor*, const char*, timestamp_t, timestamp_t) { }
     inline void beginBlock(Block&) { }
     inline void beginNonScopedBlock(const BaseBlockDescriptor*, const char* = "") { }
-    inline uint32_t dumpBlocksToFile(const char*) { return 0; }
+    inline uint64_t dumpBlocksToFile(const char*) { return 0; }
+    inline uint64_t dumpBlocksToSink(Sink&) { return 0; }
+    inline EASY_CONSTEXPR_FCN bool dumpBlocksToFileAsync(const char*, dump_callback_t = nullptr, void* = nullptr) { return false; }
+    inline void setDumpCompression(CompressionCodec) { }
+    inline EASY_CONSTEXPR_FCN CompressionCodec dumpCompression() { return CompressionCodec::None; }
     inline const char* registerThreadScoped(const char*, ThreadGuard&) { return ""; }
     inline const char* registerThread(const char*) { return ""; }
     inline void setEventTracingEnabled(bool) { }
@@ -790,6 +915,12 @@ namespace profiler {
     inline void startListen(uint16_t = ::profiler::DEFAULT_PORT) { }
     inline void stopListen() { }
     inline EASY_CONSTEXPR_FCN bool isListening() { return false; }
+    inline EASY_CONSTEXPR_FCN bool startSharedMemoryExport(const char* = nullptr, uint32_t = 0) { return false; }
+    inline void stopSharedMemoryExport() { }
+    inline EASY_CONSTEXPR_FCN bool isSharedMemoryExportEnabled() { return false; }
+    inline EASY_CONSTEXPR_FCN bool armTrigger(TriggerType, const char*, double, uint32_t, uint32_t, const char* = nullptr) { return false; }
+    inline void disarmTrigger() { }
+    inline EASY_CONSTEXPR_FCN bool isTriggerArmed() { return false; }
     inline EASY_CONSTEXPR_FCN uint8_t versionMajor() { return 0; }
     inline EASY_CONSTEXPR_FCN uint8_t versionMinor() { return 0; }
     inline EASY_CONSTEXPR_FCN uint16_t versionPatch() { return 0; }
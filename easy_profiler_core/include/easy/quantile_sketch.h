@@ -0,0 +1,306 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_QUANTILE_SKETCH_H
+#define EASY_PROFILER_QUANTILE_SKETCH_H
+
+#include <easy/details/profiler_public_types.h>
+#include <algorithm>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+    EASY_CONSTEXPR uint32_t QUANTILE_SKETCH_EXACT_SAMPLES = 4096; ///< Sketch keeps all samples (and gives exact results) until it has more samples than this
+    EASY_CONSTEXPR uint32_t QUANTILE_SKETCH_SUBBUCKET_BITS = 7; ///< Every power of 2 is split into 2^7 buckets: relative error of results is less than 0.4%
+
+    /** Mergeable sketch of durations distribution used to estimate median and percentiles.
+
+    Small sets of durations are stored as is and give exact results. When number of durations exceeds
+    QUANTILE_SKETCH_EXACT_SAMPLES, sketch switches into HDR-histogram-like mode: durations are counted
+    in logarithmic buckets of relative width 1/128, so memory usage does not depend on the number of durations
+    (at most 7424 buckets for the whole 64-bit range) while results keep relative error < 0.4%.
+
+    Sketches of different sets of durations can be merged into a sketch of the union of these sets.
+    */
+    class QuantileSketch EASY_FINAL
+    {
+        std::vector<timestamp_t> m_samples; ///< Durations stored in exact mode
+        std::vector<uint64_t>    m_buckets; ///< Durations counters stored in histogram mode
+        uint64_t                   m_count; ///< Total number of durations
+        timestamp_t                  m_min; ///< Min duration (results are clamped into [min, max])
+        timestamp_t                  m_max; ///< Max duration
+        bool                       m_exact; ///< Exact mode flag
+
+    public:
+
+        QuantileSketch() : m_count(0), m_min(0), m_max(0), m_exact(true)
+        {
+        }
+
+        QuantileSketch(QuantileSketch&&) = default;
+        QuantileSketch& operator = (QuantileSketch&&) = default;
+        QuantileSketch(const QuantileSketch&) = default;
+        QuantileSketch& operator = (const QuantileSketch&) = default;
+
+        inline uint64_t count() const { return m_count; }
+        inline bool empty() const { return m_count == 0; }
+        inline bool exact() const { return m_exact; }
+
+        /** Remove all durations. Allocated memory is kept for reuse.
+        */
+        void clear()
+        {
+            m_samples.clear();
+            m_buckets.clear();
+            m_count = 0;
+            m_min = m_max = 0;
+            m_exact = true;
+        }
+
+        void add(timestamp_t _duration)
+        {
+            if (m_count == 0)
+            {
+                m_min = m_max = _duration;
+            }
+            else if (_duration < m_min)
+            {
+                m_min = _duration;
+            }
+            else if (_duration > m_max)
+            {
+                m_max = _duration;
+            }
+
+            ++m_count;
+
+            if (m_exact)
+            {
+                if (m_samples.size() < QUANTILE_SKETCH_EXACT_SAMPLES)
+                {
+                    m_samples.push_back(_duration);
+                    return;
+                }
+
+                switchToHistogram();
+            }
+
+            addToBucket(bucketIndex(_duration), 1);
+        }
+
+        /** Add all durations of another sketch.
+        */
+        void merge(const QuantileSketch& _other)
+        {
+            if (_other.m_count == 0)
+                return;
+
+            if (m_count == 0)
+            {
+                m_min = _other.m_min;
+                m_max = _other.m_max;
+            }
+            else
+            {
+                m_min = std::min(m_min, _other.m_min);
+                m_max = std::max(m_max, _other.m_max);
+            }
+
+            m_count += _other.m_count;
+
+            if (m_exact && _other.m_exact && m_samples.size() + _other.m_samples.size() <= QUANTILE_SKETCH_EXACT_SAMPLES)
+            {
+                m_samples.insert(m_samples.end(), _other.m_samples.begin(), _other.m_samples.end());
+                return;
+            }
+
+            if (m_exact)
+                switchToHistogram();
+
+            if (_other.m_exact)
+            {
+                for (auto duration : _other.m_samples)
+                    addToBucket(bucketIndex(duration), 1);
+            }
+            else
+            {
+                if (m_buckets.size() < _other.m_buckets.size())
+                    m_buckets.resize(_other.m_buckets.size(), 0);
+                for (size_t i = 0, size = _other.m_buckets.size(); i < size; ++i)
+                    m_buckets[i] += _other.m_buckets[i];
+            }
+        }
+
+        /** Median duration.
+
+        For even number of durations in exact mode it is the mean of two middle durations.
+        \note Changes the order of stored durations.
+        */
+        timestamp_t median()
+        {
+            if (!m_exact || m_count < 2)
+                return quantile(0.5);
+
+            const auto middle = m_samples.begin() + (m_samples.size() >> 1);
+            std::nth_element(m_samples.begin(), middle, m_samples.end());
+
+            const auto upper = *middle;
+            if ((m_samples.size() & 1) != 0)
+                return upper;
+
+            const auto lower = *std::max_element(m_samples.begin(), middle);
+            return lower + ((upper - lower) >> 1);
+        }
+
+        /** Duration which is not less than _quantile part of all durations (nearest-rank method).
+
+        \param _quantile Value in range [0, 1], for example 0.99 for 99th percentile.
+        \note Changes the order of stored durations.
+        */
+        timestamp_t quantile(double _quantile)
+        {
+            if (m_count == 0)
+                return 0;
+
+            const auto rank = this->rank(_quantile);
+
+            if (m_exact)
+            {
+                const auto nth = m_samples.begin() + (rank - 1);
+                std::nth_element(m_samples.begin(), nth, m_samples.end());
+                return *nth;
+            }
+
+            uint64_t accumulated = 0;
+            for (size_t i = 0, size = m_buckets.size(); i < size; ++i)
+            {
+                accumulated += m_buckets[i];
+                if (accumulated >= rank)
+                    return std::max(m_min, std::min(m_max, bucketValue(static_cast<uint32_t>(i))));
+            }
+
+            return m_max;
+        }
+
+    private:
+
+        uint64_t rank(double _quantile) const
+        {
+            if (!(_quantile > 0))
+                return 1;
+
+            if (_quantile >= 1)
+                return m_count;
+
+            // nearest rank: ceil(quantile * count)
+            const auto product = _quantile * static_cast<double>(m_count);
+            auto result = static_cast<uint64_t>(product);
+            if (static_cast<double>(result) < product)
+                ++result;
+
+            return std::max(result, static_cast<uint64_t>(1));
+        }
+
+        void switchToHistogram()
+        {
+            m_exact = false;
+            for (auto duration : m_samples)
+                addToBucket(bucketIndex(duration), 1);
+            m_samples.clear();
+        }
+
+        void addToBucket(uint32_t _index, uint64_t _count)
+        {
+            if (_index >= m_buckets.size())
+                m_buckets.resize(_index + 1, 0);
+            m_buckets[_index] += _count;
+        }
+
+        static uint32_t highestBit(timestamp_t _value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return 63 - static_cast<uint32_t>(__builtin_clzll(_value));
+#else
+            uint32_t result = 0;
+            for (uint32_t shift = 32; shift != 0; shift >>= 1)
+            {
+                if ((_value >> shift) != 0)
+                {
+                    _value >>= shift;
+                    result += shift;
+                }
+            }
+            return result;
+#endif
+        }
+
+        static uint32_t bucketIndex(timestamp_t _duration)
+        {
+            // Durations less than 2^(bits+1) have their own buckets.
+            // Durations in range [2^n, 2^(n+1)) are split into 2^bits buckets of width 2^(n-bits).
+            if (_duration < (timestamp_t(2) << QUANTILE_SKETCH_SUBBUCKET_BITS))
+                return static_cast<uint32_t>(_duration);
+
+            const auto shift = highestBit(_duration) - QUANTILE_SKETCH_SUBBUCKET_BITS;
+            return (shift << QUANTILE_SKETCH_SUBBUCKET_BITS) + static_cast<uint32_t>(_duration >> shift);
+        }
+
+        static timestamp_t bucketValue(uint32_t _index)
+        {
+            if (_index < (2U << QUANTILE_SKETCH_SUBBUCKET_BITS))
+                return _index;
+
+            // Middle of the bucket
+            const auto shift = (_index >> QUANTILE_SKETCH_SUBBUCKET_BITS) - 1;
+            const auto mantissa = _index - (shift << QUANTILE_SKETCH_SUBBUCKET_BITS);
+            return (static_cast<timestamp_t>(mantissa) << shift) + ((timestamp_t(1) << shift) >> 1);
+        }
+
+    }; // END of class QuantileSketch.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_QUANTILE_SKETCH_H
@@ -48,6 +48,7 @@ The Apache License, Version 2.0 (the "License");
 #include <atomic>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -58,17 +59,29 @@ The Apache License, Version 2.0 (the "License");
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace profiler { namespace segments { class SegmentedCapture; } }
+
 namespace profiler {
 
     using processid_t    = uint64_t;
+
+#if defined(EASY_OPTION_64BIT_BLOCK_INDEX) && EASY_OPTION_64BIT_BLOCK_INDEX != 0
+    // Captures with more than 4G blocks, at the cost of 4 more bytes per loaded block
+    using calls_number_t = uint64_t;
+    using block_index_t  = uint64_t;
+#else
     using calls_number_t = uint32_t;
     using block_index_t  = uint32_t;
+#endif
+
+    EASY_CONSTEXPR uint8_t STATS_PERCENTILES_NUMBER = 3; ///< Number of percentiles stored in BlockStatistics (see set_stats_percentiles())
 
 #pragma pack(push, 1)
     struct BlockStatistics EASY_FINAL
     {
         profiler::timestamp_t          total_duration; ///< Total duration of all block calls
         profiler::timestamp_t         median_duration; ///< Median duration of all block calls
+        profiler::timestamp_t    percentile_durations[STATS_PERCENTILES_NUMBER]; ///< Durations of percentiles stats_percentile(i) of all block calls
         profiler::timestamp_t total_children_duration; ///< Total duration of all children of all block calls
         profiler::block_index_t    min_duration_block; ///< Will be used in GUI to jump to the block with min duration
         profiler::block_index_t    max_duration_block; ///< Will be used in GUI to jump to the block with max duration
@@ -78,6 +91,7 @@ namespace profiler {
         explicit BlockStatistics(profiler::timestamp_t _duration, profiler::block_index_t _block_index, profiler::block_index_t _parent_index)
             : total_duration(_duration)
             , median_duration(0)
+            , percentile_durations()
             , total_children_duration(0)
             , min_duration_block(_block_index)
             , max_duration_block(_block_index)
@@ -96,10 +110,108 @@ namespace profiler {
     }; // END of struct BlockStatistics.
 #pragma pack(pop)
 
+    /** Reset pointer to the block statistics.
+
+    \deprecated Statistics are allocated from the memory owned by SerializedData of the blocks
+    (and are released together with it), so there is no need to release them one by one.
+    */
     extern "C" PROFILER_API void release_stats(BlockStatistics*& _stats);
 
+    /** Index of BlockStatistics in the statistics memory of loaded trees.
+
+    Indices are shared by all trees loaded in the process: statistics are stored by up to 2^20 chunks of
+    up to 4096 statistics each (about 4 billion statistics in total), and every thread of every loaded file uses
+    at least one chunk. If the limit is exceeded then loading fails with an error message in the log.
+    Chunks are reused when SerializedData of the blocks which own them is released.
+    */
+    using stats_index_t = uint32_t;
+
+    EASY_CONSTEXPR stats_index_t NoStatsIndex = ~stats_index_t(0); ///< Index of absent statistics
+
+    /** Get statistics by index stored in BlocksTree.
+
+    \retval nullptr for NoStatsIndex.
+
+    \note Statistics are valid while SerializedData of the blocks is alive.
+    */
+    extern "C" PROFILER_API BlockStatistics* block_statistics(stats_index_t _index);
+
+    /** Set percentiles which are calculated into BlockStatistics::percentile_durations by next loaded files.
+
+    \param _percentiles Array of STATS_PERCENTILES_NUMBER values in range (0, 100). Default values are 90, 99 and 99.9.
+
+    \note Must not be called while a file is being loaded.
+    */
+    extern "C" PROFILER_API void set_stats_percentiles(const double* _percentiles);
+
+    /** Percentile (in range (0, 100)) stored in BlockStatistics::percentile_durations[_index].
+    */
+    extern "C" PROFILER_API double stats_percentile(uint8_t _index);
+
+    //////////////////////////////////////////////////////////////////////////
+
+    using block_indices_t = std::vector<profiler::block_index_t>;
+
+#pragma pack(push, 4)
+    /** Read-only list of block indices stored in contiguous memory which is owned by someone else.
+
+    Children lists of all loaded blocks are stored in a few flat arrays owned by SerializedData of the blocks
+    instead of a separate heap allocation per block. Can be implicitly constructed from std::vector,
+    so functions accepting BlocksTree::children_t also accept lists of BlocksTreeRoot.
+    */
+    class BlockIndicesRange EASY_FINAL
+    {
+        const profiler::block_index_t* m_data;
+        profiler::block_index_t        m_size;
+
+    public:
+
+        using value_type = profiler::block_index_t;
+        using size_type = size_t;
+        using const_iterator = const profiler::block_index_t*;
+        using iterator = const_iterator;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using reverse_iterator = const_reverse_iterator;
+
+        BlockIndicesRange() EASY_NOEXCEPT : m_data(nullptr), m_size(0)
+        {
+        }
+
+        BlockIndicesRange(const profiler::block_index_t* _data, profiler::block_index_t _size) EASY_NOEXCEPT
+            : m_data(_data), m_size(_size)
+        {
+        }
+
+        BlockIndicesRange(const block_indices_t& _indices) EASY_NOEXCEPT
+            : m_data(_indices.data()), m_size(static_cast<profiler::block_index_t>(_indices.size()))
+        {
+        }
+
+        inline const_iterator begin() const EASY_NOEXCEPT { return m_data; }
+        inline const_iterator end() const EASY_NOEXCEPT { return m_data + m_size; }
+        inline const_iterator cbegin() const EASY_NOEXCEPT { return begin(); }
+        inline const_iterator cend() const EASY_NOEXCEPT { return end(); }
+        inline const_reverse_iterator rbegin() const EASY_NOEXCEPT { return const_reverse_iterator(end()); }
+        inline const_reverse_iterator rend() const EASY_NOEXCEPT { return const_reverse_iterator(begin()); }
+
+        inline size_type size() const EASY_NOEXCEPT { return m_size; }
+        inline bool empty() const EASY_NOEXCEPT { return m_size == 0; }
+        inline const profiler::block_index_t* data() const EASY_NOEXCEPT { return m_data; }
+
+        inline profiler::block_index_t operator [] (size_type i) const EASY_NOEXCEPT { return m_data[i]; }
+        inline profiler::block_index_t front() const EASY_NOEXCEPT { return m_data[0]; }
+        inline profiler::block_index_t back() const EASY_NOEXCEPT { return m_data[m_size - 1]; }
+
+    }; // END of class BlockIndicesRange.
+#pragma pack(pop)
+
     //////////////////////////////////////////////////////////////////////////
 
+    /** Loaded block.
+
+    Trees are compact: children lists and statistics are not allocated per block, but are placed into
+    the memory owned by SerializedData of the blocks (see fillTreesFromFile()), which must outlive the trees.
+    */
     class BlocksTree EASY_FINAL
     {
         using This = BlocksTree;
@@ -107,9 +219,7 @@ namespace profiler {
     public:
 
         using blocks_t = std::vector<This>;
-        using children_t = std::vector<profiler::block_index_t>;
-
-        children_t children; ///< List of children blocks. May be empty.
+        using children_t = BlockIndicesRange;
 
         union {
             profiler::SerializedBlock*    node; ///< Pointer to serialized data for regular block (id, name, begin, end etc.)
@@ -117,19 +227,20 @@ namespace profiler {
             profiler::ArbitraryValue*    value; ///< Pointer to serialized data for arbitrary value
         };
 
-        profiler::BlockStatistics* per_parent_stats; ///< Pointer to statistics for this block within the parent (may be nullptr for top-level blocks)
-        profiler::BlockStatistics*  per_frame_stats; ///< Pointer to statistics for this block within the frame (may be nullptr for top-level blocks)
-        profiler::BlockStatistics* per_thread_stats; ///< Pointer to statistics for this block within the bounds of all frames per current thread
-        uint8_t                               depth; ///< Maximum number of sublevels (maximum children depth)
+        profiler::stats_index_t per_parent_stats_index; ///< Statistics for this block within the parent (may be NoStatsIndex for top-level blocks)
+        profiler::stats_index_t  per_frame_stats_index; ///< Statistics for this block within the frame (may be NoStatsIndex for top-level blocks)
+        profiler::stats_index_t per_thread_stats_index; ///< Statistics for this block within the bounds of all frames per current thread
+        children_t                            children; ///< List of children blocks. May be empty.
+        uint16_t                                 depth; ///< Maximum number of sublevels (maximum children depth)
 
         BlocksTree(const This&) = delete;
         This& operator = (const This&) = delete;
 
         BlocksTree() EASY_NOEXCEPT
             : node(nullptr)
-            , per_parent_stats(nullptr)
-            , per_frame_stats(nullptr)
-            , per_thread_stats(nullptr)
+            , per_parent_stats_index(NoStatsIndex)
+            , per_frame_stats_index(NoStatsIndex)
+            , per_thread_stats_index(NoStatsIndex)
             , depth(0)
         {
 
@@ -147,11 +258,24 @@ namespace profiler {
             return *this;
         }
 
-        ~BlocksTree() EASY_NOEXCEPT
+        ~BlocksTree() = default;
+
+        /** Statistics for this block within the parent (may be nullptr for top-level blocks) */
+        inline profiler::BlockStatistics* per_parent_stats() const EASY_NOEXCEPT
+        {
+            return block_statistics(per_parent_stats_index);
+        }
+
+        /** Statistics for this block within the frame (may be nullptr for top-level blocks) */
+        inline profiler::BlockStatistics* per_frame_stats() const EASY_NOEXCEPT
+        {
+            return block_statistics(per_frame_stats_index);
+        }
+
+        /** Statistics for this block within the bounds of all frames per current thread */
+        inline profiler::BlockStatistics* per_thread_stats() const EASY_NOEXCEPT
         {
-            release_stats(per_thread_stats);
-            release_stats(per_parent_stats);
-            release_stats(per_frame_stats);
+            return block_statistics(per_thread_stats_index);
         }
 
         bool operator < (const This& other) const EASY_NOEXCEPT
@@ -180,26 +304,18 @@ namespace profiler {
 
         void make_move(This&& that) EASY_NOEXCEPT
         {
-            if (per_thread_stats != that.per_thread_stats)
-                release_stats(per_thread_stats);
-
-            if (per_parent_stats != that.per_parent_stats)
-                release_stats(per_parent_stats);
-
-            if (per_frame_stats != that.per_frame_stats)
-                release_stats(per_frame_stats);
-
-            children = std::move(that.children);
+            children = that.children;
             node = that.node;
-            per_parent_stats = that.per_parent_stats;
-            per_frame_stats = that.per_frame_stats;
-            per_thread_stats = that.per_thread_stats;
+            per_parent_stats_index = that.per_parent_stats_index;
+            per_frame_stats_index = that.per_frame_stats_index;
+            per_thread_stats_index = that.per_thread_stats_index;
             depth = that.depth;
 
+            that.children = children_t();
             that.node = nullptr;
-            that.per_parent_stats = nullptr;
-            that.per_frame_stats = nullptr;
-            that.per_thread_stats = nullptr;
+            that.per_parent_stats_index = NoStatsIndex;
+            that.per_frame_stats_index = NoStatsIndex;
+            that.per_thread_stats_index = NoStatsIndex;
         }
 
     }; // END of class BlocksTree.
@@ -226,16 +342,16 @@ namespace profiler {
 
     public:
 
-        BlocksTree::children_t       children; ///< List of children indexes
-        BlocksTree::children_t           sync; ///< List of context-switch events
-        BlocksTree::children_t         events; ///< List of events indexes
+        block_indices_t              children; ///< List of children indexes
+        block_indices_t                  sync; ///< List of context-switch events
+        block_indices_t                events; ///< List of events indexes
         std::string               thread_name; ///< Name of this thread
         profiler::timestamp_t   profiled_time; ///< Profiled time of this thread (sum of all children duration)
         profiler::timestamp_t       wait_time; ///< Wait time of this thread (sum of all context switches)
         profiler::thread_id_t       thread_id; ///< System Id of this thread
         profiler::block_index_t frames_number; ///< Total frames number (top-level blocks)
         profiler::block_index_t blocks_number; ///< Total blocks number including their children
-        uint8_t                         depth; ///< Maximum stack depth (number of levels)
+        uint16_t                        depth; ///< Maximum stack depth (number of levels)
 
         BlocksTreeRoot(const This&) = delete;
         This& operator = (const This&) = delete;
@@ -303,10 +419,18 @@ namespace profiler {
 
     //////////////////////////////////////////////////////////////////////////
 
+    class BlocksTreeMemory;
+
+    /** Memory which holds serialized blocks or descriptors.
+
+    Memory is either allocated on the heap or is a copy-on-write mapping of the whole file (see mapFile()).
+    */
     class PROFILER_API SerializedData EASY_FINAL
     {
-        uint64_t m_size;
-        char*    m_data;
+        uint64_t              m_size;
+        char*                 m_data;
+        BlocksTreeMemory*    m_trees; ///< Children lists and statistics of the trees built from these blocks
+        bool                m_mapped; ///< If true then m_data is a file mapping
 
     public:
 
@@ -341,9 +465,26 @@ namespace profiler {
 
         void swap(SerializedData& other);
 
+        /** Map whole file into memory.
+
+        Mapping is private for this process: modified pages are copied on write and are never written back to the file.
+
+        \retval false if file can not be mapped (SerializedData stays empty).
+        */
+        bool mapFile(const char* _filename);
+
+        bool isMapped() const;
+
+        /** Memory of children lists and statistics of the blocks trees built from these blocks.
+
+        Is filled by fillTreesFromFile() and fillTreesFromStream() and is released by clear().
+        */
+        BlocksTreeMemory& treesMemory();
+
     private:
 
         void set(char* _data, uint64_t _size);
+        void release();
 
     }; // END of class SerializedData.
 
@@ -351,6 +492,137 @@ namespace profiler {
 
     using descriptors_list_t = std::vector<SerializedBlockDescriptor*>;
 
+    //////////////////////////////////////////////////////////////////////////
+
+#pragma pack(push, 1)
+    /** Group of consecutive top-level blocks (frames) of one thread in the seekable index of .prof file.
+
+    Children of a block are always stored right before the block itself, so all blocks of a group
+    occupy a contiguous range of the thread blocks list.
+    */
+    struct FileIndexCheckpoint
+    {
+        profiler::timestamp_t begin; ///< Begin time of the first frame of the group
+        profiler::timestamp_t   end; ///< End time of the last frame of the group
+        uint64_t             offset; ///< Offset of the first block record of the group
+        uint64_t       block_number; ///< Number of the first block record of the group in the thread blocks list
+    };
+#pragma pack(pop)
+
+    /** Position of one thread section in .prof file.
+    */
+    struct FileThreadIndex
+    {
+        profiler::thread_id_t                thread_id = 0;
+        uint64_t                                offset = 0; ///< Offset of the thread section (starts with thread id)
+        uint64_t                             cs_offset = 0; ///< Offset of the number of context switches
+        uint64_t                         blocks_offset = 0; ///< Offset of the number of blocks
+        uint64_t                            end_offset = 0; ///< Offset right after the last block record of the thread
+        uint64_t                             cs_number = 0; ///< Number of context switch records
+        uint64_t                         blocks_number = 0; ///< Number of block records
+        std::vector<FileIndexCheckpoint> checkpoints; ///< Groups of frames in the file order (sorted by time)
+        std::string                        thread_name; ///< Is read from the thread section by readFileIndex()
+    };
+
+    /** Optional seekable index stored at the end of .prof file.
+
+    Offsets are counted from the beginning of .prof data (for compressed files - from the beginning of unpacked data).
+    Times are in the same units as in the blocks of the file (CPU ticks if cpu frequency in the file header is not 0).
+    */
+    struct FileIndex
+    {
+        std::vector<FileThreadIndex>    threads; ///< Thread sections in the file order
+        std::vector<uint64_t> descriptors_usage; ///< Number of blocks for each block id (as stored in the file)
+        int64_t               cpu_frequency = 0; ///< Values from the file header (are read by readFileIndex())
+        profiler::timestamp_t    begin_time = 0; ///<
+        profiler::timestamp_t      end_time = 0; ///<
+    };
+
+    /** Part of .prof file to be loaded by fillTreesFromFileRange().
+
+    Blocks and context switches overlapping [begin, end] are loaded together with all their parents.
+    */
+    struct LoadRange
+    {
+        profiler::timestamp_t begin = 0; ///< Offset from the beginning of the capture (in nanoseconds)
+        profiler::timestamp_t   end = ~profiler::timestamp_t(0); ///< Offset from the beginning of the capture (in nanoseconds)
+        std::vector<profiler::thread_id_t> threads; ///< Threads to load (all threads if empty)
+        bool sidecar_index = true; ///< Create "<filename>.idx" index for files without index on the first load
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Block reported to BlocksVisitor by readBlocksFromFile() and readBlocksFromStream().
+
+    Block data is valid only during the visitor call.
+    */
+    struct StreamedBlock
+    {
+        const profiler::SerializedBlock* node; ///< Times are in nanoseconds; id is the same as fillTreesFromFile() assigns (blocks with runtime names get new ids)
+        profiler::thread_id_t       thread_id; ///<
+        uint64_t                        index; ///< Index of the block in the blocks list filled by fillTreesFromFile()
+        profiler::block_id_t    descriptor_id; ///< Id of the block description in the file
+        uint32_t                        depth; ///< Nesting level of the block (0 for top-level blocks)
+    };
+
+    /** Receiver of .prof file contents for readBlocksFromFile() and readBlocksFromStream().
+
+    Data is reported in the file order: header, blocks descriptions, then thread sections
+    (context switches, then begin and end of each block in timestamp order), then bookmarks.
+    Return false from any method to stop reading.
+    */
+    class BlocksVisitor
+    {
+    public:
+
+        virtual ~BlocksVisitor() {}
+
+        virtual bool onHeader(uint32_t /*version*/, profiler::processid_t /*pid*/, const profiler::BeginEndTime& /*begin_end_time*/) { return true; }
+        virtual bool onDescriptors(const profiler::descriptors_list_t& /*descriptors*/) { return true; }
+        virtual bool onThreadBegin(profiler::thread_id_t /*thread_id*/, const char* /*thread_name*/) { return true; }
+        virtual bool onContextSwitch(profiler::thread_id_t /*thread_id*/, const profiler::SerializedCSwitch& /*cs*/, uint64_t /*index*/) { return true; }
+        virtual bool onBlockBegin(const profiler::StreamedBlock& /*block*/) { return true; }
+        virtual bool onBlockEnd(const profiler::StreamedBlock& /*block*/) { return true; }
+        virtual bool onThreadEnd(profiler::thread_id_t /*thread_id*/) { return true; }
+        virtual bool onBookmark(const profiler::Bookmark& /*bookmark*/) { return true; }
+
+    }; // END of class BlocksVisitor.
+
+    /** Reads segmented capture (see profiler::SegmentedFileSink) while it is still being written.
+
+    Each poll() reports dumps which have been appended to the file since previous call. Only committed dumps
+    are reported, so block trees are always complete. Every dump is reported as readBlocksFromFile() reports
+    the whole file: onHeader() (with the time range of all dumps read so far), onDescriptors() (all known descriptors),
+    then threads of the dump.
+
+    \note Block indices and ids of blocks with runtime names are assigned for each dump separately.
+    */
+    class PROFILER_API SegmentedFileTail EASY_FINAL
+    {
+        std::string                  m_filename;
+        segments::SegmentedCapture*   m_capture;
+        uint64_t                       m_offset; ///< Offset of the first segment which has not been reported
+
+    public:
+
+        SegmentedFileTail(const SegmentedFileTail&) = delete;
+        SegmentedFileTail& operator = (const SegmentedFileTail&) = delete;
+
+        explicit SegmentedFileTail(const char* filename);
+        ~SegmentedFileTail();
+
+        /** Report dumps appended since previous call.
+
+        \retval false if the file can not be read, it is corrupted or reading was stopped by the visitor.
+        */
+        bool poll(BlocksVisitor& visitor, std::ostream& _log);
+
+        /** Size of the part of the file which has been reported.
+        */
+        uint64_t offset() const;
+
+    }; // END of class SegmentedFileTail.
+
 } // END of namespace profiler.
 
 extern "C" {
@@ -388,6 +660,63 @@ extern "C" {
                                                  profiler::descriptors_list_t& descriptors,
                                                  std::ostream& _log);
 
+    /** Same as fillTreesFromFile() but loads only a part of the file.
+
+    If the file has a seekable index (see readFileIndex()) then data of not requested threads and frames is not read at all,
+    so memory consumption and loading time depend on the size of requested part instead of the file size.
+    Compressed files are still unpacked entirely, but only requested data is stored.
+
+    begin_end_time is set to the loaded range.
+    */
+    PROFILER_API profiler::block_index_t fillTreesFromFileRange(std::atomic<int>& progress, const char* filename,
+                                                                const profiler::LoadRange& range,
+                                                                profiler::BeginEndTime& begin_end_time,
+                                                                profiler::SerializedData& serialized_blocks,
+                                                                profiler::SerializedData& serialized_descriptors,
+                                                                profiler::descriptors_list_t& descriptors,
+                                                                profiler::blocks_t& _blocks,
+                                                                profiler::thread_blocks_tree_t& threaded_trees,
+                                                                profiler::bookmarks_t& bookmarks,
+                                                                uint32_t& descriptors_count,
+                                                                uint32_t& version,
+                                                                profiler::processid_t& pid,
+                                                                bool gather_statistics,
+                                                                std::ostream& _log);
+
+    /** Read seekable index of .prof file (plain or compressed) without reading the rest of the file.
+
+    The index is stored at the end of files written by current version. For older plain files
+    the index is read from "<filename>.idx" created by fillTreesFromFileRange().
+
+    Segmented captures (see profiler::SegmentedFileSink) have no index: false is returned with a message telling so
+    instead of a signature error.
+
+    \retval false if the file has no index or the index is corrupted.
+    */
+    PROFILER_API bool readFileIndex(const char* filename, profiler::FileIndex& index, std::ostream& _log);
+
+    /** Same as readFileIndex() but for a seekable stream positioned at the beginning of .prof data.
+    */
+    PROFILER_API bool readFileIndexFromStream(std::istream& str, profiler::FileIndex& index, std::ostream& _log);
+
+    /** Read .prof file (plain, compressed or segmented) sequentially, reporting it's contents to the visitor.
+
+    Nothing is accumulated besides blocks descriptions and runtime names of blocks.
+    Blocks are stored in the file after their children, so blocks are kept in memory until their top-level block is read:
+    if the file has an index (see readFileIndex()) then memory consumption is limited by the largest group of frames,
+    otherwise - by the largest thread section.
+
+    \retval false if the file is corrupted or reading was stopped by the visitor.
+    */
+    PROFILER_API bool readBlocksFromFile(const char* filename, profiler::BlocksVisitor& visitor, std::ostream& _log);
+
+    /** Same as readBlocksFromFile() but for any stream, including not seekable ones (pipes, stdin).
+
+    Index of the file is not available in this case, so blocks of each thread section are kept in memory
+    until the end of the section.
+    */
+    PROFILER_API bool readBlocksFromStream(std::istream& str, profiler::BlocksVisitor& visitor, std::ostream& _log);
+
 }
 
 inline profiler::block_index_t fillTreesFromFile(const char* filename, profiler::BeginEndTime& begin_end_time,
@@ -0,0 +1,310 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_SINK_H
+#define EASY_PROFILER_SINK_H
+
+#include <easy/details/profiler_public_types.h>
+#include <cstdio>
+#include <functional>
+
+class EasySocket;
+
+namespace profiler { namespace compression { class ChunkedCompressor; } }
+namespace profiler { namespace segments { class SegmentEncoder; } }
+
+//////////////////////////////////////////////////////////////////////////
+
+/*
+Capture sinks.
+
+profiler::dumpBlocksToSink() serializes the capture as a sequence of write() calls.
+Concatenation of all written buffers is exactly the .prof file contents,
+so any sink which just stores the bytes produces a valid .prof file.
+
+Buffers are not copied: blocks are passed directly from profiler's internal storage.
+Data pointer is valid only during write() invocation.
+*/
+
+namespace profiler {
+
+    enum class SinkSection : uint8_t
+    {
+        Header = 0, ///< File header: signature, version, pid, cpu frequency, begin/end time, sizes and counts
+        Descriptors, ///< Block descriptors: [uint16_t size][SerializedBlockDescriptor]...
+        ThreadInfo, ///< Thread id and thread name
+        ContextSwitches, ///< Number of context switch events of the thread followed by [uint16_t size][SerializedBlock]...
+        Blocks, ///< Number of blocks of the thread followed by [uint16_t size][SerializedBlock]...
+        Footer, ///< End of threads section
+        Index ///< Optional seekable index of the file written after all other data (see profiler::FileIndex)
+    };
+
+    /** Receiver of serialized capture.
+
+    \sa dumpBlocksToSink
+    */
+    class PROFILER_API Sink
+    {
+    public:
+
+        virtual ~Sink();
+
+        /** Receive next part of the capture.
+
+        \param _section Part of the capture the data belongs to.
+        \param _thread Id of the thread for per-thread sections (0 for Header, Descriptors and Footer).
+        \param _data Data pointer valid only during this call.
+        \param _size Data size in bytes.
+        */
+        virtual void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size) = 0;
+
+        /** Called once after the last write().
+
+        \param _blocksCount Number of dumped blocks.
+        \param _success False if dumping has been interrupted and the capture is incomplete.
+        */
+        virtual void complete(uint64_t _blocksCount, bool _success);
+
+    }; // END of class Sink.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Writes capture into .prof file.
+    */
+    class PROFILER_API FileSink EASY_FINAL : public Sink
+    {
+        FILE* m_file;
+        bool  m_good;
+
+    public:
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator = (const FileSink&) = delete;
+
+        explicit FileSink(const char* _filename);
+        ~FileSink();
+
+        bool isOpen() const;
+
+        /** Returns false if file can not be opened or some write has failed.
+        */
+        bool good() const;
+
+        void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size);
+        void complete(uint64_t _blocksCount, bool _success);
+
+    }; // END of class FileSink.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Streams raw .prof contents to a TCP socket (a local collector, for example).
+
+    Connection is established in constructor and closed in complete().
+    Small writes are gathered into an internal buffer to reduce number of send() calls.
+    */
+    class PROFILER_API SocketSink EASY_FINAL : public Sink
+    {
+        EasySocket*   m_socket;
+        char*         m_buffer;
+        uint64_t  m_bufferSize;
+        bool            m_good;
+
+    public:
+
+        SocketSink(const SocketSink&) = delete;
+        SocketSink& operator = (const SocketSink&) = delete;
+
+        SocketSink(const char* _address, uint16_t _port);
+        ~SocketSink();
+
+        bool isConnected() const;
+
+        /** Returns false if connection has failed or has been broken.
+        */
+        bool good() const;
+
+        void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size);
+        void complete(uint64_t _blocksCount, bool _success);
+
+    private:
+
+        bool send(const char* _data, uint64_t _size);
+        void flush();
+
+    }; // END of class SocketSink.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Compresses the capture before passing it into the target sink.
+
+    Target sink receives compressed .prof container: capture is split into blocks
+    (header, descriptors and each thread are packed separately) which are compressed in parallel.
+    fillTreesFromFile() and fillTreesFromStream() unpack such files transparently.
+
+    \sa setDumpCompression
+    */
+    class PROFILER_API CompressingSink EASY_FINAL : public Sink
+    {
+        Sink&                                 m_target;
+        compression::ChunkedCompressor*   m_compressor;
+
+    public:
+
+        CompressingSink(const CompressingSink&) = delete;
+        CompressingSink& operator = (const CompressingSink&) = delete;
+
+        /** \param _codec If the codec is not available then CompressionCodec::LZ4 is used.
+        */
+        explicit CompressingSink(Sink& _target, CompressionCodec _codec = CompressionCodec::LZ4);
+        ~CompressingSink();
+
+        void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size);
+        void complete(uint64_t _blocksCount, bool _success);
+
+    }; // END of class CompressingSink.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Writes segmented capture file for continuous recording.
+
+    Unlike FileSink, the sink is used for many dumps: each dumpBlocksToSink() call appends blocks dumped since
+    previous call to the same file (descriptors are written only once). The file consists of self-describing
+    segments with checksums, so it could be read by fillTreesFromFile() or readBlocksFromFile() at any moment:
+    while it is still being written or after the application has crashed. Only committed dumps are loaded; if
+    the rest of the file has been skipped then the loading still succeeds, but a warning is written into the log.
+    Use profiler::SegmentedFileTail to read only new dumps.
+
+    \code
+        profiler::SegmentedFileSink sink("capture.prof");
+        while (isRunning())
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            profiler::dumpBlocksToSink(sink); // Dumping stops profiling
+            EASY_PROFILER_ENABLE;
+        }
+    \endcode
+
+    \note Data is passed to the file as is, so the sink must not be wrapped by CompressingSink.
+    */
+    class PROFILER_API SegmentedFileSink EASY_FINAL : public Sink
+    {
+        FILE*                      m_file;
+        segments::SegmentEncoder* m_encoder;
+        bool                       m_good;
+
+    public:
+
+        SegmentedFileSink(const SegmentedFileSink&) = delete;
+        SegmentedFileSink& operator = (const SegmentedFileSink&) = delete;
+
+        /** Creates new file (existing file is overwritten).
+        */
+        explicit SegmentedFileSink(const char* _filename);
+        ~SegmentedFileSink();
+
+        bool isOpen() const;
+
+        /** Returns false if file can not be opened or some write has failed.
+        */
+        bool good() const;
+
+        /** Add bookmark which is written together with the next dump. May be called from any thread.
+
+        \param _pos Position of the bookmark in nanoseconds (see profiler::toNanoseconds()).
+        */
+        void addBookmark(timestamp_t _pos, color_t _color, const char* _text);
+
+        void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size);
+
+        /** Finish the dump: all written data is flushed into the file, so readers can see it.
+        */
+        void complete(uint64_t _blocksCount, bool _success);
+
+    private:
+
+        void output(const char* _data, uint64_t _size);
+
+    }; // END of class SegmentedFileSink.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Forwards capture into user callbacks.
+    */
+    class CallbackSink EASY_FINAL : public Sink
+    {
+    public:
+
+        using write_callback_t = std::function<void(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size)>;
+        using complete_callback_t = std::function<void(uint64_t _blocksCount, bool _success)>;
+
+    private:
+
+        write_callback_t       m_write;
+        complete_callback_t m_complete;
+
+    public:
+
+        explicit CallbackSink(write_callback_t _write, complete_callback_t _complete = nullptr)
+            : m_write(std::move(_write))
+            , m_complete(std::move(_complete))
+        {
+        }
+
+        void write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size)
+        {
+            if (m_write)
+                m_write(_section, _thread, _data, _size);
+        }
+
+        void complete(uint64_t _blocksCount, bool _success)
+        {
+            if (m_complete)
+                m_complete(_blocksCount, _success);
+        }
+
+    }; // END of class CallbackSink.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_SINK_H
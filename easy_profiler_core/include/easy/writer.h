@@ -57,7 +57,8 @@ extern "C" {
                                                           profiler::timestamp_t begin_time,
                                                           profiler::timestamp_t end_time,
                                                           profiler::processid_t pid,
-                                                          std::ostream& log);
+                                                          std::ostream& log,
+                                                          profiler::CompressionCodec codec = profiler::CompressionCodec::None);
 
     PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
                                                             const profiler::SerializedData& serialized_descriptors,
@@ -69,7 +70,8 @@ extern "C" {
                                                             profiler::timestamp_t begin_time,
                                                             profiler::timestamp_t end_time,
                                                             profiler::processid_t pid,
-                                                            std::ostream& log);
+                                                            std::ostream& log,
+                                                            profiler::CompressionCodec codec = profiler::CompressionCodec::None);
 }
 
 inline profiler::block_index_t writeTreesToFile(const char* filename,
@@ -82,11 +84,12 @@ inline profiler::block_index_t writeTreesToFile(const char* filename,
                                                 profiler::timestamp_t begin_time,
                                                 profiler::timestamp_t end_time,
                                                 profiler::processid_t pid,
-                                                std::ostream& log)
+                                                std::ostream& log,
+                                                profiler::CompressionCodec codec = profiler::CompressionCodec::None)
 {
     std::atomic<int> progress(0);
     return writeTreesToFile(progress, filename, serialized_descriptors, descriptors, descriptors_count, trees,
-                            bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
+                            bookmarks, std::move(block_getter), begin_time, end_time, pid, log, codec);
 }
 
 inline profiler::block_index_t writeTreesToStream(std::ostream& str,
@@ -99,11 +102,12 @@ inline profiler::block_index_t writeTreesToStream(std::ostream& str,
                                                   profiler::timestamp_t begin_time,
                                                   profiler::timestamp_t end_time,
                                                   profiler::processid_t pid,
-                                                  std::ostream& log)
+                                                  std::ostream& log,
+                                                  profiler::CompressionCodec codec = profiler::CompressionCodec::None)
 {
     std::atomic<int> progress(0);
     return writeTreesToStream(progress, str, serialized_descriptors, descriptors, descriptors_count, trees,
-                              bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
+                              bookmarks, std::move(block_getter), begin_time, end_time, pid, log, codec);
 }
 
 #endif //EASY_PROFILER_WRITER_H
@@ -49,8 +49,10 @@
 ************************************************************************/
 
 #include <algorithm>
+#include <condition_variable>
 #include <future>
 #include <fstream>
+#include <iterator>
 #include <ostream>
 #include <sstream>
 #include "profile_manager.h"
@@ -58,6 +60,7 @@
 #include <easy/profiler.h>
 #include <easy/arbitrary_value.h>
 #include <easy/easy_net.h>
+#include <easy/sink.h>
 
 #ifndef _WIN32
 # include <easy/easy_socket.h>
@@ -66,8 +69,11 @@
 #endif
 
 #include "block_descriptor.h"
+#include "compression.h"
 #include "current_time.h"
 #include "current_thread.h"
+#include "file_index.h"
+#include "shared_memory.h"
 
 #ifdef __APPLE__
 # include <mach/clock.h>
@@ -191,12 +197,6 @@ thread_local static profiler::ThreadGuard THIS_THREAD_GUARD; // thread guard for
         profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
             __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(__VA_ARGS__)));\
     storeBlockForce2(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name), timestamp)
-
-# define EASY_FORCE_EVENT3(ts, timestamp, name, ...)\
-    EASY_LOCAL_STATIC_PTR(const profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), addBlockDescriptor(\
-        profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
-            __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(__VA_ARGS__)));\
-    ts.storeBlockForce(profiler::Block(timestamp, timestamp, EASY_UNIQUE_DESC(__LINE__)->id(), EASY_RUNTIME_NAME(name)))
 #else
 # ifndef EASY_PROFILER_API_DISABLED
 #  define EASY_PROFILER_API_DISABLED
@@ -204,7 +204,6 @@ thread_local static profiler::ThreadGuard THIS_THREAD_GUARD; // thread guard for
 # define EASY_EVENT_RES(res, name, ...)
 # define EASY_FORCE_EVENT(timestamp, name, ...)
 # define EASY_FORCE_EVENT2(timestamp, name, ...)
-# define EASY_FORCE_EVENT3(ts, timestamp, name, ...)
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -221,6 +220,247 @@ static void write(std::ostream& _outstream, const T& _data)
     _outstream.write((const char*)&_data, sizeof(T));
 }
 
+/** Small buffer for gathering several header fields into one write.
+*/
+class SinkBuffer EASY_FINAL
+{
+    char     m_data[128];
+    uint16_t m_size = 0;
+
+public:
+
+    template <class T>
+    SinkBuffer& put(const T& _data)
+    {
+        static_assert(sizeof(T) <= sizeof(m_data), "Too big data for SinkBuffer");
+        memcpy(m_data + m_size, &_data, sizeof(T));
+        m_size += static_cast<uint16_t>(sizeof(T));
+        return *this;
+    }
+
+    template <class TWriter>
+    void flush(TWriter& _write, profiler::SinkSection _section)
+    {
+        _write(_section, m_data, m_size);
+        m_size = 0;
+    }
+};
+
+/** Serialize thread section of .prof file: thread info, context switch events and blocks.
+
+_write(section, data, size) receives parts of the section in the file order.
+Index of the section is collected into _index at the same time.
+
+\warning Closed lists of the thread are cleared after serialization.
+*/
+template <class TWriter>
+static void serializeThread(ThreadStorage& _thread, profiler::thread_id_t _id, TWriter& _write,
+                            profiler::index::ThreadIndexBuilder& _index)
+{
+    SinkBuffer buffer;
+
+    const auto name_size = static_cast<uint16_t>(_thread.name.size() + 1);
+    buffer.put(_id);
+    buffer.put(name_size);
+    buffer.flush(_write, profiler::SinkSection::ThreadInfo);
+    _write(profiler::SinkSection::ThreadInfo, name_size > 1 ? _thread.name.c_str() : "", name_size);
+    _index.skip(sizeof(_id) + sizeof(name_size) + name_size);
+
+    const uint64_t cs_number = _thread.sync.closedList.size();
+    buffer.put(cs_number);
+    buffer.flush(_write, profiler::SinkSection::ContextSwitches);
+    _index.beginContextSwitches(cs_number);
+    if (!_thread.sync.closedList.empty())
+    {
+        _thread.sync.closedList.serialize([&_write, &_index](const char* _data, uint16_t _size) {
+            _write(profiler::SinkSection::ContextSwitches, _data, _size);
+            _index.addContextSwitches(_data, _size);
+        });
+    }
+
+    const uint64_t blocks_number = _thread.blocks.closedList.markedSize();
+    buffer.put(blocks_number);
+    buffer.flush(_write, profiler::SinkSection::Blocks);
+    _index.beginBlocks(blocks_number);
+    if (!_thread.blocks.closedList.markedEmpty())
+    {
+        _thread.blocks.closedList.serialize([&_write, &_index](const char* _data, uint16_t _size) {
+            _write(profiler::SinkSection::Blocks, _data, _size);
+            _index.addBlocks(_data, _size);
+        });
+    }
+
+    _index.finish();
+}
+
+/** Serializes sections of several threads concurrently into independent buffers.
+
+Workers take threads in the .prof file order, so the caller writes sections
+one by one as soon as they are ready, while next sections are being serialized.
+*/
+class ParallelThreadsSerializer EASY_FINAL
+{
+    struct Section
+    {
+        std::string                          data;
+        uint64_t                       offsets[3]; ///< Offsets of ThreadInfo, ContextSwitches and Blocks parts in data
+        profiler::index::ThreadIndexBuilder index;
+        bool                                ready = false; ///< Protected by m_mutex
+    };
+
+    std::vector<std::pair<profiler::thread_id_t, ThreadStorage*> > m_threads;
+    std::unique_ptr<Section[]>  m_sections;
+    std::vector<std::thread>     m_workers;
+    std::mutex                     m_mutex;
+    std::condition_variable   m_condition;
+    std::atomic<size_t>       m_nextThread;
+
+public:
+
+    template <class TThreads>
+    ParallelThreadsSerializer(TThreads& _threads, unsigned _workersCount)
+        : m_sections(new Section[_threads.size()])
+    {
+        m_nextThread = ATOMIC_VAR_INIT(0);
+
+        m_threads.reserve(_threads.size());
+        for (auto& thread : _threads)
+            m_threads.emplace_back(thread.first, &thread.second);
+
+        m_workers.reserve(_workersCount);
+        for (unsigned i = 0; i < _workersCount; ++i)
+            m_workers.emplace_back([this] { work(); });
+    }
+
+    ~ParallelThreadsSerializer()
+    {
+        // Skip all threads which have not been taken yet
+        m_nextThread.store(m_threads.size(), std::memory_order_release);
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    /** Wait for the section of _index-th thread, pass it to the sink and add it's index into _fileIndex.
+    */
+    void write(size_t _index, profiler::Sink& _sink, profiler::index::FileIndexBuilder& _fileIndex)
+    {
+        auto& section = m_sections[_index];
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&section] { return section.ready; });
+        }
+
+        const auto id = m_threads[_index].first;
+        const auto data = section.data.data();
+        const uint64_t ends[3] = {section.offsets[1], section.offsets[2], section.data.size()};
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto part = static_cast<profiler::SinkSection>(static_cast<int>(profiler::SinkSection::ThreadInfo) + i);
+            _sink.write(part, id, data + section.offsets[i], ends[i] - section.offsets[i]);
+        }
+
+        std::string().swap(section.data);
+
+        _fileIndex.addThread(section.index);
+        section.index = profiler::index::ThreadIndexBuilder();
+    }
+
+private:
+
+    void work()
+    {
+        const auto threadsCount = m_threads.size();
+        for (auto index = m_nextThread.fetch_add(1, std::memory_order_acq_rel); index < threadsCount;
+             index = m_nextThread.fetch_add(1, std::memory_order_acq_rel))
+        {
+            auto& thread = *m_threads[index].second;
+            auto& section = m_sections[index];
+
+            section.data.reserve(thread.blocks.usedMemorySize + thread.sync.usedMemorySize + thread.name.size()
+                + (thread.blocks.closedList.markedSize() + thread.sync.closedList.size()) * sizeof(uint16_t) + 32);
+
+            auto current = profiler::SinkSection::Header;
+            auto append = [&section, &current](profiler::SinkSection _section, const char* _data, uint64_t _size)
+            {
+                if (_section != current)
+                {
+                    current = _section;
+                    section.offsets[static_cast<int>(_section) - static_cast<int>(profiler::SinkSection::ThreadInfo)] = section.data.size();
+                }
+                section.data.append(_data, static_cast<size_t>(_size));
+            };
+
+            section.index = profiler::index::ThreadIndexBuilder(m_threads[index].first);
+            serializeThread(thread, m_threads[index].first, append, section.index);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                section.ready = true;
+            }
+
+            m_condition.notify_all();
+        }
+    }
+};
+
+/** Number of workers for parallel serialization of threads (0 means serialize sequentially).
+*/
+static unsigned serializationWorkersCount(size_t _threadsCount, uint64_t _usedMemorySize)
+{
+    // Small captures are serialized faster without copying into intermediate buffers
+    EASY_CONSTEXPR uint64_t MinParallelSize = 16 << 20;
+    if (_threadsCount < 2 || _usedMemorySize < MinParallelSize)
+        return 0;
+
+    const unsigned concurrency = std::thread::hardware_concurrency();
+    if (concurrency < 2)
+        return 0;
+
+    return static_cast<unsigned>(std::min(static_cast<size_t>(concurrency), _threadsCount));
+}
+
+/** Sink writing data into std::ostream.
+*/
+class StreamSink EASY_FINAL : public profiler::Sink
+{
+    std::ostream& m_stream;
+
+public:
+
+    explicit StreamSink(std::ostream& _stream) : m_stream(_stream)
+    {
+    }
+
+    void write(profiler::SinkSection, profiler::thread_id_t, const char* _data, uint64_t _size)
+    {
+        m_stream.write(_data, static_cast<std::streamsize>(_size));
+    }
+};
+
+static bool value_to_double(profiler::DataType _type, const void* _data, bool _isArray, double& _value)
+{
+    if (_isArray)
+        return false;
+
+    switch (_type)
+    {
+        case profiler::DataType::Bool: _value = *static_cast<const bool*>(_data) ? 1 : 0; return true;
+        case profiler::DataType::Char: _value = *static_cast<const char*>(_data); return true;
+        case profiler::DataType::Int8: _value = *static_cast<const int8_t*>(_data); return true;
+        case profiler::DataType::Uint8: _value = *static_cast<const uint8_t*>(_data); return true;
+        case profiler::DataType::Int16: _value = *static_cast<const int16_t*>(_data); return true;
+        case profiler::DataType::Uint16: _value = *static_cast<const uint16_t*>(_data); return true;
+        case profiler::DataType::Int32: _value = *static_cast<const int32_t*>(_data); return true;
+        case profiler::DataType::Uint32: _value = *static_cast<const uint32_t*>(_data); return true;
+        case profiler::DataType::Int64: _value = static_cast<double>(*static_cast<const int64_t*>(_data)); return true;
+        case profiler::DataType::Uint64: _value = static_cast<double>(*static_cast<const uint64_t*>(_data)); return true;
+        case profiler::DataType::Float: _value = *static_cast<const float*>(_data); return true;
+        case profiler::DataType::Double: _value = *static_cast<const double*>(_data); return true;
+        default: return false;
+    }
+}
+
 static void clear_sstream(std::stringstream& _outstream)
 {
 #if defined(__GNUC__) && __GNUC__ < 5
@@ -335,7 +575,21 @@ ProfileManager::ProfileManager() :
     m_isEventTracingEnabled = EASY_OPTION_EVENT_TRACING_ENABLED;
     m_isAlreadyListening = false;
     m_stopDumping = false;
+    m_dumpCompression = static_cast<uint8_t>(profiler::CompressionCodec::None);
     m_stopListen = false;
+    m_dumping = false;
+    m_stopSharedMemory = false;
+    m_isSharedMemoryExporting = false;
+    m_stopAsyncDump = false;
+    m_triggerDuration = 0;
+    m_triggerAfter = 0;
+    m_triggerThreshold = 0;
+    m_historyDuration = 0;
+    m_triggerTime = 0;
+    m_triggerBlockId = 0;
+    m_triggerType = static_cast<uint8_t>(profiler::TriggerType::None);
+    m_stopTrigger = false;
+    m_isTriggerActive = false;
 
     m_mainThreadId = 0;
     m_frameMax = 0;
@@ -362,7 +616,10 @@ ProfileManager::ProfileManager() :
 ProfileManager::~ProfileManager()
 {
 #ifndef EASY_PROFILER_API_DISABLED
+    disarmTrigger();
     stopListen();
+    stopSharedMemoryExport();
+    stopAsyncDump();
 #endif
 
     for (auto desc : m_descriptors)
@@ -445,6 +702,13 @@ const profiler::BaseBlockDescriptor* ProfileManager::addBlockDescriptor(profiler
     m_descriptors.emplace_back(desc);
     m_descriptorsMap.emplace(key, desc->id());
 
+    if (!m_triggerBlockName.empty() && m_triggerBlockName == _name)
+    {
+        // Trigger has been armed before this block has been registered
+        m_triggerBlockId.store(desc->id(), std::memory_order_relaxed);
+        m_triggerBlockName.clear();
+    }
+
     return desc;
 }
 
@@ -468,7 +732,15 @@ void ProfileManager::storeValue(const profiler::BaseBlockDescriptor* _desc, prof
         return;
 #endif
 
-    THIS_THREAD->storeValue(profiler::clock::now(), _desc->id(), _type, _data, _size, _isArray, _vin);
+    const auto time = profiler::clock::now();
+    THIS_THREAD->storeValue(time, _desc->id(), _type, _data, _size, _isArray, _vin);
+
+    if (armedTrigger() == profiler::TriggerType::Value && _desc->id() == m_triggerBlockId.load(std::memory_order_relaxed))
+    {
+        double value = 0;
+        if (value_to_double(_type, _data, _isArray, value) && value > m_triggerThreshold)
+            fireTrigger(profiler::TriggerType::Value, time);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -671,6 +943,12 @@ void ProfileManager::endBlock()
         if (!top.finished())
             top.finish();
         THIS_THREAD->storeBlock(top);
+
+        if (armedTrigger() == profiler::TriggerType::BlockDuration && top.id() == m_triggerBlockId.load(std::memory_order_relaxed)
+            && top.duration() > m_triggerDuration)
+        {
+            fireTrigger(profiler::TriggerType::BlockDuration, top.end());
+        }
     }
     else
     {
@@ -685,6 +963,7 @@ void ProfileManager::endBlock()
     if (currentThreadStack.empty())
     {
         THIS_THREAD->putMark();
+        keepHistory();
         endFrame(); // FPS counter
 #if EASY_ENABLE_BLOCK_STATUS != 0
         THIS_THREAD->allowChildren = true;
@@ -699,13 +978,21 @@ void ProfileManager::endBlock()
 void ProfileManager::endContextSwitch(profiler::thread_id_t _thread_id, processid_t _process_id,
                                       profiler::timestamp_t _endtime, bool _lockSpin)
 {
+    if (_lockSpin)
+    {
+        // Context switches must not be stored while the owner thread drops old history (see keepHistory())
+        guard_lock_t lock(m_spin);
+        endContextSwitch(_thread_id, _process_id, _endtime, false);
+        return;
+    }
+
     ThreadStorage* ts = nullptr;
     if (_process_id == m_processId)
     {
         // Implicit thread registration.
         // If thread owned by current process then create new ThreadStorage if there is no one
 #if EASY_OPTION_IMPLICIT_THREAD_REGISTRATION != 0
-        ts = _lockSpin ? &threadStorage(_thread_id) : &_threadStorage(_thread_id);
+        ts = &_threadStorage(_thread_id);
 # if !defined(_WIN32) && !defined(EASY_CXX11_TLS_AVAILABLE)
 #  if EASY_OPTION_REMOVE_EMPTY_UNGUARDED_THREADS != 0
 #   pragma message "Warning: Implicit thread registration together with removing empty unguarded threads may cause application crash because there is no possibility to check thread state (dead or alive) for pthreads and removed ThreadStorage may be reused if thread is still alive."
@@ -718,7 +1005,7 @@ void ProfileManager::endContextSwitch(profiler::thread_id_t _thread_id, processi
     else
     {
         // If thread owned by another process OR _process_id IS UNKNOWN then do not create ThreadStorage for this
-        ts = _lockSpin ? findThreadStorage(_thread_id) : _findThreadStorage(_thread_id);
+        ts = _findThreadStorage(_thread_id);
     }
 
     if (ts == nullptr || ts->sync.openedList.empty())
@@ -778,6 +1065,9 @@ void ProfileManager::endFrame()
 
         m_frameCur.store(duration, std::memory_order_release);
 
+        if (armedTrigger() == profiler::TriggerType::FrameDuration && duration > m_triggerDuration && isEnabled())
+            fireTrigger(profiler::TriggerType::FrameDuration, THIS_THREAD->frameStartTime + duration);
+
         return;
     }
 
@@ -835,7 +1125,8 @@ void ProfileManager::setEnabled(bool isEnable)
     {
         EASY_LOGMSG("Enabled profiling\n");
         enableEventTracer();
-        m_beginTime = time;
+        if (m_beginTime == 0) // Keep begin time of the blocks which have not been dumped yet
+            m_beginTime = time;
     }
     else
     {
@@ -902,9 +1193,9 @@ char ProfileManager::checkThreadExpired(ThreadStorage& _registeredThread)
 
 //////////////////////////////////////////////////////////////////////////
 
-uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _lockSpin, bool _async)
+uint64_t ProfileManager::dumpBlocks(profiler::Sink& _sink, bool _lockSpin, bool _async)
 {
-    EASY_LOGMSG("dumpBlocksToStream(_lockSpin = " << _lockSpin << ")...\n");
+    EASY_LOGMSG("dumpBlocks(_lockSpin = " << _lockSpin << ")...\n");
 
     if (_lockSpin)
         m_dumpSpin.lock();
@@ -924,6 +1215,7 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
     {
         if (_lockSpin)
             m_dumpSpin.unlock();
+        _sink.complete(0, false);
         return 0;
     }
 
@@ -933,6 +1225,13 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
     // Note: this means - wait for all ThreadStorage::storeBlock() to finish.
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
+#ifdef BUILD_WITH_EASY_PROFILER
+    // Register "ThreadExpired" event descriptor before locking m_storedSpin because addBlockDescriptor() locks it too
+    EASY_LOCAL_STATIC_PTR(const profiler::BaseBlockDescriptor*, threadExpiredDesc, addBlockDescriptor(
+        profiler::extract_enable_flag(EASY_COLOR_THREAD_END), EASY_UNIQUE_LINE_ID, "ThreadExpired",
+        __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(EASY_COLOR_THREAD_END)));
+#endif
+
     // This is to make sure that no new descriptors or new threads will be
     // added until we finish sending data.
     m_spin.lock();
@@ -940,6 +1239,9 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
     // This is the only place using both spins, so no dead-lock will occur
     // TODO: think about better solution because this one is not 100% safe...
 
+    // Wait until shared memory export finishes reading thread storages which are cleared and removed below
+    m_sharedMemorySpin.lock();
+
     const auto time = profiler::clock::now();
     const auto endtime = m_endTime == 0 ? time : std::min(time, m_endTime);
 
@@ -952,8 +1254,10 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
         {
             m_spin.unlock();
             m_storedSpin.unlock();
+            m_sharedMemorySpin.unlock();
             if (_lockSpin)
                 m_dumpSpin.unlock();
+            _sink.complete(0, false);
             return 0;
         }
 
@@ -974,8 +1278,10 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
                 {
                     m_spin.unlock();
                     m_storedSpin.unlock();
+                    m_sharedMemorySpin.unlock();
                     if (_lockSpin)
                         m_dumpSpin.unlock();
+                    _sink.complete(0, false);
                     return 0;
                 }
 
@@ -998,20 +1304,22 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
 
     // Calculate used memory total size and total blocks number
     uint64_t usedMemorySize = 0;
-    uint32_t blocks_number = 0;
+    uint64_t blocks_number = 0;
     for (auto thread_it = m_threads.begin(), end = m_threads.end(); thread_it != end;)
     {
         if (_async && m_stopDumping.load(std::memory_order_acquire))
         {
             m_spin.unlock();
             m_storedSpin.unlock();
+            m_sharedMemorySpin.unlock();
             if (_lockSpin)
                 m_dumpSpin.unlock();
+            _sink.complete(0, false);
             return 0;
         }
 
         auto& thread = thread_it->second;
-        uint32_t num = thread.blocks.closedList.markedSize() + thread.sync.closedList.size();
+        uint64_t num = thread.blocks.closedList.markedSize() + thread.sync.closedList.size();
         const char expired = ProfileManager::checkThreadExpired(thread);
 
 #ifdef _WIN32
@@ -1039,7 +1347,9 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
 
         if (expired == 1)
         {
-            EASY_FORCE_EVENT3(thread, endtime, "ThreadExpired", EASY_COLOR_THREAD_END);
+#ifdef BUILD_WITH_EASY_PROFILER
+            thread.storeBlockForce(profiler::Block(endtime, endtime, threadExpiredDesc->id(), ""));
+#endif
             ++num;
         }
 
@@ -1048,35 +1358,45 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
         ++thread_it;
     }
 
+    profiler::index::FileIndexBuilder fileIndex;
+
+    auto write = [&_sink, &fileIndex](profiler::SinkSection _section, const char* _data, uint64_t _size) {
+        _sink.write(_section, 0, _data, _size);
+        fileIndex.skip(_size);
+    };
+
+    SinkBuffer buffer;
+
     // Write profiler signature and version
-    write(_outputStream, EASY_PROFILER_SIGNATURE);
-    write(_outputStream, EASY_PROFILER_VERSION);
-    write(_outputStream, m_processId);
+    buffer.put(EASY_PROFILER_SIGNATURE);
+    buffer.put(EASY_PROFILER_VERSION);
+    buffer.put(m_processId);
 
     // Write CPU frequency to let GUI calculate real time value from CPU clocks
 #if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
-    write(_outputStream, m_cpuFrequency);
+    buffer.put(m_cpuFrequency);
 #else
     EASY_LOGMSG("Calculating CPU frequency\n");
     const int64_t cpu_frequency = calculate_cpu_frequency();
-    write(_outputStream, cpu_frequency * 1000LL);
+    buffer.put(cpu_frequency * 1000LL);
     EASY_LOGMSG("Done calculating CPU frequency\n");
 
     m_cpuFrequency.store(cpu_frequency, std::memory_order_release);
 #endif
 
     // Write begin and end time
-    write(_outputStream, m_beginTime);
-    write(_outputStream, m_endTime);
+    buffer.put(m_beginTime);
+    buffer.put(m_endTime);
 
     // Write blocks number and used memory size
-    write(_outputStream, usedMemorySize);
-    write(_outputStream, m_descriptorsMemorySize);
-    write(_outputStream, blocks_number);
-    write(_outputStream, static_cast<uint32_t>(m_descriptors.size()));
-    write(_outputStream, static_cast<uint32_t>(m_threads.size()));
-    write(_outputStream, static_cast<uint16_t>(0)); // Bookmarks count (they can be created by user in the UI)
-    write(_outputStream, static_cast<uint16_t>(0)); // padding
+    buffer.put(usedMemorySize);
+    buffer.put(m_descriptorsMemorySize);
+    buffer.put(blocks_number);
+    buffer.put(static_cast<uint32_t>(m_descriptors.size()));
+    buffer.put(static_cast<uint32_t>(m_threads.size()));
+    buffer.put(static_cast<uint16_t>(0)); // Bookmarks count (they can be created by user in the UI)
+    buffer.put(static_cast<uint16_t>(0)); // padding
+    buffer.flush(write, profiler::SinkSection::Header);
 
     // Write block descriptors
     for (const auto descriptor : m_descriptors)
@@ -1085,40 +1405,56 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
         const auto filename_size = descriptor->filenameSize();
         const auto size = static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor) + name_size + filename_size);
 
-        write(_outputStream, size);
-        write<profiler::BaseBlockDescriptor>(_outputStream, *descriptor);
-        write(_outputStream, name_size);
-        write(_outputStream, descriptor->name(), name_size);
-        write(_outputStream, descriptor->filename(), filename_size);
+        buffer.put(size);
+        buffer.put<profiler::BaseBlockDescriptor>(*descriptor);
+        buffer.put(name_size);
+        buffer.flush(write, profiler::SinkSection::Descriptors);
+        _sink.write(profiler::SinkSection::Descriptors, 0, descriptor->name(), name_size);
+        _sink.write(profiler::SinkSection::Descriptors, 0, descriptor->filename(), filename_size);
+        fileIndex.skip(static_cast<uint64_t>(name_size) + filename_size);
     }
 
     // Write blocks and context switch events for each thread
-    for (auto thread_it = m_threads.begin(), end = m_threads.end(); thread_it != end;)
+    std::unique_ptr<ParallelThreadsSerializer> serializer;
+    const auto workersCount = serializationWorkersCount(m_threads.size(), usedMemorySize);
+    if (workersCount != 0)
+    {
+        EASY_LOGMSG("Serializing " << m_threads.size() << " threads using " << workersCount << " workers\n");
+        serializer.reset(new ParallelThreadsSerializer(m_threads, workersCount));
+    }
+
+    size_t index = 0;
+    for (auto thread_it = m_threads.begin(), end = m_threads.end(); thread_it != end; ++index)
     {
         if (_async && m_stopDumping.load(std::memory_order_acquire))
         {
+            serializer.reset(); // Workers must finish before unlocking
             m_spin.unlock();
             m_storedSpin.unlock();
+            m_sharedMemorySpin.unlock();
             if (_lockSpin)
                 m_dumpSpin.unlock();
+            _sink.complete(0, false);
             return 0;
         }
 
         auto& thread = thread_it->second;
 
-        write(_outputStream, thread_it->first);
-
-        const auto name_size = static_cast<uint16_t>(thread.name.size() + 1);
-        write(_outputStream, name_size);
-        write(_outputStream, name_size > 1 ? thread.name.c_str() : "", name_size);
-
-        write(_outputStream, thread.sync.closedList.size());
-        if (!thread.sync.closedList.empty())
-            thread.sync.closedList.serialize(_outputStream);
-
-        write(_outputStream, thread.blocks.closedList.markedSize());
-        if (!thread.blocks.closedList.markedEmpty())
-            thread.blocks.closedList.serialize(_outputStream);
+        if (serializer != nullptr)
+        {
+            serializer->write(index, _sink, fileIndex);
+        }
+        else
+        {
+            const auto threadId = thread_it->first;
+            auto writeThread = [&_sink, threadId](profiler::SinkSection _section, const char* _data, uint64_t _size) {
+                _sink.write(_section, threadId, _data, _size);
+            };
+
+            profiler::index::ThreadIndexBuilder threadIndex(threadId);
+            serializeThread(thread, threadId, writeThread, threadIndex);
+            fileIndex.addThread(threadIndex);
+        }
 
         thread.clearClosed();
         //t.blocks.openedList.clear();
@@ -1138,39 +1474,188 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
         }
     }
 
+    serializer.reset();
+
     // End of threads section
-    write(_outputStream, EASY_PROFILER_SIGNATURE);
+    buffer.put(EASY_PROFILER_SIGNATURE);
+    buffer.flush(write, profiler::SinkSection::Footer);
 
+    // Seekable index goes after all other data, so readers which do not know about it just ignore it
+    std::vector<char> indexData;
+    fileIndex.serialize(indexData);
+    _sink.write(profiler::SinkSection::Index, 0, indexData.data(), indexData.size());
+
+    // All blocks have been dumped, so next setEnabled(true) starts new capture
+    m_beginTime = 0;
+
+    m_sharedMemorySpin.unlock();
     m_storedSpin.unlock();
     m_spin.unlock();
 
     if (_lockSpin)
         m_dumpSpin.unlock();
 
-    EASY_LOGMSG("Done dumpBlocksToStream(). Dumped " << blocks_number << " blocks\n");
+    EASY_LOGMSG("Done dumpBlocks(). Dumped " << blocks_number << " blocks\n");
+
+    _sink.complete(blocks_number, true);
 
     return blocks_number;
 }
 
-uint32_t ProfileManager::dumpBlocksToFile(const char* _filename)
+uint64_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _lockSpin, bool _async,
+                                            profiler::CompressionCodec _codec)
+{
+    StreamSink sink(_outputStream);
+    if (_codec == profiler::CompressionCodec::None)
+        return dumpBlocks(sink, _lockSpin, _async);
+
+    profiler::CompressingSink compressingSink(sink, _codec);
+    return dumpBlocks(compressingSink, _lockSpin, _async);
+}
+
+uint64_t ProfileManager::dumpBlocksToFile(const char* _filename)
 {
     EASY_LOGMSG("dumpBlocksToFile(\"" << _filename << "\")...\n");
 
-    std::ofstream outputFile(_filename, std::fstream::binary);
-    if (!outputFile.is_open())
+    profiler::FileSink sink(_filename);
+    if (!sink.isOpen())
     {
         EASY_ERROR("Can not open \"" << _filename << "\" for writing\n");
         return 0;
     }
 
     // Write data directly to file
-    const auto blocksNumber = dumpBlocksToStream(outputFile, true, false);
+    uint64_t blocksNumber = 0;
+    const auto codec = dumpCompression();
+    if (codec == profiler::CompressionCodec::None)
+    {
+        blocksNumber = dumpBlocks(sink, true, false);
+    }
+    else
+    {
+        profiler::CompressingSink compressingSink(sink, codec);
+        blocksNumber = dumpBlocks(compressingSink, true, false);
+    }
+
+    if (!sink.good())
+    {
+        EASY_ERROR("Can not write \"" << _filename << "\"\n");
+    }
 
     EASY_LOGMSG("Done dumpBlocksToFile()\n");
 
     return blocksNumber;
 }
 
+uint64_t ProfileManager::dumpBlocksToSink(profiler::Sink& _sink)
+{
+    return dumpBlocks(_sink, true, false);
+}
+
+void ProfileManager::setDumpCompression(profiler::CompressionCodec _codec)
+{
+    if (!profiler::compression::isCodecAvailable(_codec))
+    {
+        EASY_ERROR("Compression codec " << static_cast<int>(_codec) << " is not available, using LZ4 instead\n");
+        _codec = profiler::compression::availableCodec(_codec);
+    }
+
+    m_dumpCompression.store(static_cast<uint8_t>(_codec), std::memory_order_release);
+}
+
+profiler::CompressionCodec ProfileManager::dumpCompression() const
+{
+    return static_cast<profiler::CompressionCodec>(m_dumpCompression.load(std::memory_order_acquire));
+}
+
+bool ProfileManager::dumpBlocksToFileAsync(const char* _filename, profiler::dump_callback_t _callback, void* _userData)
+{
+    if (_filename == nullptr)
+        return false;
+
+    // Stop profiling right now to capture exactly the time of the call.
+    // If m_dumpSpin is busy then another dump is in progress and profiling is already disabled.
+    if (m_dumpSpin.try_lock())
+    {
+        const auto time = profiler::clock::now();
+        if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
+        {
+            disableEventTracer();
+            m_endTime = time;
+        }
+        m_dumpSpin.unlock();
+    }
+
+    std::lock_guard<std::mutex> lock(m_asyncDumpMutex);
+
+    // Coalesce with pending request for the same file (skip the front one because it may be in progress)
+    auto it = m_asyncDumps.size() > 1 ? m_asyncDumps.begin() + 1 : m_asyncDumps.end();
+    for (; it != m_asyncDumps.end(); ++it)
+    {
+        if (it->filename == _filename)
+            break;
+    }
+
+    if (it == m_asyncDumps.end())
+    {
+        m_asyncDumps.emplace_back();
+        it = m_asyncDumps.end() - 1;
+        it->filename = _filename;
+    }
+
+    if (_callback != nullptr)
+        it->callbacks.emplace_back(_callback, _userData);
+
+    if (!m_asyncDumpThread.joinable())
+        m_asyncDumpThread = std::thread([this] { dumpAsync(); });
+    else
+        m_asyncDumpCond.notify_one();
+
+    return true;
+}
+
+void ProfileManager::dumpAsync()
+{
+    EASY_THREAD_SCOPE("EasyProfiler.Dump");
+
+    std::unique_lock<std::mutex> lock(m_asyncDumpMutex);
+    while (true)
+    {
+        m_asyncDumpCond.wait(lock, [this] { return m_stopAsyncDump || !m_asyncDumps.empty(); });
+        if (m_asyncDumps.empty())
+            break; // Pending requests are always finished before stopping
+
+        // The front request stays in the queue while being processed to avoid coalescing with it
+        const std::string filename = m_asyncDumps.front().filename;
+        lock.unlock();
+
+        const auto blocksNumber = dumpBlocksToFile(filename.c_str());
+
+        lock.lock();
+        const auto callbacks = std::move(m_asyncDumps.front().callbacks);
+        m_asyncDumps.pop_front();
+        lock.unlock();
+
+        for (const auto& callback : callbacks)
+            callback.first(filename.c_str(), blocksNumber, callback.second);
+
+        lock.lock();
+    }
+}
+
+void ProfileManager::stopAsyncDump()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_asyncDumpMutex);
+        m_stopAsyncDump = true;
+    }
+
+    m_asyncDumpCond.notify_one();
+
+    if (m_asyncDumpThread.joinable())
+        m_asyncDumpThread.join();
+}
+
 void ProfileManager::registerThread()
 {
     THIS_THREAD = &threadStorage(getCurrentThreadId());
@@ -1273,47 +1758,255 @@ bool ProfileManager::isListening() const
     return m_isAlreadyListening.load(std::memory_order_acquire);
 }
 
-//////////////////////////////////////////////////////////////////////////
+bool ProfileManager::startSharedMemoryExport(const char* _name, uint32_t _ringSize)
+{
+    if (m_isSharedMemoryExporting.exchange(true, std::memory_order_acq_rel))
+        return true;
 
-void ProfileManager::setContextSwitchLogFilename(const char* name)
+    char defaultName[64];
+    if (_name == nullptr || *_name == 0)
+    {
+        profiler::shm::defaultName(defaultName, sizeof(defaultName), m_processId);
+        _name = defaultName;
+    }
+
+#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
+    const int64_t cpu_frequency = m_cpuFrequency;
+#else
+    const int64_t cpu_frequency = m_cpuFrequency.load(std::memory_order_acquire) * 1000LL;
+#endif
+
+    m_sharedMemory.reset(new SharedMemoryWriter());
+    if (!m_sharedMemory->open(_name, m_processId, cpu_frequency, _ringSize != 0 ? _ringSize : profiler::shm::DEFAULT_RING_SIZE))
+    {
+        EASY_ERROR("Can not create shared memory segment \"" << _name << "\"\n");
+        m_sharedMemory.reset();
+        m_isSharedMemoryExporting.store(false, std::memory_order_release);
+        return false;
+    }
+
+    m_stopSharedMemory.store(false, std::memory_order_release);
+    m_sharedMemoryThread = std::thread(&ProfileManager::exportToSharedMemory, this);
+
+    return true;
+}
+
+void ProfileManager::stopSharedMemoryExport()
 {
-    m_csInfoFilename = name;
+    m_stopSharedMemory.store(true, std::memory_order_release);
+    if (m_sharedMemoryThread.joinable())
+        m_sharedMemoryThread.join();
+    m_sharedMemory.reset();
+    m_isSharedMemoryExporting.store(false, std::memory_order_release);
 }
 
-const char* ProfileManager::getContextSwitchLogFilename() const
+bool ProfileManager::isSharedMemoryExportEnabled() const
 {
-    return m_csInfoFilename.c_str();
+    return m_isSharedMemoryExporting.load(std::memory_order_acquire);
 }
 
 //////////////////////////////////////////////////////////////////////////
 
-#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
-profiler::timestamp_t ProfileManager::ticks2ns(profiler::timestamp_t ticks) const
+bool ProfileManager::armTrigger(profiler::TriggerType _type, const char* _blockName, profiler::block_id_t _id,
+                                double _threshold, uint32_t _historyMs, uint32_t _afterMs, const char* _filename)
 {
-    return static_cast<profiler::timestamp_t>(ticks * 1000000000LL / m_cpuFrequency);
+    if (_type == profiler::TriggerType::None || _type >= profiler::TriggerType::TypesCount)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_triggerMutex);
+    stopTrigger();
+
+    m_triggerFilename = _filename != nullptr ? _filename : "";
+    m_triggerThreshold = _threshold;
+    m_triggerDuration = _threshold > 0 ? us2ticks(static_cast<profiler::timestamp_t>(_threshold)) : 0;
+    m_triggerAfter = us2ticks(static_cast<profiler::timestamp_t>(_afterMs) * 1000);
+
+    if (_blockName != nullptr)
+    {
+        guard_lock_t descriptorsLock(m_storedSpin);
+
+        // Block could be not registered yet, then it's id would be set in addBlockDescriptor()
+        _id = profiler::block_id_t(-1);
+        m_triggerBlockName = _blockName;
+        for (const auto descriptor : m_descriptors)
+        {
+            if (m_triggerBlockName == descriptor->name())
+            {
+                _id = descriptor->id();
+                m_triggerBlockName.clear();
+                break;
+            }
+        }
+    }
+
+    m_triggerBlockId.store(_id, std::memory_order_relaxed);
+    m_triggerTime.store(0, std::memory_order_release);
+
+    // Keep at least one tick of history (0 means "keep everything")
+    const auto history = us2ticks(static_cast<profiler::timestamp_t>(_historyMs) * 1000);
+    m_historyDuration.store(std::max(history, profiler::timestamp_t(1)), std::memory_order_release);
+
+    m_stopTrigger.store(false, std::memory_order_release);
+    m_isTriggerActive.store(true, std::memory_order_release);
+    m_triggerType.store(static_cast<uint8_t>(_type), std::memory_order_release);
+    m_triggerThread = std::thread(&ProfileManager::waitForTrigger, this);
+
+    EASY_LOGMSG("Trigger armed\n");
+
+    setEnabled(true);
+
+    return true;
 }
 
-profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) const
+void ProfileManager::disarmTrigger()
 {
-    return static_cast<profiler::timestamp_t>(ticks * 1000000LL / m_cpuFrequency);
+    std::lock_guard<std::mutex> lock(m_triggerMutex);
+    stopTrigger();
 }
-#else
-profiler::timestamp_t ProfileManager::ticks2ns(profiler::timestamp_t ticks) const
+
+bool ProfileManager::isTriggerArmed() const
 {
-    return static_cast<profiler::timestamp_t>(ticks / m_cpuFrequency.load(std::memory_order_acquire));
+    return m_isTriggerActive.load(std::memory_order_acquire);
 }
 
-profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) const
+void ProfileManager::stopTrigger()
 {
-    return static_cast<profiler::timestamp_t>(ticks * 1000 / m_cpuFrequency.load(std::memory_order_acquire));
-}
-#endif
+    m_triggerType.store(static_cast<uint8_t>(profiler::TriggerType::None), std::memory_order_release);
+    m_historyDuration.store(0, std::memory_order_release);
+    m_stopTrigger.store(true, std::memory_order_release);
 
-//////////////////////////////////////////////////////////////////////////
+    if (m_triggerThread.joinable())
+        m_triggerThread.join();
 
-bool ProfileManager::isMainThread()
-{
-    return THIS_THREAD_IS_MAIN;
+    {
+        guard_lock_t lock(m_storedSpin);
+        m_triggerBlockName.clear();
+    }
+
+    m_isTriggerActive.store(false, std::memory_order_release);
+}
+
+void ProfileManager::fireTrigger(profiler::TriggerType _type, profiler::timestamp_t _time)
+{
+    // Only one thread could fire the trigger
+    auto type = static_cast<uint8_t>(_type);
+    if (!m_triggerType.compare_exchange_strong(type, static_cast<uint8_t>(profiler::TriggerType::None),
+                                               std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    // Stop dropping old blocks: the history before the trigger must be kept until dumping
+    m_historyDuration.store(0, std::memory_order_release);
+    m_triggerTime.store(_time != 0 ? _time : 1, std::memory_order_release);
+}
+
+void ProfileManager::waitForTrigger()
+{
+    EASY_THREAD_SCOPE("EasyProfiler.Trigger");
+
+    while (!m_stopTrigger.load(std::memory_order_acquire))
+    {
+        const auto triggerTime = m_triggerTime.load(std::memory_order_acquire);
+        if (triggerTime == 0 || profiler::clock::now() < triggerTime + m_triggerAfter)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+
+        EASY_LOGMSG("Trigger fired, dumping captured blocks\n");
+
+        if (m_triggerFilename.empty())
+            startDumping();
+        else
+            dumpBlocksToFile(m_triggerFilename.c_str());
+
+        break;
+    }
+
+    m_isTriggerActive.store(false, std::memory_order_release);
+}
+
+void ProfileManager::keepHistory()
+{
+    const auto history = m_historyDuration.load(std::memory_order_acquire);
+    if (history == 0)
+        return;
+
+    const auto time = profiler::clock::now();
+    THIS_THREAD->addHistoryCheckpoint(time);
+
+    if (time <= history || !THIS_THREAD->needDropHistory(time - history))
+        return;
+
+    // Old blocks must not be dropped while they are being dumped or exported to shared memory.
+    // Do not wait for them to finish: blocks would be dropped at the end of one of the next frames.
+    if (!m_spin.try_lock())
+        return;
+
+    if (!m_sharedMemorySpin.try_lock())
+    {
+        m_spin.unlock();
+        return;
+    }
+
+    THIS_THREAD->dropHistory(time, time - history);
+
+    m_sharedMemorySpin.unlock();
+    m_spin.unlock();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void ProfileManager::setContextSwitchLogFilename(const char* name)
+{
+    m_csInfoFilename = name;
+}
+
+const char* ProfileManager::getContextSwitchLogFilename() const
+{
+    return m_csInfoFilename.c_str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
+profiler::timestamp_t ProfileManager::ticks2ns(profiler::timestamp_t ticks) const
+{
+    return static_cast<profiler::timestamp_t>(ticks * 1000000000LL / m_cpuFrequency);
+}
+
+profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) const
+{
+    return static_cast<profiler::timestamp_t>(ticks * 1000000LL / m_cpuFrequency);
+}
+
+profiler::timestamp_t ProfileManager::us2ticks(profiler::timestamp_t us) const
+{
+    return static_cast<profiler::timestamp_t>(us * m_cpuFrequency / 1000000LL);
+}
+#else
+profiler::timestamp_t ProfileManager::ticks2ns(profiler::timestamp_t ticks) const
+{
+    return static_cast<profiler::timestamp_t>(ticks / m_cpuFrequency.load(std::memory_order_acquire));
+}
+
+profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) const
+{
+    return static_cast<profiler::timestamp_t>(ticks * 1000 / m_cpuFrequency.load(std::memory_order_acquire));
+}
+
+profiler::timestamp_t ProfileManager::us2ticks(profiler::timestamp_t us) const
+{
+    return static_cast<profiler::timestamp_t>(us * m_cpuFrequency.load(std::memory_order_acquire) / 1000);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+bool ProfileManager::isMainThread()
+{
+    return THIS_THREAD_IS_MAIN;
 }
 
 profiler::timestamp_t ProfileManager::this_thread_frameTime(profiler::Duration _durationCast)
@@ -1388,122 +2081,407 @@ static void join(std::future<T>& futureResult)
         futureResult.get();
 }
 
-void ProfileManager::listen(uint16_t _port)
+/** Network client connected to the listening port.
+
+Each client is served by it's own thread, so a slow client does not stall the others.
+Captured blocks are serialized once and shared by all subscribed clients.
+*/
+struct ListenClient EASY_FINAL
 {
-    EASY_THREAD_SCOPE("EasyProfiler.Listen");
+    using shared_packet_t = std::shared_ptr<const std::string>;
+
+    EasySocket                 socket; ///< Session socket
+    std::thread                thread; ///< Thread serving this client
+    std::mutex                  mutex; ///< Guards pendingBlocks and hasPendingBlocks
+    shared_packet_t     pendingBlocks; ///< Captured blocks which have not been sent to this client yet (may be nullptr if dump failed)
+    bool             hasPendingBlocks; ///< True if there are captured blocks (or dump error) which must be sent to this client
+    std::atomic_bool       subscribed; ///< True if this client waits for captured blocks
+    std::atomic_bool         finished; ///< True if client has been disconnected and it's thread may be joined
+    std::atomic<uint8_t>        codec; ///< profiler::CompressionCodec of captured blocks requested by client
+
+    ListenClient() : hasPendingBlocks(false)
+    {
+        subscribed = ATOMIC_VAR_INIT(false);
+        finished = ATOMIC_VAR_INIT(false);
+        codec = ATOMIC_VAR_INIT(static_cast<uint8_t>(profiler::CompressionCodec::None));
+    }
 
-    EASY_LOGMSG("Listening started\n");
+    /** Post captured blocks for sending.
+
+    If previous capture has not been sent yet (slow client) then it is replaced by the new one.
+    */
+    void post(const shared_packet_t& _packet)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingBlocks = _packet;
+        hasPendingBlocks = true;
+    }
+
+    bool take(shared_packet_t& _packet)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasPendingBlocks)
+            return false;
+        _packet = std::move(pendingBlocks);
+        hasPendingBlocks = false;
+        return true;
+    }
+};
+
+/** Size of the client request message of given type (0 for unknown types).
+*/
+static size_t netMessageSize(profiler::net::MessageType _type)
+{
+    using namespace profiler::net;
+
+    switch (_type)
+    {
+        case MessageType::Ping:
+        case MessageType::Request_MainThread_FPS:
+        case MessageType::Request_Start_Capture:
+        case MessageType::Request_Stop_Capture:
+        case MessageType::Request_Disarm_Trigger:
+        case MessageType::Request_Blocks_Description:
+            return sizeof(Message);
+
+        case MessageType::Request_Arm_Trigger:
+            return sizeof(TriggerMessage);
+
+        case MessageType::Request_Blocks_Compression:
+            return sizeof(CompressionMessage);
+
+        case MessageType::Change_Block_Status:
+            return sizeof(BlockStatusMessage);
+
+        case MessageType::Change_Event_Tracing_Status:
+        case MessageType::Change_Event_Tracing_Priority:
+            return sizeof(BoolMessage);
+
+        default:
+            return 0;
+    }
+}
+
+/** Creates network packet: DataMessage header followed by the data.
+
+DataMessage::size is 32-bit, so data bigger than MaxFrameSize is split into several messages
+of the same type which are concatenated by the client.
+
+\retval Packet or nullptr if there is not enough memory.
+*/
+static ListenClient::shared_packet_t makeDataPacket(profiler::net::MessageType _type, const std::string& _data)
+{
+    EASY_CONSTEXPR size_t MaxFrameSize = 1U << 30;
+
+    const size_t framesCount = _data.empty() ? 1 : (_data.size() + MaxFrameSize - 1) / MaxFrameSize;
+    const size_t packet_size = framesCount * sizeof(profiler::net::DataMessage) + _data.size();
+    auto packet = std::make_shared<std::string>();
+    packet->reserve(packet_size + 1);
+
+    if (packet->capacity() < packet_size) // check if there is enough memory
+    {
+        EASY_ERROR("Can not send data. Not enough memory for allocating " << packet_size << " bytes");
+        return nullptr;
+    }
+
+    size_t offset = 0;
+    do {
+        const auto frameSize = std::min(_data.size() - offset, MaxFrameSize);
+        const profiler::net::DataMessage dm(static_cast<uint32_t>(frameSize), _type);
 
-    std::stringstream os(std::ios_base::out | std::ios_base::binary);
-    std::future<uint32_t> dumpingResult;
-    bool dumping = false;
+        packet->append((const char*)&dm, sizeof(dm));
+        packet->append(_data, offset, frameSize);
+        offset += frameSize;
+    } while (offset < _data.size());
 
-    const auto stopDumping = [&] {
-        dumping = false;
-        m_stopDumping.store(true, std::memory_order_release);
-        join(dumpingResult);
-        clear_sstream(os);
+    return packet;
+}
+
+/** Creates network packet: DataMessage header followed by the stream contents.
+
+\retval Packet or nullptr if stream is bad or there is not enough memory.
+*/
+static ListenClient::shared_packet_t makeDataPacket(profiler::net::MessageType _type, std::stringstream& _stream)
+{
+    const auto size = _stream.tellp();
+    static const decltype(size) badSize = -1;
+    if (size == badSize)
+    {
+        EASY_ERROR("Can not send data. Bad std::stringstream.tellp() == -1");
+        return nullptr;
+    }
+
+    return makeDataPacket(_type, _stream.str()); // TODO: Avoid double-coping data from stringstream!
+}
+
+/** Creates network packet with compressed captured blocks.
+
+Compressed container is split into several Reply_Blocks messages, so the client
+could unpack received blocks while receiving the rest of data.
+*/
+static ListenClient::shared_packet_t makeCompressedBlocksPacket(const std::string& _data, profiler::CompressionCodec _codec)
+{
+    EASY_CONSTEXPR size_t FrameSize = 1 << 20;
+
+    if (_data.empty())
+        return makeDataPacket(profiler::net::MessageType::Reply_Blocks, _data);
+
+    auto packet = std::make_shared<std::string>();
+    std::string frame;
+
+    auto flushFrame = [&packet, &frame] {
+        const profiler::net::DataMessage dm(static_cast<uint32_t>(frame.size()), profiler::net::MessageType::Reply_Blocks);
+        packet->append((const char*)&dm, sizeof(dm));
+        packet->append(frame);
+        frame.clear();
     };
 
-    EasySocket socket;
-    profiler::net::Message replyMessage(profiler::net::MessageType::Reply_Capturing_Started);
+    profiler::compression::ChunkedCompressor compressor(_codec,
+        [&frame, &flushFrame](profiler::SinkSection, profiler::thread_id_t, const char* _packed, uint64_t _size) {
+            frame.append(_packed, static_cast<size_t>(_size));
+            if (frame.size() >= FrameSize)
+                flushFrame();
+        });
+
+    compressor.write(profiler::SinkSection::Blocks, 0, _data.data(), _data.size());
+    compressor.finish();
+
+    if (!frame.empty())
+        flushFrame();
+
+    EASY_LOGMSG("Compressed " << _data.size() << " bytes of captured blocks into " << compressor.packedSize() << " bytes\n");
+
+    return packet;
+}
+
+void ProfileManager::listen(uint16_t _port)
+{
+    EASY_THREAD_SCOPE("EasyProfiler.Listen");
 
+    EASY_LOGMSG("Listening started\n");
+
+    EasySocket socket;
     socket.bind(_port);
-    int bytes = 0;
+    socket.listen();
+
+    std::shared_ptr<ListenClient> client;
     while (!m_stopListen.load(std::memory_order_acquire))
     {
-        if (dumping)
-            stopDumping();
+        joinListenClients(true);
 
-        socket.listen();
-        socket.accept();
+        if (client == nullptr)
+            client = std::make_shared<ListenClient>();
 
-        bool hasConnect = true;
+        if (socket.accept(client->socket) < 0)
+        {
+            // There is no incoming connection. Do not waste CPU time.
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            continue;
+        }
+
+        EASY_LOGMSG("New client connected\n");
+
+        std::lock_guard<std::mutex> lock(m_listenClientsMutex);
+        client->thread = std::thread(&ProfileManager::serveClient, this, std::ref(*client));
+        m_listenClients.emplace_back(std::move(client));
+    }
+
+    joinListenClients(false);
 
-        // Send reply
+    {
+        std::lock_guard<std::mutex> lock(m_dumpingMutex);
+        if (m_dumpingResult.valid())
         {
-            const bool wasLowPriorityET =
+            m_stopDumping.store(true, std::memory_order_release);
+            join(m_dumpingResult);
+        }
+    }
+
+    EASY_LOGMSG("Listening stopped\n");
+}
+
+void ProfileManager::joinListenClients(bool _finishedOnly)
+{
+    listen_clients_t clients;
+
+    {
+        std::lock_guard<std::mutex> lock(m_listenClientsMutex);
+        if (_finishedOnly)
+        {
+            auto it = std::partition(m_listenClients.begin(), m_listenClients.end(),
+                                     [](const std::shared_ptr<ListenClient>& c) {
+                                         return !c->finished.load(std::memory_order_acquire);
+                                     });
+            std::move(it, m_listenClients.end(), std::back_inserter(clients));
+            m_listenClients.erase(it, m_listenClients.end());
+        }
+        else
+        {
+            clients.swap(m_listenClients);
+        }
+    }
+
+    // Join threads outside of the lock because dumping thread may want to access clients list
+    for (auto& client : clients)
+    {
+        if (client->thread.joinable())
+            client->thread.join();
+    }
+}
+
+void ProfileManager::startDumping()
+{
+    std::lock_guard<std::mutex> lock(m_dumpingMutex);
+
+    if (m_dumping.load(std::memory_order_acquire))
+        return; // Blocks are being dumped right now. They will be sent to all subscribed clients.
+
+    join(m_dumpingResult);
+
+    m_dumpSpin.lock();
+    auto time = profiler::clock::now();
+    if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
+    {
+        disableEventTracer();
+        m_endTime = time;
+    }
+    EASY_FORCE_EVENT2(m_endTime, "StopCapture", EASY_COLOR_END, profiler::OFF);
+
+    m_dumping.store(true, std::memory_order_release);
+    m_stopDumping.store(false, std::memory_order_release);
+
+    m_dumpingResult = std::async(std::launch::async, [this]
+    {
+        std::stringstream os(std::ios_base::out | std::ios_base::binary);
+        dumpBlocksToStream(os, false, true, profiler::CompressionCodec::None);
+        m_dumpSpin.unlock();
+
+        if (!m_stopDumping.load(std::memory_order_acquire))
+        {
+            // Serialize once, send to each subscriber
+            const auto data = os.str();
+            clear_sstream(os);
+            broadcastBlocks(data);
+        }
+
+        m_dumping.store(false, std::memory_order_release);
+    });
+}
+
+void ProfileManager::broadcastBlocks(const std::string& _data)
+{
+    EASY_CONSTEXPR auto CodecsCount = static_cast<size_t>(profiler::CompressionCodec::TypesCount);
+
+    // Each format is prepared once and shared by all subscribers requesting it
+    shared_packet_t packets[CodecsCount];
+    bool ready[CodecsCount] = {};
+
+    auto packet = [&](uint8_t _codec) -> const shared_packet_t& {
+        if (_codec >= CodecsCount)
+            _codec = static_cast<uint8_t>(profiler::CompressionCodec::None);
+
+        if (!ready[_codec])
+        {
+            const auto codec = static_cast<profiler::CompressionCodec>(_codec);
+            packets[_codec] = codec == profiler::CompressionCodec::None
+                ? makeDataPacket(profiler::net::MessageType::Reply_Blocks, _data)
+                : makeCompressedBlocksPacket(_data, codec);
+            ready[_codec] = true;
+        }
+
+        return packets[_codec];
+    };
+
+    // Compress outside of the lock: it may take a while for big captures
+    std::vector<uint8_t> codecs;
+    {
+        std::lock_guard<std::mutex> lock(m_listenClientsMutex);
+        for (const auto& client : m_listenClients)
+        {
+            if (client->subscribed.load(std::memory_order_acquire))
+                codecs.push_back(client->codec.load(std::memory_order_acquire));
+        }
+    }
+
+    for (auto codec : codecs)
+        packet(codec);
+
+    std::lock_guard<std::mutex> lock(m_listenClientsMutex);
+    for (auto& client : m_listenClients)
+    {
+        if (client->subscribed.exchange(false, std::memory_order_acq_rel))
+            client->post(packet(client->codec.load(std::memory_order_acquire)));
+    }
+}
+
+void ProfileManager::serveClient(ListenClient& _client)
+{
+    EASY_THREAD_SCOPE("EasyProfiler.Client");
+
+    // Receive timeout is used to check if there are captured blocks to send
+    EASY_CONSTEXPR int ReceiveTimeoutMs = 100;
+
+    auto& socket = _client.socket;
+    profiler::net::Message replyMessage(profiler::net::MessageType::Reply_Capturing_Started);
+
+    int bytes = 0;
+    bool hasConnect = true;
+
+    // Send reply
+    {
+        const bool wasLowPriorityET =
 #ifdef _WIN32
-                EasyEventTracer::instance().isLowPriority();
+            EasyEventTracer::instance().isLowPriority();
 #else
-                false;
+            false;
 #endif
-            const profiler::net::EasyProfilerStatus connectionReply(isEnabled(), isEventTracingEnabled(), wasLowPriorityET);
+        const profiler::net::EasyProfilerStatus connectionReply(isEnabled(), isEventTracingEnabled(), wasLowPriorityET);
 
-            bytes = socket.send(&connectionReply, sizeof(profiler::net::EasyProfilerStatus));
-            hasConnect = bytes > 0;
-        }
+        bytes = socket.send(&connectionReply, sizeof(profiler::net::EasyProfilerStatus));
+        hasConnect = bytes > 0;
+    }
+
+    socket.setReceiveTimeout(ReceiveTimeoutMs);
 
-        while (hasConnect && !m_stopListen.load(std::memory_order_acquire))
+    while (hasConnect && !m_stopListen.load(std::memory_order_acquire))
+    {
+        shared_packet_t packet;
+        if (_client.take(packet))
         {
-            if (dumping)
+            if (packet != nullptr)
             {
-                if (!dumpingResult.valid())
-                {
-                    dumping = false;
-                    socket.setReceiveTimeout(0);
-                    clear_sstream(os);
-                }
-                else if (dumpingResult.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
-                {
-                    dumping = false;
-                    dumpingResult.get();
-
-                    const auto size = os.tellp();
-                    static const decltype(size) badSize = -1;
-                    if (size != badSize)
-                    {
-                        const profiler::net::DataMessage dm(static_cast<uint32_t>(size),
-                                                            profiler::net::MessageType::Reply_Blocks);
-
-                        const size_t packet_size = sizeof(dm) + dm.size;
-                        std::string sendbuf;
-                        sendbuf.reserve(packet_size + 1);
-
-                        if (sendbuf.capacity() >= packet_size) // check if there is enough memory
-                        {
-                            sendbuf.append((const char*) &dm, sizeof(dm));
-                            sendbuf += os.str(); // TODO: Avoid double-coping data from stringstream!
-                            clear_sstream(os);
-
-                            bytes = socket.send(sendbuf.c_str(), packet_size);
-                            hasConnect = bytes > 0;
-                            if (!hasConnect)
-                                break;
-                        }
-                        else
-                        {
-                            EASY_ERROR("Can not send blocks. Not enough memory for allocating " << packet_size
-                                                                                                << " bytes");
-                            clear_sstream(os);
-                        }
-                    }
-                    else
-                    {
-                        EASY_ERROR("Can not send blocks. Bad std::stringstream.tellp() == -1");
-                        clear_sstream(os);
-                    }
+                bytes = socket.send(packet->data(), packet->size());
+                packet.reset();
 
-                    replyMessage.type = profiler::net::MessageType::Reply_Blocks_End;
-                    bytes = socket.send(&replyMessage, sizeof(replyMessage));
-                    hasConnect = bytes > 0;
-                    if (!hasConnect)
-                        break;
-
-                    socket.setReceiveTimeout(0);
-                }
+                hasConnect = bytes > 0;
+                if (!hasConnect)
+                    break;
             }
 
-            char buffer[256] = {};
-            bytes = socket.receive(buffer, 255);
+            replyMessage.type = profiler::net::MessageType::Reply_Blocks_End;
+            bytes = socket.send(&replyMessage, sizeof(replyMessage));
+            hasConnect = bytes > 0;
+            if (!hasConnect)
+                break;
+        }
+
+        char buffer[256] = {};
+        const int received = socket.receive(buffer, 255);
 
-            hasConnect = socket.isConnected();
-            if (!hasConnect || bytes < static_cast<int>(sizeof(profiler::net::Message)))
-                continue;
+        hasConnect = socket.isConnected();
 
-            auto message = (const profiler::net::Message*)buffer;
+        // Several messages could be received at once (e.g. compression request followed by start capture)
+        for (int offset = 0; hasConnect && received - offset >= static_cast<int>(sizeof(profiler::net::Message));)
+        {
+            auto message = (const profiler::net::Message*)(buffer + offset);
             if (!message->isEasyNetMessage())
-                continue;
+                break;
+
+            const auto messageSize = static_cast<int>(netMessageSize(message->type));
+            if (received - offset < messageSize)
+                break;
+
+            offset = messageSize != 0 ? offset + messageSize : received;
 
             switch (message->type)
             {
@@ -1540,10 +2518,14 @@ void ProfileManager::listen(uint16_t _port)
                     if (!m_profilerStatus.exchange(true, std::memory_order_acq_rel))
                     {
                         enableEventTracer();
-                        m_beginTime = t;
+                        if (m_beginTime == 0)
+                            m_beginTime = t;
                     }
                     m_dumpSpin.unlock();
 
+                    // This client would receive captured blocks when any client stops capturing
+                    _client.subscribed.store(true, std::memory_order_release);
+
                     replyMessage.type = profiler::net::MessageType::Reply_Capturing_Started;
                     bytes = socket.send(&replyMessage, sizeof(replyMessage));
                     hasConnect = bytes > 0;
@@ -1555,28 +2537,43 @@ void ProfileManager::listen(uint16_t _port)
                 {
                     EASY_LOGMSG("receive MessageType::Request_Stop_Capture\n");
 
-                    if (dumping)
-                        break;
+                    _client.subscribed.store(true, std::memory_order_release);
+                    startDumping();
 
-                    m_dumpSpin.lock();
-                    auto time = profiler::clock::now();
-                    if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
-                    {
-                        disableEventTracer();
-                        m_endTime = time;
-                    }
-                    EASY_FORCE_EVENT2(m_endTime, "StopCapture", EASY_COLOR_END, profiler::OFF);
+                    break;
+                }
 
-                    dumping = true;
-                    socket.setReceiveTimeout(500); // We have to check if dumping ready or not
+                case profiler::net::MessageType::Request_Arm_Trigger:
+                {
+                    auto data = reinterpret_cast<const profiler::net::TriggerMessage*>(message);
+                    EASY_LOGMSG("receive MessageType::Request_Arm_Trigger type=" << (int)data->trigger_type << std::endl);
 
-                    m_stopDumping.store(false, std::memory_order_release);
-                    dumpingResult = std::async(std::launch::async, [this, &os]
-                    {
-                        auto result = dumpBlocksToStream(os, false, true);
-                        m_dumpSpin.unlock();
-                        return result;
-                    });
+                    // This client would receive captured blocks when the trigger fires
+                    _client.subscribed.store(true, std::memory_order_release);
+                    armTrigger(static_cast<profiler::TriggerType>(data->trigger_type), nullptr, data->id, data->threshold,
+                               data->history_ms, data->after_ms, nullptr);
+
+                    break;
+                }
+
+                case profiler::net::MessageType::Request_Disarm_Trigger:
+                {
+                    EASY_LOGMSG("receive MessageType::Request_Disarm_Trigger\n");
+                    disarmTrigger();
+                    break;
+                }
+
+                case profiler::net::MessageType::Request_Blocks_Compression:
+                {
+                    auto data = reinterpret_cast<const profiler::net::CompressionMessage*>(message);
+                    EASY_LOGMSG("receive MessageType::Request_Blocks_Compression codec=" << (int)data->codec << std::endl);
+
+                    auto codec = static_cast<profiler::CompressionCodec>(data->codec);
+                    if (codec >= profiler::CompressionCodec::TypesCount)
+                        codec = profiler::CompressionCodec::None;
+
+                    _client.codec.store(static_cast<uint8_t>(profiler::compression::availableCodec(codec)),
+                                        std::memory_order_release);
 
                     break;
                 }
@@ -1585,8 +2582,7 @@ void ProfileManager::listen(uint16_t _port)
                 {
                     EASY_LOGMSG("receive MessageType::Request_Blocks_Description\n");
 
-                    if (dumping)
-                        stopDumping();
+                    std::stringstream os(std::ios_base::out | std::ios_base::binary);
 
                     // Write profiler signature and version
                     write(os, EASY_PROFILER_SIGNATURE);
@@ -1612,34 +2608,14 @@ void ProfileManager::listen(uint16_t _port)
                     m_storedSpin.unlock();
                     // END of Write block descriptors.
 
-                    const auto size = os.tellp();
-                    static const decltype(size) badSize = -1;
-                    if (size != badSize)
-                    {
-                        const profiler::net::DataMessage dm(static_cast<uint32_t>(size),
-                                                            profiler::net::MessageType::Reply_Blocks_Description);
-
-                        const size_t packet_size = sizeof(dm) + dm.size;
-                        std::string sendbuf;
-                        sendbuf.reserve(packet_size + 1);
-
-                        if (sendbuf.capacity() >= packet_size) // check if there is enough memory
-                        {
-                            sendbuf.append((const char*)&dm, sizeof(dm));
-                            sendbuf += os.str(); // TODO: Avoid double-coping data from stringstream!
-                            clear_sstream(os);
-
-                            bytes = socket.send(sendbuf.c_str(), packet_size);
-                            //hasConnect = bytes > 0;
-                        }
-                        else
-                        {
-                            EASY_ERROR("Can not send block descriptions. Not enough memory for allocating " << packet_size << " bytes");
-                        }
-                    }
-                    else
+                    packet = makeDataPacket(profiler::net::MessageType::Reply_Blocks_Description, os);
+                    clear_sstream(os);
+
+                    if (packet != nullptr)
                     {
-                        EASY_ERROR("Can not send block descriptions. Bad std::stringstream.tellp() == -1");
+                        bytes = socket.send(packet->data(), packet->size());
+                        packet.reset();
+                        //hasConnect = bytes > 0;
                     }
 
                     replyMessage.type = profiler::net::MessageType::Reply_Blocks_Description_End;
@@ -1667,15 +2643,15 @@ void ProfileManager::listen(uint16_t _port)
 
                 case profiler::net::MessageType::Change_Event_Tracing_Priority:
                 {
-#if defined(_WIN32) || EASY_OPTION_LOG_ENABLED != 0
+    #if defined(_WIN32) || EASY_OPTION_LOG_ENABLED != 0
                     auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
-#endif
+    #endif
 
                     EASY_LOGMSG("receive MessageType::Change_Event_Tracing_Priority low=" << data->flag << std::endl);
 
-#if defined(_WIN32)
+    #if defined(_WIN32)
                     EasyEventTracer::instance().setLowPriority(data->flag);
-#endif
+    #endif
                     break;
                 }
 
@@ -1685,14 +2661,114 @@ void ProfileManager::listen(uint16_t _port)
         }
     }
 
-    if (dumping)
+    _client.subscribed.store(false, std::memory_order_release);
+    _client.finished.store(true, std::memory_order_release);
+
+    EASY_LOGMSG("Client disconnected\n");
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void ProfileManager::exportToSharedMemory()
+{
+    EASY_THREAD_SCOPE("EasyProfiler.SharedMemory");
+
+    EASY_LOGMSG("Shared memory export started\n");
+
+    using position_t = decltype(ThreadStorage::blocks.closedList)::position;
+    using marked_end_t = decltype(ThreadStorage::blocks.closedList)::marked_end;
+
+    struct ExportedThread
+    {
+        const ThreadStorage* storage = nullptr;
+        position_t          position;
+        int32_t                 ring = -1;
+    };
+
+    struct ThreadSnapshot
+    {
+        profiler::thread_id_t        id;
+        const ThreadStorage*    storage;
+        marked_end_t                end;
+    };
+
+    std::unordered_map<profiler::thread_id_t, ExportedThread> exportedThreads;
+    std::vector<ThreadSnapshot> snapshot;
+    std::vector<const void*> chunks;
+    size_t exportedDescriptors = 0;
+
+    auto& writer = *m_sharedMemory;
+
+    for (;;)
     {
-        m_stopDumping.store(true, std::memory_order_release);
-        join(dumpingResult);
+        const bool stop = m_stopSharedMemory.load(std::memory_order_acquire);
+
+        // Descriptors are exported first to let readers know all block ids before reading blocks
+        {
+            guard_lock_t lock(m_storedSpin);
+            for (; exportedDescriptors < m_descriptors.size(); ++exportedDescriptors)
+            {
+                const auto descriptor = m_descriptors[exportedDescriptors];
+                if (!writer.addDescriptor(*descriptor, descriptor->name(), descriptor->nameSize(),
+                                          descriptor->filename(), descriptor->filenameSize()))
+                {
+                    break;
+                }
+            }
+        }
+
+        // Export only closed blocks (marked by put_mark() at the end of each top-level block).
+        // Application threads are not affected: data is copied directly from their storages.
+        // Context switch events are not exported because they are gathered only while dumping.
+        //
+        // m_spin is held only to take a snapshot of threads, so registration of new threads does not wait for copying.
+        // Thread storages are removed and cleared only by dumpBlocks() (expired threads are kept until the next dump),
+        // which waits for m_sharedMemorySpin, so storages from the snapshot stay valid until it is released.
+        m_spin.lock();
+
+        snapshot.clear();
+        for (auto& it : m_threads)
+        {
+            const auto& thread = it.second;
+            snapshot.push_back(ThreadSnapshot {it.first, &thread, thread.blocks.closedList.published_mark()});
+        }
+
+        m_sharedMemorySpin.lock();
+        m_spin.unlock();
+
+        for (const auto& thread : snapshot)
+        {
+            auto& exported = exportedThreads[thread.id];
+
+            if (exported.storage != thread.storage)
+            {
+                exported.storage = thread.storage;
+                exported.position = position_t();
+            }
+
+            if (exported.ring < 0)
+            {
+                exported.ring = writer.addThread(thread.id, thread.storage->name.c_str());
+                if (exported.ring < 0)
+                    continue; // There are no free rings
+            }
+
+            writer.beginBatch(exported.ring);
+            thread.storage->blocks.closedList.read_marked(exported.position, thread.end, chunks, [&writer](const char* _data, size_t _size) {
+                writer.write(_data, _size);
+            });
+            writer.endBatch();
+        }
+
+        m_sharedMemorySpin.unlock();
+
+        if (stop)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
-    EASY_LOGMSG("Listening stopped\n");
+    EASY_LOGMSG("Shared memory export stopped\n");
 }
 
 //////////////////////////////////////////////////////////////////////////
-
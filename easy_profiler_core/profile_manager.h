@@ -56,8 +56,14 @@ The Apache License, Version 2.0 (the "License");
 #include "thread_storage.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
 #include <unordered_map>
 #include <thread>
 #include <type_traits>
@@ -68,11 +74,24 @@ The Apache License, Version 2.0 (the "License");
 using processid_t = uint64_t;
 
 class BlockDescriptor;
+class SharedMemoryWriter;
+struct ListenClient;
 
 namespace profiler {
+    class Sink;
     class ValueId;
 }
 
+/** Request of dumpBlocksToFileAsync().
+*/
+struct AsyncDumpRequest
+{
+    using callbacks_t = std::vector<std::pair<profiler::dump_callback_t, void*> >;
+
+    std::string    filename;
+    callbacks_t   callbacks; ///< Callbacks of all coalesced requests for the same file
+};
+
 class ProfileManager
 {
 #ifndef EASY_MAGIC_STATIC_AVAILABLE
@@ -86,6 +105,8 @@ class ProfileManager
     using map_of_threads_stacks = std::map<profiler::thread_id_t, ThreadStorage>;
     using block_descriptors_t   = std::vector<BlockDescriptor*>;
     using descriptors_map_t     = std::unordered_map<profiler::string_with_hash, profiler::block_id_t>;
+    using listen_clients_t      = std::vector<std::shared_ptr<ListenClient> >;
+    using shared_packet_t       = std::shared_ptr<const std::string>;
 
     const processid_t                     m_processId;
 
@@ -117,11 +138,43 @@ class ProfileManager
     std::atomic_bool                  m_frameMaxReset;
     std::atomic_bool                  m_frameAvgReset;
     std::atomic_bool                    m_stopDumping;
+    std::atomic<uint8_t>            m_dumpCompression; ///< profiler::CompressionCodec of files written by dumpBlocksToFile()
 
     std::string m_csInfoFilename = "/tmp/cs_profiling_info.log";
 
-    std::thread      m_listenThread;
-    std::atomic_bool   m_stopListen;
+    std::thread             m_listenThread;
+    std::atomic_bool          m_stopListen;
+    listen_clients_t       m_listenClients; ///< Connected network clients (each one is served by it's own thread)
+    std::mutex        m_listenClientsMutex;
+    std::future<void>      m_dumpingResult; ///< Dumping task for network clients (one dump is shared by all subscribers)
+    std::mutex             m_dumpingMutex;
+    std::atomic_bool             m_dumping;
+
+    std::thread                            m_sharedMemoryThread; ///< Thread exporting closed blocks into shared memory
+    std::unique_ptr<SharedMemoryWriter>          m_sharedMemory;
+    std::atomic_bool                         m_stopSharedMemory;
+    std::atomic_bool                  m_isSharedMemoryExporting;
+    profiler::spin_lock                      m_sharedMemorySpin; ///< Held while closed blocks are copied into shared memory
+
+    std::thread                                 m_asyncDumpThread; ///< Thread writing files requested by dumpBlocksToFileAsync()
+    std::mutex                                   m_asyncDumpMutex; ///< Protects m_asyncDumps and m_stopAsyncDump
+    std::condition_variable                       m_asyncDumpCond;
+    std::deque<AsyncDumpRequest>                     m_asyncDumps; ///< Pending requests (the front one may be in progress)
+    bool                                          m_stopAsyncDump;
+
+    std::thread                                   m_triggerThread; ///< Thread waiting for the trigger to fire and dumping captured blocks
+    std::mutex                                     m_triggerMutex; ///< Protects arming and disarming of the trigger
+    std::string                                 m_triggerFilename; ///< Empty if captured blocks should be sent to network clients
+    std::string                                m_triggerBlockName; ///< Name of the block which has not been registered yet (protected by m_storedSpin)
+    profiler::timestamp_t                       m_triggerDuration; ///< Duration threshold in ticks
+    profiler::timestamp_t                          m_triggerAfter; ///< Capturing duration after the trigger fired (in ticks)
+    double                                     m_triggerThreshold; ///< Threshold for TriggerType::Value
+    std::atomic<profiler::timestamp_t>        m_historyDuration; ///< Duration of history to keep in memory (in ticks). 0 means "keep everything"
+    std::atomic<profiler::timestamp_t>            m_triggerTime; ///< Time when trigger fired (0 if it has not fired yet)
+    std::atomic<profiler::block_id_t>          m_triggerBlockId;
+    std::atomic<uint8_t>                          m_triggerType; ///< Armed trigger type (TriggerType::None if there is no armed trigger)
+    std::atomic_bool                              m_stopTrigger;
+    std::atomic_bool                         m_isTriggerActive;
 
 public:
 
@@ -160,7 +213,11 @@ public:
 
     void setEventTracingEnabled(bool _isEnable);
     bool isEventTracingEnabled() const;
-    uint32_t dumpBlocksToFile(const char* filename);
+    uint64_t dumpBlocksToFile(const char* filename);
+    uint64_t dumpBlocksToSink(profiler::Sink& _sink);
+    bool dumpBlocksToFileAsync(const char* _filename, profiler::dump_callback_t _callback, void* _userData);
+    void setDumpCompression(profiler::CompressionCodec _codec);
+    profiler::CompressionCodec dumpCompression() const;
     const char* registerThread(const char* name, profiler::ThreadGuard& threadGuard);
     const char* registerThread(const char* name);
 
@@ -172,9 +229,17 @@ public:
     void startListen(uint16_t _port);
     void stopListen();
     bool isListening() const;
+    bool startSharedMemoryExport(const char* _name, uint32_t _ringSize);
+    void stopSharedMemoryExport();
+    bool isSharedMemoryExportEnabled() const;
+    bool armTrigger(profiler::TriggerType _type, const char* _blockName, profiler::block_id_t _id, double _threshold,
+                    uint32_t _historyMs, uint32_t _afterMs, const char* _filename);
+    void disarmTrigger();
+    bool isTriggerArmed() const;
 
     profiler::timestamp_t ticks2ns(profiler::timestamp_t ticks) const;
     profiler::timestamp_t ticks2us(profiler::timestamp_t ticks) const;
+    profiler::timestamp_t us2ticks(profiler::timestamp_t us) const;
 
     static bool isMainThread();
     static profiler::timestamp_t this_thread_frameTime(profiler::Duration _durationCast);
@@ -187,8 +252,24 @@ public:
 private:
 
     void listen(uint16_t _port);
+    void serveClient(ListenClient& _client);
+    void joinListenClients(bool _finishedOnly);
+    void startDumping();
+    void broadcastBlocks(const std::string& _data);
+    void exportToSharedMemory();
+    void waitForTrigger();
+    void stopTrigger();
+    void fireTrigger(profiler::TriggerType _type, profiler::timestamp_t _time);
+    void keepHistory();
+    void dumpAsync();
+    void stopAsyncDump();
+
+    EASY_FORCE_INLINE profiler::TriggerType armedTrigger() const {
+        return static_cast<profiler::TriggerType>(m_triggerType.load(std::memory_order_acquire));
+    }
 
-    uint32_t dumpBlocksToStream(std::ostream& _outputStream, bool _lockSpin, bool _async);
+    uint64_t dumpBlocks(profiler::Sink& _sink, bool _lockSpin, bool _async);
+    uint64_t dumpBlocksToStream(std::ostream& _outputStream, bool _lockSpin, bool _async, profiler::CompressionCodec _codec);
     void setBlockStatus(profiler::block_id_t _id, profiler::EasyBlockStatus _status);
 
     void registerThread();
@@ -50,6 +50,7 @@
 
 #include <easy/profiler.h>
 #include <easy/arbitrary_value.h>
+#include <easy/sink.h>
 #include "profile_manager.h"
 #include "event_trace_win.h"
 #include "current_time.h"
@@ -75,6 +76,9 @@
                                           EASY_STRINGIFICATION(EASY_PROFILER_VERSION_PATCH)
 
 extern const uint32_t EASY_PROFILER_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'y';
+extern const uint32_t EASY_PROFILER_COMPRESSED_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'z';
+extern const uint32_t EASY_PROFILER_INDEX_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'i';
+extern const uint32_t EASY_PROFILER_SEGMENTED_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 's';
 extern const uint32_t EASY_PROFILER_VERSION = (static_cast<uint32_t>(EASY_PROFILER_VERSION_MAJOR) << 24) |
                                               (static_cast<uint32_t>(EASY_PROFILER_VERSION_MINOR) << 16) |
                                                static_cast<uint32_t>(EASY_PROFILER_VERSION_PATCH);
@@ -193,11 +197,31 @@ PROFILER_API void beginNonScopedBlock(const profiler::BaseBlockDescriptor* _desc
     ProfileManager::instance().beginNonScopedBlock(_desc, _runtimeName);
 }
 
-PROFILER_API uint32_t dumpBlocksToFile(const char* filename)
+PROFILER_API uint64_t dumpBlocksToFile(const char* filename)
 {
     return ProfileManager::instance().dumpBlocksToFile(filename);
 }
 
+PROFILER_API uint64_t dumpBlocksToSink(profiler::Sink& _sink)
+{
+    return ProfileManager::instance().dumpBlocksToSink(_sink);
+}
+
+PROFILER_API bool dumpBlocksToFileAsync(const char* _filename, profiler::dump_callback_t _callback, void* _userData)
+{
+    return ProfileManager::instance().dumpBlocksToFileAsync(_filename, _callback, _userData);
+}
+
+PROFILER_API void setDumpCompression(profiler::CompressionCodec _codec)
+{
+    ProfileManager::instance().setDumpCompression(_codec);
+}
+
+PROFILER_API profiler::CompressionCodec dumpCompression()
+{
+    return ProfileManager::instance().dumpCompression();
+}
+
 PROFILER_API const char* registerThreadScoped(const char* name, profiler::ThreadGuard& threadGuard)
 {
     return ProfileManager::instance().registerThread(name, threadGuard);
@@ -258,6 +282,38 @@ PROFILER_API bool isListening()
     return ProfileManager::instance().isListening();
 }
 
+PROFILER_API bool startSharedMemoryExport(const char* _name, uint32_t _ringSize)
+{
+    return ProfileManager::instance().startSharedMemoryExport(_name, _ringSize);
+}
+
+PROFILER_API void stopSharedMemoryExport()
+{
+    return ProfileManager::instance().stopSharedMemoryExport();
+}
+
+PROFILER_API bool isSharedMemoryExportEnabled()
+{
+    return ProfileManager::instance().isSharedMemoryExportEnabled();
+}
+
+PROFILER_API bool armTrigger(profiler::TriggerType _type, const char* _blockName, double _threshold, uint32_t _historyMs,
+                             uint32_t _afterMs, const char* _filename)
+{
+    return ProfileManager::instance().armTrigger(_type, _blockName, profiler::block_id_t(-1), _threshold,
+                                                 _historyMs, _afterMs, _filename);
+}
+
+PROFILER_API void disarmTrigger()
+{
+    return ProfileManager::instance().disarmTrigger();
+}
+
+PROFILER_API bool isTriggerArmed()
+{
+    return ProfileManager::instance().isTriggerArmed();
+}
+
 PROFILER_API bool isMainThread()
 {
     return ProfileManager::isMainThread();
@@ -323,7 +379,11 @@ PROFILER_API void storeBlock(const profiler::BaseBlockDescriptor*, const char*,
 
 PROFILER_API void beginBlock(profiler::Block&) { }
 PROFILER_API void beginNonScopedBlock(const profiler::BaseBlockDescriptor*, const char*) { }
-PROFILER_API uint32_t dumpBlocksToFile(const char*) { return 0; }
+PROFILER_API uint64_t dumpBlocksToFile(const char*) { return 0; }
+PROFILER_API uint64_t dumpBlocksToSink(profiler::Sink& _sink) { _sink.complete(0, false); return 0; }
+PROFILER_API bool dumpBlocksToFileAsync(const char*, profiler::dump_callback_t, void*) { return false; }
+PROFILER_API void setDumpCompression(profiler::CompressionCodec) { }
+PROFILER_API profiler::CompressionCodec dumpCompression() { return profiler::CompressionCodec::None; }
 PROFILER_API const char* registerThreadScoped(const char*, profiler::ThreadGuard&) { return ""; }
 PROFILER_API const char* registerThread(const char*) { return ""; }
 PROFILER_API void setEventTracingEnabled(bool) { }
@@ -335,6 +395,12 @@ PROFILER_API const char* getContextSwitchLogFilename() { return ""; }
 PROFILER_API void startListen(uint16_t) { }
 PROFILER_API void stopListen() { }
 PROFILER_API bool isListening() { return false; }
+PROFILER_API bool startSharedMemoryExport(const char*, uint32_t) { return false; }
+PROFILER_API void stopSharedMemoryExport() { }
+PROFILER_API bool isSharedMemoryExportEnabled() { return false; }
+PROFILER_API bool armTrigger(profiler::TriggerType, const char*, double, uint32_t, uint32_t, const char*) { return false; }
+PROFILER_API void disarmTrigger() { }
+PROFILER_API bool isTriggerArmed() { return false; }
 
 PROFILER_API bool isMainThread() { return false; }
 PROFILER_API profiler::timestamp_t this_thread_frameTime(profiler::Duration) { return 0; }
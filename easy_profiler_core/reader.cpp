@@ -57,19 +57,48 @@
 #include <future>
 #include <iterator>
 #include <limits>
-#include <map>
+#include <memory>
 #include <mutex>
+#include <sstream>
 #include <unordered_map>
 #include <thread>
 
 #include <easy/reader.h>
 #include <easy/profiler.h>
+#include <easy/quantile_sketch.h>
 
 #include "hashed_cstr.h"
+#include "compression.h"
+#include "file_index.h"
+#include "segments.h"
+#include "alignment_helpers.h"
+
+#ifdef _WIN32
+# include <Windows.h>
+# ifdef min
+#  undef min
+# endif
+# ifdef max
+#  undef max
+# endif
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# include <immintrin.h>
+# define EASY_CONVERT_TIMES_AVX2
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 
 extern const uint32_t EASY_PROFILER_SIGNATURE;
+extern const uint32_t EASY_PROFILER_COMPRESSED_SIGNATURE;
+extern const uint32_t EASY_PROFILER_INDEX_SIGNATURE;
+extern const uint32_t EASY_PROFILER_SEGMENTED_SIGNATURE;
 extern const uint32_t EASY_PROFILER_VERSION;
 
 # define EASY_VERSION_INT(v_major, v_minor, v_patch) ((static_cast<uint32_t>(v_major) << 24) | \
@@ -81,6 +110,7 @@ EASY_CONSTEXPR uint32_t EASY_V_100 = EASY_VERSION_INT(1, 0, 0); ///< in v1.0.0 s
 EASY_CONSTEXPR uint32_t EASY_V_130 = EASY_VERSION_INT(1, 3, 0); ///< in v1.3.0 changed sizeof(thread_id_t) uint32_t -> uint64_t
 EASY_CONSTEXPR uint32_t EASY_V_200 = EASY_VERSION_INT(2, 0, 0); ///< in v2.0.0 file header was slightly rearranged
 EASY_CONSTEXPR uint32_t EASY_V_210 = EASY_VERSION_INT(2, 1, 0); ///< in v2.1.0 user bookmarks were added
+EASY_CONSTEXPR uint32_t EASY_V_220 = EASY_VERSION_INT(2, 2, 0); ///< in v2.2.0 changed blocks counts uint32_t -> uint64_t
 
 # undef EASY_VERSION_INT
 
@@ -133,33 +163,180 @@ using async_result_t = void;
 
 using async_future = std::future<async_result_t>;
 
-template <class T>
-struct Counter
-{
-    T count = 0;
-};
-
 struct Stats
 {
     profiler::BlockStatistics* stats;
-    std::map<profiler::timestamp_t, Counter<size_t> > durations;
+    profiler::QuantileSketch durations;
+    profiler::stats_index_t index;
 
-    Stats(profiler::BlockStatistics* stats_ptr, profiler::timestamp_t duration) EASY_NOEXCEPT
+    Stats(profiler::BlockStatistics* stats_ptr, profiler::stats_index_t stats_index, profiler::timestamp_t duration)
         : stats(stats_ptr)
+        , index(stats_index)
     {
-        durations[duration].count = 1;
+        durations.add(duration);
     }
 
     Stats(Stats&& another) EASY_NOEXCEPT
         : stats(another.stats)
         , durations(std::move(another.durations))
+        , index(another.index)
     {
         another.stats = nullptr;
+        another.index = profiler::NoStatsIndex;
     }
 
     Stats(const Stats&) = delete;
 };
 
+EASY_CONSTEXPR size_t StatsFirstChunkSize = 64; ///< Number of BlockStatistics in the first chunk of StatsArena
+EASY_CONSTEXPR uint32_t StatsChunkBits = 12; ///< Number of bits of statistics index which address BlockStatistics inside the chunk
+EASY_CONSTEXPR size_t StatsMaxChunkSize = size_t(1) << StatsChunkBits; ///< Maximum number of BlockStatistics in one chunk of StatsArena
+EASY_CONSTEXPR uint32_t StatsChunksNumber = uint32_t(1) << (32 - StatsChunkBits); ///< Maximum number of chunks of all loaded trees
+EASY_CONSTEXPR uint32_t StatsDirectoryPageSize = 1024;
+
+/** Thrown by StatsDirectory::add() when all chunk ids are used by loaded trees.
+
+Is caught by fillTreesFromData(), which fails the loading with an error message.
+*/
+struct StatsDirectoryFull EASY_FINAL : public std::exception
+{
+    const char* what() const EASY_NOEXCEPT override
+    {
+        return "Too many statistics in loaded trees";
+    }
+};
+
+/** Chunks of statistics of all loaded trees.
+
+Translates profiler::stats_index_t, which is (chunk id << StatsChunkBits) | (offset in the chunk), into pointer.
+Chunks are registered by worker threads in parallel, so registration is locked. Lookup is not locked: chunk
+can be looked up only by the trees built from it, and these trees are passed to the user after the chunk is registered.
+*/
+class StatsDirectory EASY_FINAL
+{
+    using Page = std::unique_ptr<profiler::BlockStatistics*[]>;
+
+    Page     m_pages[StatsChunksNumber / StatsDirectoryPageSize];
+    std::vector<uint32_t>                                m_free;
+    std::mutex                                          m_mutex;
+    uint32_t                                             m_next;
+
+    StatsDirectory() : m_next(0)
+    {
+    }
+
+public:
+
+    static StatsDirectory& instance()
+    {
+        // Never destroyed: trees may be released by static objects of the user after this one.
+        static auto directory = new StatsDirectory();
+        return *directory;
+    }
+
+    uint32_t add(profiler::BlockStatistics* _chunk)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        uint32_t id;
+        if (!m_free.empty())
+        {
+            id = m_free.back();
+            m_free.pop_back();
+        }
+        else if (m_next < StatsChunksNumber - 1) // The last id is reserved for profiler::NoStatsIndex
+        {
+            id = m_next++;
+        }
+        else
+        {
+            throw StatsDirectoryFull();
+        }
+
+        auto& page = m_pages[id / StatsDirectoryPageSize];
+        if (page == nullptr)
+            page.reset(new profiler::BlockStatistics*[StatsDirectoryPageSize]);
+        page[id % StatsDirectoryPageSize] = _chunk;
+
+        return id;
+    }
+
+    void remove(uint32_t _id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pages[_id / StatsDirectoryPageSize][_id % StatsDirectoryPageSize] = nullptr;
+        m_free.push_back(_id);
+    }
+
+    profiler::BlockStatistics* get(profiler::stats_index_t _index) const
+    {
+        const auto id = _index >> StatsChunkBits;
+        return m_pages[id / StatsDirectoryPageSize][id % StatsDirectoryPageSize] + (_index & (StatsMaxChunkSize - 1));
+    }
+
+}; // END of class StatsDirectory.
+
+/** Allocates statistics of one thread by chunks.
+
+Statistics are never released one by one: all chunks are released together with the trees memory.
+Chunks grow geometrically, so threads with a few distinct blocks do not waste memory.
+Every chunk is registered in StatsDirectory, so blocks refer to statistics by 32-bit index.
+*/
+class StatsArena EASY_FINAL
+{
+    static_assert(std::is_trivially_destructible<profiler::BlockStatistics>::value,
+                  "StatsArena never calls destructors of BlockStatistics");
+
+    std::vector<std::unique_ptr<char[]> > m_chunks;
+    std::vector<uint32_t>                    m_ids; ///< Ids of m_chunks in StatsDirectory
+    size_t                                  m_used;
+    size_t                                  m_size; ///< Capacity of the last chunk
+
+public:
+
+    StatsArena() : m_used(0), m_size(0)
+    {
+    }
+
+    StatsArena(StatsArena&& that) EASY_NOEXCEPT
+        : m_chunks(std::move(that.m_chunks))
+        , m_ids(std::move(that.m_ids))
+        , m_used(that.m_used)
+        , m_size(that.m_size)
+    {
+        that.m_used = 0;
+        that.m_size = 0;
+    }
+
+    StatsArena(const StatsArena&) = delete;
+
+    ~StatsArena()
+    {
+        auto& directory = StatsDirectory::instance();
+        for (auto id : m_ids)
+            directory.remove(id);
+    }
+
+    profiler::stats_index_t allocate(profiler::timestamp_t _duration, profiler::block_index_t _index,
+                                     profiler::block_index_t _parent, profiler::BlockStatistics*& _stats)
+    {
+        if (m_used == m_size)
+        {
+            const auto size = m_size == 0 ? StatsFirstChunkSize : std::min(m_size << 1, StatsMaxChunkSize);
+            m_chunks.emplace_back(new char[size * sizeof(profiler::BlockStatistics)]);
+            m_ids.push_back(StatsDirectory::instance().add(reinterpret_cast<profiler::BlockStatistics*>(m_chunks.back().get())));
+            m_size = size;
+            m_used = 0;
+        }
+
+        auto memory = m_chunks.back().get() + m_used * sizeof(profiler::BlockStatistics);
+        _stats = new (memory) profiler::BlockStatistics(_duration, _index, _parent);
+
+        return static_cast<profiler::stats_index_t>((m_ids.back() << StatsChunkBits) | m_used++);
+    }
+
+}; // END of class StatsArena.
+
 class ReaderThreadPool
 {
     std::vector<std::thread>                        m_threads;
@@ -241,16 +418,30 @@ private:
 
 namespace profiler {
 
-    using stats_map_t = std::unordered_map<profiler::block_id_t, Stats, estd::hash<profiler::block_id_t> >;
+    /** Children lists and statistics of the loaded blocks trees.
+
+    Memory is split by threads, so trees of different threads are built in parallel without locks.
+    */
+    class BlocksTreeMemory EASY_FINAL
+    {
+    public:
+
+        std::vector<block_indices_t> children; ///< Children lists of all blocks of the thread are placed one after another
+        std::vector<StatsArena>         stats; ///< Statistics of all blocks of the thread
+
+    }; // END of class BlocksTreeMemory.
 
-    SerializedData::SerializedData() : m_size(0), m_data(nullptr)
+    SerializedData::SerializedData() : m_size(0), m_data(nullptr), m_trees(nullptr), m_mapped(false)
     {
     }
 
-    SerializedData::SerializedData(SerializedData&& that) : m_size(that.m_size), m_data(that.m_data)
+    SerializedData::SerializedData(SerializedData&& that)
+        : m_size(that.m_size), m_data(that.m_data), m_trees(that.m_trees), m_mapped(that.m_mapped)
     {
         that.m_size = 0;
         that.m_data = nullptr;
+        that.m_trees = nullptr;
+        that.m_mapped = false;
     }
 
     SerializedData::~SerializedData()
@@ -258,9 +449,29 @@ namespace profiler {
         clear();
     }
 
+    void SerializedData::release()
+    {
+        if (m_data == nullptr)
+            return;
+
+        if (m_mapped)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+#else
+            munmap(m_data, m_size);
+#endif
+            m_mapped = false;
+        }
+        else
+        {
+            delete [] m_data;
+        }
+    }
+
     void SerializedData::set(char* _data, uint64_t _size)
     {
-        delete [] m_data;
+        release();
         m_size = _size;
         m_data = _data;
     }
@@ -278,20 +489,23 @@ namespace profiler {
         auto oldsize = m_size;
         auto olddata = m_data;
 
-        m_size = oldsize + _size;
-        m_data = new char[m_size];
+        auto newdata = new char[oldsize + _size];
+        if (olddata != nullptr)
+            memcpy(newdata, olddata, oldsize);
 
-        if (olddata != nullptr) {
-            memcpy(m_data, olddata, oldsize);
-            delete [] olddata;
-        }
+        set(newdata, oldsize + _size);
     }
 
     SerializedData& SerializedData::operator = (SerializedData&& that)
     {
         set(that.m_data, that.m_size);
+        delete m_trees;
+        m_trees = that.m_trees;
+        m_mapped = that.m_mapped;
         that.m_size = 0;
         that.m_data = nullptr;
+        that.m_trees = nullptr;
+        that.m_mapped = false;
         return *this;
     }
 
@@ -328,118 +542,247 @@ namespace profiler {
     void SerializedData::clear()
     {
         set(nullptr, 0);
+        delete m_trees;
+        m_trees = nullptr;
     }
 
     void SerializedData::swap(SerializedData& other)
     {
-        char* d = other.m_data;
-        const auto sz = other.m_size;
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_trees, other.m_trees);
+        std::swap(m_mapped, other.m_mapped);
+    }
+
+    bool SerializedData::isMapped() const
+    {
+        return m_mapped;
+    }
+
+    BlocksTreeMemory& SerializedData::treesMemory()
+    {
+        if (m_trees == nullptr)
+            m_trees = new BlocksTreeMemory();
+        return *m_trees;
+    }
+
+#ifdef _WIN32
+
+    bool SerializedData::mapFile(const char* _filename)
+    {
+        clear();
+
+        HANDLE file = CreateFileA(_filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+
+        if (mapping == nullptr)
+            return false;
+
+        // View keeps reference to the mapping object, so it can be closed right now
+        void* memory = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+
+        if (memory == nullptr)
+            return false;
 
-        other.m_data = m_data;
-        other.m_size = m_size;
+        m_data = static_cast<char*>(memory);
+        m_size = static_cast<uint64_t>(fileSize.QuadPart);
+        m_mapped = true;
 
-        m_data = d;
-        m_size = sz;
+        return true;
     }
 
-    extern "C" PROFILER_API void release_stats(BlockStatistics*& _stats)
+#else // _WIN32
+
+    bool SerializedData::mapFile(const char* _filename)
     {
-        if (_stats == nullptr)
-            return;
+        clear();
+
+        const int fd = ::open(_filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        const auto fileSize = static_cast<uint64_t>(st.st_size);
+        void* memory = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (memory == MAP_FAILED)
+            return false;
+
+        m_data = static_cast<char*>(memory);
+        m_size = fileSize;
+        m_mapped = true;
+
+        return true;
+    }
 
-        if (--_stats->calls_number == 0)
-            delete _stats;
+#endif // _WIN32
 
+    extern "C" PROFILER_API void release_stats(BlockStatistics*& _stats)
+    {
         _stats = nullptr;
     }
 
-} // end of namespace profiler.
+    extern "C" PROFILER_API BlockStatistics* block_statistics(stats_index_t _index)
+    {
+        return _index != NoStatsIndex ? StatsDirectory::instance().get(_index) : nullptr;
+    }
 
-//////////////////////////////////////////////////////////////////////////
+    static double s_statsPercentiles[STATS_PERCENTILES_NUMBER] = {90., 99., 99.9};
 
-using IdMap = std::unordered_map<profiler::hashed_stdstring, profiler::block_id_t>;
-using CsStatsMap = std::unordered_map<profiler::string_with_hash, Stats>;
+    extern "C" PROFILER_API void set_stats_percentiles(const double* _percentiles)
+    {
+        for (uint8_t i = 0; i < STATS_PERCENTILES_NUMBER; ++i)
+            s_statsPercentiles[i] = estd::clamp(0., _percentiles[i], 100.);
+    }
+
+    extern "C" PROFILER_API double stats_percentile(uint8_t _index)
+    {
+        return _index < STATS_PERCENTILES_NUMBER ? s_statsPercentiles[_index] : 0.;
+    }
+
+} // end of namespace profiler.
 
 //////////////////////////////////////////////////////////////////////////
 
-/** \brief Updates statistics for a profiler block.
+using CsStatsMap = std::unordered_map<profiler::string_with_hash, Stats>;
 
-\param _stats_map Storage of statistics for blocks.
-\param _current Pointer to the current block.
-\param _stats Reference to the variable where pointer to the block statistics must be written.
+EASY_CONSTEXPR uint16_t MaxBlockDepth = std::numeric_limits<uint16_t>::max() - 1; ///< Block depth saturates here (1 more level is reserved for thread root)
+EASY_CONSTEXPR profiler::block_index_t NoParentIndex = std::numeric_limits<profiler::block_index_t>::max(); ///< parent_block of per-thread and top-level statistics
 
-\note All blocks with similar name have the same pointer to statistics information.
+//////////////////////////////////////////////////////////////////////////
 
-\note As all profiler block keeps a pointer to it's statistics, all similar blocks
-automatically receive statistics update.
+/** Open addressing hash table which maps runtime block names to generated block ids.
 
+Names are not copied: the table stores pointers to names inside serialized blocks memory, which outlives the table.
+find() does not modify the table, so it may be called concurrently as long as nobody inserts at the same time.
 */
-static profiler::BlockStatistics* update_statistics(
-    profiler::stats_map_t& _stats_map,
-    const profiler::BlocksTree& _current,
-    profiler::block_index_t _current_index,
-    profiler::block_index_t _parent_index,
-    const profiler::blocks_t& _blocks,
-    bool _calculate_children = true
-) {
-    auto duration = _current.node->duration();
-    //StatsMap::key_type key(_current.node->name());
-    //auto it = _stats_map.find(key);
-    auto it = _stats_map.find(_current.node->id());
-    if (it != _stats_map.end())
+class RuntimeNamesTable EASY_FINAL
+{
+    struct Entry
     {
-        // Update already existing statistics
+        const char*          name; ///< nullptr for an empty slot
+        uint64_t             hash;
+        size_t             length;
+        profiler::block_id_t   id;
+    };
 
-        // write pointer to statistics into output (this is BlocksTree:: per_thread_stats or per_parent_stats or per_frame_stats)
-        auto stats = it->second.stats;
-        auto& durations = it->second.durations;
-        ++durations[duration].count;
+    std::vector<Entry> m_entries; ///< Number of entries is always a power of 2
+    size_t                m_size;
 
-        ++stats->calls_number; // update calls number of this block
-        stats->total_duration += duration; // update summary duration of all block calls
+public:
 
-        if (_calculate_children)
-        {
-            for (auto i : _current.children)
-                stats->total_children_duration += _blocks[i].node->duration();
-        }
+    RuntimeNamesTable() : m_entries(256, Entry {nullptr, 0, 0, 0}), m_size(0)
+    {
+    }
 
-        if (duration > _blocks[stats->max_duration_block].node->duration())
+    /** Calculates FNV-1a hash and length of the name in one pass. */
+    static uint64_t hash(const char* _name, size_t& _length)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        const char* c = _name;
+        for (; *c != 0; ++c)
         {
-            // update max duration
-            stats->max_duration_block = _current_index;
-            //stats->max_duration = duration;
+            h ^= static_cast<uint8_t>(*c);
+            h *= 1099511628211ULL;
         }
 
-        if (duration < _blocks[stats->min_duration_block].node->duration())
+        _length = static_cast<size_t>(c - _name);
+        return h;
+    }
+
+    bool find(const char* _name, size_t _length, uint64_t _hash, profiler::block_id_t& _id) const
+    {
+        const size_t mask = m_entries.size() - 1;
+        for (size_t slot = slotOf(_hash) & mask;; slot = (slot + 1) & mask)
         {
-            // update min duraton
-            stats->min_duration_block = _current_index;
-            //stats->min_duration = duration;
+            const auto& entry = m_entries[slot];
+            if (entry.name == nullptr)
+                return false;
+
+            if (entry.hash == _hash && entry.length == _length && memcmp(entry.name, _name, _length) == 0)
+            {
+                _id = entry.id;
+                return true;
+            }
         }
+    }
 
-        // average duration is calculated inside average_duration() method by dividing total_duration to the calls_number
+    /** Inserts a name which is not in the table yet. */
+    void insert(const char* _name, size_t _length, uint64_t _hash, profiler::block_id_t _id)
+    {
+        if ((m_size + 1) * 2 > m_entries.size())
+            grow();
 
-        return stats;
+        place(Entry {_name, _hash, _length, _id});
+        ++m_size;
     }
 
-    // This is first time the block appear in the file.
-    // Create new statistics.
-    auto stats = new profiler::BlockStatistics(duration, _current_index, _parent_index);
-    //_stats_map.emplace(key, stats);
-    _stats_map.emplace(_current.node->id(), Stats {stats, duration});
+private:
 
-    if (_calculate_children)
+    static size_t slotOf(uint64_t _hash)
     {
-        for (auto i : _current.children)
-            stats->total_children_duration += _blocks[i].node->duration();
+        return static_cast<size_t>(_hash ^ (_hash >> 32));
     }
 
-    return stats;
-}
+    void place(const Entry& _entry)
+    {
+        const size_t mask = m_entries.size() - 1;
+        size_t slot = slotOf(_entry.hash) & mask;
+        while (m_entries[slot].name != nullptr)
+            slot = (slot + 1) & mask;
+        m_entries[slot] = _entry;
+    }
+
+    void grow()
+    {
+        std::vector<Entry> entries(m_entries.size() << 1, Entry {nullptr, 0, 0, 0});
+        entries.swap(m_entries);
+        for (const auto& entry : entries)
+        {
+            if (entry.name != nullptr)
+                place(entry);
+        }
+    }
+
+}; // END of class RuntimeNamesTable.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** \brief Updates statistics for a profiler block.
+
+\param _stats_map Storage of statistics for blocks.
+\param _current Pointer to the current block.
+\returns Index of the block statistics (this is BlocksTree::per_thread_stats_index or per_frame_stats_index).
+
+\note All blocks with similar name have the same index of statistics information.
+
+\note As all profiler block keeps an index of it's statistics, all similar blocks
+automatically receive statistics update.
 
-static profiler::BlockStatistics* update_statistics(
+*/
+static profiler::stats_index_t update_statistics(
     CsStatsMap& _stats_map,
+    StatsArena& _arena,
     const profiler::BlocksTree& _current,
     profiler::block_index_t _current_index,
     profiler::block_index_t _parent_index,
@@ -453,11 +796,10 @@ static profiler::BlockStatistics* update_statistics(
     {
         // Update already existing statistics
 
-        // write pointer to statistics into output (this is BlocksTree:: per_thread_stats or per_parent_stats or per_frame_stats)
         auto stats = it->second.stats;
         auto& durations = it->second.durations;
 
-        ++durations[duration].count;
+        durations.add(duration);
 
         ++stats->calls_number; // update calls number of this block
         stats->total_duration += duration; // update summary duration of all block calls
@@ -484,13 +826,14 @@ static profiler::BlockStatistics* update_statistics(
 
         // average duration is calculated inside average_duration() method by dividing total_duration to the calls_number
 
-        return stats;
+        return it->second.index;
     }
 
     // This is first time the block appear in the file.
     // Create new statistics.
-    auto stats = new profiler::BlockStatistics(duration, _current_index, _parent_index);
-    _stats_map.emplace(key, Stats {stats, duration});
+    profiler::BlockStatistics* stats = nullptr;
+    const auto index = _arena.allocate(duration, _current_index, _parent_index, stats);
+    _stats_map.emplace(key, Stats {stats, index, duration});
 
     if (_calculate_children)
     {
@@ -498,184 +841,755 @@ static profiler::BlockStatistics* update_statistics(
             stats->total_children_duration += _blocks[i].node->duration();
     }
 
-    return stats;
+    return index;
+}
+
+/** \brief Calculates median and percentiles of block durations.
+
+\param _quantiles Array of STATS_PERCENTILES_NUMBER quantiles in range [0, 1] (see stats_percentile()).
+*/
+static void calculate_percentiles(profiler::BlockStatistics& _stats, profiler::QuantileSketch& _durations, const double* _quantiles)
+{
+    _stats.median_duration = _durations.median();
+    for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+        _stats.percentile_durations[i] = _durations.quantile(_quantiles[i]);
 }
 
-template <class TStatsMapIterator>
-static void calculate_medians(TStatsMapIterator begin, TStatsMapIterator end)
+static void calculate_percentiles(CsStatsMap& _stats_map, const double* _quantiles)
 {
-    for (auto it = begin; it != end; ++it)
+    for (auto& kv : _stats_map)
     {
-        auto& durations = it->second.durations;
+        auto& durations = kv.second.durations;
         if (durations.empty())
         {
             continue;
         }
 
-        size_t total_count = 0;
-        for (auto& kv : durations)
-        {
-            total_count += kv.second.count;
-        }
+        calculate_percentiles(*kv.second.stats, durations, _quantiles);
 
-        auto stats = it->second.stats;
-        if (total_count & 1)
-        {
-            const auto index = total_count >> 1;
-            size_t i = 0;
-            for (auto& kv : durations)
-            {
-                const auto count = kv.second.count;
+        decltype(kv.second.durations) dummy;
+        std::swap(dummy, durations);
+    }
+}
 
-                i += count;
-                if (i < index)
-                {
-                    continue;
-                }
+//////////////////////////////////////////////////////////////////////////
 
-                stats->median_duration = kv.first;
-                break;
-            }
-        }
-        else
-        {
-            const auto index2 = total_count >> 1;
-            const auto index1 = index2 - 1;
+//////////////////////////////////////////////////////////////////////////
 
-            size_t i = 0;
-            bool i1 = false;
-            for (auto& kv : durations)
-            {
-                const auto count = kv.second.count;
+static bool update_progress(std::atomic<int>& progress, int new_value, std::ostream& _log)
+{
+    auto oldprogress = progress.exchange(new_value, std::memory_order_release);
+    if (oldprogress < 0)
+    {
+        _log << "Reading was interrupted";
+        return false;
+    }
 
-                i += count;
-                if (i < index1)
-                {
-                    continue;
-                }
+    return true;
+}
 
-                if (!i1)
-                {
-                    i1 = true;
-                    stats->median_duration = kv.first;
-                }
+//////////////////////////////////////////////////////////////////////////
 
-                if (i < index2)
-                {
-                    continue;
-                }
+/** Part of the thread data in the file: context switches and blocks lists.
+
+Each record in the lists is block size (uint16_t) followed by block data.
+*/
+struct ThreadSection
+{
+    char*                           cs = nullptr; ///< First context switch record
+    char*                       blocks = nullptr; ///< First block record
+    uint64_t                     cs_number = 0;
+    uint64_t                 blocks_number = 0;
+    uint64_t                          size = 0; ///< Size of blocks data (used for progress)
+    profiler::block_index_t    first_index = 0; ///< Index of the first block of the section in the blocks list
+    profiler::block_index_t   blocks_index = 0; ///< Index of the first block after context switches
+    profiler::block_index_t      end_index = 0; ///< Index after the last block of the section
+};
 
-                stats->median_duration += kv.first;
-                stats->median_duration >>= 1;
+struct ThreadTask
+{
+    profiler::BlocksTreeRoot*      root = nullptr;
+    std::vector<ThreadSection> sections;
+};
 
-                break;
-            }
-        }
+struct TimeConversion
+{
+    profiler::timestamp_t begin_time;
+    uint64_t          cpu_frequency;
+    double        conversion_factor;
+    bool                    enabled;
+};
+
+/** Records which are loaded.
+
+Raw time values of the records (as stored in the file) are compared, see first_ticks_after().
+*/
+struct RecordsFilter
+{
+    profiler::timestamp_t    first_cs_end; ///< Context switches which end before it are skipped
+    profiler::timestamp_t first_block_end; ///< Blocks which end before it are skipped
+    profiler::timestamp_t      last_begin; ///< Records which begin at or after it are skipped
+
+    bool passesCSwitch(const char* _data) const
+    {
+        return unaligned_load64<profiler::timestamp_t>(_data + sizeof(profiler::timestamp_t)) >= first_cs_end &&
+               unaligned_load64<profiler::timestamp_t>(_data) < last_begin;
+    }
+
+    bool passesBlock(const char* _data) const
+    {
+        return unaligned_load64<profiler::timestamp_t>(_data + sizeof(profiler::timestamp_t)) >= first_block_end &&
+               unaligned_load64<profiler::timestamp_t>(_data) < last_begin;
+    }
+};
+
+/** Returns the least ticks value which is converted to nanoseconds greater than (or equal to, if _inclusive) _time.
+
+Conversion is monotonic, so the sequential reading pass compares raw ticks with the result
+instead of converting each block. Conversion itself is done by workers (see buildThreadTree()).
+
+\param _hint Ticks value which is converted to about _time.
+*/
+static profiler::timestamp_t first_ticks_after(profiler::timestamp_t _time, bool _inclusive, profiler::timestamp_t _hint,
+                                               const TimeConversion& _conversion)
+{
+    if (!_conversion.enabled)
+        return _inclusive ? _time : _time + 1;
 
-        decltype(it->second.durations) dummy;
-        dummy.swap(durations);
+    const auto passes = [&] (profiler::timestamp_t ticks) -> bool
+    {
+        EASY_CONVERT_TO_NANO(ticks, _conversion.cpu_frequency, _conversion.conversion_factor);
+        return _inclusive ? ticks >= _time : ticks > _time;
+    };
+
+    profiler::timestamp_t lo = 0, hi = std::max(_hint, profiler::timestamp_t(1));
+    while (!passes(hi))
+    {
+        lo = hi;
+        hi <<= 1;
+    }
+
+    while (lo < hi)
+    {
+        const auto mid = lo + ((hi - lo) >> 1);
+        if (passes(mid))
+            hi = mid;
+        else
+            lo = mid + 1;
     }
+
+    return lo;
 }
 
-template <class TStatsMap>
-static void calculate_medians_async(ReaderThreadPool& pool, TStatsMap& stats_map)
+static char* nextRecord(char*& record)
 {
-    if (stats_map.empty())
+    const auto size = unaligned_load16<uint16_t>(record);
+    char* data = record + sizeof(uint16_t);
+    record = data + size;
+    return data;
+}
+
+static void convert_times_scalar(profiler::timestamp_t* _times, size_t _size, const TimeConversion& _time,
+                                 profiler::timestamp_t _min)
+{
+    for (size_t i = 0; i < _size; ++i)
     {
-        return;
+        auto t = _times[i];
+        if (_time.enabled)
+        {
+            EASY_CONVERT_TO_NANO(t, _time.cpu_frequency, _time.conversion_factor);
+        }
+        _times[i] = t < _min ? _min : t;
     }
+}
+
+#if defined(EASY_CONVERT_TIMES_AVX2) && defined(EASY_USE_FLOATING_POINT_CONVERSION)
+/** AVX2 version of convert_times_scalar() for enabled conversion.
 
-    if (stats_map.size() < 1000)
+Results are exactly the same as of the scalar code: uint64 -> double conversion rounds to nearest
+and double -> uint64 conversion truncates. AVX2 has no such conversions, so both are done with
+32-bit halves placed into mantissas of large powers of 2.
+*/
+__attribute__((target("avx2")))
+static void convert_times_avx2(profiler::timestamp_t* _times, size_t _size, const TimeConversion& _time,
+                               profiler::timestamp_t _min)
+{
+    const __m256d factor = _mm256_set1_pd(_time.conversion_factor);
+    const __m256d p32 = _mm256_set1_pd(4294967296.); // 2^32
+    const __m256d inv_p32 = _mm256_set1_pd(1. / 4294967296.);
+    const __m256d p52 = _mm256_set1_pd(4503599627370496.); // 2^52
+    const __m256d p84 = _mm256_set1_pd(19342813113834066795298816.); // 2^84
+    const __m256d p84_52 = _mm256_set1_pd(19342813118337666422669312.); // 2^84 + 2^52
+    const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+    const __m256i min = _mm256_set1_epi64x(static_cast<long long>(_min));
+    const __m256i min_biased = _mm256_xor_si256(min, sign);
+
+    size_t i = 0;
+    for (; i + 4 <= _size; i += 4)
+    {
+        const __m256i ticks = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_times + i));
+
+        // uint64 -> double: (2^84 + high * 2^32) - (2^84 + 2^52) + (2^52 + low) is rounded only once
+        const __m256i high = _mm256_or_si256(_mm256_srli_epi64(ticks, 32), _mm256_castpd_si256(p84));
+        const __m256i low = _mm256_blend_epi32(ticks, _mm256_castpd_si256(p52), 0xaa);
+        const __m256d value = _mm256_add_pd(_mm256_sub_pd(_mm256_castsi256_pd(high), p84_52), _mm256_castsi256_pd(low));
+
+        // double -> uint64: truncated integer value is split into exact 32-bit halves, mantissas of (2^52 + half) are the halves
+        const __m256d ns = _mm256_round_pd(_mm256_mul_pd(value, factor), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __m256d ns_high = _mm256_floor_pd(_mm256_mul_pd(ns, inv_p32));
+        const __m256d ns_low = _mm256_sub_pd(ns, _mm256_mul_pd(ns_high, p32));
+        const __m256i result_high = _mm256_xor_si256(_mm256_castpd_si256(_mm256_add_pd(ns_high, p52)), _mm256_castpd_si256(p52));
+        const __m256i result_low = _mm256_xor_si256(_mm256_castpd_si256(_mm256_add_pd(ns_low, p52)), _mm256_castpd_si256(p52));
+        const __m256i result = _mm256_or_si256(_mm256_slli_epi64(result_high, 32), result_low);
+
+        // Unsigned comparison with _min
+        const __m256i less = _mm256_cmpgt_epi64(min_biased, _mm256_xor_si256(result, sign));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_times + i), _mm256_blendv_epi8(result, min, less));
+    }
+
+    convert_times_scalar(_times + i, _size - i, _time, _min);
+}
+#endif
+
+/** Converts ticks to nanoseconds (if conversion is enabled) and raises values which are less than _min to _min.
+
+Uses AVX2 if it is supported by CPU. Other platforms use the scalar loop, which can be vectorized by compiler
+(for example, AArch64 has vector conversions between uint64 and double).
+*/
+static void convert_times(profiler::timestamp_t* _times, size_t _size, const TimeConversion& _time,
+                          profiler::timestamp_t _min)
+{
+#if defined(EASY_CONVERT_TIMES_AVX2) && defined(EASY_USE_FLOATING_POINT_CONVERSION)
+    static const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+    if (_time.enabled && avx2)
     {
-        calculate_medians(stats_map.begin(), stats_map.end());
+        convert_times_avx2(_times, _size, _time, _min);
         return;
     }
+#endif
+
+    convert_times_scalar(_times, _size, _time, _min);
+}
+
+EASY_CONSTEXPR size_t ConvertBatchSize = 1024; ///< Number of records which times are converted at once
+
+/** Records of one thread section are processed by batches in three stages:
+decode (records which pass the filter are found and their times are copied into contiguous arrays),
+convert (see convert_times()) and tree-build.
+*/
+struct RecordsBatch
+{
+    char*                            records[ConvertBatchSize];
+    profiler::timestamp_t             begins[ConvertBatchSize];
+    profiler::timestamp_t               ends[ConvertBatchSize];
+    size_t                                                 size = 0;
+
+    /** Decodes next records starting from _record, until the batch is full or _number records are visited.
+
+    \param _record Next record, is advanced.
+    \param _visited Number of visited records, is advanced.
+    */
+    template <class TFilter>
+    void decode(char*& _record, uint64_t _number, uint64_t& _visited, TFilter _passes)
+    {
+        size = 0;
+        for (; _visited < _number && size < ConvertBatchSize; ++_visited)
+        {
+            char* data = nextRecord(_record);
+            if (!_passes(data))
+                continue;
+
+            records[size] = data;
+            begins[size] = unaligned_load64<profiler::timestamp_t>(data);
+            ends[size] = unaligned_load64<profiler::timestamp_t>(data + sizeof(profiler::timestamp_t));
+            ++size;
+        }
+    }
+
+    /** Converts times of the batch and writes them back into records. Begin times are clamped to _time.begin_time. */
+    void convert(const TimeConversion& _time)
+    {
+        convert_times(begins, size, _time, _time.begin_time);
+        convert_times(ends, size, _time, 0);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            unaligned_store64(records[i], begins[i]);
+            unaligned_store64(records[i] + sizeof(profiler::timestamp_t), ends[i]);
+        }
+    }
+};
+
+/** Build tree of one thread section which was already read and validated by fillTreesFromData().
+
+Is executed by worker thread. Blocks of the section are placed into their own range of blocks list
+starting from _section.first_index, so workers of different threads never touch the same blocks.
+Blocks statistics are calculated later, for the whole tree at once (see gather_thread_statistics()).
+
+\retval false if loading was interrupted.
+*/
+static bool buildThreadTree(profiler::BlocksTreeRoot& root, const ThreadSection& _section, profiler::blocks_t& blocks,
+                            profiler::block_indices_t& _children, StatsArena& _arena,
+                            const profiler::descriptors_list_t& descriptors, const TimeConversion& _time,
+                            const RecordsFilter& _filter, bool gather_statistics, const double* _quantiles,
+                            const std::atomic_bool& interrupted)
+{
+    auto block_index = _section.first_index;
+
+    CsStatsMap per_thread_statistics_cs;
+
+    std::unique_ptr<RecordsBatch> batch(new RecordsBatch());
+
+    auto record = _section.cs;
+    for (uint64_t k = 0; k < _section.cs_number;)
+    {
+        // Records are filtered exactly as in the sequential reading pass, so blocks indices are the same
+        batch->decode(record, _section.cs_number, k, [&_filter] (const char* data) { return _filter.passesCSwitch(data); });
+        batch->convert(_time);
+
+        for (size_t i = 0; i < batch->size; ++i)
+        {
+            auto baseData = reinterpret_cast<profiler::SerializedCSwitch*>(batch->records[i]);
+
+            profiler::BlocksTree& tree = blocks[block_index];
+            tree.cs = baseData;
 
-    const auto threads_count = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), stats_map.size());
-    const auto count_per_thread = stats_map.size() / threads_count;
+            root.wait_time += baseData->duration();
+            root.sync.emplace_back(block_index);
 
-    std::vector<async_future> results;
-    results.reserve(threads_count);
+            if (gather_statistics)
+                tree.per_thread_stats_index = update_statistics(per_thread_statistics_cs, _arena, tree, block_index, NoParentIndex, blocks);
 
-    for (size_t i = 1; i <= threads_count; ++i)
+            ++block_index;
+        }
+
+        if (interrupted.load(std::memory_order_acquire))
+            return false;
+    }
+
+    // calculate medians and percentiles for each block
+    calculate_percentiles(per_thread_statistics_cs, _quantiles);
+
+    record = _section.blocks;
+    for (uint64_t k = 0; k < _section.blocks_number;)
     {
-        results.emplace_back(pool.async([i, threads_count, count_per_thread, &stats_map] () -> async_result_t
+        batch->decode(record, _section.blocks_number, k, [&_filter] (const char* data) { return _filter.passesBlock(data); });
+        batch->convert(_time);
+
+        for (size_t i = 0; i < batch->size; ++i)
         {
-            auto begin = stats_map.begin();
-            const auto advance_count = (i - 1) * count_per_thread;
-            std::advance(begin, advance_count);
+            auto baseData = reinterpret_cast<profiler::SerializedBlock*>(batch->records[i]);
+
+            profiler::BlocksTree& tree = blocks[block_index];
+            tree.node = baseData;
 
-            auto end = begin;
-            if (i == threads_count)
+            if (!root.children.empty())
             {
-                end = stats_map.end();
+                auto& back = blocks[root.children.back()];
+                auto t1 = back.node->end();
+                auto mt0 = tree.node->begin();
+                if (mt0 < t1)//parent - starts earlier than last ends
+                {
+                    auto rlower1 = ++root.children.rbegin();
+                    for (; rlower1 != root.children.rend() && mt0 <= blocks[*rlower1].node->begin(); ++rlower1);
+                    auto lower = rlower1.base();
+
+                    // _children has enough capacity for all blocks of the thread, so pointers to it are never invalidated
+                    const auto first_child = _children.size();
+                    _children.insert(_children.end(), lower, root.children.end());
+                    tree.children = profiler::BlockIndicesRange(_children.data() + first_child,
+                                                                static_cast<profiler::block_index_t>(_children.size() - first_child));
+
+                    root.children.erase(lower, root.children.end());
+
+                    for (auto child_block_index : tree.children)
+                    {
+                        const auto& child = blocks[child_block_index];
+                        if (tree.depth < child.depth)
+                            tree.depth = child.depth;
+                    }
+
+                    if (tree.depth < MaxBlockDepth)
+                        ++tree.depth;
+                }
             }
-            else
+
+            ++root.blocks_number;
+            root.children.emplace_back(block_index);
+            if (descriptors[baseData->id()]->type() != profiler::BlockType::Block)
+                root.events.emplace_back(block_index);
+
+            ++block_index;
+        }
+
+        if (interrupted.load(std::memory_order_acquire))
+            return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+using StatsIndexPointer = profiler::stats_index_t profiler::BlocksTree::*;
+
+EASY_CONSTEXPR uint32_t NoStatsSlot = std::numeric_limits<uint32_t>::max();
+
+/** Accumulates statistics of one group of blocks (all blocks of the thread, children of one parent or blocks of one frame).
+
+Blocks are added in the order of their appearance in the group. Durations of each block id are collected
+into QuantileSketch, so medians and percentiles are found when the group is finished.
+
+\note All blocks with similar id within the group have the same index of statistics information.
+*/
+class StatsGroup EASY_FINAL
+{
+    struct Slot
+    {
+        profiler::QuantileSketch   durations;
+        profiler::BlockStatistics*     stats = nullptr;
+        profiler::stats_index_t        index = profiler::NoStatsIndex;
+        profiler::timestamp_t   min_duration = 0;
+        profiler::timestamp_t   max_duration = 0;
+        profiler::block_id_t              id = 0;
+    };
+
+    std::vector<Slot>               m_slots;
+    std::vector<uint32_t>     m_slotIndices; ///< Index of the slot for each block id
+    profiler::blocks_t&            m_blocks;
+    StatsArena&                     m_arena;
+    const double*               m_quantiles; ///< Quantiles of BlockStatistics::percentile_durations
+    profiler::block_index_t        m_parent;
+    uint32_t                     m_usedSlots;
+
+public:
+
+    StatsGroup(profiler::blocks_t& _blocks, StatsArena& _arena, size_t _descriptorsCount, const double* _quantiles)
+        : m_slotIndices(_descriptorsCount, NoStatsSlot)
+        , m_blocks(_blocks)
+        , m_arena(_arena)
+        , m_quantiles(_quantiles)
+        , m_parent(NoParentIndex)
+        , m_usedSlots(0)
+    {
+    }
+
+    void begin(profiler::block_index_t _parent)
+    {
+        m_parent = _parent;
+    }
+
+    void add(profiler::block_index_t _index, StatsIndexPointer _stats)
+    {
+        auto& block = m_blocks[_index];
+        const auto duration = block.node->duration();
+
+        auto& slot_index = m_slotIndices[block.node->id()];
+        if (slot_index == NoStatsSlot)
+        {
+            // This is first time the block appear in the group.
+            slot_index = m_usedSlots++;
+            if (m_slots.size() < m_usedSlots)
+                m_slots.emplace_back();
+
+            auto& slot = m_slots[slot_index];
+            slot.index = m_arena.allocate(duration, _index, m_parent, slot.stats);
+            slot.min_duration = slot.max_duration = duration;
+            slot.id = block.node->id();
+        }
+        else
+        {
+            auto& slot = m_slots[slot_index];
+            auto stats = slot.stats;
+
+            ++stats->calls_number;
+            stats->total_duration += duration;
+
+            if (duration > slot.max_duration)
+            {
+                slot.max_duration = duration;
+                stats->max_duration_block = _index;
+            }
+
+            if (duration < slot.min_duration)
             {
-                std::advance(end, count_per_thread);
+                slot.min_duration = duration;
+                stats->min_duration_block = _index;
             }
+        }
+
+        auto& slot = m_slots[slot_index];
+        slot.durations.add(duration);
 
-            calculate_medians(begin, end);
+        for (auto i : block.children)
+            slot.stats->total_children_duration += m_blocks[i].node->duration();
 
-            EASY_FINISH_ASYNC; // MSVC 2013 hack
-        }));
+        block.*_stats = slot.index;
     }
 
-    for (auto& result : results)
+    void finish()
     {
-        if (result.valid())
+        for (uint32_t i = 0; i < m_usedSlots; ++i)
         {
-            result.get();
+            auto& slot = m_slots[i];
+            calculate_percentiles(*slot.stats, slot.durations, m_quantiles);
+            slot.durations.clear();
+            m_slotIndices[slot.id] = NoStatsSlot;
         }
+
+        m_usedSlots = 0;
     }
-}
 
-//////////////////////////////////////////////////////////////////////////
+}; // END of class StatsGroup.
+
+/** Calculates per-thread, per-parent and per-frame statistics of all blocks of the thread.
 
-static void update_statistics_recursive(profiler::stats_map_t& _stats_map, profiler::BlocksTree& _current, profiler::block_index_t _current_index, profiler::block_index_t _parent_index, profiler::blocks_t& _blocks)
+Is executed by worker thread after the tree of the thread was built.
+*/
+static void gather_thread_statistics(profiler::BlocksTreeRoot& root, const std::vector<ThreadSection>& _sections,
+                                     profiler::blocks_t& blocks, StatsArena& arena, size_t descriptors_count,
+                                     const double* quantiles)
 {
-    _current.per_frame_stats = update_statistics(_stats_map, _current, _current_index, _parent_index, _blocks, false);
-    for (auto i : _current.children)
+    StatsGroup thread_group(blocks, arena, descriptors_count, quantiles);
+    StatsGroup frame_group(blocks, arena, descriptors_count, quantiles);
+    StatsGroup parent_group(blocks, arena, descriptors_count, quantiles);
+
+    // Thread blocks (except context switches) occupy contiguous ranges of the blocks list
+    for (const auto& section : _sections)
     {
-        _current.per_frame_stats->total_children_duration += _blocks[i].node->duration();
-        update_statistics_recursive(_stats_map, _blocks[i], i, _parent_index, _blocks);
+        for (auto i = section.blocks_index; i < section.end_index; ++i)
+            thread_group.add(i, &profiler::BlocksTree::per_thread_stats_index);
+    }
+
+    thread_group.finish();
+
+    // Top-level blocks are "children" of the thread
+    for (auto frame_index : root.children)
+        parent_group.add(frame_index, &profiler::BlocksTree::per_parent_stats_index);
+    parent_group.finish();
+
+    std::vector<profiler::block_index_t> stack;
+    for (auto frame_index : root.children)
+    {
+        // Iterative pre-order traversal: stack depth is limited only by the number of blocks, not by the call stack.
+        frame_group.begin(frame_index);
+        stack.push_back(frame_index);
+
+        while (!stack.empty())
+        {
+            const auto current_index = stack.back();
+            stack.pop_back();
+
+            frame_group.add(current_index, &profiler::BlocksTree::per_frame_stats_index);
+
+            const auto& children = blocks[current_index].children;
+            if (!children.empty())
+            {
+                parent_group.begin(current_index);
+                for (auto i : children)
+                    parent_group.add(i, &profiler::BlocksTree::per_parent_stats_index);
+                parent_group.finish();
+
+                stack.insert(stack.end(), children.rbegin(), children.rend());
+            }
+        }
+
+        frame_group.finish();
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
 
-static bool update_progress(std::atomic<int>& progress, int new_value, std::ostream& _log)
+/** Sequential reader of the file mapped into memory (see SerializedData::mapFile()).
+
+Has the same reading interface as std::istream, but blocks data is not copied:
+BlocksTree::node points directly into the mapping.
+*/
+class MappedFileStream EASY_FINAL
 {
-    auto oldprogress = progress.exchange(new_value, std::memory_order_release);
-    if (oldprogress < 0)
+    char*         m_begin;
+    char*        m_cursor;
+    const char*     m_end;
+    bool            m_eof;
+
+public:
+
+    explicit MappedFileStream(profiler::SerializedData& _mapping)
+        : m_begin(_mapping.data())
+        , m_cursor(_mapping.data())
+        , m_end(_mapping.data() + _mapping.size())
+        , m_eof(false)
     {
-        _log << "Reading was interrupted";
-        return false;
     }
 
-    return true;
-}
+    bool eof() const
+    {
+        return m_eof;
+    }
+
+    char* cursor() const
+    {
+        return m_cursor;
+    }
+
+    /** Move cursor to _offset from the beginning of the file.
+
+    \retval false if _offset is out of file.
+    */
+    bool seek(uint64_t _offset)
+    {
+        if (_offset > static_cast<uint64_t>(m_end - m_begin))
+            return false;
+
+        m_cursor = m_begin + _offset;
+        m_eof = false;
+        return true;
+    }
+
+    /** Returns pointer to the next _size bytes and moves cursor forward.
+
+    \retval nullptr if there is not enough data till the end of file.
+    */
+    char* skip(size_t _size)
+    {
+        if (static_cast<size_t>(m_end - m_cursor) < _size)
+        {
+            m_cursor = const_cast<char*>(m_end);
+            m_eof = true;
+            return nullptr;
+        }
+
+        auto data = m_cursor;
+        m_cursor += _size;
+        return data;
+    }
+
+    void read(char* _value, size_t _size)
+    {
+        const auto data = skip(_size);
+        if (data != nullptr)
+            memcpy(_value, data, _size);
+    }
+
+}; // END of class MappedFileStream.
 
 //////////////////////////////////////////////////////////////////////////
 
-static void read(std::istream& inStream, char* value, size_t size)
+template <class TStream>
+static void read(TStream& inStream, char* value, size_t size)
 {
     inStream.read(value, size);
 }
 
-template <class T>
-static void read(std::istream& inStream, T& value)
+template <class TStream, class T>
+static void read(TStream& inStream, T& value)
 {
     read(inStream, (char*)&value, sizeof(T));
 }
 
-static bool tryReadMarker(std::istream& inStream, uint32_t& marker)
+static void reserveBlocksMemory(std::istream&, profiler::SerializedData& serialized_blocks, uint64_t memory_size, uint64_t blocks_count)
+{
+    // Blocks are stored together with their sizes, exactly as in the file
+    serialized_blocks.set(memory_size + blocks_count * sizeof(uint16_t));
+}
+
+static void reserveBlocksMemory(MappedFileStream&, profiler::SerializedData&, uint64_t, uint64_t)
+{
+    // Blocks stay in the mapped file
+}
+
+/** Read serialized block or context switch data of size _size.
+
+Size of the data is always stored right before the data, so blocks could be iterated later without the stream.
+
+\retval nullptr if there is not enough data.
+*/
+static char* readBlockData(std::istream& inStream, profiler::SerializedData& serialized_blocks, uint64_t& offset, uint16_t size)
+{
+    if (offset + sizeof(uint16_t) + size > serialized_blocks.size())
+        return nullptr;
+
+    unaligned_store16(serialized_blocks[offset], size);
+    char* data = serialized_blocks[offset + sizeof(uint16_t)];
+    read(inStream, data, size);
+    offset += sizeof(uint16_t) + size;
+
+    return data;
+}
+
+static char* readBlockData(MappedFileStream& inStream, profiler::SerializedData&, uint64_t&, uint16_t size)
+{
+    return inStream.skip(size);
+}
+
+static void skipBlockData(std::istream& inStream, uint16_t size)
+{
+    inStream.ignore(size);
+}
+
+static void skipBlockData(MappedFileStream& inStream, uint16_t size)
+{
+    inStream.skip(size);
+}
+
+/** Streams are read sequentially, only mapped file can be read at random positions (using the file index).
+*/
+static bool isSeekable(const std::istream&)
+{
+    return false;
+}
+
+static bool isSeekable(const MappedFileStream&)
+{
+    return true;
+}
+
+static bool seek(std::istream&, uint64_t)
+{
+    return false;
+}
+
+static bool seek(MappedFileStream& inStream, uint64_t offset)
+{
+    return inStream.seek(offset);
+}
+
+static const char* cursor(const std::istream&)
+{
+    return nullptr;
+}
+
+static const char* cursor(const MappedFileStream& inStream)
+{
+    return inStream.cursor();
+}
+
+/** Read number of blocks (total or per thread) which was 32-bit before v2.2.0.
+*/
+template <class TStream>
+static void readBlocksCount(TStream& inStream, uint32_t _version, uint64_t& _count)
+{
+    if (_version < EASY_V_220)
+    {
+        uint32_t count32 = 0;
+        read(inStream, count32);
+        _count = count32;
+    }
+    else
+    {
+        read(inStream, _count);
+    }
+}
+
+template <class TStream>
+static bool tryReadMarker(TStream& inStream, uint32_t& marker)
 {
     read(inStream, marker);
     return marker == EASY_PROFILER_SIGNATURE;
 }
 
-static bool tryReadMarker(std::istream& inStream)
+template <class TStream>
+static bool tryReadMarker(TStream& inStream)
 {
     uint32_t marker = 0;
     return tryReadMarker(inStream, marker);
@@ -693,14 +1607,15 @@ struct EasyFileHeader
     profiler::timestamp_t end_time = 0;
     uint64_t memory_size = 0;
     uint64_t descriptors_memory_size = 0;
-    uint32_t blocks_count = 0;
+    uint64_t blocks_count = 0;
     uint32_t descriptors_count = 0;
     uint32_t threads_count = 0;
     uint16_t bookmarks_count = 0;
     uint16_t padding = 0;
 };
 
-static bool readHeader_v1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+template <class TStream>
+static bool readHeader_v1(EasyFileHeader& _header, TStream& inStream, std::ostream& _log)
 {
     // File header before v2.0.0
 
@@ -722,7 +1637,7 @@ static bool readHeader_v1(EasyFileHeader& _header, std::istream& inStream, std::
     read(inStream, _header.begin_time);
     read(inStream, _header.end_time);
 
-    read(inStream, _header.blocks_count);
+    readBlocksCount(inStream, _header.version, _header.blocks_count);
     if (_header.blocks_count == 0)
     {
         _log << "Profiled blocks number == 0";
@@ -753,7 +1668,8 @@ static bool readHeader_v1(EasyFileHeader& _header, std::istream& inStream, std::
     return true;
 }
 
-static bool readHeader_v2(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+template <class TStream>
+static bool readHeader_v2(EasyFileHeader& _header, TStream& inStream, std::ostream& _log)
 {
     // File header after v2.0.0
 
@@ -776,7 +1692,7 @@ static bool readHeader_v2(EasyFileHeader& _header, std::istream& inStream, std::
         return false;
     }
 
-    read(inStream, _header.blocks_count);
+    readBlocksCount(inStream, _header.version, _header.blocks_count);
     if (_header.blocks_count == 0)
     {
         _log << "Profiled blocks number == 0";
@@ -793,7 +1709,8 @@ static bool readHeader_v2(EasyFileHeader& _header, std::istream& inStream, std::
     return true;
 }
 
-static bool readHeader_v2_1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+template <class TStream>
+static bool readHeader_v2_1(EasyFileHeader& _header, TStream& inStream, std::ostream& _log)
 {
     if (!readHeader_v2(_header, inStream, _log))
         return false;
@@ -817,108 +1734,170 @@ static bool readHeader_v2_1(EasyFileHeader& _header, std::istream& inStream, std
     return true;
 }
 
-//////////////////////////////////////////////////////////////////////////
-
-extern "C" PROFILER_API profiler::block_index_t fillTreesFromFile(std::atomic<int>& progress, const char* filename,
-                                                                  profiler::BeginEndTime& begin_end_time,
-                                                                  profiler::SerializedData& serialized_blocks,
-                                                                  profiler::SerializedData& serialized_descriptors,
-                                                                  profiler::descriptors_list_t& descriptors,
-                                                                  profiler::blocks_t& blocks,
-                                                                  profiler::thread_blocks_tree_t& threaded_trees,
-                                                                  profiler::bookmarks_t& bookmarks,
-                                                                  uint32_t& descriptors_count,
-                                                                  uint32_t& version,
-                                                                  profiler::processid_t& pid,
-                                                                  bool gather_statistics,
-                                                                  std::ostream& _log)
+/** Read file version and the rest of the header which follows the signature.
+*/
+template <class TStream>
+static bool readHeader(EasyFileHeader& _header, TStream& inStream, std::ostream& _log)
 {
-    if (!update_progress(progress, 0, _log))
+    read(inStream, _header.version);
+    if (!isCompatibleVersion(_header.version))
     {
-        return 0;
+        const auto version = _header.version;
+        _log << "Incompatible version: v"
+             << (version >> 24) << "." << ((version & 0x00ff0000) >> 16) << "." << (version & 0x0000ffff);
+        return false;
     }
 
-    std::ifstream inFile(filename, std::fstream::binary);
-    if (!inFile.is_open())
+    if (_header.version < EASY_V_200)
     {
-        _log << "Can not open file " << filename;
-        return 0;
+        if (!readHeader_v1(_header, inStream, _log))
+            return false;
+        _header.threads_count = std::numeric_limits<decltype(_header.threads_count)>::max();
+    }
+    else if (_header.version < EASY_V_210)
+    {
+        if (!readHeader_v2(_header, inStream, _log))
+            return false;
+        _header.threads_count = std::numeric_limits<decltype(_header.threads_count)>::max();
+    }
+    else
+    {
+        if (!readHeader_v2_1(_header, inStream, _log))
+            return false;
     }
 
-    // Read data from file
-    auto result = fillTreesFromStream(progress, inFile, begin_end_time, serialized_blocks, serialized_descriptors,
-                                      descriptors, blocks, threaded_trees, bookmarks, descriptors_count, version, pid,
-                                      gather_statistics, _log);
-
-    return result;
+    return true;
 }
 
-//////////////////////////////////////////////////////////////////////////
-
-extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<int>& progress, std::istream& inStream,
-                                                                    profiler::BeginEndTime& begin_end_time,
-                                                                    profiler::SerializedData& serialized_blocks,
-                                                                    profiler::SerializedData& serialized_descriptors,
-                                                                    profiler::descriptors_list_t& descriptors,
-                                                                    profiler::blocks_t& blocks,
-                                                                    profiler::thread_blocks_tree_t& threaded_trees,
-                                                                    profiler::bookmarks_t& bookmarks,
-                                                                    uint32_t& descriptors_count,
-                                                                    uint32_t& version,
-                                                                    profiler::processid_t& pid,
-                                                                    bool gather_statistics,
-                                                                    std::ostream& _log)
+template <class TStream>
+static bool readBookmark(profiler::Bookmark& bookmark, std::vector<char>& stringBuffer, TStream& inStream, std::ostream& _log)
 {
-    EASY_FUNCTION(profiler::colors::Cyan);
+    uint16_t usedMemorySize = 0;
+    read(inStream, usedMemorySize);
+    read(inStream, bookmark.pos);
+    read(inStream, bookmark.color);
 
-    if (!update_progress(progress, 0, _log))
+    if (usedMemorySize < profiler::Bookmark::BaseSize)
     {
-        return 0;
+        _log << "Bad bookmark size: " << usedMemorySize
+             << ", which is less than Bookmark::BaseSize: "
+             << profiler::Bookmark::BaseSize;
+        return false;
     }
 
-    uint32_t signature = 0;
-    if (!tryReadMarker(inStream, signature))
+    usedMemorySize -= static_cast<uint16_t>(profiler::Bookmark::BaseSize) - 1;
+    if (usedMemorySize > 0)
     {
-        _log << "Wrong signature " << signature << ".\nThis is not EasyProfiler file/stream.";
-        return 0;
-    }
+        stringBuffer.resize(usedMemorySize);
+        read(inStream, stringBuffer.data(), usedMemorySize);
 
-    version = 0;
-    read(inStream, version);
-    if (!isCompatibleVersion(version))
-    {
-        _log << "Incompatible version: v"
-             << (version >> 24) << "." << ((version & 0x00ff0000) >> 16) << "." << (version & 0x0000ffff);
-        return 0;
-    }
+        if (stringBuffer.back() != 0)
+        {
+            stringBuffer.resize(stringBuffer.size() + 1);
+            stringBuffer.back() = 0;
 
-    EasyFileHeader header;
-    header.signature = signature;
-    header.version = version;
+            _log << "Bad bookmark description:\n\"" << const_cast<const char*>(stringBuffer.data())
+                << "\"\nWhich is not zero terminated string.\nLast symbol is: '"
+                << const_cast<const char*>(stringBuffer.data() + stringBuffer.size() - 2) << "'";
 
-    if (version < EASY_V_200)
-    {
-        if (!readHeader_v1(header, inStream, _log))
-            return 0;
-        header.threads_count = std::numeric_limits<decltype(header.threads_count)>::max();
+            return false;
+        }
+
+        if (usedMemorySize != 1)
+            bookmark.text = stringBuffer.data();
     }
-    else if (version < EASY_V_210)
+    else
     {
-        if (!readHeader_v2(header, inStream, _log))
-            return 0;
-        header.threads_count = std::numeric_limits<decltype(header.threads_count)>::max();
+        bookmark.text.clear();
     }
-    else
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Part of the file requested by fillTreesFromFileRange().
+*/
+struct RangeRequest
+{
+    const profiler::LoadRange*                   range = nullptr; ///< nullptr if the whole file is loaded
+    const profiler::FileIndex*                   index = nullptr; ///< Index of the file (nullptr if there is no index)
+    profiler::index::FileIndexBuilder* index_builder = nullptr; ///< Collects index of the file if it has no index
+};
+
+/** Block records of one thread which may be requested (found using the file index).
+*/
+struct RecordsRange
+{
+    uint64_t          first = 0; ///< Number of the first record
+    uint64_t           last = 0; ///< Number of the record after the last one
+    uint64_t         offset = 0; ///< Offset of the first record
+    uint64_t     end_offset = 0; ///< Offset after the last record
+};
+
+static RecordsRange find_records(const profiler::FileThreadIndex& _thread, const RecordsFilter& _filter)
+{
+    // Groups of frames are sorted by time, so groups overlapping the range are found by binary search
+    const auto& checkpoints = _thread.checkpoints;
+
+    const auto first = std::lower_bound(checkpoints.begin(), checkpoints.end(), _filter.first_block_end,
+        [] (const profiler::FileIndexCheckpoint& _checkpoint, profiler::timestamp_t _time) { return _checkpoint.end < _time; });
+
+    const auto last = std::lower_bound(first, checkpoints.end(), _filter.last_begin,
+        [] (const profiler::FileIndexCheckpoint& _checkpoint, profiler::timestamp_t _time) { return _checkpoint.begin < _time; });
+
+    RecordsRange records;
+    records.first = first != checkpoints.end() ? first->block_number : _thread.blocks_number;
+    records.offset = first != checkpoints.end() ? first->offset : _thread.end_offset;
+    records.last = last != checkpoints.end() ? last->block_number : _thread.blocks_number;
+    records.end_offset = last != checkpoints.end() ? last->offset : _thread.end_offset;
+
+    if (records.last < records.first || records.end_offset < records.offset)
     {
-        if (!readHeader_v2_1(header, inStream, _log))
-            return 0;
+        // Corrupted index
+        records.last = records.first;
+        records.end_offset = records.offset;
     }
 
+    return records;
+}
+
+template <class TStream>
+static profiler::block_index_t fillTreesFromData(std::atomic<int>& progress, TStream& inStream,
+                                                 uint32_t signature,
+                                                 profiler::BeginEndTime& begin_end_time,
+                                                 profiler::SerializedData& serialized_blocks,
+                                                 profiler::SerializedData& serialized_descriptors,
+                                                 profiler::descriptors_list_t& descriptors,
+                                                 profiler::blocks_t& blocks,
+                                                 profiler::thread_blocks_tree_t& threaded_trees,
+                                                 profiler::bookmarks_t& bookmarks,
+                                                 uint32_t& descriptors_count,
+                                                 uint32_t& version,
+                                                 profiler::processid_t& pid,
+                                                 bool gather_statistics,
+                                                 const RangeRequest& request,
+                                                 std::ostream& _log)
+{
+    EASY_FUNCTION(profiler::colors::Cyan);
+
+    EasyFileHeader header;
+    header.signature = signature;
+
+    const bool header_read = readHeader(header, inStream, _log);
+    version = header.version;
+    if (!header_read)
+        return 0;
+
     pid = header.pid;
 
     const uint64_t cpu_frequency = header.cpu_frequency;
     const double conversion_factor = (cpu_frequency != 0 ? static_cast<double>(TIME_FACTOR) / static_cast<double>(cpu_frequency) : 1.);
 
+    // Timestamps which are already in nanoseconds are left untouched:
+    // this keeps pages of the mapped file clean (and avoids precision loss of the floating point conversion)
+    const bool convert_time = cpu_frequency != 0 && cpu_frequency != TIME_FACTOR;
+
     auto begin_time = header.begin_time;
     auto end_time = header.end_time;
 
@@ -927,7 +1906,14 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
     const auto total_blocks_count = header.blocks_count;
     descriptors_count = header.descriptors_count;
 
-    if (cpu_frequency != 0)
+    if (total_blocks_count > std::numeric_limits<profiler::block_index_t>::max())
+    {
+        _log << "Too many blocks: " << total_blocks_count
+             << ".\nRebuild easy_profiler with EASY_OPTION_64BIT_BLOCK_INDEX=ON to read such files.";
+        return 0;
+    }
+
+    if (convert_time)
     {
         EASY_CONVERT_TO_NANO(begin_time, cpu_frequency, conversion_factor);
         EASY_CONVERT_TO_NANO(end_time, cpu_frequency, conversion_factor);
@@ -936,6 +1922,49 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
     begin_end_time.beginTime = begin_time;
     begin_end_time.endTime = end_time;
 
+    const TimeConversion time_conversion {begin_time, cpu_frequency, conversion_factor, convert_time};
+
+    // Blocks which ended before begin_time are skipped (context switches which ended exactly at begin_time too)
+    RecordsFilter filter {first_ticks_after(begin_time, false, header.begin_time, time_conversion),
+                          first_ticks_after(begin_time, true, header.begin_time, time_conversion),
+                          std::numeric_limits<profiler::timestamp_t>::max()};
+
+    const auto range = request.range;
+    if (range != nullptr)
+    {
+        const auto duration = end_time > begin_time ? end_time - begin_time : 0;
+        if (range->begin > duration || range->begin > range->end)
+        {
+            filter.last_begin = 0; // Nothing to load
+        }
+        else
+        {
+            if (range->begin != 0)
+            {
+                const auto range_begin = begin_time + range->begin;
+                filter.first_cs_end = first_ticks_after(range_begin, false, header.begin_time, time_conversion);
+                filter.first_block_end = first_ticks_after(range_begin, true, header.begin_time, time_conversion);
+            }
+
+            if (range->end < duration)
+                filter.last_begin = first_ticks_after(begin_time + range->end, false, header.end_time, time_conversion);
+        }
+
+        begin_end_time.beginTime = begin_time + std::min(range->begin, duration);
+        begin_end_time.endTime = begin_time + std::min(range->end, duration);
+    }
+
+    const auto file_index = range != nullptr ? request.index : nullptr;
+    if (file_index != nullptr && file_index->threads.size() != header.threads_count)
+    {
+        _log << "File index does not match the file data.";
+        return 0;
+    }
+
+    // Index is collected only by walking through the mapped file
+    const auto index_builder = range != nullptr && file_index == nullptr && isSeekable(inStream) && version >= EASY_V_220
+                             ? request.index_builder : nullptr;
+
     descriptors.reserve(descriptors_count);
     //const char* olddata = append_regime ? serialized_descriptors.data() : nullptr;
     serialized_descriptors.set(descriptors_memory_size);
@@ -969,26 +1998,63 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         }
     }
 
-    using PerThreadStats = std::unordered_map<profiler::thread_id_t, profiler::stats_map_t, estd::hash<profiler::thread_id_t> >;
-    PerThreadStats parent_statistics, frame_statistics;
-    IdMap identification_table;
+    RuntimeNamesTable runtime_names;
+
+    auto is_requested = [range] (profiler::thread_id_t _id) -> bool
+    {
+        return range == nullptr || range->threads.empty() ||
+               std::find(range->threads.begin(), range->threads.end(), _id) != range->threads.end();
+    };
+
+    uint64_t blocks_memory_size = memory_size, blocks_records_number = total_blocks_count;
+    if (file_index != nullptr)
+    {
+        // Only context switches and groups of frames overlapping the range are stored.
+        // Offsets in the index include records sizes.
+        blocks_memory_size = blocks_records_number = 0;
+        for (const auto& thread : file_index->threads)
+        {
+            if (!is_requested(thread.thread_id))
+                continue;
+
+            const auto records = find_records(thread, filter);
+            blocks_memory_size += thread.blocks_offset - thread.cs_offset - sizeof(uint64_t);
+            blocks_memory_size += records.end_offset - records.offset;
+        }
+    }
 
-    blocks.reserve(total_blocks_count);
     //olddata = append_regime ? serialized_blocks.data() : nullptr;
-    serialized_blocks.set(memory_size);
+    reserveBlocksMemory(inStream, serialized_blocks, blocks_memory_size, blocks_records_number);
     //validate_pointers(progress, olddata, serialized_blocks, blocks, blocks.size());
 
+    // Thread sections are read and validated sequentially, then their trees are built in parallel.
+    // Blocks indices are assigned during reading in the same order as if sections were parsed one by one,
+    // so each worker fills it's own range of blocks and no rebasing is needed afterwards.
+
+    std::vector<ThreadTask> tasks;
+    std::unordered_map<profiler::thread_id_t, size_t, estd::hash<profiler::thread_id_t> > task_indices;
+
     i = 0;
-    uint32_t read_number = 0, threads_read_number = 0;
+    uint64_t offset = 0;
+    uint32_t threads_read_number = 0;
     profiler::block_index_t blocks_counter = 0;
     std::vector<char> name;
 
-    ReaderThreadPool pool;
+    // With the index not requested data of mapped file is not read at all
+    const bool seekable = file_index != nullptr && isSeekable(inStream);
 
     while (!inStream.eof() && threads_read_number++ < header.threads_count)
     {
         EASY_BLOCK("Read thread data", profiler::colors::DarkGreen);
 
+        const char* const section_begin = cursor(inStream);
+        const auto thread_index = file_index != nullptr ? &file_index->threads[threads_read_number - 1] : nullptr;
+        if (seekable && static_cast<uint64_t>(section_begin - serialized_blocks.data()) != thread_index->offset)
+        {
+            _log << "File index does not match the file data.";
+            return 0;
+        }
+
         profiler::thread_id_t thread_id = 0;
         if (version < EASY_V_130)
         {
@@ -1004,7 +2070,11 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         if (inStream.eof())
             break;
 
-        auto& root = threaded_trees[thread_id];
+        if (thread_index != nullptr && thread_index->thread_id != thread_id)
+        {
+            _log << "File index does not match the file data.";
+            return 0;
+        }
 
         uint16_t name_size = 0;
         read(inStream, name_size);
@@ -1012,20 +2082,56 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         {
             name.resize(name_size);
             read(inStream, name.data(), name_size);
-            root.thread_name = name.data();
         }
 
-        CsStatsMap per_thread_statistics_cs;
+        const bool requested = is_requested(thread_id);
+        if (!requested && seekable)
+        {
+            if (!seek(inStream, thread_index->end_offset))
+            {
+                _log << "File index does not match the file data.";
+                return 0;
+            }
+
+            continue;
+        }
+
+        ThreadSection* section = nullptr;
+        if (requested)
+        {
+            auto& root = threaded_trees[thread_id];
+            if (name_size != 0)
+                root.thread_name = name.data();
+
+            // Sections of the same thread (if any) are processed by one worker in the order of appearance
+            auto task_it = task_indices.find(thread_id);
+            if (task_it == task_indices.end())
+            {
+                task_it = task_indices.emplace(thread_id, tasks.size()).first;
+                tasks.emplace_back();
+                tasks.back().root = &root;
+            }
+
+            tasks[task_it->second].sections.emplace_back();
+            section = &tasks[task_it->second].sections.back();
+            section->first_index = blocks_counter;
+        }
+
+        const char* const cs_number_position = cursor(inStream);
 
-        uint32_t blocks_number_in_thread = 0;
-        read(inStream, blocks_number_in_thread);
-        auto threshold = read_number + blocks_number_in_thread;
-        while (!inStream.eof() && read_number < threshold)
+        uint64_t cs_number = 0;
+        readBlocksCount(inStream, version, cs_number);
+        if (thread_index != nullptr && thread_index->cs_number != cs_number)
         {
-            EASY_BLOCK("Read context switch", profiler::colors::Green);
+            _log << "File index does not match the file data.";
+            return 0;
+        }
 
-            ++read_number;
+        if (section != nullptr)
+            section->cs_number = cs_number;
 
+        for (uint64_t k = 0; k < cs_number && !inStream.eof(); ++k)
+        {
             uint16_t sz = 0;
             read(inStream, sz);
             if (sz == 0)
@@ -1040,44 +2146,31 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                 return 0;
             }
 
-            char* data = serialized_blocks[i];
-            read(inStream, data, sz);
             i += sz;
 
-            auto baseData = reinterpret_cast<profiler::SerializedCSwitch*>(data);
-            auto t_begin = reinterpret_cast<profiler::timestamp_t*>(data);
-            auto t_end = t_begin + 1;
-
-            if (cpu_frequency != 0)
+            if (section != nullptr)
             {
-                EASY_CONVERT_TO_NANO(*t_begin, cpu_frequency, conversion_factor);
-                EASY_CONVERT_TO_NANO(*t_end, cpu_frequency, conversion_factor);
-            }
-
-            if (*t_end > begin_time)
-            {
-                if (*t_begin < begin_time)
-                    *t_begin = begin_time;
+                char* data = readBlockData(inStream, serialized_blocks, offset, sz);
+                if (data == nullptr)
+                {
+                    _log << "File corrupted.\nUnexpected end of file.";
+                    return 0;
+                }
 
-                blocks.emplace_back();
-                profiler::BlocksTree& tree = blocks.back();
-                tree.cs = baseData;
-                const auto block_index = blocks_counter++;
+                if (section->cs == nullptr)
+                    section->cs = data - sizeof(uint16_t);
 
-                root.wait_time += baseData->duration();
-                root.sync.emplace_back(block_index);
+                section->size += sz;
 
-                if (gather_statistics)
-                {
-                    EASY_BLOCK("Gather per thread statistics", profiler::colors::Coral);
-                    tree.per_thread_stats = update_statistics(per_thread_statistics_cs, tree, block_index, ~0U, blocks);//, thread_id, blocks);
-                }
+                if (filter.passesCSwitch(data))
+                    ++blocks_counter;
+            }
+            else
+            {
+                skipBlockData(inStream, sz);
             }
 
-            // calculate medians for each block
-            calculate_medians_async(pool, per_thread_statistics_cs);
-
-            if (!update_progress(progress, 20 + static_cast<int>(67 * i / memory_size), _log))
+            if (!update_progress(progress, 20 + static_cast<int>(40 * i / memory_size), _log))
             {
                 return 0; // Loading interrupted
             }
@@ -1086,16 +2179,54 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         if (inStream.eof())
             break;
 
-        profiler::stats_map_t per_thread_statistics;
+        if (section != nullptr)
+            section->blocks_index = blocks_counter;
+
+        const char* const blocks_number_position = cursor(inStream);
+
+        uint64_t blocks_number_in_thread = 0;
+        readBlocksCount(inStream, version, blocks_number_in_thread);
+        if (thread_index != nullptr && thread_index->blocks_number != blocks_number_in_thread)
+        {
+            _log << "File index does not match the file data.";
+            return 0;
+        }
+
+        profiler::index::ThreadIndexBuilder thread_index_builder(thread_id);
+        if (index_builder != nullptr)
+        {
+            thread_index_builder.skip(static_cast<uint64_t>(cs_number_position - section_begin));
+            thread_index_builder.beginContextSwitches(cs_number);
+            thread_index_builder.addContextSwitches(cs_number_position + sizeof(uint64_t),
+                static_cast<uint64_t>(blocks_number_position - cs_number_position) - sizeof(uint64_t));
+            thread_index_builder.beginBlocks(blocks_number_in_thread);
+        }
 
-        blocks_number_in_thread = 0;
-        read(inStream, blocks_number_in_thread);
-        threshold = read_number + blocks_number_in_thread;
-        while (!inStream.eof() && read_number < threshold)
+        // Numbers of records which may be loaded
+        uint64_t first_record = 0, last_record = section != nullptr ? blocks_number_in_thread : 0;
+        uint64_t k = 0, records_end = blocks_number_in_thread;
+        if (section != nullptr && thread_index != nullptr)
         {
-            EASY_BLOCK("Read block", profiler::colors::Green);
+            const auto records = find_records(*thread_index, filter);
+            first_record = records.first;
+            last_record = records.last;
+
+            if (seekable)
+            {
+                if (!seek(inStream, records.offset))
+                {
+                    _log << "File index does not match the file data.";
+                    return 0;
+                }
+
+                k = first_record;
+                records_end = last_record;
+            }
+        }
 
-            ++read_number;
+        for (; k < records_end && !inStream.eof(); ++k)
+        {
+            const char* const record = cursor(inStream);
 
             uint16_t sz = 0;
             read(inStream, sz);
@@ -1111,154 +2242,104 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                 return 0;
             }
 
-            char* data = serialized_blocks[i];
-            read(inStream, data, sz);
             i += sz;
-            auto baseData = reinterpret_cast<profiler::SerializedBlock*>(data);
-            if (baseData->id() >= descriptors_count)
-            {
-                _log << "Bad block id == " << baseData->id();
-                return 0;
-            }
 
-            auto desc = descriptors[baseData->id()];
-            if (desc == nullptr)
+            char* data = nullptr;
+            if (k >= first_record && k < last_record)
             {
-                _log << "Bad block id == " << baseData->id() << ". Description is null.";
-                return 0;
+                data = readBlockData(inStream, serialized_blocks, offset, sz);
+                if (data == nullptr)
+                {
+                    _log << "File corrupted.\nUnexpected end of file.";
+                    return 0;
+                }
             }
-
-            auto t_begin = reinterpret_cast<profiler::timestamp_t*>(data);
-            auto t_end = t_begin + 1;
-
-            if (cpu_frequency != 0)
+            else
             {
-                EASY_CONVERT_TO_NANO(*t_begin, cpu_frequency, conversion_factor);
-                EASY_CONVERT_TO_NANO(*t_end, cpu_frequency, conversion_factor);
+                skipBlockData(inStream, sz);
             }
 
-            if (*t_end >= begin_time)
+            // Record is added to the index before it's id is changed (see below)
+            if (index_builder != nullptr && !inStream.eof())
+                thread_index_builder.addBlocks(record, sizeof(uint16_t) + sz);
+
+            if (data != nullptr)
             {
-                if (*t_begin < begin_time)
-                    *t_begin = begin_time;
+                if (section->blocks == nullptr)
+                    section->blocks = data - sizeof(uint16_t);
 
-                blocks.emplace_back();
-                profiler::BlocksTree& tree = blocks.back();
-                tree.node = baseData;
-                const auto block_index = blocks_counter++;
+                ++section->blocks_number;
+                section->size += sz;
 
-                if (*tree.node->name() != 0)
+                auto baseData = reinterpret_cast<profiler::SerializedBlock*>(data);
+                if (baseData->id() >= descriptors_count)
                 {
-                    // If block has runtime name then generate new id for such block.
-                    // Blocks with the same name will have same id.
+                    _log << "Bad block id == " << baseData->id();
+                    return 0;
+                }
 
-                    IdMap::key_type key(tree.node->name());
-                    auto it = identification_table.find(key);
-                    if (it != identification_table.end())
-                    {
-                        // There is already block with such name, use it's id
-                        baseData->setId(it->second);
-                    }
-                    else
-                    {
-                        // There were no blocks with such name, generate new id and save it in the table for further usage.
-                        auto id = static_cast<profiler::block_id_t>(descriptors.size());
-                        identification_table.emplace(key, id);
-                        if (descriptors.capacity() == descriptors.size())
-                            descriptors.reserve((descriptors.size() * 3) >> 1);
-                        descriptors.push_back(descriptors[baseData->id()]);
-                        baseData->setId(id);
-                    }
+                if (descriptors[baseData->id()] == nullptr)
+                {
+                    _log << "Bad block id == " << baseData->id() << ". Description is null.";
+                    return 0;
                 }
 
-                if (!root.children.empty())
+                if (filter.passesBlock(data))
                 {
-                    auto& back = blocks[root.children.back()];
-                    auto t1 = back.node->end();
-                    auto mt0 = tree.node->begin();
-                    if (mt0 < t1)//parent - starts earlier than last ends
+                    ++blocks_counter;
+
+                    if (*baseData->name() != 0)
                     {
-                        //auto lower = std::lower_bound(root.children.begin(), root.children.end(), tree);
-                        /**/
-                        EASY_BLOCK("Find children", profiler::colors::Blue);
-                        auto rlower1 = ++root.children.rbegin();
-                        for (; rlower1 != root.children.rend() && mt0 <= blocks[*rlower1].node->begin(); ++rlower1);
-                        auto lower = rlower1.base();
-                        std::move(lower, root.children.end(), std::back_inserter(tree.children));
-
-                        root.children.erase(lower, root.children.end());
-                        EASY_END_BLOCK;
-
-                        if (gather_statistics)
+                        // If block has runtime name then generate new id for such block.
+                        // Blocks with the same name will have same id.
+                        // This is done here (not by workers) to keep ids independent of the workers order.
+
+                        const char* runtime_name = baseData->name();
+                        size_t length = 0;
+                        const auto hash = RuntimeNamesTable::hash(runtime_name, length);
+
+                        profiler::block_id_t id = 0;
+                        if (runtime_names.find(runtime_name, length, hash, id))
                         {
-                            EASY_BLOCK("Gather statistic within parent", profiler::colors::Magenta);
-                            auto& per_parent_statistics = parent_statistics[thread_id];
-                            per_parent_statistics.clear();
-
-                            //per_parent_statistics.reserve(tree.children.size());     // this gives slow-down on Windows
-                            //per_parent_statistics.reserve(tree.children.size() * 2); // this gives no speed-up on Windows
-                            // TODO: check this behavior on Linux
-
-                            for (auto child_block_index : tree.children)
-                            {
-                                auto& child = blocks[child_block_index];
-                                child.per_parent_stats = update_statistics(per_parent_statistics, child, child_block_index, block_index, blocks);
-                                if (tree.depth < child.depth)
-                                    tree.depth = child.depth;
-                            }
-
-                            // calculate medians for each block
-                            calculate_medians_async(pool, per_parent_statistics);
+                            // There is already block with such name, use it's id
+                            baseData->setId(id);
                         }
                         else
                         {
-                            for (auto child_block_index : tree.children)
-                            {
-                                const auto& child = blocks[child_block_index];
-                                if (tree.depth < child.depth)
-                                    tree.depth = child.depth;
-                            }
-                        }
-
-                        if (tree.depth == 254)
-                        {
-                            // 254 because we need 1 additional level for root (thread).
-                            // In other words: real stack depth = 1 root block + 254 children
-
-                            if (*tree.node->name() != 0)
-                                _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"";
-                            else
-                                _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"\nfrom file \"" << desc->file() << "\":" << desc->line();
-
-                            return 0;
+                            // There were no blocks with such name, generate new id and save it in the table for further usage.
+                            // The name is stored in serialized_blocks memory, so the table keeps just a pointer to it.
+                            id = static_cast<profiler::block_id_t>(descriptors.size());
+                            runtime_names.insert(runtime_name, length, hash, id);
+                            const auto descriptor = descriptors[baseData->id()];
+                            descriptors.push_back(descriptor);
+                            baseData->setId(id);
                         }
-
-                        ++tree.depth;
                     }
                 }
-
-                ++root.blocks_number;
-                root.children.emplace_back(block_index);// std::move(tree));
-                if (desc->type() != profiler::BlockType::Block)
-                    root.events.emplace_back(block_index);
-
-
-                if (gather_statistics)
-                {
-                    EASY_BLOCK("Gather per thread statistics", profiler::colors::Coral);
-                    tree.per_thread_stats = update_statistics(per_thread_statistics, tree, block_index, ~0U, blocks);//, thread_id, blocks);
-                }
             }
 
-            if (!update_progress(progress, 20 + static_cast<int>(67 * i / memory_size), _log))
+            if (!update_progress(progress, 20 + static_cast<int>(40 * i / memory_size), _log))
                 return 0; // Loading interrupted
         }
 
-        // calculate medians for each block
-        calculate_medians_async(pool, per_thread_statistics);
+        if (seekable && !seek(inStream, thread_index->end_offset))
+        {
+            _log << "File index does not match the file data.";
+            return 0;
+        }
+
+        if (index_builder != nullptr)
+        {
+            thread_index_builder.finish();
+            index_builder->skip(static_cast<uint64_t>(section_begin - serialized_blocks.data()) - index_builder->offset());
+            index_builder->addThread(thread_index_builder);
+        }
+
+        if (section != nullptr)
+            section->end_index = blocks_counter;
     }
 
-    if (total_blocks_count != blocks_counter)
+    if (range == nullptr && total_blocks_count != blocks_counter)
     {
         _log << "Read blocks count: " << blocks_counter
              << "\ndoes not match blocks count\nstored in header: " << total_blocks_count
@@ -1266,65 +2347,121 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         return 0;
     }
 
-    if (!inStream.eof() && version >= EASY_V_210)
+    if (blocks_counter == 0)
     {
-        if (!tryReadMarker(inStream))
-        {
-            _log << "Bad threads section end mark.\nFile corrupted.";
-            return 0;
-        }
+        _log << "There are no blocks in the requested range.";
+        return 0;
+    }
 
-        if (!inStream.eof() && header.bookmarks_count != 0)
-        {
-            // Read bookmarks
-            bookmarks.reserve(header.bookmarks_count);
+    double quantiles[profiler::STATS_PERCENTILES_NUMBER];
+    for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+        quantiles[i] = profiler::stats_percentile(i) * 0.01;
 
-            std::vector<char> stringBuffer;
-            read_number = 0;
+    auto& trees_memory = serialized_blocks.treesMemory();
+    ReaderThreadPool pool;
 
-            while (!inStream.eof() && read_number < header.bookmarks_count)
-            {
-                profiler::Bookmark bookmark;
+    {
+        EASY_BLOCK("Build threads trees", profiler::colors::Green);
 
-                uint16_t usedMemorySize = 0;
-                read(inStream, usedMemorySize);
-                read(inStream, bookmark.pos);
-                read(inStream, bookmark.color);
+        blocks.resize(blocks_counter);
 
-                if (usedMemorySize < profiler::Bookmark::BaseSize)
-                {
-                    _log << "Bad bookmark size: " << usedMemorySize
-                         << ", which is less than Bookmark::BaseSize: "
-                         << profiler::Bookmark::BaseSize;
-                    return 0;
-                }
+        trees_memory.children.clear();
+        trees_memory.children.resize(tasks.size());
+        trees_memory.stats.clear();
+        trees_memory.stats.resize(tasks.size());
 
-                usedMemorySize -= static_cast<uint16_t>(profiler::Bookmark::BaseSize) - 1;
-                if (usedMemorySize > 0)
-                {
-                    stringBuffer.resize(usedMemorySize);
-                    read(inStream, stringBuffer.data(), usedMemorySize);
+        std::atomic_bool interrupted(false);
 
-                    if (stringBuffer.back() != 0)
-                    {
-                        stringBuffer.resize(stringBuffer.size() + 1);
-                        stringBuffer.back() = 0;
+        std::vector<async_future> results;
+        results.reserve(tasks.size());
 
-                        _log << "Bad bookmark description:\n\"" << const_cast<const char*>(stringBuffer.data())
-                            << "\"\nWhich is not zero terminated string.\nLast symbol is: '"
-                            << const_cast<const char*>(stringBuffer.data() + stringBuffer.size() - 2) << "'";
+        for (size_t k = 0; k < tasks.size(); ++k)
+        {
+            auto& task = tasks[k];
+            auto& children = trees_memory.children[k];
+            auto& arena = trees_memory.stats[k];
 
-                        return 0;
-                    }
+            results.emplace_back(pool.async([&task, &children, &arena, &blocks, &descriptors, &time_conversion, &filter,
+                                             &quantiles, &interrupted, gather_statistics] () -> async_result_t
+            {
+                // Every block is a child of at most one other block
+                uint64_t thread_blocks_number = 0;
+                for (const auto& section : task.sections)
+                    thread_blocks_number += section.end_index - section.blocks_index;
+                children.reserve(static_cast<size_t>(thread_blocks_number));
 
-                    if (usedMemorySize != 1)
-                        bookmark.text = stringBuffer.data();
-                }
-                else
+                for (const auto& section : task.sections)
                 {
-                    bookmark.text.clear();
+                    if (!buildThreadTree(*task.root, section, blocks, children, arena, descriptors, time_conversion,
+                                         filter, gather_statistics, quantiles, interrupted))
+                        break;
                 }
 
+                EASY_FINISH_ASYNC; // MSVC 2013 hack
+            }));
+        }
+
+        uint64_t built_size = 0;
+        bool ok = true, stats_full = false;
+        for (size_t k = 0; k < results.size(); ++k)
+        {
+            try
+            {
+                if (results[k].valid())
+                    results[k].get();
+            }
+            catch (const StatsDirectoryFull&)
+            {
+                // Wait for all workers before exit: they use local variables
+                interrupted.store(true, std::memory_order_release);
+                stats_full = true;
+                ok = false;
+            }
+
+            for (const auto& section : tasks[k].sections)
+                built_size += section.size;
+
+            if (ok && !update_progress(progress, 60 + static_cast<int>(27 * built_size / memory_size), _log))
+            {
+                // Wait for all workers before exit: they use local variables
+                interrupted.store(true, std::memory_order_release);
+                ok = false;
+            }
+        }
+
+        if (stats_full)
+        {
+            _log << "Can not calculate blocks statistics:\nall statistics indices are used by loaded trees.\n"
+                    "Release previously loaded files or load without statistics.";
+            return 0;
+        }
+
+        if (!ok)
+            return 0; // Loading interrupted
+    }
+
+    if (!inStream.eof() && version >= EASY_V_210)
+    {
+        if (!tryReadMarker(inStream))
+        {
+            _log << "Bad threads section end mark.\nFile corrupted.";
+            return 0;
+        }
+
+        if (!inStream.eof() && header.bookmarks_count != 0)
+        {
+            // Read bookmarks
+            bookmarks.reserve(header.bookmarks_count);
+
+            std::vector<char> stringBuffer;
+            uint64_t read_number = 0;
+
+            while (!inStream.eof() && read_number < header.bookmarks_count)
+            {
+                profiler::Bookmark bookmark;
+                if (!readBookmark(bookmark, stringBuffer, inStream, _log))
+                    return 0;
+
                 bookmarks.push_back(bookmark);
 
                 ++read_number;
@@ -1356,17 +2493,19 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
             root.thread_id = it.first;
             //root.tree.shrink_to_fit();
 
-            auto& per_frame_statistics = frame_statistics[root.thread_id];
-            auto& per_parent_statistics = parent_statistics[it.first];
-            per_parent_statistics.clear();
+            const auto task_index = task_indices[it.first];
+            const auto& sections = tasks[task_index].sections;
+            auto& arena = trees_memory.stats[task_index];
 
-            results.emplace_back(pool.async([&] () -> async_result_t
+            results.emplace_back(pool.async([&root, &sections, &arena, &blocks, &descriptors, &quantiles] () -> async_result_t
             {
                 //std::sort(root.sync.begin(), root.sync.end(), [&blocks](profiler::block_index_t left, profiler::block_index_t right)
                 //{
                 //    return blocks[left].node->begin() < blocks[right].node->begin();
                 //});
 
+                gather_thread_statistics(root, sections, blocks, arena, descriptors.size(), quantiles);
+
                 profiler::block_index_t cs_index = 0;
                 for (auto child_index : root.children)
                 {
@@ -1375,14 +2514,6 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                     if (descriptors[frame.node->id()]->type() == profiler::BlockType::Block)
                         ++root.frames_number;
 
-                    frame.per_parent_stats = update_statistics(per_parent_statistics, frame, child_index, ~0U, blocks);//, root.thread_id, blocks);
-
-                    per_frame_statistics.clear();
-                    update_statistics_recursive(per_frame_statistics, frame, child_index, child_index, blocks);
-
-                    calculate_medians(per_parent_statistics.begin(), per_parent_statistics.end());
-                    calculate_medians(per_frame_statistics.begin(), per_frame_statistics.end());
-
                     if (cs_index < root.sync.size())
                     {
                         CsStatsMap frame_stats_cs;
@@ -1394,11 +2525,11 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                                 continue;
                             if (cs.node->begin() > frame.node->end())
                                 break;
-                            cs.per_frame_stats = update_statistics(frame_stats_cs, cs, cs_index, child_index, blocks);
+                            cs.per_frame_stats_index = update_statistics(frame_stats_cs, arena, cs, j, child_index, blocks);
 
                         } while (++cs_index < root.sync.size());
 
-                        calculate_medians(frame_stats_cs.begin(), frame_stats_cs.end());
+                        calculate_percentiles(frame_stats_cs, quantiles);
                     }
 
                     if (root.depth < frame.depth)
@@ -1413,15 +2544,30 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
             }));
         }
 
+        bool stats_full = false;
         int j = 0, n = static_cast<int>(results.size());
         for (auto& result : results)
         {
-            if (result.valid())
+            try
+            {
+                if (result.valid())
+                {
+                    result.get();
+                }
+            }
+            catch (const StatsDirectoryFull&)
             {
-                result.get();
+                stats_full = true;
             }
             progress.store(90 + (10 * ++j) / n, std::memory_order_release);
         }
+
+        if (stats_full)
+        {
+            _log << "Can not calculate blocks statistics:\nall statistics indices are used by loaded trees.\n"
+                    "Release previously loaded files or load without statistics.";
+            return 0;
+        }
     }
     else
     {
@@ -1463,6 +2609,229 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
 
 //////////////////////////////////////////////////////////////////////////
 
+static profiler::block_index_t readTreesFromStream(std::atomic<int>& progress, std::istream& inStream,
+                                                   profiler::BeginEndTime& begin_end_time,
+                                                   profiler::SerializedData& serialized_blocks,
+                                                   profiler::SerializedData& serialized_descriptors,
+                                                   profiler::descriptors_list_t& descriptors,
+                                                   profiler::blocks_t& blocks,
+                                                   profiler::thread_blocks_tree_t& threaded_trees,
+                                                   profiler::bookmarks_t& bookmarks,
+                                                   uint32_t& descriptors_count,
+                                                   uint32_t& version,
+                                                   profiler::processid_t& pid,
+                                                   bool gather_statistics,
+                                                   const RangeRequest& request,
+                                                   std::ostream& _log)
+{
+    uint32_t signature = 0;
+    if (!tryReadMarker(inStream, signature))
+    {
+        if (signature == EASY_PROFILER_COMPRESSED_SIGNATURE)
+        {
+            // Blocks are unpacked by worker threads ahead of parsing
+            profiler::compression::CompressedInputStream unpackedStream(inStream);
+            if (!unpackedStream.error().empty())
+            {
+                _log << unpackedStream.error();
+                return 0;
+            }
+
+            const auto result = readTreesFromStream(progress, unpackedStream, begin_end_time, serialized_blocks,
+                                                    serialized_descriptors, descriptors, blocks, threaded_trees,
+                                                    bookmarks, descriptors_count, version, pid, gather_statistics,
+                                                    request, _log);
+
+            if (result == 0 && !unpackedStream.error().empty())
+                _log << "\n" << unpackedStream.error();
+
+            return result;
+        }
+
+        if (signature == EASY_PROFILER_SEGMENTED_SIGNATURE)
+        {
+            // All complete segments are gathered into plain .prof layout
+            profiler::segments::SegmentedInputStream assembledStream(inStream);
+            if (!assembledStream.error().empty())
+            {
+                _log << assembledStream.error();
+                return 0;
+            }
+
+            const auto result = readTreesFromStream(progress, assembledStream, begin_end_time, serialized_blocks,
+                                                    serialized_descriptors, descriptors, blocks, threaded_trees,
+                                                    bookmarks, descriptors_count, version, pid, gather_statistics,
+                                                    request, _log);
+
+            // Blocks are loaded, but the caller should know that the end of the capture is missing
+            if (result != 0 && assembledStream.truncated())
+                _log << "Segmented capture is incomplete.\nNot committed or damaged data at the end of the file has been skipped.";
+
+            return result;
+        }
+
+        _log << "Wrong signature " << signature << ".\nThis is not EasyProfiler file/stream.";
+        return 0;
+    }
+
+    return fillTreesFromData(progress, inStream, signature, begin_end_time, serialized_blocks, serialized_descriptors,
+                             descriptors, blocks, threaded_trees, bookmarks, descriptors_count, version, pid,
+                             gather_statistics, request, _log);
+}
+
+static profiler::block_index_t readTreesFromFile(std::atomic<int>& progress, const char* filename,
+                                                 profiler::BeginEndTime& begin_end_time,
+                                                 profiler::SerializedData& serialized_blocks,
+                                                 profiler::SerializedData& serialized_descriptors,
+                                                 profiler::descriptors_list_t& descriptors,
+                                                 profiler::blocks_t& blocks,
+                                                 profiler::thread_blocks_tree_t& threaded_trees,
+                                                 profiler::bookmarks_t& bookmarks,
+                                                 uint32_t& descriptors_count,
+                                                 uint32_t& version,
+                                                 profiler::processid_t& pid,
+                                                 bool gather_statistics,
+                                                 const RangeRequest& request,
+                                                 std::ostream& _log)
+{
+    // Plain .prof file is parsed right from the memory mapped file without copying blocks data.
+    // Compressed files are unpacked by stream.
+    if (serialized_blocks.mapFile(filename))
+    {
+        MappedFileStream mappedFile(serialized_blocks);
+
+        uint32_t signature = 0;
+        if (tryReadMarker(mappedFile, signature))
+        {
+            return fillTreesFromData(progress, mappedFile, signature, begin_end_time, serialized_blocks,
+                                     serialized_descriptors, descriptors, blocks, threaded_trees, bookmarks,
+                                     descriptors_count, version, pid, gather_statistics, request, _log);
+        }
+
+        serialized_blocks.clear();
+    }
+
+    std::ifstream inFile(filename, std::fstream::binary);
+    if (!inFile.is_open())
+    {
+        _log << "Can not open file " << filename;
+        return 0;
+    }
+
+    // Read data from file
+    return readTreesFromStream(progress, inFile, begin_end_time, serialized_blocks, serialized_descriptors, descriptors,
+                               blocks, threaded_trees, bookmarks, descriptors_count, version, pid, gather_statistics,
+                               request, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t fillTreesFromFile(std::atomic<int>& progress, const char* filename,
+                                                                  profiler::BeginEndTime& begin_end_time,
+                                                                  profiler::SerializedData& serialized_blocks,
+                                                                  profiler::SerializedData& serialized_descriptors,
+                                                                  profiler::descriptors_list_t& descriptors,
+                                                                  profiler::blocks_t& blocks,
+                                                                  profiler::thread_blocks_tree_t& threaded_trees,
+                                                                  profiler::bookmarks_t& bookmarks,
+                                                                  uint32_t& descriptors_count,
+                                                                  uint32_t& version,
+                                                                  profiler::processid_t& pid,
+                                                                  bool gather_statistics,
+                                                                  std::ostream& _log)
+{
+    if (!update_progress(progress, 0, _log))
+    {
+        return 0;
+    }
+
+    return readTreesFromFile(progress, filename, begin_end_time, serialized_blocks, serialized_descriptors, descriptors,
+                             blocks, threaded_trees, bookmarks, descriptors_count, version, pid, gather_statistics,
+                             RangeRequest(), _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<int>& progress, std::istream& inStream,
+                                                                    profiler::BeginEndTime& begin_end_time,
+                                                                    profiler::SerializedData& serialized_blocks,
+                                                                    profiler::SerializedData& serialized_descriptors,
+                                                                    profiler::descriptors_list_t& descriptors,
+                                                                    profiler::blocks_t& blocks,
+                                                                    profiler::thread_blocks_tree_t& threaded_trees,
+                                                                    profiler::bookmarks_t& bookmarks,
+                                                                    uint32_t& descriptors_count,
+                                                                    uint32_t& version,
+                                                                    profiler::processid_t& pid,
+                                                                    bool gather_statistics,
+                                                                    std::ostream& _log)
+{
+    if (!update_progress(progress, 0, _log))
+    {
+        return 0;
+    }
+
+    return readTreesFromStream(progress, inStream, begin_end_time, serialized_blocks, serialized_descriptors,
+                               descriptors, blocks, threaded_trees, bookmarks, descriptors_count, version, pid,
+                               gather_statistics, RangeRequest(), _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t fillTreesFromFileRange(std::atomic<int>& progress, const char* filename,
+                                                                       const profiler::LoadRange& range,
+                                                                       profiler::BeginEndTime& begin_end_time,
+                                                                       profiler::SerializedData& serialized_blocks,
+                                                                       profiler::SerializedData& serialized_descriptors,
+                                                                       profiler::descriptors_list_t& descriptors,
+                                                                       profiler::blocks_t& blocks,
+                                                                       profiler::thread_blocks_tree_t& threaded_trees,
+                                                                       profiler::bookmarks_t& bookmarks,
+                                                                       uint32_t& descriptors_count,
+                                                                       uint32_t& version,
+                                                                       profiler::processid_t& pid,
+                                                                       bool gather_statistics,
+                                                                       std::ostream& _log)
+{
+    if (!update_progress(progress, 0, _log))
+    {
+        return 0;
+    }
+
+    // Files without index are read sequentially (not requested data is just skipped)
+    profiler::FileIndex index;
+    std::stringstream index_log;
+    const bool indexed = readFileIndex(filename, index, index_log);
+
+    profiler::index::FileIndexBuilder index_builder;
+
+    RangeRequest request;
+    request.range = &range;
+    request.index = indexed ? &index : nullptr;
+    request.index_builder = !indexed && range.sidecar_index ? &index_builder : nullptr;
+
+    const auto result = readTreesFromFile(progress, filename, begin_end_time, serialized_blocks, serialized_descriptors,
+                                          descriptors, blocks, threaded_trees, bookmarks, descriptors_count, version,
+                                          pid, gather_statistics, request, _log);
+
+    if (result != 0 && index_builder.offset() != 0 && serialized_blocks.isMapped())
+    {
+        // Index was collected while reading the mapped file. It is saved near the file, so next loads will use it.
+        index_builder.skip(serialized_blocks.size() - index_builder.offset());
+
+        std::vector<char> data;
+        index_builder.serialize(data);
+
+        std::ofstream sidecar(std::string(filename) + profiler::index::SIDECAR_EXTENSION, std::fstream::binary);
+        if (sidecar.is_open())
+            sidecar.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 extern "C" PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progress, std::istream& inStream,
                                                         profiler::SerializedData& serialized_descriptors,
                                                         profiler::descriptors_list_t& descriptors,
@@ -1546,6 +2915,829 @@ extern "C" PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progre
 
 //////////////////////////////////////////////////////////////////////////
 
+/** Reads ranges of plain or compressed .prof data from seekable stream.
+*/
+class RandomAccessReader EASY_FINAL
+{
+    std::istream&                                              m_stream;
+    std::unique_ptr<profiler::compression::BlockTableReader> m_compressed;
+    std::string                                                 m_error;
+    std::streampos                                              m_begin;
+    uint64_t                                                     m_size;
+
+public:
+
+    explicit RandomAccessReader(std::istream& _stream) : m_stream(_stream), m_begin(_stream.tellg()), m_size(0)
+    {
+    }
+
+    bool open()
+    {
+        uint32_t signature = 0;
+        ::read(m_stream, signature);
+        if (!m_stream)
+        {
+            m_error = "Unexpected end of file/stream";
+            return false;
+        }
+
+        if (signature == EASY_PROFILER_COMPRESSED_SIGNATURE)
+        {
+            m_stream.seekg(m_begin);
+            m_compressed.reset(new profiler::compression::BlockTableReader(m_stream));
+            if (!m_compressed->open())
+            {
+                m_error = m_compressed->error();
+                return false;
+            }
+
+            m_size = m_compressed->rawSize();
+            return true;
+        }
+
+        if (signature == EASY_PROFILER_SEGMENTED_SIGNATURE)
+        {
+            // Segments are written while capturing, so there is no index at the end and offsets are not stable
+            m_error = "Segmented capture has no index.\nSegmented files can only be read sequentially.";
+            return false;
+        }
+
+        if (signature != EASY_PROFILER_SIGNATURE)
+        {
+            m_error = "Wrong signature.\nThis is not EasyProfiler file/stream.";
+            return false;
+        }
+
+        m_stream.seekg(0, std::ios::end);
+        m_size = static_cast<uint64_t>(m_stream.tellg() - m_begin);
+
+        return true;
+    }
+
+    /** Size of .prof data (unpacked size for compressed data).
+    */
+    uint64_t size() const
+    {
+        return m_size;
+    }
+
+    const std::string& error() const
+    {
+        return m_error;
+    }
+
+    bool read(uint64_t _offset, uint64_t _size, std::vector<char>& _output)
+    {
+        if (m_compressed != nullptr)
+        {
+            if (m_compressed->read(_offset, _size, _output))
+                return true;
+
+            m_error = m_compressed->error();
+            return false;
+        }
+
+        if (_offset > m_size || _size > m_size - _offset)
+        {
+            m_error = "Unexpected end of file/stream";
+            return false;
+        }
+
+        _output.resize(static_cast<size_t>(_size));
+        m_stream.clear();
+        m_stream.seekg(m_begin + static_cast<std::streamoff>(_offset));
+        m_stream.read(_output.data(), static_cast<std::streamsize>(_size));
+        if (!m_stream)
+        {
+            m_error = "Unexpected end of file/stream";
+            return false;
+        }
+
+        return true;
+    }
+
+}; // END of class RandomAccessReader.
+
+/** Read values of the file header and names of indexed threads.
+*/
+static bool readIndexedFileInfo(RandomAccessReader& _data, profiler::FileIndex& _index, std::ostream& _log)
+{
+    // File header since v2.0.0 starts with signature, version, pid, cpu frequency, begin time and end time
+    EASY_CONSTEXPR uint64_t HeaderSize = 2 * sizeof(uint32_t) + sizeof(profiler::processid_t) + sizeof(int64_t) +
+                                         2 * sizeof(profiler::timestamp_t);
+
+    std::vector<char> buffer;
+    if (!_data.read(0, HeaderSize, buffer))
+    {
+        _log << _data.error();
+        return false;
+    }
+
+    uint32_t version = 0;
+    memcpy(&version, buffer.data() + sizeof(uint32_t), sizeof(version));
+    if (version < EASY_V_200 || !isCompatibleVersion(version))
+    {
+        _log << "Incompatible version: v"
+             << (version >> 24) << "." << ((version & 0x00ff0000) >> 16) << "." << (version & 0x0000ffff);
+        return false;
+    }
+
+    auto position = buffer.data() + 2 * sizeof(uint32_t) + sizeof(profiler::processid_t);
+    memcpy(&_index.cpu_frequency, position, sizeof(_index.cpu_frequency));
+    position += sizeof(_index.cpu_frequency);
+    memcpy(&_index.begin_time, position, sizeof(_index.begin_time));
+    position += sizeof(_index.begin_time);
+    memcpy(&_index.end_time, position, sizeof(_index.end_time));
+
+    for (auto& thread : _index.threads)
+    {
+        // Thread section starts with thread id and name
+        const auto name_offset = thread.offset + sizeof(profiler::thread_id_t);
+
+        uint16_t name_size = 0;
+        if (!_data.read(name_offset, sizeof(name_size), buffer))
+        {
+            _log << _data.error();
+            return false;
+        }
+
+        memcpy(&name_size, buffer.data(), sizeof(name_size));
+        if (name_size == 0)
+            continue;
+
+        if (!_data.read(name_offset + sizeof(name_size), name_size, buffer))
+        {
+            _log << _data.error();
+            return false;
+        }
+
+        thread.thread_name.assign(buffer.data(), std::find(buffer.begin(), buffer.end(), 0) - buffer.begin());
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API bool readFileIndexFromStream(std::istream& inStream, profiler::FileIndex& index,
+                                                     std::ostream& _log)
+{
+    EASY_FUNCTION(profiler::colors::Cyan);
+
+    index = profiler::FileIndex();
+
+    // Index is read from the end of data, for compressed data only blocks containing the index are unpacked
+    RandomAccessReader data(inStream);
+    if (!data.open())
+    {
+        _log << data.error();
+        return false;
+    }
+
+    std::vector<char> buffer;
+    profiler::index::Footer footer;
+    if (data.size() < sizeof(uint32_t) + sizeof(footer) || !data.read(data.size() - sizeof(footer), sizeof(footer), buffer))
+    {
+        _log << "No index found in the file/stream";
+        return false;
+    }
+
+    memcpy(&footer, buffer.data(), sizeof(footer));
+    if (footer.signature != EASY_PROFILER_INDEX_SIGNATURE || footer.offset > data.size() - sizeof(footer))
+    {
+        _log << "No index found in the file/stream";
+        return false;
+    }
+
+    if (!data.read(footer.offset, data.size() - sizeof(footer) - footer.offset, buffer))
+    {
+        _log << data.error();
+        return false;
+    }
+
+    return profiler::index::parse(buffer.data(), buffer.size(), footer.offset, index, _log) &&
+           readIndexedFileInfo(data, index, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API bool readFileIndex(const char* filename, profiler::FileIndex& index, std::ostream& _log)
+{
+    std::ifstream inFile(filename, std::fstream::binary);
+    if (!inFile.is_open())
+    {
+        _log << "Can not open file " << filename;
+        return false;
+    }
+
+    std::stringstream log;
+    if (readFileIndexFromStream(inFile, index, log))
+        return true;
+
+    // Files without index may have an index saved near them by fillTreesFromFileRange()
+    std::ifstream sidecar(std::string(filename) + profiler::index::SIDECAR_EXTENSION, std::fstream::binary);
+    if (!sidecar.is_open())
+    {
+        _log << log.rdbuf();
+        return false;
+    }
+
+    std::vector<char> buffer((std::istreambuf_iterator<char>(sidecar)), std::istreambuf_iterator<char>());
+
+    inFile.clear();
+    inFile.seekg(0);
+    RandomAccessReader data(inFile);
+    if (!data.open())
+    {
+        _log << data.error();
+        return false;
+    }
+
+    // Index is valid only for the file it was created for
+    profiler::index::Footer footer;
+    if (buffer.size() >= sizeof(footer))
+        memcpy(&footer, buffer.data() + buffer.size() - sizeof(footer), sizeof(footer));
+    if (buffer.size() < sizeof(footer) || footer.signature != EASY_PROFILER_INDEX_SIGNATURE || footer.offset != data.size())
+    {
+        _log << "Index file " << filename << profiler::index::SIDECAR_EXTENSION << " does not match the file";
+        return false;
+    }
+
+    return profiler::index::parse(buffer.data(), buffer.size() - sizeof(footer), footer.offset, index, _log) &&
+           readIndexedFileInfo(data, index, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Blocks of the thread section which are read but not yet reported by readBlocksFromStream().
+
+Blocks are stored in the file after their children, so blocks can be reported in timestamp order
+only when their top-level block is read. Top-level blocks are found in the same way as buildThreadTree() does.
+Blocks are kept in the file order: children of a block always occupy the positions right before it.
+*/
+class PendingBlocks EASY_FINAL
+{
+    struct Node
+    {
+        size_t                          offset; ///< Offset of the block data in m_data
+        size_t                 first_descendant; ///< Position of the first block of the subtree
+        uint64_t                         index;
+        profiler::block_id_t     descriptor_id;
+    };
+
+    struct Visit
+    {
+        size_t   position;
+        uint32_t    depth;
+        bool          end;
+    };
+
+    std::vector<char>   m_data;
+    std::vector<Node>  m_nodes;
+    std::vector<size_t> m_roots; ///< Positions of current top-level blocks
+    std::vector<Visit>  m_stack;
+
+public:
+
+    PendingBlocks() = default;
+
+    bool empty() const
+    {
+        return m_nodes.empty();
+    }
+
+    /** Store block data. Times of the block must be already converted.
+    */
+    void add(const char* _data, uint16_t _size, uint64_t _index, profiler::block_id_t _descriptor_id)
+    {
+        const auto position = m_nodes.size();
+
+        Node node;
+        node.offset = m_data.size();
+        node.first_descendant = position;
+        node.index = _index;
+        node.descriptor_id = _descriptor_id;
+
+        m_data.insert(m_data.end(), _data, _data + _size);
+
+        const auto begin = block(node)->begin();
+        if (!m_roots.empty() && begin < block(m_nodes[m_roots.back()])->end())
+        {
+            auto lower = m_roots.size() - 1;
+            while (lower != 0 && begin <= block(m_nodes[m_roots[lower - 1]])->begin())
+                --lower;
+
+            node.first_descendant = m_nodes[m_roots[lower]].first_descendant;
+            m_roots.resize(lower);
+        }
+
+        m_nodes.push_back(node);
+        m_roots.push_back(position);
+    }
+
+    /** Report all stored blocks to the visitor and clear the storage.
+
+    \retval false if reading was stopped by the visitor.
+    */
+    bool flush(profiler::thread_id_t _thread_id, profiler::BlocksVisitor& _visitor)
+    {
+        bool ok = true;
+        for (auto root : m_roots)
+        {
+            m_stack.push_back(Visit {root, 0, false});
+
+            while (ok && !m_stack.empty())
+            {
+                const auto visit = m_stack.back();
+                m_stack.pop_back();
+
+                const auto& node = m_nodes[visit.position];
+                const profiler::StreamedBlock streamed {block(node), _thread_id, node.index, node.descriptor_id, visit.depth};
+
+                if (visit.end)
+                {
+                    ok = _visitor.onBlockEnd(streamed);
+                    continue;
+                }
+
+                ok = _visitor.onBlockBegin(streamed);
+                m_stack.push_back(Visit {visit.position, visit.depth, true});
+
+                // Children are found from the last one, so the first child is pushed last
+                for (auto child = visit.position; child-- > node.first_descendant; child = m_nodes[child].first_descendant)
+                    m_stack.push_back(Visit {child, visit.depth + 1, false});
+            }
+
+            if (!ok)
+                break;
+        }
+
+        m_data.clear();
+        m_nodes.clear();
+        m_roots.clear();
+        m_stack.clear();
+
+        return ok;
+    }
+
+private:
+
+    profiler::SerializedBlock* block(const Node& _node)
+    {
+        return reinterpret_cast<profiler::SerializedBlock*>(m_data.data() + _node.offset);
+    }
+
+}; // END of class PendingBlocks.
+
+static bool stopped_by_visitor(std::ostream& _log)
+{
+    _log << "Reading was interrupted";
+    return false;
+}
+
+static bool readBlocksData(std::istream& inStream, const profiler::FileIndex* file_index,
+                           profiler::BlocksVisitor& visitor, std::ostream& _log)
+{
+    EASY_FUNCTION(profiler::colors::Cyan);
+
+    EasyFileHeader header;
+    header.signature = EASY_PROFILER_SIGNATURE;
+
+    if (!readHeader(header, inStream, _log))
+        return false;
+
+    const auto version = header.version;
+    const uint64_t cpu_frequency = header.cpu_frequency;
+    const double conversion_factor = (cpu_frequency != 0 ? static_cast<double>(TIME_FACTOR) / static_cast<double>(cpu_frequency) : 1.);
+    const bool convert_time = cpu_frequency != 0 && cpu_frequency != TIME_FACTOR;
+
+    profiler::BeginEndTime begin_end_time {header.begin_time, header.end_time};
+    if (convert_time)
+    {
+        EASY_CONVERT_TO_NANO(begin_end_time.beginTime, cpu_frequency, conversion_factor);
+        EASY_CONVERT_TO_NANO(begin_end_time.endTime, cpu_frequency, conversion_factor);
+    }
+
+    const auto begin_time = begin_end_time.beginTime;
+    const TimeConversion time_conversion {begin_time, cpu_frequency, conversion_factor, convert_time};
+
+    // Same records are skipped as by fillTreesFromFile(), so blocks indices are the same
+    const RecordsFilter filter {first_ticks_after(begin_time, false, header.begin_time, time_conversion),
+                                first_ticks_after(begin_time, true, header.begin_time, time_conversion),
+                                std::numeric_limits<profiler::timestamp_t>::max()};
+
+    if (!visitor.onHeader(version, header.pid, begin_end_time))
+        return stopped_by_visitor(_log);
+
+    profiler::SerializedData serialized_descriptors;
+    profiler::descriptors_list_t descriptors;
+    descriptors.reserve(header.descriptors_count);
+    serialized_descriptors.set(header.descriptors_memory_size);
+
+    uint64_t i = 0;
+    while (!inStream.eof() && descriptors.size() < header.descriptors_count)
+    {
+        uint16_t sz = 0;
+        read(inStream, sz);
+        if (sz == 0)
+        {
+            descriptors.push_back(nullptr);
+            continue;
+        }
+
+        if (i + sz > header.descriptors_memory_size)
+        {
+            _log << "File corrupted.\nActual blocks descriptions size > size pointed in file.";
+            return false;
+        }
+
+        char* data = serialized_descriptors[i];
+        read(inStream, data, sz);
+        descriptors.push_back(reinterpret_cast<profiler::SerializedBlockDescriptor*>(data));
+
+        i += sz;
+    }
+
+    if (!visitor.onDescriptors(descriptors))
+        return stopped_by_visitor(_log);
+
+    const auto descriptors_count = header.descriptors_count;
+    auto next_id = static_cast<profiler::block_id_t>(descriptors.size());
+    std::unordered_map<std::string, profiler::block_id_t> runtime_names;
+
+    // Index is used only to find borders of frames groups
+    if (file_index != nullptr && file_index->threads.size() != header.threads_count)
+        file_index = nullptr;
+
+    PendingBlocks pending;
+    std::vector<char> record, name;
+
+    i = 0;
+    uint64_t blocks_counter = 0;
+    uint32_t threads_read_number = 0;
+
+    while (!inStream.eof() && threads_read_number++ < header.threads_count)
+    {
+        profiler::thread_id_t thread_id = 0;
+        if (version < EASY_V_130)
+        {
+            uint32_t thread_id32 = 0;
+            read(inStream, thread_id32);
+            thread_id = thread_id32;
+        }
+        else
+        {
+            read(inStream, thread_id);
+        }
+
+        if (inStream.eof())
+            break;
+
+        uint16_t name_size = 0;
+        read(inStream, name_size);
+        name.resize(name_size + 1);
+        read(inStream, name.data(), name_size);
+        name.back() = 0;
+
+        if (!visitor.onThreadBegin(thread_id, name.data()))
+            return stopped_by_visitor(_log);
+
+        uint64_t cs_number = 0;
+        readBlocksCount(inStream, version, cs_number);
+
+        for (uint64_t k = 0; k < cs_number && !inStream.eof(); ++k)
+        {
+            uint16_t sz = 0;
+            read(inStream, sz);
+            if (sz == 0)
+            {
+                _log << "Bad CSwitch block size == 0";
+                return false;
+            }
+
+            if (i + sz > header.memory_size)
+            {
+                _log << "File corrupted.\nActual context switches data size > size pointed in file.";
+                return false;
+            }
+
+            i += sz;
+
+            record.resize(sz);
+            read(inStream, record.data(), sz);
+            if (inStream.eof())
+                break;
+
+            char* data = record.data();
+            if (!filter.passesCSwitch(data))
+                continue;
+
+            auto t_begin = reinterpret_cast<profiler::timestamp_t*>(data);
+            auto t_end = t_begin + 1;
+
+            if (convert_time)
+            {
+                EASY_CONVERT_TO_NANO(*t_begin, cpu_frequency, conversion_factor);
+                EASY_CONVERT_TO_NANO(*t_end, cpu_frequency, conversion_factor);
+            }
+
+            if (*t_begin < begin_time)
+                *t_begin = begin_time;
+
+            if (!visitor.onContextSwitch(thread_id, *reinterpret_cast<profiler::SerializedCSwitch*>(data), blocks_counter++))
+                return stopped_by_visitor(_log);
+        }
+
+        if (inStream.eof())
+            break;
+
+        uint64_t blocks_number_in_thread = 0;
+        readBlocksCount(inStream, version, blocks_number_in_thread);
+
+        // All blocks of a frames group have been read when the next group begins
+        const auto thread_index = file_index != nullptr ? &file_index->threads[threads_read_number - 1] : nullptr;
+        const bool use_index = thread_index != nullptr && thread_index->thread_id == thread_id &&
+                               thread_index->cs_number == cs_number && thread_index->blocks_number == blocks_number_in_thread;
+        size_t next_checkpoint = 1;
+
+        for (uint64_t k = 0; k < blocks_number_in_thread && !inStream.eof(); ++k)
+        {
+            if (use_index && next_checkpoint < thread_index->checkpoints.size() &&
+                thread_index->checkpoints[next_checkpoint].block_number == k)
+            {
+                ++next_checkpoint;
+                if (!pending.flush(thread_id, visitor))
+                    return stopped_by_visitor(_log);
+            }
+
+            uint16_t sz = 0;
+            read(inStream, sz);
+            if (sz == 0)
+            {
+                _log << "Bad block size == 0";
+                return false;
+            }
+
+            if (i + sz > header.memory_size)
+            {
+                _log << "File corrupted.\nActual blocks data size > size pointed in file.";
+                return false;
+            }
+
+            i += sz;
+
+            record.resize(sz);
+            read(inStream, record.data(), sz);
+            if (inStream.eof())
+                break;
+
+            char* data = record.data();
+            auto baseData = reinterpret_cast<profiler::SerializedBlock*>(data);
+            const auto descriptor_id = baseData->id();
+            if (descriptor_id >= descriptors_count)
+            {
+                _log << "Bad block id == " << descriptor_id;
+                return false;
+            }
+
+            if (descriptors[descriptor_id] == nullptr)
+            {
+                _log << "Bad block id == " << descriptor_id << ". Description is null.";
+                return false;
+            }
+
+            if (!filter.passesBlock(data))
+                continue;
+
+            if (*baseData->name() != 0)
+            {
+                // Blocks with the same runtime name get the same new id (as in fillTreesFromFile())
+                const auto inserted = runtime_names.emplace(baseData->name(), next_id);
+                if (inserted.second)
+                    ++next_id;
+                baseData->setId(inserted.first->second);
+            }
+
+            auto t_begin = reinterpret_cast<profiler::timestamp_t*>(data);
+            auto t_end = t_begin + 1;
+
+            if (convert_time)
+            {
+                EASY_CONVERT_TO_NANO(*t_begin, cpu_frequency, conversion_factor);
+                EASY_CONVERT_TO_NANO(*t_end, cpu_frequency, conversion_factor);
+            }
+
+            if (*t_begin < begin_time)
+                *t_begin = begin_time;
+
+            pending.add(data, sz, blocks_counter++, descriptor_id);
+        }
+
+        if (!pending.flush(thread_id, visitor))
+            return stopped_by_visitor(_log);
+
+        if (inStream.eof())
+            break;
+
+        if (!visitor.onThreadEnd(thread_id))
+            return stopped_by_visitor(_log);
+    }
+
+    if (header.blocks_count != blocks_counter)
+    {
+        _log << "Read blocks count: " << blocks_counter
+             << "\ndoes not match blocks count\nstored in header: " << header.blocks_count
+             << ".\nFile corrupted.";
+        return false;
+    }
+
+    if (!inStream.eof() && version >= EASY_V_210)
+    {
+        if (!tryReadMarker(inStream))
+        {
+            _log << "Bad threads section end mark.\nFile corrupted.";
+            return false;
+        }
+
+        std::vector<char> stringBuffer;
+        for (uint16_t k = 0; k < header.bookmarks_count && !inStream.eof(); ++k)
+        {
+            profiler::Bookmark bookmark;
+            if (!readBookmark(bookmark, stringBuffer, inStream, _log))
+                return false;
+
+            if (!visitor.onBookmark(bookmark))
+                return stopped_by_visitor(_log);
+        }
+    }
+
+    return true;
+}
+
+static bool readBlocks(std::istream& inStream, const profiler::FileIndex* file_index,
+                       profiler::BlocksVisitor& visitor, std::ostream& _log)
+{
+    uint32_t signature = 0;
+    if (!tryReadMarker(inStream, signature))
+    {
+        if (signature == EASY_PROFILER_COMPRESSED_SIGNATURE)
+        {
+            profiler::compression::CompressedInputStream unpackedStream(inStream);
+            if (!unpackedStream.error().empty())
+            {
+                _log << unpackedStream.error();
+                return false;
+            }
+
+            const auto result = readBlocks(unpackedStream, file_index, visitor, _log);
+            if (!result && !unpackedStream.error().empty())
+                _log << "\n" << unpackedStream.error();
+
+            return result;
+        }
+
+        if (signature == EASY_PROFILER_SEGMENTED_SIGNATURE)
+        {
+            profiler::segments::SegmentedInputStream assembledStream(inStream);
+            if (!assembledStream.error().empty())
+            {
+                _log << assembledStream.error();
+                return false;
+            }
+
+            const auto result = readBlocks(assembledStream, nullptr, visitor, _log);
+            if (result && assembledStream.truncated())
+                _log << "Segmented capture is incomplete.\nNot committed or damaged data at the end of the file has been skipped.";
+
+            return result;
+        }
+
+        _log << "Wrong signature " << signature << ".\nThis is not EasyProfiler file/stream.";
+        return false;
+    }
+
+    return readBlocksData(inStream, file_index, visitor, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API bool readBlocksFromFile(const char* filename, profiler::BlocksVisitor& visitor, std::ostream& _log)
+{
+    std::ifstream inFile(filename, std::fstream::binary);
+    if (!inFile.is_open())
+    {
+        _log << "Can not open file " << filename;
+        return false;
+    }
+
+    // Without index blocks are just kept in memory longer
+    profiler::FileIndex index;
+    std::stringstream log;
+    const bool indexed = readFileIndex(filename, index, log);
+
+    return readBlocks(inFile, indexed ? &index : nullptr, visitor, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API bool readBlocksFromStream(std::istream& inStream, profiler::BlocksVisitor& visitor, std::ostream& _log)
+{
+    return readBlocks(inStream, nullptr, visitor, _log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+SegmentedFileTail::SegmentedFileTail(const char* filename)
+    : m_filename(filename != nullptr ? filename : "")
+    , m_capture(new segments::SegmentedCapture())
+    , m_offset(0)
+{
+}
+
+SegmentedFileTail::~SegmentedFileTail()
+{
+    delete m_capture;
+}
+
+bool SegmentedFileTail::poll(BlocksVisitor& visitor, std::ostream& _log)
+{
+    EASY_FUNCTION(profiler::colors::Cyan);
+
+    std::ifstream inFile(m_filename.c_str(), std::fstream::binary);
+    if (!inFile.is_open())
+    {
+        _log << "Can not open file " << m_filename;
+        return false;
+    }
+
+    if (m_offset == 0)
+    {
+        uint32_t signature = 0;
+        ::read(inFile, signature);
+        if (!inFile)
+            return true; // Nothing has been written yet
+
+        if (signature != EASY_PROFILER_SEGMENTED_SIGNATURE)
+        {
+            _log << "Wrong signature " << signature << ".\nThis is not segmented EasyProfiler file.";
+            return false;
+        }
+
+        m_offset = sizeof(signature);
+    }
+
+    inFile.seekg(static_cast<std::streamoff>(m_offset));
+
+    // Segments of not committed dump were read by previous poll, they are read again
+    m_capture->clearData();
+
+    segments::SegmentHeader header;
+    std::vector<char> payload;
+    while (true)
+    {
+        const auto status = segments::readSegment(inFile, header, payload);
+        if (status == segments::ReadStatus::End || status == segments::ReadStatus::Incomplete)
+            return true; // The rest of the dump has not been written yet
+
+        if (status == segments::ReadStatus::Corrupted)
+        {
+            _log << "Bad segment after offset " << m_offset << ".\nFile corrupted.";
+            return false;
+        }
+
+        if (!m_capture->add(header, payload))
+        {
+            _log << m_capture->error();
+            return false;
+        }
+
+        if (static_cast<segments::SegmentType>(header.type) != segments::SegmentType::Commit)
+            continue;
+
+        m_offset = static_cast<uint64_t>(inFile.tellg());
+        if (m_capture->empty())
+            continue;
+
+        segments::PartsStreamBuf buffer;
+        m_capture->assemble(buffer.parts());
+
+        std::istream dumpStream(&buffer);
+        if (!readBlocks(dumpStream, nullptr, visitor, _log))
+            return false;
+    }
+}
+
+uint64_t SegmentedFileTail::offset() const
+{
+    return m_offset;
+}
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
 #undef EASY_CONVERT_TO_NANO
 #undef EASY_FINISH_ASYNC
 
@@ -0,0 +1,851 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "segments.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+extern const uint32_t EASY_PROFILER_SIGNATURE;
+extern const uint32_t EASY_PROFILER_SEGMENTED_SIGNATURE;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** Plain .prof header is assembled in v2.2.0 layout (64-bit blocks count), which is used by all segmented captures.
+*/
+EASY_CONSTEXPR uint32_t MIN_CAPTURE_VERSION = (2U << 24) | (2U << 16);
+
+/** Size of Capture payload: version, pid, cpu frequency, begin time and end time.
+*/
+EASY_CONSTEXPR uint64_t CAPTURE_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int64_t) + 2 * sizeof(profiler::timestamp_t);
+
+/** Size of the thread info part of ContextSwitches and Blocks payloads without thread name.
+*/
+EASY_CONSTEXPR uint64_t THREAD_INFO_SIZE = sizeof(profiler::thread_id_t) + sizeof(uint16_t);
+
+/** Tables for slicing-by-8 CRC-32 calculation.
+*/
+struct Crc32Table
+{
+    uint32_t values[8][256];
+
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; ++k)
+                crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+            values[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int k = 1; k < 8; ++k)
+                values[k][i] = (values[k - 1][i] >> 8) ^ values[0][values[k - 1][i] & 0xff];
+        }
+    }
+};
+
+const Crc32Table& crc32Table()
+{
+    static const Crc32Table table;
+    return table;
+}
+
+template <class T>
+void append(std::vector<char>& _buffer, const T& _value)
+{
+    const auto data = reinterpret_cast<const char*>(&_value);
+    _buffer.insert(_buffer.end(), data, data + sizeof(T));
+}
+
+template <class T>
+T get(const char* _data)
+{
+    T value;
+    memcpy(&value, _data, sizeof(T));
+    return value;
+}
+
+/** Check that [_data, _data + _size) contains exactly _count records [uint16_t size][data].
+*/
+bool checkRecords(const char* _data, uint64_t _size, uint64_t _count)
+{
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i < _count; ++i)
+    {
+        if (_size - offset < sizeof(uint16_t))
+            return false;
+
+        offset += sizeof(uint16_t) + get<uint16_t>(_data + offset);
+        if (offset > _size)
+            return false;
+    }
+
+    return offset == _size;
+}
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler { namespace segments {
+
+uint32_t crc32(const char* _data, uint64_t _size, uint32_t _crc)
+{
+    const auto& table = crc32Table().values;
+    auto input = reinterpret_cast<const uint8_t*>(_data);
+
+    uint32_t crc = ~_crc;
+    for (; _size >= 8; _size -= 8, input += 8)
+    {
+        // Data is little-endian as the rest of .prof file
+        const uint32_t low = get<uint32_t>(reinterpret_cast<const char*>(input)) ^ crc;
+        const uint32_t high = get<uint32_t>(reinterpret_cast<const char*>(input) + 4);
+        crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+              table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^ table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+    }
+
+    for (; _size != 0; --_size)
+        crc = table[0][(crc ^ *input++) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+uint32_t checksum(const SegmentHeader& _header, const char* _payload)
+{
+    // Marker is not included: it is checked separately
+    const auto fields = reinterpret_cast<const char*>(&_header.type);
+    const auto crc = crc32(fields, sizeof(_header.type) + sizeof(_header.flags) + sizeof(_header.reserved) + sizeof(_header.size));
+    return crc32(_payload, _header.size, crc);
+}
+
+ReadStatus readSegment(std::istream& _source, SegmentHeader& _header, std::vector<char>& _payload)
+{
+    _source.read(reinterpret_cast<char*>(&_header), sizeof(SegmentHeader));
+    const auto received = _source.gcount();
+    if (received == 0)
+        return ReadStatus::End;
+
+    if (received != static_cast<std::streamsize>(sizeof(SegmentHeader)))
+        return ReadStatus::Incomplete;
+
+    if (_header.marker != EASY_PROFILER_SEGMENTED_SIGNATURE || _header.size > MAX_SEGMENT_SIZE)
+        return ReadStatus::Corrupted;
+
+    _payload.resize(_header.size);
+    if (_header.size != 0)
+    {
+        _source.read(_payload.data(), static_cast<std::streamsize>(_header.size));
+        if (_source.gcount() != static_cast<std::streamsize>(_header.size))
+            return ReadStatus::Incomplete;
+    }
+
+    if (checksum(_header, _payload.data()) != _header.checksum)
+        return ReadStatus::Corrupted;
+
+    return ReadStatus::Ok;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SegmentEncoder::SegmentEncoder(output_t _output)
+    : m_output(std::move(_output))
+    , m_descriptorsWritten(0)
+    , m_descriptorIndex(0)
+    , m_dumpRecords(0)
+    , m_bookmarksNumber(0)
+    , m_recordsCount(0)
+    , m_countOffset(0)
+    , m_recordStart(0)
+    , m_skip(0)
+    , m_recordLeft(0)
+    , m_prefixSize(0)
+    , m_section(profiler::SinkSection::Header)
+    , m_type(SegmentType::None)
+    , m_skipRecord(false)
+    , m_threadWritten(false)
+    , m_started(false)
+{
+    m_payload.reserve(SEGMENT_SIZE + std::numeric_limits<uint16_t>::max());
+}
+
+void SegmentEncoder::write(profiler::SinkSection _section, profiler::thread_id_t, const char* _data, uint64_t _size)
+{
+    if (!m_started || _section != m_section)
+    {
+        if (m_started)
+            endSection();
+        beginSection(_section);
+    }
+
+    switch (m_section)
+    {
+        case profiler::SinkSection::Header:
+        case profiler::SinkSection::ThreadInfo:
+            m_info.insert(m_info.end(), _data, _data + _size);
+            break;
+
+        case profiler::SinkSection::Descriptors:
+        case profiler::SinkSection::ContextSwitches:
+        case profiler::SinkSection::Blocks:
+            writeRecords(_data, _size);
+            break;
+
+        default:
+            // Footer and index are not needed: segments are self-describing
+            break;
+    }
+}
+
+void SegmentEncoder::commit()
+{
+    if (m_started)
+        endSection();
+
+    {
+        std::lock_guard<std::mutex> lock(m_bookmarksMutex);
+        if (m_bookmarksNumber != 0)
+        {
+            memcpy(m_bookmarks.data(), &m_bookmarksNumber, sizeof(m_bookmarksNumber));
+            emit(SegmentType::Bookmarks, m_bookmarks.data(), m_bookmarks.size());
+            m_bookmarks.clear();
+            m_bookmarksNumber = 0;
+        }
+    }
+
+    emit(SegmentType::Commit, reinterpret_cast<const char*>(&m_dumpRecords), sizeof(m_dumpRecords));
+
+    m_dumpRecords = 0;
+    m_descriptorIndex = 0;
+    m_started = false;
+}
+
+void SegmentEncoder::addBookmark(profiler::timestamp_t _pos, profiler::color_t _color, const char* _text)
+{
+    EASY_CONSTEXPR size_t BaseSize = sizeof(profiler::timestamp_t) + sizeof(profiler::color_t) + 1;
+    const size_t length = std::min(_text != nullptr ? strlen(_text) : 0, std::numeric_limits<uint16_t>::max() - BaseSize);
+    const auto size = static_cast<uint16_t>(BaseSize + length);
+
+    std::lock_guard<std::mutex> lock(m_bookmarksMutex);
+    if (m_bookmarks.empty())
+        append(m_bookmarks, m_bookmarksNumber); // Patched in commit()
+
+    append(m_bookmarks, size);
+    append(m_bookmarks, _pos);
+    append(m_bookmarks, _color);
+    m_bookmarks.insert(m_bookmarks.end(), _text, _text + length);
+    m_bookmarks.push_back(0);
+    ++m_bookmarksNumber;
+}
+
+void SegmentEncoder::beginSection(profiler::SinkSection _section)
+{
+    m_section = _section;
+    m_started = true;
+    m_skip = 0;
+    m_recordLeft = 0;
+    m_prefixSize = 0;
+    m_skipRecord = false;
+
+    switch (_section)
+    {
+        case profiler::SinkSection::Header:
+            m_info.clear();
+            break;
+
+        case profiler::SinkSection::ThreadInfo:
+            m_info.clear();
+            m_threadWritten = false;
+            break;
+
+        case profiler::SinkSection::ContextSwitches:
+        case profiler::SinkSection::Blocks:
+            m_skip = sizeof(uint64_t); // Records count is written by each segment
+            break;
+
+        default:
+            break;
+    }
+}
+
+void SegmentEncoder::endSection()
+{
+    switch (m_section)
+    {
+        case profiler::SinkSection::Header:
+            // Signature is followed by version, pid, cpu frequency, begin and end time
+            if (m_info.size() >= sizeof(uint32_t) + CAPTURE_SIZE)
+                emit(SegmentType::Capture, m_info.data() + sizeof(uint32_t), CAPTURE_SIZE);
+            break;
+
+        case profiler::SinkSection::ThreadInfo:
+            // Thread info section is used as is for the beginning of ContextSwitches and Blocks payloads
+            break;
+
+        case profiler::SinkSection::Descriptors:
+        case profiler::SinkSection::ContextSwitches:
+            flush();
+            break;
+
+        case profiler::SinkSection::Blocks:
+            flush();
+            if (!m_threadWritten)
+            {
+                // Threads without blocks are written too, so they are shown as for plain .prof file
+                beginSegment(SegmentType::Blocks);
+                emitSegment();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void SegmentEncoder::writeRecords(const char* _data, uint64_t _size)
+{
+    while (_size != 0)
+    {
+        if (m_skip != 0)
+        {
+            const auto size = std::min(m_skip, _size);
+            _data += size;
+            _size -= size;
+            m_skip -= size;
+            continue;
+        }
+
+        if (m_recordLeft == 0)
+        {
+            // Size of the record could be split between two writes
+            m_prefix[m_prefixSize++] = *_data++;
+            --_size;
+
+            if (m_prefixSize == sizeof(m_prefix))
+            {
+                m_prefixSize = 0;
+                beginRecord(get<uint16_t>(m_prefix));
+            }
+
+            continue;
+        }
+
+        const auto size = std::min(static_cast<uint64_t>(m_recordLeft), _size);
+        if (!m_skipRecord)
+            m_payload.insert(m_payload.end(), _data, _data + size);
+
+        _data += size;
+        _size -= size;
+        m_recordLeft -= static_cast<uint16_t>(size);
+
+        if (m_recordLeft == 0)
+            endRecord();
+    }
+}
+
+void SegmentEncoder::beginRecord(uint16_t _size)
+{
+    const bool descriptors = m_section == profiler::SinkSection::Descriptors;
+
+    // Descriptors are never removed, so only descriptors registered after previous dump are written
+    m_skipRecord = descriptors && m_descriptorIndex < m_descriptorsWritten;
+
+    if (!m_skipRecord)
+    {
+        if (m_type != SegmentType::None && m_recordsCount != 0 &&
+            m_payload.size() + sizeof(uint16_t) + _size > SEGMENT_SIZE)
+        {
+            flush();
+        }
+
+        if (m_type == SegmentType::None)
+        {
+            beginSegment(descriptors ? SegmentType::Descriptors :
+                         m_section == profiler::SinkSection::ContextSwitches ? SegmentType::ContextSwitches :
+                                                                               SegmentType::Blocks);
+        }
+
+        m_recordStart = m_payload.size();
+        m_payload.insert(m_payload.end(), m_prefix, m_prefix + sizeof(m_prefix));
+    }
+
+    m_recordLeft = _size;
+    if (_size == 0)
+        endRecord();
+}
+
+void SegmentEncoder::endRecord()
+{
+    if (m_section == profiler::SinkSection::Descriptors)
+        ++m_descriptorIndex;
+    else if (!m_skipRecord)
+        ++m_dumpRecords;
+
+    if (!m_skipRecord)
+        ++m_recordsCount;
+
+    m_skipRecord = false;
+}
+
+void SegmentEncoder::beginSegment(SegmentType _type)
+{
+    m_type = _type;
+    m_recordsCount = 0;
+    m_payload.clear();
+
+    if (_type == SegmentType::Descriptors)
+        append(m_payload, static_cast<uint32_t>(m_descriptorIndex));
+    else
+        m_payload.insert(m_payload.end(), m_info.begin(), m_info.end()); // Thread id and name
+
+    m_countOffset = static_cast<uint32_t>(m_payload.size());
+    append(m_payload, m_recordsCount); // Patched in flush()
+}
+
+void SegmentEncoder::flush()
+{
+    if (m_type == SegmentType::None)
+        return;
+
+    // The record could be incomplete only if dumping has been interrupted
+    if (m_recordLeft != 0 && !m_skipRecord)
+        m_payload.resize(static_cast<size_t>(m_recordStart));
+
+    if (m_recordsCount != 0)
+        emitSegment();
+
+    m_type = SegmentType::None;
+    m_recordsCount = 0;
+    m_payload.clear();
+}
+
+void SegmentEncoder::emitSegment()
+{
+    memcpy(m_payload.data() + m_countOffset, &m_recordsCount, sizeof(m_recordsCount));
+    emit(m_type, m_payload.data(), m_payload.size());
+
+    if (m_type == SegmentType::Descriptors)
+        m_descriptorsWritten += m_recordsCount;
+    else
+        m_threadWritten = true;
+
+    m_type = SegmentType::None;
+    m_recordsCount = 0;
+    m_payload.clear();
+}
+
+void SegmentEncoder::emit(SegmentType _type, const char* _payload, uint64_t _size)
+{
+    SegmentHeader header;
+    header.marker = EASY_PROFILER_SEGMENTED_SIGNATURE;
+    header.type = static_cast<uint8_t>(_type);
+    header.flags = 0;
+    header.reserved = 0;
+    header.size = static_cast<uint32_t>(_size);
+    header.checksum = checksum(header, _payload);
+
+    m_output(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (_size != 0)
+        m_output(_payload, _size);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SegmentedCapture::SegmentedCapture()
+    : m_memorySize(0)
+    , m_descriptorsMemorySize(0)
+    , m_blocksNumber(0)
+    , m_cpuFrequency(0)
+    , m_pid(0)
+    , m_beginTime(0)
+    , m_endTime(0)
+    , m_version(0)
+    , m_descriptorsCount(0)
+    , m_bookmarksCount(0)
+{
+}
+
+bool SegmentedCapture::add(const SegmentHeader& _header, const std::vector<char>& _payload)
+{
+    const auto data = _payload.data();
+    const auto size = static_cast<uint64_t>(_payload.size());
+
+    switch (static_cast<SegmentType>(_header.type))
+    {
+        case SegmentType::Capture:
+        {
+            if (size < CAPTURE_SIZE)
+            {
+                m_error = "Bad capture segment.\nFile corrupted.";
+                return false;
+            }
+
+            const auto version = get<uint32_t>(data);
+            auto offset = sizeof(uint32_t);
+            const auto pid = get<uint64_t>(data + offset); offset += sizeof(uint64_t);
+            const auto cpu_frequency = get<int64_t>(data + offset); offset += sizeof(int64_t);
+            const auto begin_time = get<profiler::timestamp_t>(data + offset); offset += sizeof(profiler::timestamp_t);
+            const auto end_time = get<profiler::timestamp_t>(data + offset);
+
+            if (m_version == 0)
+            {
+                // Values of the first dump are used for the whole capture
+                m_version = version;
+                m_pid = pid;
+                m_cpuFrequency = cpu_frequency;
+            }
+
+            if (begin_time != 0 && (m_beginTime == 0 || begin_time < m_beginTime))
+                m_beginTime = begin_time;
+            m_endTime = std::max(m_endTime, end_time);
+
+            return true;
+        }
+
+        case SegmentType::Descriptors:
+        {
+            if (size < 2 * sizeof(uint32_t))
+            {
+                m_error = "Bad descriptors segment.\nFile corrupted.";
+                return false;
+            }
+
+            const auto first = get<uint32_t>(data);
+            const auto count = get<uint32_t>(data + sizeof(uint32_t));
+            const auto records = data + 2 * sizeof(uint32_t);
+            const auto records_size = size - 2 * sizeof(uint32_t);
+
+            if (first > m_descriptorsCount || !checkRecords(records, records_size, count))
+            {
+                m_error = "Bad descriptors segment.\nFile corrupted.";
+                return false;
+            }
+
+            // Skip descriptors which have been already applied
+            uint64_t offset = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const auto record_size = sizeof(uint16_t) + get<uint16_t>(records + offset);
+                if (first + i >= m_descriptorsCount)
+                {
+                    m_descriptors.insert(m_descriptors.end(), records + offset, records + offset + record_size);
+                    m_descriptorsMemorySize += record_size - sizeof(uint16_t);
+                    ++m_descriptorsCount;
+                }
+
+                offset += record_size;
+            }
+
+            return true;
+        }
+
+        case SegmentType::ContextSwitches:
+            return addRecords(_payload, true);
+
+        case SegmentType::Blocks:
+            return addRecords(_payload, false);
+
+        case SegmentType::Bookmarks:
+        {
+            const auto count = size >= sizeof(uint32_t) ? get<uint32_t>(data) : 0;
+            if (size < sizeof(uint32_t) || !checkRecords(data + sizeof(uint32_t), size - sizeof(uint32_t), count))
+            {
+                m_error = "Bad bookmarks segment.\nFile corrupted.";
+                return false;
+            }
+
+            // Number of bookmarks is 16-bit in .prof header
+            if (count > static_cast<uint32_t>(std::numeric_limits<uint16_t>::max() - m_bookmarksCount))
+                return true;
+
+            m_bookmarks.insert(m_bookmarks.end(), data + sizeof(uint32_t), data + size);
+            m_bookmarksCount += static_cast<uint16_t>(count);
+
+            return true;
+        }
+
+        default:
+            // Commit and unknown segments do not contain capture data
+            return true;
+    }
+}
+
+bool SegmentedCapture::addRecords(const std::vector<char>& _payload, bool _cs)
+{
+    const auto data = _payload.data();
+    const auto size = static_cast<uint64_t>(_payload.size());
+
+    const auto name_size = size >= THREAD_INFO_SIZE ? get<uint16_t>(data + sizeof(profiler::thread_id_t)) : 0;
+    const auto records_offset = THREAD_INFO_SIZE + name_size + sizeof(uint32_t);
+    if (size < records_offset)
+    {
+        m_error = "Bad thread segment.\nFile corrupted.";
+        return false;
+    }
+
+    const auto count = get<uint32_t>(data + records_offset - sizeof(uint32_t));
+    const auto records_size = size - records_offset;
+    if (!checkRecords(data + records_offset, records_size, count))
+    {
+        m_error = "Bad thread segment.\nFile corrupted.";
+        return false;
+    }
+
+    const auto id = get<profiler::thread_id_t>(data);
+    auto it = m_threadsMap.find(id);
+    if (it == m_threadsMap.end())
+    {
+        it = m_threadsMap.emplace(id, m_threads.size()).first;
+        m_threads.emplace_back();
+        m_threads.back().id = id;
+    }
+
+    auto& thread = m_threads[it->second];
+    if (name_size > 1 || thread.name.empty())
+        thread.name.assign(data + THREAD_INFO_SIZE, name_size);
+
+    auto& records = _cs ? thread.cs_records : thread.records;
+    records.insert(records.end(), data + records_offset, data + size);
+
+    if (_cs)
+        thread.cs_number += count;
+    else
+        thread.blocks_number += count;
+
+    m_memorySize += records_size - count * sizeof(uint16_t);
+    m_blocksNumber += count;
+
+    return true;
+}
+
+void SegmentedCapture::clearData()
+{
+    m_threads.clear();
+    m_threadsMap.clear();
+    m_bookmarks.clear();
+    m_memorySize = 0;
+    m_blocksNumber = 0;
+    m_bookmarksCount = 0;
+}
+
+bool SegmentedCapture::empty() const
+{
+    return m_blocksNumber == 0;
+}
+
+uint32_t SegmentedCapture::version() const
+{
+    return m_version;
+}
+
+const std::string& SegmentedCapture::error() const
+{
+    return m_error;
+}
+
+void SegmentedCapture::assemble(std::vector<std::vector<char> >& _parts)
+{
+    _parts.clear();
+    _parts.reserve(m_threads.size() * 4 + 4);
+
+    _parts.emplace_back();
+    auto& header = _parts.back();
+    append(header, EASY_PROFILER_SIGNATURE);
+    append(header, std::max(m_version, MIN_CAPTURE_VERSION));
+    append(header, m_pid);
+    append(header, m_cpuFrequency);
+    append(header, m_beginTime);
+    append(header, m_endTime);
+    append(header, m_memorySize);
+    append(header, m_descriptorsMemorySize);
+    append(header, m_blocksNumber);
+    append(header, m_descriptorsCount);
+    append(header, static_cast<uint32_t>(m_threads.size()));
+    append(header, m_bookmarksCount);
+    append(header, static_cast<uint16_t>(0)); // padding
+
+    _parts.push_back(m_descriptors);
+
+    for (auto& thread : m_threads)
+    {
+        _parts.emplace_back();
+        auto& info = _parts.back();
+        append(info, thread.id);
+        append(info, static_cast<uint16_t>(thread.name.size()));
+        info.insert(info.end(), thread.name.begin(), thread.name.end());
+        append(info, thread.cs_number);
+
+        _parts.emplace_back(std::move(thread.cs_records));
+
+        _parts.emplace_back();
+        append(_parts.back(), thread.blocks_number);
+
+        _parts.emplace_back(std::move(thread.records));
+    }
+
+    _parts.emplace_back();
+    append(_parts.back(), EASY_PROFILER_SIGNATURE);
+
+    if (m_bookmarksCount != 0)
+    {
+        _parts.emplace_back(std::move(m_bookmarks));
+        _parts.emplace_back();
+        append(_parts.back(), EASY_PROFILER_SIGNATURE);
+    }
+
+    clearData();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+PartsStreamBuf::PartsStreamBuf() : m_index(0)
+{
+}
+
+std::vector<std::vector<char> >& PartsStreamBuf::parts()
+{
+    return m_parts;
+}
+
+PartsStreamBuf::int_type PartsStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    // Release the part which has been read
+    if (m_index != 0)
+        std::vector<char>().swap(m_parts[m_index - 1]);
+
+    while (m_index < m_parts.size())
+    {
+        auto& part = m_parts[m_index++];
+        if (!part.empty())
+        {
+            setg(part.data(), part.data(), part.data() + part.size());
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+
+    setg(nullptr, nullptr, nullptr);
+    return traits_type::eof();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SegmentedInputStream::SegmentedInputStream(std::istream& _source)
+    : std::istream(nullptr)
+    , m_truncated(false)
+{
+    rdbuf(&m_buffer);
+
+    SegmentedCapture capture;
+    SegmentHeader header;
+    std::vector<char> payload;
+
+    // Segments of a dump are applied only when it's Commit has been read, so block trees are complete
+    std::vector<std::pair<SegmentHeader, std::vector<char> > > staged;
+
+    while (true)
+    {
+        const auto status = readSegment(_source, header, payload);
+        if (status == ReadStatus::End)
+        {
+            // Not committed dump at the end of the file is dropped
+            m_truncated = !staged.empty();
+            break;
+        }
+
+        // Data committed before the damaged segment is still valid
+        if (status != ReadStatus::Ok)
+        {
+            m_truncated = true;
+            break;
+        }
+
+        if (static_cast<SegmentType>(header.type) != SegmentType::Commit)
+        {
+            staged.emplace_back(header, std::move(payload));
+            payload = std::vector<char>();
+            continue;
+        }
+
+        for (const auto& segment : staged)
+        {
+            if (!capture.add(segment.first, segment.second))
+            {
+                // Trees of the dump are partially applied, so the capture can not be shown
+                m_error = capture.error();
+                setstate(std::ios::failbit);
+                return;
+            }
+        }
+
+        staged.clear();
+    }
+
+    if (capture.version() == 0)
+    {
+        m_error = "Segmented capture has no complete dumps.";
+        setstate(std::ios::failbit);
+        return;
+    }
+
+    capture.assemble(m_buffer.parts());
+}
+
+const std::string& SegmentedInputStream::error() const
+{
+    return m_error;
+}
+
+bool SegmentedInputStream::truncated() const
+{
+    return m_truncated;
+}
+
+} // END of namespace segments.
+
+} // END of namespace profiler.
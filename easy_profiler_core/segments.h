@@ -0,0 +1,328 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_SEGMENTS_H
+#define EASY_PROFILER_SEGMENTS_H
+
+#include <easy/sink.h>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+/*
+Segmented .prof capture for continuous recording.
+
+Capture is written as a sequence of self-describing segments. There are no totals anywhere,
+so the file is only appended and it can be read at any moment, even while it is being written.
+Every segment carries it's own size and checksum: reader stops at the first incomplete or
+corrupted segment, so everything written before a crash stays readable.
+
+Layout:
+    uint32_t EASY_PROFILER_SEGMENTED_SIGNATURE
+    [SegmentHeader][payload]...
+
+Payloads:
+    Capture:         uint32_t version, processid_t pid, int64_t cpu frequency, timestamp_t begin time, timestamp_t end time
+    Descriptors:     uint32_t id of the first descriptor, uint32_t count, [uint16_t size][SerializedBlockDescriptor]...
+    ContextSwitches: thread_id_t thread, uint16_t name size, name, uint32_t count, [uint16_t size][SerializedCSwitch]...
+    Blocks:          thread_id_t thread, uint16_t name size, name, uint32_t count, [uint16_t size][SerializedBlock]...
+    Bookmarks:       uint32_t count, [uint16_t size][timestamp_t pos][color_t color][text]... (the same as in .prof file)
+    Commit:          uint64_t number of blocks and context switches written since previous Commit
+
+Each dump is written as Capture, Descriptors added since previous dump, thread batches and Commit.
+Block records of a dump are complete trees (children before parents, as in .prof file), so all
+segments up to a Commit could be shown without waiting for the rest of the file.
+*/
+
+namespace profiler { namespace segments {
+
+enum class SegmentType : uint8_t
+{
+    None = 0,
+    Capture,
+    Descriptors,
+    ContextSwitches,
+    Blocks,
+    Bookmarks,
+    Commit
+};
+
+#pragma pack(push, 1)
+struct SegmentHeader
+{
+    uint32_t   marker; ///< EASY_PROFILER_SEGMENTED_SIGNATURE
+    uint8_t      type; ///< SegmentType
+    uint8_t     flags; ///< Reserved (0)
+    uint16_t reserved;
+    uint32_t     size; ///< Size of the payload following this header
+    uint32_t checksum; ///< CRC-32 of type, flags, reserved, size and the payload
+};
+#pragma pack(pop)
+
+EASY_CONSTEXPR uint32_t SEGMENT_SIZE = 1024 * 1024; ///< Preferred payload size of thread batches and descriptors
+EASY_CONSTEXPR uint32_t MAX_SEGMENT_SIZE = 64 * 1024 * 1024; ///< Bigger segments are considered corrupted
+
+/** CRC-32 (IEEE 802.3) of the data continuing _crc of previous data.
+*/
+uint32_t crc32(const char* _data, uint64_t _size, uint32_t _crc = 0);
+
+/** Checksum of the segment stored in SegmentHeader::checksum.
+*/
+uint32_t checksum(const SegmentHeader& _header, const char* _payload);
+
+enum class ReadStatus : uint8_t
+{
+    Ok = 0,
+    End, ///< No more data
+    Incomplete, ///< Segment has not been written completely (yet)
+    Corrupted
+};
+
+/** Read next segment from the stream.
+
+Stream position is not restored if the segment is incomplete or corrupted.
+*/
+ReadStatus readSegment(std::istream& _source, SegmentHeader& _header, std::vector<char>& _payload);
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Converts plain capture written by profiler::dumpBlocksToSink() into segments.
+
+Descriptors are written only once: each dump adds only descriptors which have been registered since previous dump.
+Segments are passed into output callback one by one (header and payload are passed by separate calls).
+*/
+class SegmentEncoder EASY_FINAL
+{
+public:
+
+    using output_t = std::function<void(const char* _data, uint64_t _size)>;
+
+private:
+
+    std::vector<char>           m_payload; ///< Payload of the segment being gathered
+    std::vector<char>              m_info; ///< Header or thread info section being gathered
+    std::vector<char>         m_bookmarks; ///< Bookmark records added since previous Commit
+    std::mutex            m_bookmarksMutex;
+    output_t                     m_output;
+    uint64_t         m_descriptorsWritten; ///< Number of descriptors written by previous dumps
+    uint64_t            m_descriptorIndex; ///< Index of the next descriptor of current dump
+    uint64_t               m_dumpRecords; ///< Number of blocks and context switches of current dump
+    uint32_t           m_bookmarksNumber; ///< Number of records in m_bookmarks
+    uint32_t              m_recordsCount; ///< Number of records in m_payload
+    uint32_t               m_countOffset; ///< Offset of the records count in m_payload
+    uint64_t               m_recordStart; ///< Offset of the record being received in m_payload
+    uint64_t                       m_skip; ///< Number of bytes of current section to be skipped
+    uint16_t                m_recordLeft; ///< Number of bytes of the record which have not been received yet
+    uint8_t                m_prefixSize; ///< Number of received bytes of the record size
+    char                      m_prefix[2]; ///< Received bytes of the record size
+    profiler::SinkSection       m_section;
+    SegmentType                    m_type; ///< Type of the segment being gathered
+    bool                     m_skipRecord; ///< Current record has been written by previous dumps
+    bool                  m_threadWritten; ///< Some segment of the current thread has been written
+    bool                       m_started; ///< Some section of current dump has been received
+
+public:
+
+    SegmentEncoder(const SegmentEncoder&) = delete;
+    SegmentEncoder& operator = (const SegmentEncoder&) = delete;
+
+    explicit SegmentEncoder(output_t _output);
+
+    void write(profiler::SinkSection _section, profiler::thread_id_t _thread, const char* _data, uint64_t _size);
+
+    /** Finish current dump: write the rest of the data, pending bookmarks and Commit segment.
+    */
+    void commit();
+
+    /** Add bookmark which will be written together with the next dump (may be called from any thread).
+
+    \param _pos Position of the bookmark in nanoseconds.
+    */
+    void addBookmark(profiler::timestamp_t _pos, profiler::color_t _color, const char* _text);
+
+private:
+
+    void beginSection(profiler::SinkSection _section);
+    void endSection();
+    void writeRecords(const char* _data, uint64_t _size);
+    void beginRecord(uint16_t _size);
+    void endRecord();
+    void beginSegment(SegmentType _type);
+    void flush();
+    void emitSegment();
+    void emit(SegmentType _type, const char* _payload, uint64_t _size);
+
+}; // END of class SegmentEncoder.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Gathers segments of the capture in plain .prof layout.
+*/
+class SegmentedCapture EASY_FINAL
+{
+    struct Thread
+    {
+        std::string             name;
+        std::vector<char> cs_records;
+        std::vector<char>    records;
+        profiler::thread_id_t     id = 0;
+        uint64_t           cs_number = 0;
+        uint64_t       blocks_number = 0;
+    };
+
+    std::vector<char>                             m_descriptors; ///< Descriptor records
+    std::vector<char>                               m_bookmarks; ///< Bookmark records
+    std::vector<Thread>                               m_threads; ///< Threads in order of their first appearance
+    std::unordered_map<profiler::thread_id_t, size_t> m_threadsMap;
+    std::string                                           m_error;
+    uint64_t                                       m_memorySize; ///< Size of blocks and context switches (excluding sizes of records)
+    uint64_t                            m_descriptorsMemorySize;
+    uint64_t                                     m_blocksNumber;
+    int64_t                                      m_cpuFrequency;
+    uint64_t                                              m_pid;
+    profiler::timestamp_t                           m_beginTime;
+    profiler::timestamp_t                             m_endTime;
+    uint32_t                                          m_version;
+    uint32_t                                 m_descriptorsCount;
+    uint16_t                                   m_bookmarksCount;
+
+public:
+
+    SegmentedCapture();
+
+    /** Apply next segment of the file.
+
+    Descriptors which are already known are skipped, so the same segments could be applied again.
+
+    \retval false if the segment is inconsistent with previous ones (see error()).
+    */
+    bool add(const SegmentHeader& _header, const std::vector<char>& _payload);
+
+    /** Forget blocks, context switches and bookmarks. Header values and descriptors are kept.
+    */
+    void clearData();
+
+    /** True if there are no blocks and context switches.
+    */
+    bool empty() const;
+
+    /** Version of the profiler which has written the capture (0 if there were no Capture segments).
+    */
+    uint32_t version() const;
+
+    const std::string& error() const;
+
+    /** Split gathered data into parts of plain .prof file.
+
+    Blocks, context switches and bookmarks are moved into the parts (as by clearData()), descriptors are copied.
+    */
+    void assemble(std::vector<std::vector<char> >& _parts);
+
+private:
+
+    bool addRecords(const std::vector<char>& _payload, bool _cs);
+
+}; // END of class SegmentedCapture.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Reads data from several buffers one by one. Buffers are released as soon as they have been read.
+*/
+class PartsStreamBuf EASY_FINAL : public std::streambuf
+{
+    std::vector<std::vector<char> > m_parts;
+    size_t                           m_index;
+
+public:
+
+    PartsStreamBuf();
+
+    std::vector<std::vector<char> >& parts();
+
+protected:
+
+    int_type underflow();
+
+}; // END of class PartsStreamBuf.
+
+/** Input stream presenting segmented capture as plain .prof file.
+
+All segments are read in constructor. Reading stops at the end of the source, or at the first
+incomplete or corrupted segment (the file could be still being written or it's writing could be
+interrupted by a crash). Only dumps committed before that point are available.
+
+\note Signature must be already read from the source stream.
+*/
+class SegmentedInputStream EASY_FINAL : public std::istream
+{
+    PartsStreamBuf m_buffer;
+    std::string     m_error;
+    bool        m_truncated;
+
+public:
+
+    explicit SegmentedInputStream(std::istream& _source);
+
+    /** Description of the error (empty if the capture has been read).
+    */
+    const std::string& error() const;
+
+    /** True if some data at the end of the source has been skipped: not committed dump,
+    incomplete or corrupted segment.
+    */
+    bool truncated() const;
+
+}; // END of class SegmentedInputStream.
+
+} // END of namespace segments.
+
+} // END of namespace profiler.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_SEGMENTS_H
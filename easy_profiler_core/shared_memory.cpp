@@ -0,0 +1,558 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "shared_memory.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+EASY_CONSTEXPR_FCN uint64_t align8(uint64_t _size)
+{
+    return (_size + 7) & ~static_cast<uint64_t>(7);
+}
+
+EASY_CONSTEXPR_FCN uint64_t headerSize()
+{
+    return (sizeof(profiler::shm::Header) + 63) & ~static_cast<uint64_t>(63);
+}
+
+EASY_CONSTEXPR_FCN uint64_t ringStride(uint32_t _ringSize)
+{
+    return sizeof(profiler::shm::Ring) + _ringSize;
+}
+
+uint32_t roundRingSize(uint32_t _ringSize)
+{
+    uint32_t size = profiler::shm::MIN_RING_SIZE;
+    while (size < _ringSize && size < (1U << 31))
+        size <<= 1;
+    return size;
+}
+
+uint32_t countBlocks(const char* _data, uint64_t _size)
+{
+    uint32_t count = 0;
+    for (uint64_t offset = 0; offset < _size; ++count)
+    {
+        uint16_t size = 0;
+        memcpy(&size, _data + offset, sizeof(uint16_t));
+        offset += sizeof(uint16_t) + size;
+    }
+    return count;
+}
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+SharedMemoryWriter::SharedMemoryWriter()
+    : m_memory(nullptr)
+    , m_memorySize(0)
+    , m_header(nullptr)
+    , m_batchRing(nullptr)
+    , m_batchPosition(0)
+    , m_batchSize(0)
+    , m_batchBlocksCount(0)
+{
+}
+
+SharedMemoryWriter::~SharedMemoryWriter()
+{
+    close();
+}
+
+#ifndef _WIN32
+
+bool SharedMemoryWriter::open(const char* _name, uint64_t _pid, int64_t _cpuFrequency, uint32_t _ringSize)
+{
+    close();
+
+    const auto ringSize = roundRingSize(_ringSize);
+    const auto memorySize = headerSize() + profiler::shm::DESCRIPTORS_CAPACITY + profiler::shm::MAX_THREADS * ringStride(ringSize);
+
+    // Remove stale segment which could be left by crashed application with the same pid
+    shm_unlink(_name);
+
+    const int fd = shm_open(_name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+        return false;
+
+    if (ftruncate(fd, static_cast<off_t>(memorySize)) != 0)
+    {
+        ::close(fd);
+        shm_unlink(_name);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(_name);
+        return false;
+    }
+
+    m_name = _name;
+    m_memory = static_cast<char*>(memory);
+    m_memorySize = memorySize;
+
+    // Memory is zero-initialized by ftruncate
+    m_header = ::new (m_memory) profiler::shm::Header();
+    m_header->version = profiler::shm::VERSION;
+    m_header->pid = _pid;
+    m_header->cpu_frequency = _cpuFrequency;
+    m_header->segment_size = memorySize;
+    m_header->descriptors_capacity = profiler::shm::DESCRIPTORS_CAPACITY;
+    m_header->ring_size = ringSize;
+    m_header->rings_count = profiler::shm::MAX_THREADS;
+    m_header->threads_count.store(0, std::memory_order_relaxed);
+    m_header->descriptors_count.store(0, std::memory_order_relaxed);
+    m_header->descriptors_size.store(0, std::memory_order_relaxed);
+    m_header->alive.store(1, std::memory_order_relaxed);
+
+    // Signature is written last: reader considers segment valid only after that
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->signature = profiler::shm::SIGNATURE;
+
+    return true;
+}
+
+void SharedMemoryWriter::close()
+{
+    if (m_memory == nullptr)
+        return;
+
+    m_header->alive.store(0, std::memory_order_release);
+
+    munmap(m_memory, m_memorySize);
+    shm_unlink(m_name.c_str());
+
+    m_name.clear();
+    m_memory = nullptr;
+    m_memorySize = 0;
+    m_header = nullptr;
+    m_batchRing = nullptr;
+}
+
+#else // _WIN32
+
+bool SharedMemoryWriter::open(const char*, uint64_t, int64_t, uint32_t)
+{
+    return false;
+}
+
+void SharedMemoryWriter::close()
+{
+}
+
+#endif // _WIN32
+
+bool SharedMemoryWriter::isOpen() const
+{
+    return m_memory != nullptr;
+}
+
+profiler::shm::Ring* SharedMemoryWriter::ring(uint32_t _index) const
+{
+    const auto offset = headerSize() + m_header->descriptors_capacity + _index * ringStride(m_header->ring_size);
+    return reinterpret_cast<profiler::shm::Ring*>(m_memory + offset);
+}
+
+char* SharedMemoryWriter::ringData(profiler::shm::Ring* _ring) const
+{
+    return reinterpret_cast<char*>(_ring) + sizeof(profiler::shm::Ring);
+}
+
+int32_t SharedMemoryWriter::addThread(profiler::thread_id_t _id, const char* _name)
+{
+    const auto index = m_header->threads_count.load(std::memory_order_relaxed);
+    if (index >= m_header->rings_count)
+        return -1;
+
+    auto r = ::new (ring(index)) profiler::shm::Ring();
+    r->thread_id = _id;
+    strncpy(r->name, _name, profiler::shm::THREAD_NAME_SIZE - 1);
+    r->name[profiler::shm::THREAD_NAME_SIZE - 1] = 0;
+    r->write_begin.store(0, std::memory_order_relaxed);
+    r->write_end.store(0, std::memory_order_relaxed);
+    r->batches.store(0, std::memory_order_relaxed);
+
+    m_header->threads_count.store(index + 1, std::memory_order_release);
+
+    return static_cast<int32_t>(index);
+}
+
+bool SharedMemoryWriter::addDescriptor(const profiler::BaseBlockDescriptor& _descriptor, const char* _name, uint16_t _nameSize,
+                                       const char* _filename, uint16_t _filenameSize)
+{
+    // The same format as in .prof file
+    const auto size = static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor) + _nameSize + _filenameSize);
+
+    const auto offset = m_header->descriptors_size.load(std::memory_order_relaxed);
+    if (offset + sizeof(uint16_t) + size > m_header->descriptors_capacity)
+        return false;
+
+    char* data = m_memory + headerSize() + offset;
+    memcpy(data, &size, sizeof(uint16_t)); data += sizeof(uint16_t);
+    memcpy(data, &_descriptor, sizeof(profiler::BaseBlockDescriptor)); data += sizeof(profiler::BaseBlockDescriptor);
+    memcpy(data, &_nameSize, sizeof(uint16_t)); data += sizeof(uint16_t);
+    memcpy(data, _name, _nameSize); data += _nameSize;
+    memcpy(data, _filename, _filenameSize);
+
+    m_header->descriptors_size.store(offset + sizeof(uint16_t) + size, std::memory_order_release);
+    m_header->descriptors_count.fetch_add(1, std::memory_order_release);
+
+    return true;
+}
+
+uint64_t SharedMemoryWriter::maxBatchSize() const
+{
+    return m_header->ring_size >> 2;
+}
+
+void SharedMemoryWriter::copyToRing(profiler::shm::Ring* _ring, uint64_t _position, const void* _data, uint64_t _size)
+{
+    const uint64_t mask = m_header->ring_size - 1;
+    const auto offset = _position & mask;
+    const auto firstPart = std::min(_size, static_cast<uint64_t>(m_header->ring_size) - offset);
+
+    char* data = ringData(_ring);
+    memcpy(data + offset, _data, firstPart);
+    if (firstPart < _size)
+        memcpy(data, static_cast<const char*>(_data) + firstPart, _size - firstPart);
+}
+
+void SharedMemoryWriter::beginBatch(int32_t _index)
+{
+    m_batchRing = ring(static_cast<uint32_t>(_index));
+    m_batchPosition = m_batchRing->write_end.load(std::memory_order_relaxed);
+    m_batchSize = 0;
+    m_batchBlocksCount = 0;
+}
+
+void SharedMemoryWriter::write(const char* _data, uint64_t _size)
+{
+    if (m_batchSize != 0 && m_batchSize + _size > maxBatchSize())
+    {
+        auto r = m_batchRing;
+        endBatch();
+        m_batchRing = r;
+        m_batchPosition = r->write_end.load(std::memory_order_relaxed);
+        m_batchSize = 0;
+        m_batchBlocksCount = 0;
+    }
+
+    const auto position = m_batchPosition + sizeof(profiler::shm::Batch) + m_batchSize;
+
+    // Let readers know that data up to this position is going to be changed (sequence lock writer side)
+    m_batchRing->write_begin.store(position + _size, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    copyToRing(m_batchRing, position, _data, _size);
+
+    m_batchSize += _size;
+    m_batchBlocksCount += countBlocks(_data, _size);
+}
+
+void SharedMemoryWriter::endBatch()
+{
+    if (m_batchRing == nullptr)
+        return;
+
+    if (m_batchSize != 0)
+    {
+        profiler::shm::Batch batch;
+        batch.sequence = m_batchRing->batches.load(std::memory_order_relaxed);
+        batch.size = static_cast<uint32_t>(m_batchSize);
+        batch.blocks_count = m_batchBlocksCount;
+
+        const auto end = m_batchPosition + sizeof(profiler::shm::Batch) + align8(m_batchSize);
+        if (m_batchRing->write_begin.load(std::memory_order_relaxed) < end)
+            m_batchRing->write_begin.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        copyToRing(m_batchRing, m_batchPosition, &batch, sizeof(batch));
+
+        m_batchRing->batches.store(batch.sequence + 1, std::memory_order_relaxed);
+        m_batchRing->write_end.store(end, std::memory_order_release);
+    }
+
+    m_batchRing = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+SharedMemoryCollector::SharedMemoryCollector()
+    : m_memory(nullptr)
+    , m_memorySize(0)
+    , m_positions(nullptr)
+    , m_sequences(nullptr)
+    , m_buffer(nullptr)
+    , m_lostBytes(0)
+    , m_lostBatches(0)
+    , m_descriptorsRead(0)
+{
+}
+
+SharedMemoryCollector::~SharedMemoryCollector()
+{
+    close();
+}
+
+#ifndef _WIN32
+
+bool SharedMemoryCollector::open(const char* _name)
+{
+    close();
+
+    const int fd = shm_open(_name, O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < headerSize())
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const auto memorySize = static_cast<uint64_t>(st.st_size);
+    void* memory = mmap(nullptr, memorySize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+        return false;
+
+    const auto header = static_cast<const shm::Header*>(memory);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->signature != shm::SIGNATURE || header->version != shm::VERSION || header->segment_size != memorySize)
+    {
+        munmap(memory, memorySize);
+        return false;
+    }
+
+    m_memory = static_cast<char*>(memory);
+    m_memorySize = memorySize;
+    m_positions = new uint64_t[header->rings_count]();
+    m_sequences = new uint64_t[header->rings_count]();
+    m_buffer = new char[header->ring_size];
+
+    return true;
+}
+
+void SharedMemoryCollector::close()
+{
+    if (m_memory == nullptr)
+        return;
+
+    munmap(m_memory, m_memorySize);
+
+    delete [] m_positions;
+    delete [] m_sequences;
+    delete [] m_buffer;
+
+    m_memory = nullptr;
+    m_memorySize = 0;
+    m_positions = nullptr;
+    m_sequences = nullptr;
+    m_buffer = nullptr;
+    m_lostBytes = 0;
+    m_lostBatches = 0;
+    m_descriptorsRead = 0;
+}
+
+#else // _WIN32
+
+bool SharedMemoryCollector::open(const char*)
+{
+    return false;
+}
+
+void SharedMemoryCollector::close()
+{
+}
+
+#endif // _WIN32
+
+bool SharedMemoryCollector::isOpen() const
+{
+    return m_memory != nullptr;
+}
+
+bool SharedMemoryCollector::isAlive() const
+{
+    if (m_memory == nullptr)
+        return false;
+    return reinterpret_cast<const shm::Header*>(m_memory)->alive.load(std::memory_order_acquire) != 0;
+}
+
+uint64_t SharedMemoryCollector::pid() const
+{
+    return m_memory != nullptr ? reinterpret_cast<const shm::Header*>(m_memory)->pid : 0;
+}
+
+int64_t SharedMemoryCollector::cpuFrequency() const
+{
+    return m_memory != nullptr ? reinterpret_cast<const shm::Header*>(m_memory)->cpu_frequency : 0;
+}
+
+uint64_t SharedMemoryCollector::lostBytes() const
+{
+    return m_lostBytes;
+}
+
+uint64_t SharedMemoryCollector::lostBatches() const
+{
+    return m_lostBatches;
+}
+
+uint32_t SharedMemoryCollector::readDescriptors(const descriptor_callback_t& _callback)
+{
+    if (m_memory == nullptr)
+        return 0;
+
+    const auto header = reinterpret_cast<const shm::Header*>(m_memory);
+    const auto size = std::min(header->descriptors_size.load(std::memory_order_acquire), header->descriptors_capacity);
+    const char* data = m_memory + headerSize();
+
+    uint32_t count = 0;
+    while (m_descriptorsRead + sizeof(uint16_t) <= size)
+    {
+        uint16_t descriptorSize = 0;
+        memcpy(&descriptorSize, data + m_descriptorsRead, sizeof(uint16_t));
+        if (m_descriptorsRead + sizeof(uint16_t) + descriptorSize > size)
+            break;
+
+        _callback(*reinterpret_cast<const SerializedBlockDescriptor*>(data + m_descriptorsRead + sizeof(uint16_t)));
+
+        m_descriptorsRead += sizeof(uint16_t) + descriptorSize;
+        ++count;
+    }
+
+    return count;
+}
+
+uint64_t SharedMemoryCollector::readBlocks(const blocks_callback_t& _callback)
+{
+    if (m_memory == nullptr)
+        return 0;
+
+    const auto header = reinterpret_cast<const shm::Header*>(m_memory);
+    const uint64_t ringSize = header->ring_size;
+    const uint64_t mask = ringSize - 1;
+    const auto threadsCount = std::min(header->threads_count.load(std::memory_order_acquire), header->rings_count);
+
+    uint64_t bytesRead = 0;
+    for (uint32_t i = 0; i < threadsCount; ++i)
+    {
+        const auto offset = headerSize() + header->descriptors_capacity + i * ringStride(header->ring_size);
+        const auto ring = reinterpret_cast<const shm::Ring*>(m_memory + offset);
+        const char* ringData = m_memory + offset + sizeof(shm::Ring);
+
+        auto& position = m_positions[i];
+        const auto end = ring->write_end.load(std::memory_order_acquire);
+        if (end == position)
+            continue;
+
+        const auto size = end - position;
+        if (size > ringSize)
+        {
+            // Reader is too slow: data has been overwritten. Resync to the last complete batch.
+            m_lostBytes += size;
+            position = end;
+            continue;
+        }
+
+        // Copy data and check that writer did not overwrite it while copying (sequence lock reader side)
+        const auto ringOffset = position & mask;
+        const auto firstPart = std::min(size, ringSize - ringOffset);
+        memcpy(m_buffer, ringData + ringOffset, firstPart);
+        if (firstPart < size)
+            memcpy(m_buffer + firstPart, ringData, size - firstPart);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->write_begin.load(std::memory_order_relaxed) - position > ringSize)
+        {
+            m_lostBytes += size;
+            position = end;
+            continue;
+        }
+
+        uint64_t batchOffset = 0;
+        while (batchOffset + sizeof(shm::Batch) <= size)
+        {
+            shm::Batch batch;
+            memcpy(&batch, m_buffer + batchOffset, sizeof(shm::Batch));
+            if (batchOffset + sizeof(shm::Batch) + batch.size > size)
+                break; // Must never happen
+
+            auto& sequence = m_sequences[i];
+            if (batch.sequence > sequence)
+                m_lostBatches += batch.sequence - sequence;
+            sequence = batch.sequence + 1;
+
+            _callback(ring->thread_id, ring->name, m_buffer + batchOffset + sizeof(shm::Batch), batch.size, batch.blocks_count);
+
+            bytesRead += batch.size;
+            batchOffset += sizeof(shm::Batch) + align8(batch.size);
+        }
+
+        position = end;
+    }
+
+    return bytesRead;
+}
+
+} // END of namespace profiler.
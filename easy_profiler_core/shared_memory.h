@@ -0,0 +1,128 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_SHARED_MEMORY_WRITER_H
+#define EASY_PROFILER_SHARED_MEMORY_WRITER_H
+
+#include <easy/easy_shared_memory.h>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Writer side of the shared memory transport (see easy/easy_shared_memory.h).
+
+\note Not thread-safe: is used only by ProfileManager exporting thread.
+*/
+class SharedMemoryWriter EASY_FINAL
+{
+    std::string                m_name;
+    char*                    m_memory;
+    uint64_t             m_memorySize;
+    profiler::shm::Header*   m_header;
+    profiler::shm::Ring*  m_batchRing; ///< Ring of the batch being written (nullptr if there is no batch)
+    uint64_t          m_batchPosition; ///< Position of the Batch header of the batch being written
+    uint64_t              m_batchSize;
+    uint32_t       m_batchBlocksCount;
+
+public:
+
+    SharedMemoryWriter(const SharedMemoryWriter&) = delete;
+    SharedMemoryWriter& operator = (const SharedMemoryWriter&) = delete;
+
+    SharedMemoryWriter();
+    ~SharedMemoryWriter();
+
+    /** Create new shared memory segment.
+
+    \param _ringSize Size of each thread ring. Would be rounded up to the power of 2.
+    */
+    bool open(const char* _name, uint64_t _pid, int64_t _cpuFrequency, uint32_t _ringSize);
+
+    /** Mark segment as not alive and remove it's name.
+
+    \note Readers which have already opened segment still could read the rest of the data.
+    */
+    void close();
+
+    bool isOpen() const;
+
+    /** Returns index of the ring for new thread or -1 if there are no free rings.
+    */
+    int32_t addThread(profiler::thread_id_t _id, const char* _name);
+
+    /** Append block descriptor to the descriptors area.
+
+    \retval false if there is not enough space.
+    */
+    bool addDescriptor(const profiler::BaseBlockDescriptor& _descriptor, const char* _name, uint16_t _nameSize,
+                       const char* _filename, uint16_t _filenameSize);
+
+    /** Start new batch in the ring _index.
+    */
+    void beginBatch(int32_t _index);
+
+    /** Append serialized blocks to the current batch.
+
+    Starts new batch automatically if current batch becomes too large.
+    Data is never split, so one chunk of blocks larger than maxBatchSize() is written as a single batch.
+    */
+    void write(const char* _data, uint64_t _size);
+
+    /** Publish current batch for readers.
+    */
+    void endBatch();
+
+    /** Maximum size of the data in one batch (quarter of the ring size).
+    */
+    uint64_t maxBatchSize() const;
+
+private:
+
+    profiler::shm::Ring* ring(uint32_t _index) const;
+    char* ringData(profiler::shm::Ring* _ring) const;
+    void copyToRing(profiler::shm::Ring* _ring, uint64_t _position, const void* _data, uint64_t _size);
+
+}; // END of class SharedMemoryWriter.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_SHARED_MEMORY_WRITER_H
@@ -0,0 +1,292 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights 
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+	of the Software, and to permit persons to whom the Software is furnished 
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all 
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <easy/sink.h>
+#include <easy/easy_socket.h>
+#include "compression.h"
+#include "segments.h"
+#include <algorithm>
+#include <cstring>
+
+extern const uint32_t EASY_PROFILER_SEGMENTED_SIGNATURE;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+EASY_CONSTEXPR size_t FILE_BUFFER_SIZE = 1 << 20; ///< Size of stdio buffer for FileSink (1 MiB)
+EASY_CONSTEXPR uint64_t SOCKET_BUFFER_SIZE = 64 << 10; ///< Size of gathering buffer for SocketSink (64 KiB)
+EASY_CONSTEXPR uint64_t MAX_SEND_SIZE = 1 << 30; ///< Maximum size of data for one send() call
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler {
+
+Sink::~Sink()
+{
+}
+
+void Sink::complete(uint64_t, bool)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FileSink::FileSink(const char* _filename)
+    : m_file(_filename != nullptr ? fopen(_filename, "wb") : nullptr)
+    , m_good(m_file != nullptr)
+{
+    if (m_file != nullptr)
+        setvbuf(m_file, nullptr, _IOFBF, FILE_BUFFER_SIZE);
+}
+
+FileSink::~FileSink()
+{
+    if (m_file != nullptr)
+        fclose(m_file);
+}
+
+bool FileSink::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+bool FileSink::good() const
+{
+    return m_good;
+}
+
+void FileSink::write(SinkSection, thread_id_t, const char* _data, uint64_t _size)
+{
+    if (m_good && fwrite(_data, 1, static_cast<size_t>(_size), m_file) != static_cast<size_t>(_size))
+        m_good = false;
+}
+
+void FileSink::complete(uint64_t, bool)
+{
+    if (m_file == nullptr)
+        return;
+
+    if (fclose(m_file) != 0)
+        m_good = false;
+
+    m_file = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SocketSink::SocketSink(const char* _address, uint16_t _port)
+    : m_socket(new EasySocket())
+    , m_buffer(new char[SOCKET_BUFFER_SIZE])
+    , m_bufferSize(0)
+    , m_good(false)
+{
+    m_good = _address != nullptr && m_socket->setAddress(_address, _port) && m_socket->connect() == 0;
+}
+
+SocketSink::~SocketSink()
+{
+    delete m_socket;
+    delete [] m_buffer;
+}
+
+bool SocketSink::isConnected() const
+{
+    return m_socket != nullptr && m_socket->isConnected();
+}
+
+bool SocketSink::good() const
+{
+    return m_good;
+}
+
+bool SocketSink::send(const char* _data, uint64_t _size)
+{
+    while (_size != 0)
+    {
+        const int bytes = m_socket->send(_data, static_cast<size_t>(std::min(_size, MAX_SEND_SIZE)));
+        if (bytes <= 0)
+            return false;
+
+        _data += bytes;
+        _size -= static_cast<uint64_t>(bytes);
+    }
+
+    return true;
+}
+
+void SocketSink::flush()
+{
+    if (m_bufferSize == 0)
+        return;
+
+    m_good = m_good && send(m_buffer, m_bufferSize);
+    m_bufferSize = 0;
+}
+
+void SocketSink::write(SinkSection, thread_id_t, const char* _data, uint64_t _size)
+{
+    if (!m_good)
+        return;
+
+    if (m_bufferSize + _size > SOCKET_BUFFER_SIZE)
+    {
+        flush();
+
+        if (_size >= SOCKET_BUFFER_SIZE)
+        {
+            // Big spans are sent directly without copying
+            m_good = m_good && send(_data, _size);
+            return;
+        }
+    }
+
+    memcpy(m_buffer + m_bufferSize, _data, static_cast<size_t>(_size));
+    m_bufferSize += _size;
+}
+
+void SocketSink::complete(uint64_t, bool)
+{
+    if (m_socket == nullptr)
+        return;
+
+    flush();
+
+    delete m_socket;
+    m_socket = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CompressingSink::CompressingSink(Sink& _target, CompressionCodec _codec)
+    : m_target(_target)
+    , m_compressor(new compression::ChunkedCompressor(_codec,
+        [&_target](SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size) {
+            _target.write(_section, _thread, _data, _size);
+        }))
+{
+}
+
+CompressingSink::~CompressingSink()
+{
+    delete m_compressor;
+}
+
+void CompressingSink::write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size)
+{
+    m_compressor->write(_section, _thread, _data, _size);
+}
+
+void CompressingSink::complete(uint64_t _blocksCount, bool _success)
+{
+    if (_success)
+        m_compressor->finish();
+    m_target.complete(_blocksCount, _success);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SegmentedFileSink::SegmentedFileSink(const char* _filename)
+    : m_file(_filename != nullptr ? fopen(_filename, "wb") : nullptr)
+    , m_encoder(nullptr)
+    , m_good(m_file != nullptr)
+{
+    if (m_file == nullptr)
+        return;
+
+    setvbuf(m_file, nullptr, _IOFBF, FILE_BUFFER_SIZE);
+
+    output(reinterpret_cast<const char*>(&EASY_PROFILER_SEGMENTED_SIGNATURE), sizeof(EASY_PROFILER_SEGMENTED_SIGNATURE));
+
+    m_encoder = new segments::SegmentEncoder([this](const char* _data, uint64_t _size) { output(_data, _size); });
+}
+
+SegmentedFileSink::~SegmentedFileSink()
+{
+    delete m_encoder;
+    if (m_file != nullptr)
+        fclose(m_file);
+}
+
+bool SegmentedFileSink::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+bool SegmentedFileSink::good() const
+{
+    return m_good;
+}
+
+void SegmentedFileSink::addBookmark(timestamp_t _pos, color_t _color, const char* _text)
+{
+    if (m_encoder != nullptr)
+        m_encoder->addBookmark(_pos, _color, _text);
+}
+
+void SegmentedFileSink::write(SinkSection _section, thread_id_t _thread, const char* _data, uint64_t _size)
+{
+    if (m_encoder != nullptr)
+        m_encoder->write(_section, _thread, _data, _size);
+}
+
+void SegmentedFileSink::complete(uint64_t, bool)
+{
+    if (m_encoder == nullptr)
+        return;
+
+    // Data of interrupted dump is committed too: all it's segments are complete
+    m_encoder->commit();
+
+    if (m_good && fflush(m_file) != 0)
+        m_good = false;
+}
+
+void SegmentedFileSink::output(const char* _data, uint64_t _size)
+{
+    if (m_good && fwrite(_data, 1, static_cast<size_t>(_size), m_file) != static_cast<size_t>(_size))
+        m_good = false;
+}
+
+} // END of namespace profiler.
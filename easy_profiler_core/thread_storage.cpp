@@ -235,3 +235,76 @@ void ThreadStorage::putMarkIfEmpty()
     if (!frameOpened)
         putMark();
 }
+
+template <class TStorage, class TCheckpoint>
+static void addCheckpoint(const TStorage& _storage, std::deque<ThreadStorage::HistoryCheckpoint<TStorage> >& _history,
+                          const TCheckpoint& _mark, profiler::timestamp_t _time)
+{
+    if (_mark.chunk == nullptr)
+        return;
+
+    if (!_history.empty())
+    {
+        const auto& last = _history.back();
+        if (last.mark.generation != _mark.generation)
+            _history.clear(); // Blocks have been serialized and cleared
+        else if (last.mark.chunk == _mark.chunk)
+            return; // There is already a checkpoint for this chunk
+    }
+
+    _history.push_back(ThreadStorage::HistoryCheckpoint<TStorage> {_mark, _time, _storage.usedMemorySize});
+}
+
+template <class TStorage, class TCheckpoint>
+static void dropBefore(TStorage& _storage, std::deque<ThreadStorage::HistoryCheckpoint<TStorage> >& _history,
+                       const TCheckpoint& _current, profiler::timestamp_t _time)
+{
+    if (_history.empty())
+        return;
+
+    if (_history.front().mark.generation != _current.generation)
+    {
+        _history.clear();
+        return;
+    }
+
+    // Find the latest checkpoint which is older than _time
+    size_t index = 0;
+    while (index + 1 < _history.size() && _history[index + 1].time <= _time)
+        ++index;
+
+    const auto checkpoint = _history[index];
+    const auto dropped = _storage.closedList.drop_before(checkpoint.mark);
+
+    _history.erase(_history.begin(), _history.begin() + index);
+    for (auto& h : _history)
+    {
+        h.mark.size -= dropped;
+        h.usedMemorySize -= checkpoint.usedMemorySize;
+    }
+
+    _storage.usedMemorySize -= checkpoint.usedMemorySize;
+}
+
+void ThreadStorage::addHistoryCheckpoint(profiler::timestamp_t _time)
+{
+    addCheckpoint(blocks, history, blocks.closedList.mark_checkpoint(), _time);
+}
+
+bool ThreadStorage::needDropHistory(profiler::timestamp_t _time) const
+{
+    return history.size() > 1 && history[1].time <= _time;
+}
+
+void ThreadStorage::dropHistory(profiler::timestamp_t _now, profiler::timestamp_t _time)
+{
+    dropBefore(blocks, history, blocks.closedList.mark_checkpoint(), _time);
+
+    // Context switches are not marked and may be stored by another thread (event tracing),
+    // so their checkpoints are added only here, under the same lock as dropping.
+    if (!sync.closedList.empty())
+    {
+        addCheckpoint(sync, syncHistory, sync.closedList.end_checkpoint(), _now);
+        dropBefore(sync, syncHistory, sync.closedList.end_checkpoint(), _time);
+    }
+}
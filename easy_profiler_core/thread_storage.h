@@ -44,6 +44,7 @@ The Apache License, Version 2.0 (the "License");
 #define EASY_PROFILER_THREAD_STORAGE_H
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <string>
 #include <vector>
@@ -113,9 +114,19 @@ struct ThreadStorage EASY_FINAL
     using BlocksStorage = BlocksList<std::reference_wrapper<profiler::Block>, BLOCK_CHUNK_SIZE>;
     using ContextSwitchStorage = BlocksList<CSwitchBlock, CSWITCH_CHUNK_SIZE>;
 
-    StackBuffer<NonscopedBlock> nonscopedBlocks;
-    BlocksStorage                        blocks;
-    ContextSwitchStorage                   sync;
+    template <class TStorage>
+    struct HistoryCheckpoint
+    {
+        typename decltype(TStorage::closedList)::checkpoint mark;
+        profiler::timestamp_t                               time;
+        uint64_t                                  usedMemorySize;
+    };
+
+    StackBuffer<NonscopedBlock>                         nonscopedBlocks;
+    BlocksStorage                                                blocks;
+    ContextSwitchStorage                                           sync;
+    std::deque<HistoryCheckpoint<BlocksStorage> >               history; ///< Checkpoints for dropping old blocks when only recent history is recorded (one checkpoint per chunk)
+    std::deque<HistoryCheckpoint<ContextSwitchStorage> >    syncHistory; ///< Checkpoints for dropping old context switches together with old blocks (one checkpoint per chunk)
 
     std::string                     name; ///< Thread name
     profiler::timestamp_t frameStartTime; ///< Current frame start time. Used to calculate FPS.
@@ -139,6 +150,10 @@ struct ThreadStorage EASY_FINAL
     void putMark();
     void putMarkIfEmpty();
 
+    void addHistoryCheckpoint(profiler::timestamp_t _time);
+    bool needDropHistory(profiler::timestamp_t _time) const;
+    void dropHistory(profiler::timestamp_t _now, profiler::timestamp_t _time);
+
     ThreadStorage();
     ThreadStorage(const ThreadStorage&) = delete;
     ThreadStorage(ThreadStorage&&) = delete;
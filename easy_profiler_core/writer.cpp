@@ -57,6 +57,8 @@
 #include <easy/profiler.h>
 
 #include "alignment_helpers.h"
+#include "compression.h"
+#include "file_index.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -284,7 +286,8 @@ static BlocksMemoryAndCount calculateUsedMemoryAndBlocksCount(const profiler::Bl
 
 static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
                             const profiler::BlocksTree::children_t& children, const BlocksRange& range,
-                            const profiler::block_getter_fn& getter, const profiler::descriptors_list_t& descriptors)
+                            const profiler::block_getter_fn& getter, const profiler::descriptors_list_t& descriptors,
+                            profiler::index::ThreadIndexBuilder& index)
 {
     for (auto i = range.begin; i < range.end; ++i)
     {
@@ -292,7 +295,7 @@ static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
 
         // Serialize children
         const BlocksRange childRange(0, static_cast<profiler::block_index_t>(child.children.size()));
-        serializeBlocks(output, buffer, child.children, childRange, getter, descriptors);
+        serializeBlocks(output, buffer, child.children, childRange, getter, descriptors, index);
 
         // Serialize self
         const auto& desc = *descriptors[child.node->id()];
@@ -323,12 +326,13 @@ static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
         }
 
         write(output, buffer.data(), buffer.size());
+        index.addBlocks(buffer.data(), buffer.size());
     }
 }
 
 static void serializeContextSwitches(std::ostream& output, std::vector<char>& buffer,
                                      const profiler::BlocksTree::children_t& children, const BlocksRange& range,
-                                     const profiler::block_getter_fn& getter)
+                                     const profiler::block_getter_fn& getter, profiler::index::ThreadIndexBuilder& index)
 {
     for (auto i = range.begin; i < range.end; ++i)
     {
@@ -341,13 +345,15 @@ static void serializeContextSwitches(std::ostream& output, std::vector<char>& bu
         memcpy(buffer.data() + sizeof(uint16_t), child.cs, static_cast<size_t>(usedMemorySize));
 
         write(output, buffer.data(), buffer.size());
+        index.addContextSwitches(buffer.data(), buffer.size());
     }
 }
 
-static void serializeDescriptors(std::ostream& output, std::vector<char>& buffer,
-                                 const profiler::descriptors_list_t& descriptors,
-                                 profiler::block_id_t descriptors_count)
+static uint64_t serializeDescriptors(std::ostream& output, std::vector<char>& buffer,
+                                     const profiler::descriptors_list_t& descriptors,
+                                     profiler::block_id_t descriptors_count)
 {
+    uint64_t written = 0;
     const size_t size = std::min(descriptors.size(), static_cast<size_t>(descriptors_count));
     for (size_t i = 0; i < size; ++i)
     {
@@ -363,11 +369,15 @@ static void serializeDescriptors(std::ostream& output, std::vector<char>& buffer
         memcpy(buffer.data() + sizeof(uint16_t), &desc, static_cast<size_t>(usedMemorySize));
 
         write(output, buffer.data(), buffer.size());
+        written += buffer.size();
     }
+
+    return written;
 }
 
-static void serializeBookmarks(std::ostream& output, const profiler::bookmarks_t& bookmarks, const BlocksRange& range)
+static uint64_t serializeBookmarks(std::ostream& output, const profiler::bookmarks_t& bookmarks, const BlocksRange& range)
 {
+    uint64_t written = 0;
     for (auto i = range.begin; i < range.end; ++i)
     {
         const auto& bookmark = bookmarks[i];
@@ -377,7 +387,10 @@ static void serializeBookmarks(std::ostream& output, const profiler::bookmarks_t
         write(output, bookmark.pos);
         write(output, bookmark.color);
         write(output, bookmark.text.c_str(), bookmark.text.size() + 1);
+        written += sizeof(usedMemorySize) + sizeof(bookmark.pos) + sizeof(bookmark.color) + bookmark.text.size() + 1;
     }
+
+    return written;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -392,7 +405,8 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int
                                                                  profiler::timestamp_t begin_time,
                                                                  profiler::timestamp_t end_time,
                                                                  profiler::processid_t pid,
-                                                                 std::ostream& log)
+                                                                 std::ostream& log,
+                                                                 profiler::CompressionCodec codec)
 {
     if (!update_progress_write(progress, 0, log))
         return 0;
@@ -406,25 +420,32 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int
 
     // Write data to file
     auto result = writeTreesToStream(progress, outFile, serialized_descriptors, descriptors, descriptors_count, trees,
-                                     bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
+                                     bookmarks, std::move(block_getter), begin_time, end_time, pid, log, codec);
 
     return result;
 }
 
 //////////////////////////////////////////////////////////////////////////
 
-extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
-                                                                   const profiler::SerializedData& serialized_descriptors,
-                                                                   const profiler::descriptors_list_t& descriptors,
-                                                                   profiler::block_id_t descriptors_count,
-                                                                   const profiler::thread_blocks_tree_t& trees,
-                                                                   const profiler::bookmarks_t& bookmarks,
-                                                                   profiler::block_getter_fn block_getter,
-                                                                   profiler::timestamp_t begin_time,
-                                                                   profiler::timestamp_t end_time,
-                                                                   profiler::processid_t pid,
-                                                                   std::ostream& log)
+static profiler::block_index_t writeTrees(std::atomic<int>& progress, std::ostream& str,
+                                          profiler::compression::CompressedOutputStream* packedStream,
+                                          const profiler::SerializedData& serialized_descriptors,
+                                          const profiler::descriptors_list_t& descriptors,
+                                          profiler::block_id_t descriptors_count,
+                                          const profiler::thread_blocks_tree_t& trees,
+                                          const profiler::bookmarks_t& bookmarks,
+                                          const profiler::block_getter_fn& block_getter,
+                                          profiler::timestamp_t begin_time,
+                                          profiler::timestamp_t end_time,
+                                          profiler::processid_t pid,
+                                          std::ostream& log)
 {
+    // Each section of compressed file starts a new block
+    auto beginSection = [packedStream](profiler::SinkSection section, profiler::thread_id_t thread) {
+        if (packedStream != nullptr)
+            packedStream->beginSection(section, thread);
+    };
+
     if (trees.empty() || serialized_descriptors.empty() || descriptors_count == 0)
     {
         log << "Nothing to save";
@@ -499,6 +520,7 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
     const uint64_t usedMemorySizeDescriptors = serialized_descriptors.size() + descriptors_count * sizeof(uint16_t);
 
     // Write data to stream
+    beginSection(profiler::SinkSection::Header, 0);
     write(str, EASY_PROFILER_SIGNATURE);
     write(str, EASY_PROFILER_VERSION);
     write(str, pid);
@@ -511,16 +533,23 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
 
     write(str, total.usedMemorySize);
     write(str, usedMemorySizeDescriptors);
-    write(str, total.blocksCount);
+    write(str, static_cast<uint64_t>(total.blocksCount));
     write(str, descriptors_count);
     write(str, static_cast<uint32_t>(trees.size()));
     write(str, bookmarksCount);
     write(str, static_cast<uint16_t>(0)); // padding
 
+    profiler::index::FileIndexBuilder fileIndex;
+    fileIndex.skip(sizeof(EASY_PROFILER_SIGNATURE) + sizeof(EASY_PROFILER_VERSION) + sizeof(pid) + sizeof(int64_t)
+                   + sizeof(beginTime) + sizeof(endTime) + sizeof(total.usedMemorySize) + sizeof(usedMemorySizeDescriptors)
+                   + sizeof(uint64_t) + sizeof(descriptors_count) + sizeof(uint32_t) + sizeof(bookmarksCount)
+                   + sizeof(uint16_t));
+
     std::vector<char> buffer;
 
     // Serialize all descriptors
-    serializeDescriptors(str, buffer, descriptors, descriptors_count);
+    beginSection(profiler::SinkSection::Descriptors, 0);
+    fileIndex.skip(serializeDescriptors(str, buffer, descriptors, descriptors_count));
 
     // Serialize all blocks
     i = 0;
@@ -531,34 +560,82 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
         const auto& range = block_ranges.at(id);
 
         const auto nameSize = static_cast<uint16_t>(tree.thread_name.size() + 1);
+        beginSection(profiler::SinkSection::ThreadInfo, id);
         write(str, id);
         write(str, nameSize);
         write(str, tree.name(), nameSize);
 
+        profiler::index::ThreadIndexBuilder threadIndex(id);
+        threadIndex.skip(sizeof(id) + sizeof(nameSize) + nameSize);
+
         // Serialize context switches
-        write(str, range.cswitchesMemoryAndCount.blocksCount);
+        write(str, static_cast<uint64_t>(range.cswitchesMemoryAndCount.blocksCount));
+        threadIndex.beginContextSwitches(range.cswitchesMemoryAndCount.blocksCount);
         if (range.cswitchesMemoryAndCount.blocksCount != 0)
-            serializeContextSwitches(str, buffer, tree.sync, range.cswitches, block_getter);
+            serializeContextSwitches(str, buffer, tree.sync, range.cswitches, block_getter, threadIndex);
 
         // Serialize blocks
-        write(str, range.blocksMemoryAndCount.blocksCount);
+        write(str, static_cast<uint64_t>(range.blocksMemoryAndCount.blocksCount));
+        threadIndex.beginBlocks(range.blocksMemoryAndCount.blocksCount);
         if (range.blocksMemoryAndCount.blocksCount != 0)
-            serializeBlocks(str, buffer, tree.children, range.blocks, block_getter, descriptors);
+            serializeBlocks(str, buffer, tree.children, range.blocks, block_getter, descriptors, threadIndex);
+
+        threadIndex.finish();
+        fileIndex.addThread(threadIndex);
 
         if (!update_progress_write(progress, 40 + 57 / static_cast<int>(trees.size() - i), log))
             return 0;
     }
 
+    beginSection(profiler::SinkSection::Footer, 0);
     write(str, EASY_PROFILER_SIGNATURE);
+    fileIndex.skip(sizeof(EASY_PROFILER_SIGNATURE));
 
     // Serialize bookmarks
     if (bookmarksCount != 0)
     {
-        serializeBookmarks(str, bookmarks, bookmarksRange);
+        fileIndex.skip(serializeBookmarks(str, bookmarks, bookmarksRange));
         write(str, EASY_PROFILER_SIGNATURE);
+        fileIndex.skip(sizeof(EASY_PROFILER_SIGNATURE));
     }
 
+    // Seekable index goes after all other data, so readers which do not know about it just ignore it
+    std::vector<char> indexData;
+    fileIndex.serialize(indexData);
+    beginSection(profiler::SinkSection::Index, 0);
+    write(str, indexData.data(), indexData.size());
+
     return total.blocksCount;
 }
 
 //////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
+                                                                   const profiler::SerializedData& serialized_descriptors,
+                                                                   const profiler::descriptors_list_t& descriptors,
+                                                                   profiler::block_id_t descriptors_count,
+                                                                   const profiler::thread_blocks_tree_t& trees,
+                                                                   const profiler::bookmarks_t& bookmarks,
+                                                                   profiler::block_getter_fn block_getter,
+                                                                   profiler::timestamp_t begin_time,
+                                                                   profiler::timestamp_t end_time,
+                                                                   profiler::processid_t pid,
+                                                                   std::ostream& log,
+                                                                   profiler::CompressionCodec codec)
+{
+    if (codec == profiler::CompressionCodec::None)
+    {
+        return writeTrees(progress, str, nullptr, serialized_descriptors, descriptors, descriptors_count, trees,
+                          bookmarks, block_getter, begin_time, end_time, pid, log);
+    }
+
+    profiler::compression::CompressedOutputStream packedStream(str, codec);
+    const auto result = writeTrees(progress, packedStream, &packedStream, serialized_descriptors, descriptors,
+                                   descriptors_count, trees, bookmarks, block_getter, begin_time, end_time, pid, log);
+    if (result != 0)
+        packedStream.finish();
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -2218,7 +2218,7 @@ void ArbitraryValuesWidget::onSelectedThreadChanged(profiler::thread_id_t)
     //rebuild();
 }
 
-void ArbitraryValuesWidget::onSelectedBlockChanged(uint32_t)
+void ArbitraryValuesWidget::onSelectedBlockChanged(profiler::block_index_t)
 {
     m_chart->scene()->update();
 
@@ -382,7 +382,7 @@ private slots:
 
     void onHeaderSectionResized(int logicalIndex, int oldSize, int newSize);
     void onSelectedThreadChanged(profiler::thread_id_t);
-    void onSelectedBlockChanged(uint32_t _block_index);
+    void onSelectedBlockChanged(profiler::block_index_t _block_index);
     void onSelectedBlockIdChanged(profiler::block_id_t _id);
     void onItemDoubleClicked(QTreeWidgetItem* _item, int _column);
     void onItemChanged(QTreeWidgetItem* _item, int _column);
@@ -101,9 +101,9 @@ ArbitraryValueToolTip::ArbitraryValueToolTip(const QString& _name
         pane->append(firstString);
         rowsCount += 1;
 
-        if (_block.per_thread_stats != nullptr)
+        if (_block.per_thread_stats() != nullptr)
         {
-            pane->append(QString("N calls/Thread: %1").arg(_block.per_thread_stats->calls_number));
+            pane->append(QString("N calls/Thread: %1").arg(_block.per_thread_stats()->calls_number));
             rowsCount += 1;
         }
 
@@ -131,9 +131,9 @@ ArbitraryValueToolTip::ArbitraryValueToolTip(const QString& _name
 
         pane->append(firstString);
 
-        if (_block.per_thread_stats != nullptr)
+        if (_block.per_thread_stats() != nullptr)
         {
-            pane->append(QString("N calls/Thread: %1").arg(_block.per_thread_stats->calls_number));
+            pane->append(QString("N calls/Thread: %1").arg(_block.per_thread_stats()->calls_number));
             rowsCount += 1;
         }
 
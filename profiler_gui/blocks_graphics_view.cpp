@@ -65,6 +65,8 @@
 ************************************************************************/
 
 #include <math.h>
+#include <string>
+#include <unordered_map>
 
 #include <QApplication>
 #include <QDebug>
@@ -84,6 +86,7 @@
 #include "blocks_graphics_view.h"
 #include "bookmarks_editor.h"
 #include "graphics_block_item.h"
+#include "graphics_thread_group_item.h"
 #include "graphics_ruler_item.h"
 #include "graphics_scrollbar.h"
 #include "globals.h"
@@ -97,6 +100,7 @@ const qreal BASE_SCALE = pow(profiler_gui::SCALING_COEFFICIENT_INV, 25); // ~0.0
 
 EASY_CONSTEXPR QRgb BACKGROUND_1 = 0xffe4e4ec;
 EASY_CONSTEXPR QRgb BACKGROUND_2 = profiler::colors::White;
+EASY_CONSTEXPR QRgb THREAD_GROUP_BACKGROUND = 0xffdce6dc;
 EASY_CONSTEXPR QRgb TIMELINE_BACKGROUND = 0x20000000 | (profiler::colors::Grey800 & 0x00ffffff);// 0x20303030;
 EASY_CONSTEXPR QRgb TIMELINE_BORDER = 0xffa8a0a0;
 
@@ -106,6 +110,8 @@ EASY_CONSTEXPR uint64_t IDLE_TIME = 400;
 EASY_CONSTEXPR int FLICKER_INTERVAL = 10; // 100Hz
 EASY_CONSTEXPR qreal FLICKER_FACTOR = 16.0 / FLICKER_INTERVAL;
 
+EASY_CONSTEXPR size_t MIN_THREAD_GROUP_SIZE = 4; ///< Minimum number of similar threads which are folded into one lane
+
 EASY_CONSTEXPR int BOOKMARK_WIDTH = 8;
 EASY_CONSTEXPR int BOOKMARK_HEIGHT = 11;
 
@@ -178,19 +184,23 @@ void BackgroundItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*,
     {
         const auto overlap = EASY_GLOBALS.size.threads_row_spacing >> 1;
         static const QBrush brushes[2] = {QColor::fromRgb(BACKGROUND_1), QColor::fromRgb(BACKGROUND_2)};
-        int i = -1;
 
         // Draw background
         _painter->setPen(profiler_gui::SYSTEM_BORDER_COLOR);
-        for (auto item : items)
+        for (auto i = sceneView->firstItemBelow(visibleSceneRect.top()), n = items.size(); i < n; ++i)
         {
-            ++i;
+            const auto item = items[i];
+            if (!item->isVisible())
+                continue; // folded into thread group lane
 
             auto br = item->boundingRect();
             auto top = item->y() + br.top() - visibleSceneRect.top();
             auto bottom = top + br.height();
 
-            if (top > h || bottom < 0)
+            if (top > h)
+                break;
+
+            if (bottom < 0)
                 continue;
 
             if (item->threadId() == EASY_GLOBALS.selected_thread)
@@ -208,6 +218,27 @@ void BackgroundItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*,
 
             _painter->drawRect(rect);
         }
+
+        // Draw background of thread groups lanes
+        _painter->setBrush(QColor::fromRgb(THREAD_GROUP_BACKGROUND));
+        for (auto group : sceneView->getThreadGroups())
+        {
+            const auto top = group->y() - visibleSceneRect.top();
+            const auto height = group->boundingRect().height();
+
+            if (top > h || top + height < 0)
+                continue;
+
+            rect.setRect(0, top - overlap, visibleSceneRect.width(), height + EASY_GLOBALS.size.threads_row_spacing);
+            const auto dh = rect.bottom() - visibleBottom;
+            if (dh > 0)
+                rect.setHeight(rect.height() - dh);
+
+            if (rect.top() < 0)
+                rect.setTop(0);
+
+            _painter->drawRect(rect);
+        }
     }
 
     // Draw timeline scale marks ----------------
@@ -801,6 +832,8 @@ void BlocksGraphicsView::clear()
     removePopup();
     scene()->clear();
     m_items.clear();
+    m_builtLanes.clear();
+    m_threadGroups.clear();
     m_selectedBlocks.clear();
     m_backgroundItem = nullptr;
 
@@ -927,13 +960,38 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
     m_beginTime -= std::min(m_beginTime, additional_offset);
     EASY_GLOBALS.begin_time = m_beginTime;
 
-    // Sort threads by name
-    std::vector<std::reference_wrapper<const profiler::BlocksTreeRoot> > sorted_roots;
+    // Group similar threads ("Worker 1", "Worker 2", ...)
+    struct SortedRoot
+    {
+        const profiler::BlocksTreeRoot* root;
+        std::string group; ///< Name of the threads group or empty string if the thread is not grouped
+    };
+
+    std::vector<SortedRoot> sorted_roots;
+    std::unordered_map<std::string, size_t> groups_sizes;
     sorted_roots.reserve(_blocksTree.size());
     for (const auto& threadTree : _blocksTree)
-        sorted_roots.emplace_back(threadTree.second);
-    std::sort(sorted_roots.begin(), sorted_roots.end(), [](const profiler::BlocksTreeRoot& _a, const profiler::BlocksTreeRoot& _b) {
-        return _a.thread_name < _b.thread_name;
+    {
+        sorted_roots.push_back(SortedRoot {&threadTree.second, threadGroupName(threadTree.second.thread_name)});
+        if (!sorted_roots.back().group.empty())
+            ++groups_sizes[sorted_roots.back().group];
+    }
+
+    for (auto& sorted : sorted_roots)
+    {
+        if (!sorted.group.empty() && groups_sizes[sorted.group] < MIN_THREAD_GROUP_SIZE)
+            sorted.group.clear();
+    }
+
+    // Sort threads by name (threads of one group are placed one after another)
+    std::sort(sorted_roots.begin(), sorted_roots.end(), [](const SortedRoot& _a, const SortedRoot& _b) {
+        const auto& a = _a.group.empty() ? _a.root->thread_name : _a.group;
+        const auto& b = _b.group.empty() ? _b.root->thread_name : _b.group;
+        if (a != b)
+            return a < b;
+        if (_a.group.empty() != _b.group.empty())
+            return _a.group.empty();
+        return _a.root->thread_name < _b.root->thread_name;
     });
 
     const auto row_height = EASY_GLOBALS.size.graphics_row_height;
@@ -942,14 +1000,10 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
     // Filling scene with items
     m_items.reserve(_blocksTree.size());
     qreal y = EASY_GLOBALS.size.timeline_height;
-    const GraphicsBlockItem *longestItem = nullptr, *mainThreadItem = nullptr;
-    for (const profiler::BlocksTreeRoot& t : sorted_roots)
+    GraphicsBlockItem *longestItem = nullptr, *mainThreadItem = nullptr;
+    for (const auto& sorted : sorted_roots)
     {
-        if (m_items.size() == 0xff)
-        {
-            qWarning() << "Warning: Maximum threads number (255 threads) exceeded! See BlocksGraphicsView::setTree() : " << __LINE__ << " in file " << __FILE__;
-            break;
-        }
+        const auto& t = *sorted.root;
 
         // fill scene with new items
         qreal h = 0, x = 0;
@@ -959,17 +1013,15 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
         else if (!t.sync.empty())
             x = time2position(easyBlocksTree(t.sync.front()).node->begin());
 
-        auto item = new GraphicsBlockItem(static_cast<uint8_t>(m_items.size()), t);
-        if (t.depth)
-            item->setLevels(t.depth);
+        auto item = new GraphicsBlockItem(static_cast<uint32_t>(m_items.size()), t);
         item->setPos(0, y);
 
         qreal children_duration = 0;
 
         if (!t.children.empty())
         {
-            uint32_t dummy = 0;
-            children_duration = setTree(item, t.children, h, dummy, y, 0);
+            // Only the size of the lane is calculated here, its items are created by buildLane() when the lane becomes visible
+            children_duration = measureTree(t.children, item->index(), h, 0);
         }
         else
         {
@@ -993,6 +1045,35 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
 
     // Calculating scene rect
     m_sceneWidth = time2position(finish);
+
+    // Create aggregated lanes for groups of threads
+    for (size_t i = 0, n = sorted_roots.size(); i < n;)
+    {
+        const auto& group = sorted_roots[i].group;
+
+        auto end = i + 1;
+        while (end < n && sorted_roots[end].group == group)
+            ++end;
+
+        if (!group.empty())
+        {
+            GraphicsThreadGroupItem::Threads threads;
+            threads.reserve(end - i);
+            for (auto j = i; j < end; ++j)
+                threads.push_back(sorted_roots[j].root);
+
+            auto groupItem = new GraphicsThreadGroupItem(profiler_gui::toUnicode(group.c_str()), static_cast<uint32_t>(i), std::move(threads));
+            groupItem->setBoundingRect(0, 0, m_sceneWidth, groupItem->boundingRect().height());
+            groupItem->calculate(m_beginTime, finish);
+            m_threadGroups.push_back(groupItem);
+            scene()->addItem(groupItem);
+
+            y += groupItem->boundingRect().height() + EASY_GLOBALS.size.threads_row_spacing;
+        }
+
+        i = end;
+    }
+
     setSceneRect(0, 0, m_sceneWidth, y + EASY_GLOBALS.size.timeline_height);
     EASY_GLOBALS.scene.empty = false;
 
@@ -1015,6 +1096,9 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
     connect(m_backgroundItem, &BackgroundItem::moved, indicator, &ForegroundItem::onMoved);
     scene()->addItem(indicator);
 
+    // Scene rect above fits all lanes expanded. Now place lanes according to groups folding.
+    updateLanesLayout();
+
     // Setting flags
     m_bEmpty = false;
 
@@ -1028,6 +1112,7 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
 
     if (longestItem != nullptr)
     {
+        buildLane(longestItem);
         EASY_GLOBALS.selected_thread = longestItem->threadId();
         emit EASY_GLOBALS.events.selectedThreadChanged(longestItem->threadId());
 
@@ -1072,6 +1157,115 @@ const BlocksGraphicsView::Items &BlocksGraphicsView::getItems() const
     return m_items;
 }
 
+size_t BlocksGraphicsView::firstItemBelow(qreal _sceneY) const
+{
+    const auto spacing = EASY_GLOBALS.size.threads_row_spacing;
+    auto it = std::lower_bound(m_items.begin(), m_items.end(), _sceneY, [spacing](const GraphicsBlockItem* _item, qreal _value)
+    {
+        // Folded threads are hidden at the top of their group lane (see updateLanesLayout())
+        if (!_item->isVisible())
+            return _item->y() < _value;
+        return _item->y() + _item->boundingRect().bottom() + spacing < _value;
+    });
+
+    return static_cast<size_t>(std::distance(m_items.begin(), it));
+}
+
+const BlocksGraphicsView::ThreadGroups& BlocksGraphicsView::getThreadGroups() const
+{
+    return m_threadGroups;
+}
+
+GraphicsThreadGroupItem* BlocksGraphicsView::threadGroup(const GraphicsBlockItem* _item) const
+{
+    const auto index = _item->index();
+    for (auto group : m_threadGroups)
+    {
+        if (group->firstItem() <= index && index < group->firstItem() + group->itemsNumber())
+            return group;
+    }
+
+    return nullptr;
+}
+
+void BlocksGraphicsView::setThreadGroupExpanded(GraphicsThreadGroupItem* _group, bool _expanded)
+{
+    if (_group->isExpanded() == _expanded)
+        return;
+
+    _group->setExpanded(_expanded);
+    onLanesLayoutChanged();
+}
+
+void BlocksGraphicsView::foldThreadGroups(bool _fold)
+{
+    bool changed = false;
+    for (auto group : m_threadGroups)
+    {
+        if (group->isExpanded() == _fold)
+        {
+            group->setExpanded(!_fold);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        onLanesLayoutChanged();
+}
+
+void BlocksGraphicsView::updateLanesLayout()
+{
+    const auto spacing = EASY_GLOBALS.size.threads_row_spacing;
+    qreal y = EASY_GLOBALS.size.timeline_height;
+    uint32_t i = 0;
+
+    const auto placeThreads = [this, &y, &i, spacing] (uint32_t _end)
+    {
+        for (; i < _end; ++i)
+        {
+            auto item = m_items[i];
+            item->setVisible(true);
+            item->setPos(0, y);
+            y += item->boundingRect().height() + spacing;
+        }
+    };
+
+    for (auto group : m_threadGroups)
+    {
+        placeThreads(group->firstItem());
+
+        // Aggregated lane is placed above threads of the group
+        group->setPos(0, y);
+        y += group->boundingRect().height() + spacing;
+
+        if (group->isExpanded())
+            continue;
+
+        // Folded threads are hidden. They stay at the top of the group lane to keep items sorted by y.
+        for (const auto end = i + group->itemsNumber(); i < end; ++i)
+        {
+            m_items[i]->setVisible(false);
+            m_items[i]->setPos(0, group->y());
+        }
+    }
+
+    placeThreads(static_cast<uint32_t>(m_items.size()));
+
+    setSceneRect(0, 0, m_sceneWidth, y + EASY_GLOBALS.size.timeline_height);
+}
+
+void BlocksGraphicsView::onLanesLayoutChanged()
+{
+    if (m_bEmpty)
+        return;
+
+    removePopup();
+    updateLanesLayout();
+    updateVisibleSceneRect();
+    emit treeChanged();
+    repaintScene();
+}
+
 bool BlocksGraphicsView::getSelectionRegionForSaving(profiler::timestamp_t& _beginTime, profiler::timestamp_t& _endTime) const
 {
     if (m_bEmpty)
@@ -1087,6 +1281,119 @@ bool BlocksGraphicsView::getSelectionRegionForSaving(profiler::timestamp_t& _beg
     return true;
 }
 
+qreal BlocksGraphicsView::measureTree(const profiler::BlocksTree::children_t& _children, uint32_t _lane, qreal& _height, short _level)
+{
+    // Same calculations as in setTree() but without creating items
+    if (_children.empty())
+    {
+        return 0;
+    }
+
+    const short next_level = _level + 1;
+    qreal total_duration = 0, maxh = 0;
+    qreal start_time = -1;
+    for (auto child_index : _children)
+    {
+        auto& gui_block = easyBlock(child_index);
+        const auto& child = gui_block.tree;
+
+        // Level and index of the item are set by setTree() when the lane is built
+        gui_block.graphics_item = _lane;
+
+        const auto xbegin = time2position(child.node->begin());
+        if (start_time < 0)
+        {
+            start_time = xbegin;
+        }
+
+        auto duration = time2position(child.node->end()) - xbegin;
+
+        qreal h = 0;
+        if (next_level < profiler_gui::MAX_GRAPHICS_LEVELS)
+        {
+            const auto children_duration = measureTree(child.children, _lane, h, next_level);
+            if (duration < children_duration)
+            {
+                duration = children_duration;
+            }
+        }
+
+        if (h > maxh)
+        {
+            maxh = h;
+        }
+
+        total_duration = xbegin + duration - start_time;
+    }
+
+    _height += EASY_GLOBALS.size.graphics_row_full + maxh;
+
+    return total_duration;
+}
+
+void BlocksGraphicsView::buildLane(GraphicsBlockItem* _item)
+{
+    if (_item->built())
+    {
+        return;
+    }
+
+    const auto& t = _item->root();
+    if (t.depth)
+        _item->setLevels(std::min(t.depth, profiler_gui::MAX_GRAPHICS_LEVELS));
+
+    if (!t.children.empty())
+    {
+        qreal h = 0;
+        uint32_t dummy = 0;
+        setTree(_item, t.children, h, dummy, _item->y(), 0);
+    }
+
+    _item->setBuilt();
+    m_builtLanes.push_back(_item);
+}
+
+void BlocksGraphicsView::updateBuiltLanes()
+{
+    if (m_items.empty())
+    {
+        return;
+    }
+
+    // Lanes are built one screen ahead and released two screens away,
+    // so scrolling back and forth does not rebuild them on every step
+    const auto top = m_visibleSceneRect.top();
+    const auto bottom = m_visibleSceneRect.bottom();
+    const auto height = std::max(m_visibleSceneRect.height(), static_cast<qreal>(EASY_GLOBALS.size.graphics_row_full));
+    const auto histogramThread = m_pScrollbar != nullptr ? m_pScrollbar->histThread() : 0;
+
+    // Histogram refers to items of the lane, so selected thread lane is never released
+    auto last = std::remove_if(m_builtLanes.begin(), m_builtLanes.end(), [&](GraphicsBlockItem* _item)
+    {
+        const auto itemTop = _item->y() + _item->boundingRect().top();
+        if (_item->isVisible() && itemTop + _item->boundingRect().height() > top - 2 * height && itemTop < bottom + 2 * height)
+            return false;
+
+        if (_item->threadId() == EASY_GLOBALS.selected_thread || _item->threadId() == histogramThread)
+            return false;
+
+        _item->clearLevels();
+        return true;
+    });
+
+    m_builtLanes.erase(last, m_builtLanes.end());
+
+    for (auto i = firstItemBelow(top - height), n = m_items.size(); i < n; ++i)
+    {
+        auto item = m_items[i];
+        if (item->y() > bottom + height)
+            break;
+
+        if (item->isVisible())
+            buildLane(item);
+    }
+}
+
 qreal BlocksGraphicsView::setTree(GraphicsBlockItem* _item, const profiler::BlocksTree::children_t& _children, qreal& _height, uint32_t& _maxDepthChild, qreal _y, short _level)
 {
     if (_children.empty())
@@ -1094,12 +1401,12 @@ qreal BlocksGraphicsView::setTree(GraphicsBlockItem* _item, const profiler::Bloc
         return 0;
     }
 
-    const auto level = static_cast<uint8_t>(_level);
+    const auto level = static_cast<uint16_t>(_level);
     const auto n = static_cast<unsigned int>(_children.size());
     _item->reserve(level, n);
 
     _maxDepthChild = 0;
-    uint8_t maxDepth = 0;
+    uint16_t maxDepth = 0;
     const short next_level = _level + 1;
     bool warned = false;
     qreal total_duration = 0, prev_end = 0, maxh = 0;
@@ -1141,9 +1448,9 @@ qreal BlocksGraphicsView::setTree(GraphicsBlockItem* _item, const profiler::Bloc
         gui_block.graphics_item_level = level;
         gui_block.graphics_item_index = i;
 
-        if (next_level < 256 && next_level < _item->levels() && !child.children.empty())
+        if (next_level < profiler_gui::MAX_GRAPHICS_LEVELS && next_level < _item->levels() && !child.children.empty())
         {
-            b.children_begin = static_cast<unsigned int>(_item->items(static_cast<uint8_t>(next_level)).size());
+            b.children_begin = static_cast<unsigned int>(_item->items(static_cast<uint16_t>(next_level)).size());
         }
         else
         {
@@ -1154,7 +1461,7 @@ qreal BlocksGraphicsView::setTree(GraphicsBlockItem* _item, const profiler::Bloc
         qreal children_duration = 0;
         uint32_t maxDepthChild = 0;
 
-        if (next_level < 256)
+        if (next_level < profiler_gui::MAX_GRAPHICS_LEVELS)
         {
             children_duration = setTree(_item, child.children, h, maxDepthChild,
                                         _y + EASY_GLOBALS.size.graphics_row_full, next_level);
@@ -1162,7 +1469,7 @@ qreal BlocksGraphicsView::setTree(GraphicsBlockItem* _item, const profiler::Bloc
         else if (!child.children.empty() && !warned)
         {
             warned = true;
-            qWarning() << "Warning: Maximum blocks depth (255) exceeded! See BlocksGraphicsView::setTree() : " << __LINE__ << " in file " << __FILE__;
+            qWarning() << "Warning: Maximum blocks depth (" << profiler_gui::MAX_GRAPHICS_LEVELS << ") exceeded! Deeper blocks are collapsed. See BlocksGraphicsView::setTree() : " << __LINE__ << " in file " << __FILE__;
         }
 
         if (duration < children_duration)
@@ -1234,6 +1541,8 @@ int BlocksGraphicsView::updateVisibleSceneRect()
     m_visibleSceneRect.setWidth(m_visibleSceneRect.width() - vbar_width);
     m_visibleSceneRect.setHeight(m_visibleSceneRect.height() - EASY_GLOBALS.size.timeline_height);
 
+    updateBuiltLanes();
+
     return vbar_width;
 }
 
@@ -1546,6 +1855,7 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
 
     const profiler_gui::EasyBlock* selectedBlock = nullptr;
     profiler::thread_id_t selectedBlockThread = 0;
+    GraphicsThreadGroupItem* expandedGroup = nullptr;
     bool jumpToZone = false;
     bool changedSelectionBySelectingItem = false;
     const bool leftClickSelect = (m_mouseButtons & Qt::LeftButton) != 0;
@@ -1577,10 +1887,26 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
         {
             mouseClickPos.setX(m_offset + mouseClickPos.x() / m_scale);
 
+            // Click on folded thread group lane expands the group
+            if (leftClickSelect)
+            {
+                for (auto group : m_threadGroups)
+                {
+                    if (!group->isExpanded() && group->y() <= mouseClickPos.y() && mouseClickPos.y() <= group->y() + group->boundingRect().height())
+                    {
+                        expandedGroup = group;
+                        break;
+                    }
+                }
+            }
+
             // Try to select one of item blocks
             for (auto item : m_items)
             {
-                profiler::block_index_t i = ~0U;
+                if (expandedGroup != nullptr)
+                    break;
+
+                profiler::block_index_t i = profiler_gui::numeric_max<profiler::block_index_t>();
                 auto block = item->intersect(mouseClickPos, i);
                 if (block != nullptr)
                 {
@@ -1593,7 +1919,7 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
                 }
             }
 
-            if (!changedSelectedItem && !profiler_gui::is_max(EASY_GLOBALS.selected_block))
+            if (expandedGroup == nullptr && !changedSelectedItem && !profiler_gui::is_max(EASY_GLOBALS.selected_block))
             {
                 changedSelectedItem = true;
                 profiler_gui::set_max(EASY_GLOBALS.selected_block);
@@ -1610,6 +1936,7 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
             }
 
             const auto thread_item = m_items[selectedBlock->graphics_item];
+            buildLane(thread_item);
             const auto& selectedItem = thread_item->items(selectedBlock->graphics_item_level)[selectedBlock->graphics_item_index];
             const auto left = selectedItem.left();
             const auto right = selectedItem.right();
@@ -1646,6 +1973,9 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
     m_mouseMovePath = QPoint();
     _event->accept();
 
+    if (expandedGroup != nullptr)
+        setThreadGroupExpanded(expandedGroup, true);
+
     if (changedSelection)
     {
         profiler::timestamp_t left=0, right=0;
@@ -1701,6 +2031,7 @@ void BlocksGraphicsView::mouseReleaseEvent(QMouseEvent* _event)
             {
                 if (item->threadId() == EASY_GLOBALS.selected_thread)
                 {
+                    buildLane(item);
                     m_pScrollbar->setHistogramSource(EASY_GLOBALS.selected_thread, item->items(0));
                     break;
                 }
@@ -2127,6 +2458,7 @@ void BlocksGraphicsView::initMode()
                 {
                     if (item->threadId() == EASY_GLOBALS.selected_thread)
                     {
+                        buildLane(item);
                         m_pScrollbar->setHistogramSource(EASY_GLOBALS.selected_thread, item->items(0));
                         break;
                     }
@@ -2360,10 +2692,10 @@ void BlocksGraphicsView::onIdleTimeout()
             lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, duration, 3), widget), row, 1, 1, 2, Qt::AlignLeft);
             ++row;
 
-            if (itemBlock.per_thread_stats)
+            if (itemBlock.per_thread_stats())
             {
                 lay->addWidget(new QLabel("Total:", widget), row, 0, Qt::AlignRight);
-                lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats->total_duration, 3), widget), row, 1, 1, 2, Qt::AlignLeft);
+                lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats()->total_duration, 3), widget), row, 1, 1, 2, Qt::AlignLeft);
                 ++row;
 
                 lay->addWidget(new BoldLabel("-------- Statistics --------", widget), row, 0, 1, 3, Qt::AlignHCenter);
@@ -2377,24 +2709,24 @@ void BlocksGraphicsView::onIdleTimeout()
                 auto percent = profiler_gui::percentReal(duration, item->root().profiled_time);
                 lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 2, 1, Qt::AlignHCenter);
 
-                lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats->total_duration, item->root().profiled_time)), widget), row + 3, 1, Qt::AlignHCenter);
+                lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats()->total_duration, item->root().profiled_time)), widget), row + 3, 1, Qt::AlignHCenter);
 
-                lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats->calls_number), widget), row + 4, 1, Qt::AlignHCenter);
+                lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats()->calls_number), widget), row + 4, 1, Qt::AlignHCenter);
 
-                if (itemBlock.per_frame_stats && !profiler_gui::is_max(itemBlock.per_frame_stats->parent_block))
+                if (itemBlock.per_frame_stats() && !profiler_gui::is_max(itemBlock.per_frame_stats()->parent_block))
                 {
                     int col = 2;
-                    auto frame_duration = easyBlocksTree(itemBlock.per_frame_stats->parent_block).node->duration();
+                    auto frame_duration = easyBlocksTree(itemBlock.per_frame_stats()->parent_block).node->duration();
 
                     lay->addWidget(new QLabel("Frame", widget), row + 1, col, Qt::AlignHCenter);
 
                     percent = profiler_gui::percentReal(duration, frame_duration);
                     lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 2, col, Qt::AlignHCenter);
 
-                    percent = profiler_gui::percentReal(itemBlock.per_frame_stats->total_duration, frame_duration);
+                    percent = profiler_gui::percentReal(itemBlock.per_frame_stats()->total_duration, frame_duration);
                     lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 3, col, Qt::AlignHCenter);
 
-                    lay->addWidget(new QLabel(QString::number(itemBlock.per_frame_stats->calls_number), widget), row + 4, col, Qt::AlignHCenter);
+                    lay->addWidget(new QLabel(QString::number(itemBlock.per_frame_stats()->calls_number), widget), row + 4, col, Qt::AlignHCenter);
                 }
             }
 
@@ -2403,7 +2735,7 @@ void BlocksGraphicsView::onIdleTimeout()
             break;
         }
 
-        profiler::block_index_t i = ~0U;
+        profiler::block_index_t i = profiler_gui::numeric_max<profiler::block_index_t>();
         auto block = item->intersect(pos, i);
         if (block != nullptr)
         {
@@ -2508,20 +2840,27 @@ void BlocksGraphicsView::onIdleTimeout()
                 }
             }
 
-            if (itemBlock.per_thread_stats != nullptr)
+            if (itemBlock.per_thread_stats() != nullptr)
             {
                 if (itemDesc.type() == profiler::BlockType::Block)
                 {
                     const auto duration = itemBlock.node->duration();
 
                     lay->addWidget(new QLabel("Avg:", widget), row, 0, Qt::AlignRight);
-                    lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats->average_duration(), 3), widget), row, 1, 1, 3, Qt::AlignLeft);
+                    lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats()->average_duration(), 3), widget), row, 1, 1, 3, Qt::AlignLeft);
                     ++row;
 
                     lay->addWidget(new QLabel("Median:", widget), row, 0, Qt::AlignRight);
-                    lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats->median_duration, 3), widget), row, 1, 1, 3, Qt::AlignLeft);
+                    lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats()->median_duration, 3), widget), row, 1, 1, 3, Qt::AlignLeft);
                     ++row;
 
+                    for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+                    {
+                        lay->addWidget(new QLabel(QString("P%1:").arg(profiler::stats_percentile(i)), widget), row, 0, Qt::AlignRight);
+                        lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats()->percentile_durations[i], 3), widget), row, 1, 1, 3, Qt::AlignLeft);
+                        ++row;
+                    }
+
                     // Calculate idle/active time
                     {
                         const auto& threadRoot = item->root();
@@ -2576,50 +2915,50 @@ void BlocksGraphicsView::onIdleTimeout()
                     auto percent = profiler_gui::percentReal(duration, item->root().profiled_time);
                     lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 2, 1, Qt::AlignHCenter);
 
-                    lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats->total_duration, item->root().profiled_time)), widget), row + 3, 1, Qt::AlignHCenter);
+                    lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats()->total_duration, item->root().profiled_time)), widget), row + 3, 1, Qt::AlignHCenter);
 
-                    lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats->total_duration - itemBlock.per_thread_stats->total_children_duration, item->root().profiled_time)), widget), row + 4, 1, Qt::AlignHCenter);
+                    lay->addWidget(new QLabel(QString::number(profiler_gui::percent(itemBlock.per_thread_stats()->total_duration - itemBlock.per_thread_stats()->total_children_duration, item->root().profiled_time)), widget), row + 4, 1, Qt::AlignHCenter);
 
-                    lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats->calls_number), widget), row + 5, 1, Qt::AlignHCenter);
+                    lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats()->calls_number), widget), row + 5, 1, Qt::AlignHCenter);
 
                     int col = 1;
 
-                    if (itemBlock.per_frame_stats->parent_block != i && !profiler_gui::is_max(itemBlock.per_frame_stats->parent_block))
+                    if (itemBlock.per_frame_stats()->parent_block != i && !profiler_gui::is_max(itemBlock.per_frame_stats()->parent_block))
                     {
                         ++col;
-                        auto frame_duration = easyBlocksTree(itemBlock.per_frame_stats->parent_block).node->duration();
+                        auto frame_duration = easyBlocksTree(itemBlock.per_frame_stats()->parent_block).node->duration();
 
                         lay->addWidget(new QLabel("Frame", widget), row + 1, col, Qt::AlignHCenter);
 
                         percent = profiler_gui::percentReal(duration, frame_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 2, col, Qt::AlignHCenter);
 
-                        percent = profiler_gui::percentReal(itemBlock.per_frame_stats->total_duration, frame_duration);
+                        percent = profiler_gui::percentReal(itemBlock.per_frame_stats()->total_duration, frame_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 3, col, Qt::AlignHCenter);
 
-                        percent = profiler_gui::percentReal(itemBlock.per_frame_stats->total_duration - itemBlock.per_frame_stats->total_children_duration, frame_duration);
+                        percent = profiler_gui::percentReal(itemBlock.per_frame_stats()->total_duration - itemBlock.per_frame_stats()->total_children_duration, frame_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 4, col, Qt::AlignHCenter);
 
-                        lay->addWidget(new QLabel(QString::number(itemBlock.per_frame_stats->calls_number), widget), row + 5, col, Qt::AlignHCenter);
+                        lay->addWidget(new QLabel(QString::number(itemBlock.per_frame_stats()->calls_number), widget), row + 5, col, Qt::AlignHCenter);
                     }
 
-                    if (!profiler_gui::is_max(itemBlock.per_parent_stats->parent_block))
+                    if (!profiler_gui::is_max(itemBlock.per_parent_stats()->parent_block))
                     {
                         ++col;
-                        auto parent_duration = easyBlocksTree(itemBlock.per_parent_stats->parent_block).node->duration();
+                        auto parent_duration = easyBlocksTree(itemBlock.per_parent_stats()->parent_block).node->duration();
 
                         lay->addWidget(new QLabel("Parent", widget), row + 1, col, Qt::AlignHCenter);
 
                         percent = profiler_gui::percentReal(duration, parent_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 2, col, Qt::AlignHCenter);
 
-                        percent = profiler_gui::percentReal(itemBlock.per_parent_stats->total_duration, parent_duration);
+                        percent = profiler_gui::percentReal(itemBlock.per_parent_stats()->total_duration, parent_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 3, col, Qt::AlignHCenter);
 
-                        percent = profiler_gui::percentReal(itemBlock.per_parent_stats->total_duration - itemBlock.per_parent_stats->total_children_duration, parent_duration);
+                        percent = profiler_gui::percentReal(itemBlock.per_parent_stats()->total_duration - itemBlock.per_parent_stats()->total_children_duration, parent_duration);
                         lay->addWidget(new QLabel(0.005 < percent && percent < 0.5001 ? QString::number(percent, 'f', 2) : QString::number(static_cast<int>(0.5 + percent)), widget), row + 4, col, Qt::AlignHCenter);
 
-                        lay->addWidget(new QLabel(QString::number(itemBlock.per_parent_stats->calls_number), widget), row + 5, col, Qt::AlignHCenter);
+                        lay->addWidget(new QLabel(QString::number(itemBlock.per_parent_stats()->calls_number), widget), row + 5, col, Qt::AlignHCenter);
 
                         ++col;
                     }
@@ -2627,7 +2966,7 @@ void BlocksGraphicsView::onIdleTimeout()
                 else
                 {
                     lay->addWidget(new QLabel("N calls/Thread:", widget), row, 0, Qt::AlignRight);
-                    lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats->calls_number), widget), row, 1, Qt::AlignLeft);
+                    lay->addWidget(new QLabel(QString::number(itemBlock.per_thread_stats()->calls_number), widget), row, 1, Qt::AlignLeft);
                 }
             }
 
@@ -2715,6 +3054,7 @@ void BlocksGraphicsView::onSelectedThreadChange(profiler::thread_id_t id)
     {
         if (item->threadId() == id)
         {
+            buildLane(item);
             m_pScrollbar->setHistogramSource(id, item->items(0));
 
             bool changedSelection = false;
@@ -2756,7 +3096,7 @@ void BlocksGraphicsView::onSelectedThreadChange(profiler::thread_id_t id)
 
 //////////////////////////////////////////////////////////////////////////
 
-void BlocksGraphicsView::onSelectedBlockChange(unsigned int _block_index)
+void BlocksGraphicsView::onSelectedBlockChange(::profiler::block_index_t _block_index)
 {
     if (!m_bUpdatingRect)
     {
@@ -2766,6 +3106,16 @@ void BlocksGraphicsView::onSelectedBlockChange(unsigned int _block_index)
 
             const auto& guiblock = EASY_GLOBALS.gui_blocks[_block_index];
             const auto thread_item = m_items[guiblock.graphics_item];
+
+            if (!thread_item->isVisible())
+            {
+                // Selected block belongs to the folded thread group
+                auto group = threadGroup(thread_item);
+                if (group != nullptr)
+                    setThreadGroupExpanded(group, true);
+            }
+
+            buildLane(thread_item); // Lane may be out of the view, its items are released then
             const auto& item = thread_item->items(guiblock.graphics_item_level)[guiblock.graphics_item_index];
 
             m_flickerSpeedX = m_flickerSpeedY = 0;
@@ -2791,6 +3141,7 @@ void BlocksGraphicsView::onSelectedBlockChange(unsigned int _block_index)
             {
                 if (item->threadId() == EASY_GLOBALS.selected_thread)
                 {
+                    buildLane(item);
                     m_pScrollbar->setHistogramSource(EASY_GLOBALS.selected_thread, item->items(0));
                     break;
                 }
@@ -2902,31 +3253,21 @@ void ThreadNameItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*,
 
     const auto overlap = EASY_GLOBALS.size.threads_row_spacing >> 1;
     static const QBrush brushes[2] = {QColor::fromRgb(BACKGROUND_1), QColor::fromRgb(BACKGROUND_2)};
-    int i = -1;
+    static const QBrush groupBrush = QColor::fromRgb(THREAD_GROUP_BACKGROUND);
+    static const QBrush selectedBrush = QColor::fromRgb(profiler_gui::SELECTED_THREAD_BACKGROUND);
 
     QRectF rect;
+    qreal lanesBottom = 0;
 
     _painter->resetTransform();
 
-    // Draw thread names
-    auto default_font = _painter->font();
-    _painter->setFont(EASY_GLOBALS.font.background);
-    for (auto item : items)
+    auto paintLane = [&](qreal _top, qreal _height, const QBrush& _brush, const QString& _name)
     {
-        ++i;
+        auto top = _top - visibleSceneRect.top() - overlap;
+        auto hgt = _height + EASY_GLOBALS.size.threads_row_spacing;
 
-        auto br = item->boundingRect();
-        auto top = item->y() + br.top() - visibleSceneRect.top() - overlap;
-        auto hgt = br.height() + EASY_GLOBALS.size.threads_row_spacing;
-        auto bottom = top + hgt;
-
-        if (top > h || bottom < 0)
-            continue;
-
-        if (item->threadId() == EASY_GLOBALS.selected_thread)
-            _painter->setBrush(QBrush(QColor::fromRgb(profiler_gui::SELECTED_THREAD_BACKGROUND)));
-        else
-            _painter->setBrush(brushes[i & 1]);
+        if (top > h || top + hgt < 0)
+            return;
 
         if (top < 0)
         {
@@ -2939,22 +3280,48 @@ void ThreadNameItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*,
             hgt -= dh;
 
         rect.setRect(0, top, w, hgt);
+        lanesBottom = std::max(lanesBottom, rect.bottom());
 
+        _painter->setBrush(_brush);
         _painter->setPen(profiler_gui::SYSTEM_BORDER_COLOR);
         _painter->drawRect(rect);
 
         rect.translate(-5, 0);
         _painter->setPen(profiler_gui::TEXT_COLOR);
-        _painter->drawText(rect, Qt::AlignRight | Qt::AlignVCenter, item->threadName());
+        _painter->drawText(rect, Qt::AlignRight | Qt::AlignVCenter, _name);
+    };
+
+    // Draw thread names
+    auto default_font = _painter->font();
+    _painter->setFont(EASY_GLOBALS.font.background);
+
+    auto nextStripe = view->firstItemBelow(visibleSceneRect.top());
+    for (auto i = nextStripe, n = items.size(); i < n; ++i)
+    {
+        const auto item = items[i];
+        if (!item->isVisible())
+            continue; // folded into thread group lane
+
+        const auto br = item->boundingRect();
+        const auto top = item->y() + br.top();
+        if (top - visibleSceneRect.top() - overlap > h)
+            break;
+
+        paintLane(top, br.height(), item->threadId() == EASY_GLOBALS.selected_thread ? selectedBrush : brushes[i & 1], item->threadName());
+        nextStripe = i + 1;
     }
 
-    const auto rect_bottom = rect.bottom();
-    if (rect_bottom < h)
+    // Draw thread groups names
+    for (auto group : view->getThreadGroups())
     {
-        ++i;
-        rect.translate(5, rect.height());
-        rect.setHeight(h - rect_bottom);
-        _painter->setBrush(brushes[i & 1]);
+        paintLane(group->y(), group->boundingRect().height(), groupBrush, QString("%1 x%2 [%3]")
+            .arg(group->name()).arg(group->itemsNumber()).arg(group->isExpanded() ? '-' : '+'));
+    }
+
+    if (lanesBottom < h)
+    {
+        rect.setRect(0, lanesBottom, w, h - lanesBottom);
+        _painter->setBrush(brushes[nextStripe & 1]);
         _painter->setPen(profiler_gui::SYSTEM_BORDER_COLOR);
         _painter->drawRect(rect);
     }
@@ -3079,6 +3446,8 @@ void ThreadNamesWidget::onTreeChange()
     const auto& graphicsItems = m_view->getItems();
     for (auto graphicsItem : graphicsItems)
         maxLength = std::max(maxLength, (10 + fm.width(graphicsItem->threadName())) * profiler_gui::FONT_METRICS_FACTOR);
+    for (auto group : m_view->getThreadGroups())
+        maxLength = std::max(maxLength, (10 + fm.width(QString("%1 x%2 [+]").arg(group->name()).arg(group->itemsNumber()))) * profiler_gui::FONT_METRICS_FACTOR);
 
     auto vbar = verticalScrollBar();
     auto viewBar = m_view->verticalScrollBar();
@@ -3146,8 +3515,12 @@ void ThreadNamesWidget::onIdleTimeout()
     const auto overlap = EASY_GLOBALS.size.threads_row_spacing >> 1;
 
     GraphicsBlockItem* intersectingItem = nullptr;
-    for (auto item : items)
+    for (auto i = m_view->firstItemBelow(scenePos.y() - overlap), n = items.size(); i < n; ++i)
     {
+        const auto item = items[i];
+        if (!item->isVisible())
+            continue;
+
         auto br = item->boundingRect();
         auto top = item->y() + br.top() - visibleSceneRect.top() - overlap;
         auto hgt = br.height() + EASY_GLOBALS.size.threads_row_spacing;
@@ -3279,9 +3652,27 @@ void ThreadNamesWidget::mouseDoubleClickEvent(QMouseEvent* _event)
     m_idleTime = 0;
 
     auto y = m_view->mapToScene(mapFromGlobal(QCursor::pos())).y();
+
+    // Double click on thread group lane expands or folds the group
+    for (auto group : m_view->getThreadGroups())
+    {
+        const auto top = group->y() - overlap;
+        const auto bottom = top + group->boundingRect().height() + overlap;
+        if (top <= y && y <= bottom)
+        {
+            m_view->setThreadGroupExpanded(group, !group->isExpanded());
+            _event->accept();
+            return;
+        }
+    }
+
     const auto& items = m_view->getItems();
-    for (auto item : items)
+    for (auto i = m_view->firstItemBelow(y - overlap), n = items.size(); i < n; ++i)
     {
+        const auto item = items[i];
+        if (!item->isVisible())
+            continue;
+
         auto br = item->boundingRect();
         auto top = item->y() + br.top() - overlap;
         auto bottom = top + br.height() + overlap;
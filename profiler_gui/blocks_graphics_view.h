@@ -83,6 +83,7 @@
 
 class BlocksGraphicsView;
 class GraphicsBlockItem;
+class GraphicsThreadGroupItem;
 class GraphicsScrollbar;
 class GraphicsRulerItem;
 
@@ -190,9 +191,12 @@ private:
     using Parent = QGraphicsView;
     using This = BlocksGraphicsView;
     using Items = ::std::vector<GraphicsBlockItem*>;
+    using ThreadGroups = ::std::vector<GraphicsThreadGroupItem*>;
     //using Keys = ::std::unordered_set<int, ::estd::hash<int> >;
 
     Items                               m_items; ///< Array of all GraphicsBlockItem items
+    Items                          m_builtLanes; ///< Items which levels are filled (lanes near the visible area and selected thread lane)
+    ThreadGroups                 m_threadGroups; ///< Aggregated lanes for groups of similar threads (sorted by first item index)
     //Keys                                 m_keys; ///< Pressed keyboard keys
     ::profiler_gui::TreeBlocks m_selectedBlocks; ///< Array of items which were selected by selection zone (GraphicsRulerItem)
     QTimer                       m_flickerTimer; ///< Timer for flicking behavior
@@ -257,6 +261,23 @@ public:
 
     const Items& getItems() const;
 
+    /** \brief Returns index of the first thread item which bottom is below _sceneY.
+
+    Items are sorted by y coordinate, so this lets loops over thread lanes skip invisible ones.
+    Returns getItems().size() if there is no such item. */
+    size_t firstItemBelow(qreal _sceneY) const;
+
+    const ThreadGroups& getThreadGroups() const;
+
+    ///< Returns group of the thread item or nullptr if the thread does not belong to any group
+    GraphicsThreadGroupItem* threadGroup(const GraphicsBlockItem* _item) const;
+
+    ///< Expands group into separate thread lanes or folds group threads into one aggregated lane
+    void setThreadGroupExpanded(GraphicsThreadGroupItem* _group, bool _expanded);
+
+    ///< Folds or expands all thread groups
+    void foldThreadGroups(bool _fold);
+
     bool getSelectionRegionForSaving(profiler::timestamp_t& _beginTime, profiler::timestamp_t& _endTime) const;
 
     void inspectCurrentView(bool _strict) {
@@ -295,9 +316,14 @@ private:
     void updateTimelineStep(qreal _windowWidth);
     void scaleTo(qreal _scale);
     void scrollTo(const GraphicsBlockItem* _item);
+    void updateLanesLayout();
+    void onLanesLayoutChanged();
     qreal mapToDiagram(qreal x) const;
     void onWheel(qreal _scenePos, int _wheelDelta);
     qreal setTree(GraphicsBlockItem* _item, const ::profiler::BlocksTree::children_t& _children, qreal& _height, uint32_t& _maxDepthChild, qreal _y, short _level);
+    qreal measureTree(const ::profiler::BlocksTree::children_t& _children, uint32_t _lane, qreal& _height, short _level);
+    void buildLane(GraphicsBlockItem* _item);
+    void updateBuiltLanes();
 
     void revalidateOffset();
 
@@ -315,7 +341,7 @@ private slots:
     void onIdleTimeout();
     void onHierarchyFlagChange(bool _value);
     void onSelectedThreadChange(::profiler::thread_id_t id);
-    void onSelectedBlockChange(unsigned int _block_index);
+    void onSelectedBlockChange(::profiler::block_index_t _block_index);
     void onRefreshRequired();
     void onThreadViewChanged();
     void onZoomSelection();
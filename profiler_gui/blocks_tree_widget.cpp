@@ -115,6 +115,9 @@ const bool PLAIN_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_FRAME,
     , true  // COL_AVG_PER_FRAME,
     , true  // COL_MEDIAN_PER_FRAME,
+    , true  // COL_PERCENTILE1_PER_FRAME,
+    , true  // COL_PERCENTILE2_PER_FRAME,
+    , true  // COL_PERCENTILE3_PER_FRAME,
     , true  // COL_NCALLS_PER_FRAME,
     , true  // COL_TOTAL_TIME_PER_THREAD,
     , true  // COL_PERCENT_SUM_PER_THREAD,
@@ -122,6 +125,9 @@ const bool PLAIN_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_THREAD,
     , true  // COL_AVG_PER_THREAD,
     , true  // COL_MEDIAN_PER_THREAD,
+    , true  // COL_PERCENTILE1_PER_THREAD,
+    , true  // COL_PERCENTILE2_PER_THREAD,
+    , true  // COL_PERCENTILE3_PER_THREAD,
     , true  // COL_NCALLS_PER_THREAD,
     , false // COL_PERCENT_PER_PARENT,
     , false // COL_TOTAL_TIME_PER_PARENT,
@@ -130,6 +136,9 @@ const bool PLAIN_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , false // COL_MAX_PER_PARENT,
     , false // COL_AVG_PER_PARENT,
     , false // COL_MEDIAN_PER_PARENT,
+    , false // COL_PERCENTILE1_PER_PARENT,
+    , false // COL_PERCENTILE2_PER_PARENT,
+    , false // COL_PERCENTILE3_PER_PARENT,
     , false // COL_NCALLS_PER_PARENT,
     , true  // COL_ACTIVE_TIME,
     , true  // COL_ACTIVE_PERCENT,
@@ -140,6 +149,9 @@ const bool PLAIN_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_AREA,
     , true  // COL_AVG_PER_AREA,
     , true  // COL_MEDIAN_PER_AREA,
+    , true  // COL_PERCENTILE1_PER_AREA,
+    , true  // COL_PERCENTILE2_PER_AREA,
+    , true  // COL_PERCENTILE3_PER_AREA,
     , true  // COL_NCALLS_PER_AREA,
 };
 
@@ -157,6 +169,9 @@ const bool SELECTION_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , false // COL_MAX_PER_FRAME,
     , false // COL_AVG_PER_FRAME,
     , false // COL_MEDIAN_PER_FRAME,
+    , false // COL_PERCENTILE1_PER_FRAME,
+    , false // COL_PERCENTILE2_PER_FRAME,
+    , false // COL_PERCENTILE3_PER_FRAME,
     , false // COL_NCALLS_PER_FRAME,
     , true  // COL_TOTAL_TIME_PER_THREAD,
     , true  // COL_PERCENT_SUM_PER_THREAD,
@@ -164,6 +179,9 @@ const bool SELECTION_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_THREAD,
     , true  // COL_AVG_PER_THREAD,
     , true  // COL_MEDIAN_PER_THREAD,
+    , true  // COL_PERCENTILE1_PER_THREAD,
+    , true  // COL_PERCENTILE2_PER_THREAD,
+    , true  // COL_PERCENTILE3_PER_THREAD,
     , true  // COL_NCALLS_PER_THREAD,
     , false // COL_PERCENT_PER_PARENT,
     , false // COL_TOTAL_TIME_PER_PARENT,
@@ -172,6 +190,9 @@ const bool SELECTION_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , false // COL_MAX_PER_PARENT,
     , false // COL_AVG_PER_PARENT,
     , false // COL_MEDIAN_PER_PARENT,
+    , false // COL_PERCENTILE1_PER_PARENT,
+    , false // COL_PERCENTILE2_PER_PARENT,
+    , false // COL_PERCENTILE3_PER_PARENT,
     , false // COL_NCALLS_PER_PARENT,
     , true  // COL_ACTIVE_TIME,
     , true  // COL_ACTIVE_PERCENT,
@@ -182,6 +203,9 @@ const bool SELECTION_MODE_COLUMNS[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_AREA,
     , true  // COL_AVG_PER_AREA,
     , true  // COL_MEDIAN_PER_AREA,
+    , true  // COL_PERCENTILE1_PER_AREA,
+    , true  // COL_PERCENTILE2_PER_AREA,
+    , true  // COL_PERCENTILE3_PER_AREA,
     , true  // COL_NCALLS_PER_AREA,
 };
 
@@ -269,11 +293,23 @@ BlocksTreeWidget::BlocksTreeWidget(QWidget* _parent)
     header_item->setText(COL_MEDIAN_PER_AREA,      "Mdn/area");
     header_item->setText(COL_NCALLS_PER_AREA,      "N/area");
 
+    for (int i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+    {
+        const auto percentile = QString("P%1").arg(profiler::stats_percentile(static_cast<uint8_t>(i)));
+        header_item->setText(COL_PERCENTILE1_PER_FRAME + i,  percentile + "/frame");
+        header_item->setText(COL_PERCENTILE1_PER_PARENT + i, percentile + "/parent");
+        header_item->setText(COL_PERCENTILE1_PER_THREAD + i, percentile + "/thread");
+        header_item->setText(COL_PERCENTILE1_PER_AREA + i,   percentile + "/area");
+    }
+
     auto color = QColor::fromRgb(profiler::colors::DeepOrange900);
     header_item->setForeground(COL_MIN_PER_THREAD, color);
     header_item->setForeground(COL_MAX_PER_THREAD, color);
     header_item->setForeground(COL_AVG_PER_THREAD, color);
     header_item->setForeground(COL_MEDIAN_PER_THREAD, color);
+    header_item->setForeground(COL_PERCENTILE1_PER_THREAD, color);
+    header_item->setForeground(COL_PERCENTILE2_PER_THREAD, color);
+    header_item->setForeground(COL_PERCENTILE3_PER_THREAD, color);
     header_item->setForeground(COL_NCALLS_PER_THREAD, color);
     header_item->setForeground(COL_PERCENT_SUM_PER_THREAD, color);
     header_item->setForeground(COL_TOTAL_TIME_PER_THREAD, color);
@@ -283,6 +319,9 @@ BlocksTreeWidget::BlocksTreeWidget(QWidget* _parent)
     header_item->setForeground(COL_MAX_PER_FRAME, color);
     header_item->setForeground(COL_AVG_PER_FRAME, color);
     header_item->setForeground(COL_MEDIAN_PER_FRAME, color);
+    header_item->setForeground(COL_PERCENTILE1_PER_FRAME, color);
+    header_item->setForeground(COL_PERCENTILE2_PER_FRAME, color);
+    header_item->setForeground(COL_PERCENTILE3_PER_FRAME, color);
     header_item->setForeground(COL_NCALLS_PER_FRAME, color);
     header_item->setForeground(COL_PERCENT_SUM_PER_FRAME, color);
     header_item->setForeground(COL_TOTAL_TIME_PER_FRAME, color);
@@ -293,6 +332,9 @@ BlocksTreeWidget::BlocksTreeWidget(QWidget* _parent)
     header_item->setForeground(COL_MAX_PER_PARENT, color);
     header_item->setForeground(COL_AVG_PER_PARENT, color);
     header_item->setForeground(COL_MEDIAN_PER_PARENT, color);
+    header_item->setForeground(COL_PERCENTILE1_PER_PARENT, color);
+    header_item->setForeground(COL_PERCENTILE2_PER_PARENT, color);
+    header_item->setForeground(COL_PERCENTILE3_PER_PARENT, color);
     header_item->setForeground(COL_NCALLS_PER_PARENT, color);
     header_item->setForeground(COL_PERCENT_SUM_PER_PARENT, color);
     header_item->setForeground(COL_TOTAL_TIME_PER_PARENT, color);
@@ -306,6 +348,9 @@ BlocksTreeWidget::BlocksTreeWidget(QWidget* _parent)
     header_item->setForeground(COL_MAX_PER_AREA, color);
     header_item->setForeground(COL_AVG_PER_AREA, color);
     header_item->setForeground(COL_MEDIAN_PER_AREA, color);
+    header_item->setForeground(COL_PERCENTILE1_PER_AREA, color);
+    header_item->setForeground(COL_PERCENTILE2_PER_AREA, color);
+    header_item->setForeground(COL_PERCENTILE3_PER_AREA, color);
     header_item->setForeground(COL_NCALLS_PER_AREA, color);
 
     setHeaderItem(header_item);
@@ -967,23 +1012,23 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
                 case COL_MAX_PER_AREA:
                 {
                     auto& block = item->block();
-                    auto i = profiler_gui::numeric_max<uint32_t>();
+                    auto i = profiler_gui::numeric_max<profiler::block_index_t>();
                     QString name;
                     switch (col)
                     {
-                        case COL_MIN_PER_THREAD: name = QStringLiteral("Min"); i = block.per_thread_stats->min_duration_block; break;
-                        case COL_MIN_PER_PARENT: name = QStringLiteral("Min"); i = block.per_parent_stats->min_duration_block; break;
-                        case COL_MIN_PER_FRAME:  name = QStringLiteral("Min"); i = block.per_frame_stats->min_duration_block; break;
-                        case COL_MAX_PER_THREAD: name = QStringLiteral("Max"); i = block.per_thread_stats->max_duration_block; break;
-                        case COL_MAX_PER_PARENT: name = QStringLiteral("Max"); i = block.per_parent_stats->max_duration_block; break;
-                        case COL_MAX_PER_FRAME:  name = QStringLiteral("Max"); i = block.per_frame_stats->max_duration_block; break;
+                        case COL_MIN_PER_THREAD: name = QStringLiteral("Min"); i = block.per_thread_stats()->min_duration_block; break;
+                        case COL_MIN_PER_PARENT: name = QStringLiteral("Min"); i = block.per_parent_stats()->min_duration_block; break;
+                        case COL_MIN_PER_FRAME:  name = QStringLiteral("Min"); i = block.per_frame_stats()->min_duration_block; break;
+                        case COL_MAX_PER_THREAD: name = QStringLiteral("Max"); i = block.per_thread_stats()->max_duration_block; break;
+                        case COL_MAX_PER_PARENT: name = QStringLiteral("Max"); i = block.per_parent_stats()->max_duration_block; break;
+                        case COL_MAX_PER_FRAME:  name = QStringLiteral("Max"); i = block.per_frame_stats()->max_duration_block; break;
 
                         case COL_MIN_PER_AREA:
                         {
                             name = QStringLiteral("Min");
                             auto data = item->data(COL_MIN_PER_AREA, MinMaxBlockIndexRole);
                             if (!data.isNull())
-                                i = data.toUInt();
+                                i = static_cast<profiler::block_index_t>(data.toULongLong());
                             break;
                         }
 
@@ -992,7 +1037,7 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
                             name = QStringLiteral("Max");
                             auto data = item->data(COL_MAX_PER_AREA, MinMaxBlockIndexRole);
                             if (!data.isNull())
-                                i = data.toUInt();
+                                i = static_cast<profiler::block_index_t>(data.toULongLong());
                             break;
                         }
                     }
@@ -1001,7 +1046,7 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
                     {
                         menu.addSeparator();
                         auto itemAction = new QAction(QString("Jump To %1 Item").arg(name), nullptr);
-                        itemAction->setData(i);
+                        itemAction->setData(static_cast<qulonglong>(i));
                         itemAction->setToolTip(QString("Jump to item with %1 duration").arg(name.toLower()));
                         connect(itemAction, &QAction::triggered, this, &This::onJumpToItemClicked);
                         menu.addAction(itemAction);
@@ -1071,6 +1116,9 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
     ADD_COLUMN_ACTION(COL_MAX_PER_FRAME);
     ADD_COLUMN_ACTION(COL_AVG_PER_FRAME);
     ADD_COLUMN_ACTION(COL_MEDIAN_PER_FRAME);
+    ADD_COLUMN_ACTION(COL_PERCENTILE1_PER_FRAME);
+    ADD_COLUMN_ACTION(COL_PERCENTILE2_PER_FRAME);
+    ADD_COLUMN_ACTION(COL_PERCENTILE3_PER_FRAME);
     ADD_COLUMN_ACTION(COL_NCALLS_PER_FRAME);
 
     hidemenu->addSeparator();
@@ -1081,6 +1129,9 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
     ADD_COLUMN_ACTION(COL_MAX_PER_THREAD);
     ADD_COLUMN_ACTION(COL_AVG_PER_THREAD);
     ADD_COLUMN_ACTION(COL_MEDIAN_PER_THREAD);
+    ADD_COLUMN_ACTION(COL_PERCENTILE1_PER_THREAD);
+    ADD_COLUMN_ACTION(COL_PERCENTILE2_PER_THREAD);
+    ADD_COLUMN_ACTION(COL_PERCENTILE3_PER_THREAD);
     ADD_COLUMN_ACTION(COL_NCALLS_PER_THREAD);
 
     hidemenu->addSeparator();
@@ -1092,6 +1143,9 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
     ADD_COLUMN_ACTION(COL_MAX_PER_PARENT);
     ADD_COLUMN_ACTION(COL_AVG_PER_PARENT);
     ADD_COLUMN_ACTION(COL_MEDIAN_PER_PARENT);
+    ADD_COLUMN_ACTION(COL_PERCENTILE1_PER_PARENT);
+    ADD_COLUMN_ACTION(COL_PERCENTILE2_PER_PARENT);
+    ADD_COLUMN_ACTION(COL_PERCENTILE3_PER_PARENT);
     ADD_COLUMN_ACTION(COL_NCALLS_PER_PARENT);
 
     hidemenu->addSeparator();
@@ -1108,6 +1162,9 @@ void BlocksTreeWidget::contextMenuEvent(QContextMenuEvent* _event)
     ADD_COLUMN_ACTION(COL_MAX_PER_AREA);
     ADD_COLUMN_ACTION(COL_AVG_PER_AREA);
     ADD_COLUMN_ACTION(COL_MEDIAN_PER_AREA);
+    ADD_COLUMN_ACTION(COL_PERCENTILE1_PER_AREA);
+    ADD_COLUMN_ACTION(COL_PERCENTILE2_PER_AREA);
+    ADD_COLUMN_ACTION(COL_PERCENTILE3_PER_AREA);
     ADD_COLUMN_ACTION(COL_NCALLS_PER_AREA);
 
 #undef ADD_STATUS_ACTION
@@ -1201,7 +1258,7 @@ void BlocksTreeWidget::onJumpToItemClicked(bool)
     if (action == nullptr)
         return;
 
-    auto block_index = action->data().toUInt();
+    auto block_index = static_cast<profiler::block_index_t>(action->data().toULongLong());
     EASY_GLOBALS.selected_block = block_index;
     if (block_index < EASY_GLOBALS.gui_blocks.size())
         EASY_GLOBALS.selected_block_id = easyBlock(block_index).tree.node->id();
@@ -1374,7 +1431,7 @@ void BlocksTreeWidget::onSelectedThreadChange(profiler::thread_id_t _id)
         f->setFocus();
 }
 
-void BlocksTreeWidget::onSelectedBlockChange(uint32_t _block_index)
+void BlocksTreeWidget::onSelectedBlockChange(profiler::block_index_t _block_index)
 {
     disconnect(this, &Parent::currentItemChanged, this, &This::onCurrentItemChange);
 
@@ -162,7 +162,7 @@ private slots:
 
     void onSelectedThreadChange(::profiler::thread_id_t _id);
 
-    void onSelectedBlockChange(uint32_t _block_index);
+    void onSelectedBlockChange(profiler::block_index_t _block_index);
 
     void onBlockStatusChangeClicked(bool);
 
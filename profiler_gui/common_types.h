@@ -101,8 +101,8 @@ struct EasyBlock Q_DECL_FINAL
 {
     ::profiler::BlocksTree       tree;
     uint32_t      graphics_item_index;
-    uint8_t       graphics_item_level;
-    uint8_t             graphics_item;
+    uint16_t      graphics_item_level;
+    uint32_t            graphics_item;
     bool                     expanded;
 
     EasyBlock() = default;
@@ -757,7 +757,7 @@ void DescriptorsTreeWidget::resizeColumnsToContents()
 
 //////////////////////////////////////////////////////////////////////////
 
-void DescriptorsTreeWidget::onSelectedBlockChange(uint32_t _block_index)
+void DescriptorsTreeWidget::onSelectedBlockChange(::profiler::block_index_t _block_index)
 {
     if (::profiler_gui::is_max(_block_index))
     {
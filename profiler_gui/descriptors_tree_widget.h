@@ -63,7 +63,7 @@
 #include <vector>
 #include <unordered_set>
 
-#include <easy/details/profiler_public_types.h>
+#include <easy/reader.h>
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -194,7 +194,7 @@ private slots:
     void onCurrentItemChange(QTreeWidgetItem* _item, QTreeWidgetItem* _prev);
     void onItemExpand(QTreeWidgetItem* _item);
     void onDoubleClick(QTreeWidgetItem* _item, int _column);
-    void onSelectedBlockChange(uint32_t _block_index);
+    void onSelectedBlockChange(::profiler::block_index_t _block_index);
     void onBlockStatusChange(::profiler::block_id_t _id, ::profiler::EasyBlockStatus _status);
     void resizeColumnsToContents();
 
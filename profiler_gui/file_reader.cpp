@@ -98,7 +98,7 @@ int FileReader::progress() const
     return m_progress.load(std::memory_order_acquire);
 }
 
-unsigned int FileReader::size() const
+profiler::block_index_t FileReader::size() const
 {
     return m_size.load(std::memory_order_acquire);
 }
@@ -131,6 +131,30 @@ void FileReader::load(const QString& _filename)
     }, EASY_GLOBALS.enable_statistics);
 }
 
+void FileReader::load(const QString& _filename, const profiler::LoadRange& _range)
+{
+    interrupt();
+
+    m_jobType = JobType::Loading;
+    m_isFile = true;
+    m_isSnapshot = false;
+    m_filename = _filename;
+    m_range = _range;
+
+    m_thread = std::thread([this] (bool _enableStatistics)
+    {
+        const auto size = fillTreesFromFileRange(m_progress, m_filename.toStdString().c_str(), m_range, m_beginEndTime,
+                                                 m_serializedBlocks, m_serializedDescriptors, m_descriptors, m_blocks,
+                                                 m_blocksTree, m_bookmarks, m_descriptorsNumberInFile, m_version, m_pid,
+                                                 _enableStatistics, m_errorMessage);
+
+        m_size.store(size, std::memory_order_release);
+        m_progress.store(100, std::memory_order_release);
+        m_bDone.store(true, std::memory_order_release);
+
+    }, EASY_GLOBALS.enable_statistics);
+}
+
 void FileReader::load(std::stringstream& _stream)
 {
     interrupt();
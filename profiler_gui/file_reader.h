@@ -70,6 +70,7 @@ class FileReader Q_DECL_FINAL
     profiler::thread_blocks_tree_t      m_blocksTree; ///<
     profiler::bookmarks_t                m_bookmarks; ///<
     profiler::BeginEndTime            m_beginEndTime; ///<
+    profiler::LoadRange                      m_range; ///<
     std::stringstream                       m_stream; ///<
     std::stringstream                 m_errorMessage; ///<
     QString                               m_filename; ///<
@@ -79,7 +80,7 @@ class FileReader Q_DECL_FINAL
     std::thread                             m_thread; ///<
     std::atomic_bool                         m_bDone; ///<
     std::atomic<int>                      m_progress; ///<
-    std::atomic<unsigned int>                 m_size; ///<
+    std::atomic<profiler::block_index_t>      m_size; ///<
     JobType                m_jobType = JobType::Idle; ///<
     bool                            m_isFile = false; ///<
     bool                        m_isSnapshot = false; ///<
@@ -96,10 +97,11 @@ public:
 
     bool done() const;
     int progress() const;
-    unsigned int size() const;
+    profiler::block_index_t size() const;
     const QString& filename() const;
 
     void load(const QString& _filename);
+    void load(const QString& _filename, const profiler::LoadRange& _range);
     void load(std::stringstream& _stream);
 
     /** \brief Save data to file.
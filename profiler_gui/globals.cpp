@@ -121,6 +121,7 @@ Globals::Globals()
     , auto_adjust_histogram_height(true)
     , auto_adjust_chart_height(false)
     , display_only_frames_on_histogram(false)
+    , fold_thread_groups(true)
     , bind_scene_and_tree_expand_status(true)
 {
 
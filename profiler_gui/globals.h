@@ -87,6 +87,9 @@ namespace profiler_gui {
 
     EASY_CONSTEXPR uint32_t V130 = 0x01030000;
 
+    /// Maximum number of levels drawn on the diagram. Deeper blocks are collapsed into their ancestor on the last level.
+    EASY_CONSTEXPR uint16_t MAX_GRAPHICS_LEVELS = 1024;
+
 #ifdef _WIN32
     EASY_CONSTEXPR qreal FONT_METRICS_FACTOR = 1.05;
 #else
@@ -255,6 +258,7 @@ namespace profiler_gui {
         bool                auto_adjust_histogram_height; ///< Automatically adjust histogram height to the visible region
         bool                    auto_adjust_chart_height; ///< Automatically adjust arbitrary value chart height to the visible region
         bool            display_only_frames_on_histogram; ///< Display only top-level blocks on histogram when drawing histogram by block id
+        bool                          fold_thread_groups; ///< Display groups of similar threads ("Worker 1", "Worker 2", ...) as one aggregated lane
         bool           bind_scene_and_tree_expand_status; /** \brief If true then items on graphics scene and in the tree (blocks hierarchy) are binded on each other
                                                                 so expanding/collapsing items on scene also expands/collapse items in the tree. */
 
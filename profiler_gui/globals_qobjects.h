@@ -56,7 +56,7 @@
 #define EASY_GLOBALS_QOBJECTS_H
 
 #include <QObject>
-#include <easy/details/profiler_public_types.h>
+#include <easy/reader.h>
 
 namespace profiler { class ArbitraryValue; }
 
@@ -78,7 +78,7 @@ namespace profiler_gui {
         void fileOpened();
 
         void selectedThreadChanged(::profiler::thread_id_t _id);
-        void selectedBlockChanged(uint32_t _block_index);
+        void selectedBlockChanged(::profiler::block_index_t _block_index);
         void selectedBlockIdChanged(::profiler::block_id_t _id);
         void itemsExpandStateChanged();
         void blockStatusChanged(::profiler::block_id_t _id, ::profiler::EasyBlockStatus _status);
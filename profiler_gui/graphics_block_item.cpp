@@ -112,11 +112,12 @@ const QPen HIGHLIGHTER_PEN = ([]() -> QPen {
 
 //////////////////////////////////////////////////////////////////////////
 
-GraphicsBlockItem::GraphicsBlockItem(uint8_t _index, const profiler::BlocksTreeRoot& _root)
+GraphicsBlockItem::GraphicsBlockItem(uint32_t _index, const profiler::BlocksTreeRoot& _root)
     : QGraphicsItem(nullptr)
     , m_thread(_root)
     , m_threadName(::profiler_gui::decoratedThreadName(EASY_GLOBALS.use_decorated_thread_name, _root, EASY_GLOBALS.hex_thread_id))
     , m_index(_index)
+    , m_built(false)
 {
 }
 
@@ -181,9 +182,9 @@ struct EasyPainterInformation EASY_FINAL
 };
 
 #ifdef EASY_GRAPHICS_ITEM_RECURSIVE_PAINT
-void GraphicsBlockItem::paintChildren(const float _minWidth, const int _narrowSizeHalf, const uint8_t _levelsNumber,
+void GraphicsBlockItem::paintChildren(const float _minWidth, const int _narrowSizeHalf, const uint16_t _levelsNumber,
                                        QPainter* _painter, struct EasyPainterInformation& p, profiler_gui::EasyBlockItem& _item,
-                                       const profiler_gui::EasyBlock& _itemBlock, RightBounds& _rightBounds, uint8_t _level,
+                                       const profiler_gui::EasyBlock& _itemBlock, RightBounds& _rightBounds, uint16_t _level,
                                        int8_t _mode)
 {
     if (_level >= _levelsNumber || _itemBlock.tree.children.empty())
@@ -231,7 +232,7 @@ void GraphicsBlockItem::paintChildren(const float _minWidth, const int _narrowSi
             // This item is not visible
             if (!(EASY_GLOBALS.hide_narrow_children && w < EASY_GLOBALS.blocks_narrow_size))
                 paintChildren(_minWidth, _narrowSizeHalf, _levelsNumber, _painter, p, item, itemBlock, _rightBounds,
-                              (uint8_t)next_level, BLOCK_ITEM_DO_PAINT_FIRST);
+                              (uint16_t)next_level, BLOCK_ITEM_DO_PAINT_FIRST);
             continue;
         }
 
@@ -461,6 +462,12 @@ void GraphicsBlockItem::paintChildren(const float _minWidth, const int _narrowSi
 
 void GraphicsBlockItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*, QWidget*)
 {
+    // Levels are filled only for lanes near the visible area (see BlocksGraphicsView::updateBuiltLanes())
+    if (!m_built)
+    {
+        return;
+    }
+
     const bool gotItems = !m_levels.empty() && !m_levels.front().empty();
     const bool gotSync = !m_thread.sync.empty();
 
@@ -471,13 +478,20 @@ void GraphicsBlockItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem
 
     EasyPainterInformation p(view());
 
+    // Skip thread lanes which are out of the visible area (there may be thousands of threads)
+    const auto itemTop = y() + m_boundingRect.top();
+    if (itemTop - EVENT_HEIGHT > p.visibleSceneRect.bottom() || itemTop + m_boundingRect.height() < p.visibleSceneRect.top())
+    {
+        return;
+    }
+
     _painter->save();
     _painter->setFont(EASY_GLOBALS.font.item);
     
     // Reset indices of first visible item for each layer
     const auto levelsNumber = levels();
     m_rightBounds[0] = -1e100;
-    for (uint8_t i = 1; i < levelsNumber; ++i) {
+    for (uint16_t i = 1; i < levelsNumber; ++i) {
         ::profiler_gui::set_max(m_levelsIndexes[i]);
         m_rightBounds[i] = -1e100;
     }
@@ -556,9 +570,9 @@ void GraphicsBlockItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem
 
         //size_t iterations = 0;
 #ifndef EASY_GRAPHICS_ITEM_RECURSIVE_PAINT
-        for (uint8_t l = 0; l < levelsNumber; ++l)
+        for (uint16_t l = 0; l < levelsNumber; ++l)
 #else
-        for (uint8_t l = 0; l < 1; ++l)
+        for (uint16_t l = 0; l < 1; ++l)
 #endif
         {
             auto& level = m_levels[l];
@@ -621,7 +635,7 @@ void GraphicsBlockItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem
 #ifdef EASY_GRAPHICS_ITEM_RECURSIVE_PAINT
                     if (!EASY_GLOBALS.hide_narrow_children || w >= EASY_GLOBALS.blocks_narrow_size)
                         paintChildren(MIN_WIDTH, narrow_size_half, levelsNumber, _painter, p, item, itemBlock,
-                                      m_rightBounds, (uint8_t)next_level, BLOCK_ITEM_DO_PAINT_FIRST);
+                                      m_rightBounds, (uint16_t)next_level, BLOCK_ITEM_DO_PAINT_FIRST);
 #else
                     if (!(EASY_GLOBALS.hide_narrow_children && w < EASY_GLOBALS.blocks_narrow_size) && l > 0)
                         dont_skip_children(next_level, item.children_begin, BLOCK_ITEM_DO_PAINT_FIRST);
@@ -1145,44 +1159,40 @@ QRect GraphicsBlockItem::getRect() const
 
 void GraphicsBlockItem::getBlocks(qreal _left, qreal _right, ::profiler_gui::TreeBlocks& _blocks) const
 {
-    // Search for first visible top-level item
-    auto& level0 = m_levels.front();
-    auto first = ::std::lower_bound(level0.begin(), level0.end(), _left, [](const ::profiler_gui::EasyBlockItem& _item, qreal _value)
+    // Thread tree is used instead of items of the first level, because lanes out of the view have no items
+    const auto& children = m_thread.children;
+    if (children.empty())
+        return;
+
+    const auto sceneView = view();
+
+    // Search for first visible top-level block
+    auto first = ::std::lower_bound(children.begin(), children.end(), _left, [sceneView](::profiler::block_index_t _index, qreal _value)
     {
-        return _item.left() < _value;
+        return sceneView->time2position(easyBlocksTree(_index).node->begin()) < _value;
     });
 
-    size_t itemIndex = 0;
-    if (first != level0.end())
-    {
-        itemIndex = static_cast<size_t>(std::distance(level0.begin(), first));
-        if (itemIndex > 0)
-            itemIndex -= 1;
-    }
-    else
-    {
-        itemIndex = level0.size() - 1;
-    }
+    if (first != children.begin())
+        --first;
 
-    // Add all visible top-level items into array of visible blocks
-    for (size_t i = itemIndex, end = level0.size(); i < end; ++i)
+    // Add all visible top-level blocks into array of visible blocks
+    for (auto it = first, end = children.end(); it != end; ++it)
     {
-        const auto& item = level0[i];
+        const auto& node = *easyBlocksTree(*it).node;
 
-        if (item.left() > _right)
+        if (sceneView->time2position(node.begin()) > _right)
         {
-            // First invisible item. No need to check other items.
+            // First invisible block. No need to check other blocks.
             break;
         }
 
-        if (item.right() < _left)
+        if (sceneView->time2position(node.end()) < _left)
         {
-            // This item is not visible yet
-            // This is just to be sure
+            // This block is not visible yet
             continue;
         }
 
-        _blocks.emplace_back(&m_thread, item.block);
+        _blocks.emplace_back(&m_thread, *it);
     }
 }
 
@@ -1190,7 +1200,7 @@ void GraphicsBlockItem::getBlocks(qreal _left, qreal _right, ::profiler_gui::Tre
 
 const ::profiler_gui::EasyBlock* GraphicsBlockItem::intersect(const QPointF& _pos, ::profiler::block_index_t& _blockIndex) const
 {
-    if (m_levels.empty() || m_levels.front().empty())
+    if (!isVisible() || m_levels.empty() || m_levels.front().empty())
     {
         return nullptr;
     }
@@ -1363,7 +1373,7 @@ const ::profiler_gui::EasyBlock* GraphicsBlockItem::intersect(const QPointF& _po
 
 const ::profiler_gui::EasyBlock* GraphicsBlockItem::intersectEvent(const QPointF& _pos) const
 {
-    if (m_thread.sync.empty())
+    if (!isVisible() || m_thread.sync.empty())
     {
         return nullptr;
     }
@@ -1431,17 +1441,17 @@ void GraphicsBlockItem::setBoundingRect(const QRectF& _rect)
 
 //////////////////////////////////////////////////////////////////////////
 
-uint8_t GraphicsBlockItem::levels() const
+uint16_t GraphicsBlockItem::levels() const
 {
-    return static_cast<uint8_t>(m_levels.size());
+    return static_cast<uint16_t>(m_levels.size());
 }
 
-float GraphicsBlockItem::levelY(uint8_t _level) const
+float GraphicsBlockItem::levelY(uint16_t _level) const
 {
     return static_cast<float>(y() + static_cast<int>(_level) * EASY_GLOBALS.size.graphics_row_full);
 }
 
-void GraphicsBlockItem::setLevels(uint8_t _levels)
+void GraphicsBlockItem::setLevels(uint16_t _levels)
 {
     typedef decltype(m_levelsIndexes) IndexesT;
     static const auto MAX_CHILD_INDEX = ::profiler_gui::numeric_max<IndexesT::value_type>();
@@ -1451,29 +1461,48 @@ void GraphicsBlockItem::setLevels(uint8_t _levels)
     m_rightBounds.resize(_levels, -1e100);
 }
 
-void GraphicsBlockItem::reserve(uint8_t _level, unsigned int _items)
+bool GraphicsBlockItem::built() const
+{
+    return m_built;
+}
+
+void GraphicsBlockItem::setBuilt()
+{
+    m_built = true;
+}
+
+void GraphicsBlockItem::clearLevels()
+{
+    // swap() releases memory, clear() would keep it
+    Sublevels().swap(m_levels);
+    DrawIndexes().swap(m_levelsIndexes);
+    RightBounds().swap(m_rightBounds);
+    m_built = false;
+}
+
+void GraphicsBlockItem::reserve(uint16_t _level, unsigned int _items)
 {
     m_levels[_level].reserve(_items);
 }
 
 //////////////////////////////////////////////////////////////////////////
 
-const GraphicsBlockItem::Children& GraphicsBlockItem::items(uint8_t _level) const
+const GraphicsBlockItem::Children& GraphicsBlockItem::items(uint16_t _level) const
 {
     return m_levels[_level];
 }
 
-const ::profiler_gui::EasyBlockItem& GraphicsBlockItem::getItem(uint8_t _level, unsigned int _index) const
+const ::profiler_gui::EasyBlockItem& GraphicsBlockItem::getItem(uint16_t _level, unsigned int _index) const
 {
     return m_levels[_level][_index];
 }
 
-::profiler_gui::EasyBlockItem& GraphicsBlockItem::getItem(uint8_t _level, unsigned int _index)
+::profiler_gui::EasyBlockItem& GraphicsBlockItem::getItem(uint16_t _level, unsigned int _index)
 {
     return m_levels[_level][_index];
 }
 
-unsigned int GraphicsBlockItem::addItem(uint8_t _level)
+unsigned int GraphicsBlockItem::addItem(uint16_t _level)
 {
     m_levels[_level].emplace_back();
     return static_cast<unsigned int>(m_levels[_level].size() - 1);
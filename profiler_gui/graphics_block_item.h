@@ -82,11 +82,12 @@ class GraphicsBlockItem : public QGraphicsItem
 
     QRectF                     m_boundingRect; ///< boundingRect (see QGraphicsItem)
     QString                      m_threadName; ///<
-    uint8_t                           m_index; ///< This item's index in the list of items of BlocksGraphicsView
+    uint32_t                          m_index; ///< This item's index in the list of items of BlocksGraphicsView
+    bool                              m_built; ///< Levels have been filled by BlocksGraphicsView (see BlocksGraphicsView::buildLane())
 
 public:
 
-    explicit GraphicsBlockItem(uint8_t _index, const profiler::BlocksTreeRoot& _root);
+    explicit GraphicsBlockItem(uint32_t _index, const profiler::BlocksTreeRoot& _root);
     ~GraphicsBlockItem() override;
 
     // Public virtual methods
@@ -112,46 +113,55 @@ public:
     ::profiler::thread_id_t threadId() const;
 
     ///< Returns number of levels
-    uint8_t levels() const;
+    uint16_t levels() const;
 
-    float levelY(uint8_t _level) const;
+    float levelY(uint16_t _level) const;
 
     /** \brief Sets number of levels.
     
     \note Must be set before doing anything else.
     
     \param _levels Desired number of levels */
-    void setLevels(uint8_t _levels);
+    void setLevels(uint16_t _levels);
+
+    ///< Returns true if levels have been filled (they are filled only for lanes near the visible area)
+    bool built() const;
+
+    ///< Marks levels as filled
+    void setBuilt();
+
+    ///< Releases all levels. Lane keeps its position and size.
+    void clearLevels();
 
     /** \brief Reserves memory for desired number of items on specified level.
     
     \param _level Index of the level
     \param _items Desired number of items on this level */
-    void reserve(uint8_t _level, unsigned int _items);
+    void reserve(uint16_t _level, unsigned int _items);
 
     /**\brief Returns reference to the array of items of specified level.
     
     \param _level Index of the level */
-    const Children& items(uint8_t _level) const;
+    const Children& items(uint16_t _level) const;
 
     /**\brief Returns reference to the item with required index on specified level.
     
     \param _level Index of the level
     \param _index Index of required item */
-    const ::profiler_gui::EasyBlockItem& getItem(uint8_t _level, unsigned int _index) const;
+    const ::profiler_gui::EasyBlockItem& getItem(uint16_t _level, unsigned int _index) const;
 
     /**\brief Returns reference to the item with required index on specified level.
 
     \param _level Index of the level
     \param _index Index of required item */
-    ::profiler_gui::EasyBlockItem& getItem(uint8_t _level, unsigned int _index);
+    ::profiler_gui::EasyBlockItem& getItem(uint16_t _level, unsigned int _index);
 
     /** \brief Adds new item to required level.
     
     \param _level Index of the level
     
     \retval Index of the new created item */
-    unsigned int addItem(uint8_t _level);
+    unsigned int addItem(uint16_t _level);
 
     /** \brief Finds top-level blocks which are intersects with required selection zone.
 
@@ -171,7 +181,7 @@ private:
     const BlocksGraphicsView* view() const;
 
 #ifdef EASY_GRAPHICS_ITEM_RECURSIVE_PAINT
-    void paintChildren(const float _minWidth, const int _narrowSizeHalf, const uint8_t _levelsNumber, QPainter* _painter, struct EasyPainterInformation& p, ::profiler_gui::EasyBlockItem& _item, const ::profiler_gui::EasyBlock& _itemBlock, RightBounds& _rightBounds, uint8_t _level, int8_t _mode);
+    void paintChildren(const float _minWidth, const int _narrowSizeHalf, const uint16_t _levelsNumber, QPainter* _painter, struct EasyPainterInformation& p, ::profiler_gui::EasyBlockItem& _item, const ::profiler_gui::EasyBlock& _itemBlock, RightBounds& _rightBounds, uint16_t _level, int8_t _mode);
 #endif
 
 public:
@@ -179,7 +189,7 @@ public:
     // Public inline methods
 
     ///< Returns this item's index in the list of graphics items of BlocksGraphicsView
-    uint8_t index() const {
+    uint32_t index() const {
         return m_index;
     }
 
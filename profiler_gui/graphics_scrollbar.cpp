@@ -501,7 +501,7 @@ void GraphicsHistogramItem::setSource(profiler::thread_id_t _thread_id, const pr
 
     m_selectedBlocks.clear();
     setEmpty(true);
-    { profiler::BlocksTree::children_t().swap(m_selectedBlocks); }
+    { profiler::block_indices_t().swap(m_selectedBlocks); }
 
     m_topDurationStr.clear();
     m_bottomDurationStr.clear();
@@ -657,7 +657,7 @@ void GraphicsHistogramItem::setSource(profiler::thread_id_t _thread_id, profiler
 
     m_selectedBlocks.clear();
     setEmpty(true);
-    { profiler::BlocksTree::children_t().swap(m_selectedBlocks); }
+    { profiler::block_indices_t().swap(m_selectedBlocks); }
 
     m_threadId = _thread_id;
     m_blockId = _block_id;
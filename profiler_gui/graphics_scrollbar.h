@@ -85,7 +85,7 @@ private:
     QString                              m_threadName;
     QString                               m_blockName;
     QString                               m_blockType;
-    profiler::BlocksTree::children_t m_selectedBlocks;
+    profiler::block_indices_t m_selectedBlocks;
     profiler::timestamp_t            m_threadDuration;
     profiler::timestamp_t        m_threadProfiledTime;
     profiler::timestamp_t            m_threadWaitTime;
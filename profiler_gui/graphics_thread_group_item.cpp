@@ -0,0 +1,335 @@
+/************************************************************************
+* file name         : graphics_thread_group_item.cpp
+* ----------------- :
+* creation time     : 2026/10/19
+* ----------------- :
+* description       : The file contains implementation of GraphicsThreadGroupItem.
+* ----------------- :
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights 
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+*                   : of the Software, and to permit persons to whom the Software is furnished 
+*                   : to do so, subject to the following conditions:
+*                   : 
+*                   : The above copyright notice and this permission notice shall be included in all 
+*                   : copies or substantial portions of the Software.
+*                   : 
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   : 
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+#include <QGraphicsScene>
+#include <QPainter>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include "graphics_thread_group_item.h"
+#include "blocks_graphics_view.h"
+#include "globals.h"
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+EASY_CONSTEXPR uint32_t BUCKETS_NUMBER = 4096; ///< Number of time buckets for the whole session
+EASY_CONSTEXPR size_t MAX_TOP_BLOCKS = 8; ///< Number of top-level blocks painted with their own colors
+EASY_CONSTEXPR int LANE_ROWS = 3; ///< Height of the lane in diagram rows
+EASY_CONSTEXPR int TIMER_INTERVAL = 40;
+EASY_CONSTEXPR QRgb OTHER_BLOCKS_COLOR = profiler::colors::Grey400;
+
+} // end of namespace <noname>.
+
+#ifdef max
+#undef max
+#endif
+
+#ifdef min
+#undef min
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+GraphicsThreadGroupItem::GraphicsThreadGroupItem(const QString& _name, uint32_t _firstItem, Threads&& _threads)
+    : QGraphicsItem(nullptr)
+    , m_threads(std::move(_threads))
+    , m_name(_name)
+    , m_timer(std::bind(&GraphicsThreadGroupItem::onTimeout, this))
+    , m_beginTime(0)
+    , m_bucketDuration(1)
+    , m_firstItem(_firstItem)
+    , m_bExpanded(!EASY_GLOBALS.fold_thread_groups)
+{
+    m_bInterrupt = false;
+    m_bReady = false;
+    m_timer.setInterval(TIMER_INTERVAL);
+    m_boundingRect.setRect(0, 0, 0, LANE_ROWS * EASY_GLOBALS.size.graphics_row_full);
+}
+
+GraphicsThreadGroupItem::~GraphicsThreadGroupItem()
+{
+    m_timer.stop();
+    m_worker.dequeue();
+}
+
+const BlocksGraphicsView* GraphicsThreadGroupItem::view() const
+{
+    return static_cast<const BlocksGraphicsView*>(scene()->parent());
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+QRectF GraphicsThreadGroupItem::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+void GraphicsThreadGroupItem::setBoundingRect(qreal x, qreal y, qreal w, qreal h)
+{
+    m_boundingRect.setRect(x, y, w, h);
+}
+
+const QString& GraphicsThreadGroupItem::name() const
+{
+    return m_name;
+}
+
+uint32_t GraphicsThreadGroupItem::firstItem() const
+{
+    return m_firstItem;
+}
+
+uint32_t GraphicsThreadGroupItem::itemsNumber() const
+{
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+bool GraphicsThreadGroupItem::isExpanded() const
+{
+    return m_bExpanded;
+}
+
+void GraphicsThreadGroupItem::setExpanded(bool _expanded)
+{
+    m_bExpanded = _expanded;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void GraphicsThreadGroupItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*, QWidget*)
+{
+    if (!m_bReady.load(std::memory_order_acquire) || m_occupancy.empty())
+    {
+        return;
+    }
+
+    const auto sceneView = view();
+    const auto& visibleSceneRect = sceneView->visibleSceneRect();
+    const auto top = y() + m_boundingRect.top();
+    const auto height = m_boundingRect.height();
+    if (top > visibleSceneRect.bottom() || top + height < visibleSceneRect.top())
+    {
+        return;
+    }
+
+    const auto currentScale = sceneView->scale();
+    const auto offset = sceneView->offset();
+    const auto dx = offset * currentScale;
+    const auto sceneRight = offset + visibleSceneRect.width() / currentScale;
+
+    const auto slotsNumber = m_topBlocks.size() + 1;
+    const auto bucketsNumber = m_occupancy.size() / slotsNumber;
+    const auto left = sceneView->time2position(m_beginTime);
+    const auto bucketWidth = PROF_MICROSECONDS(qreal(m_bucketDuration));
+
+    // Buckets which are narrower than 1 pixel are merged into one column.
+    // This way the number of painted rectangles depends on the view width only.
+    const auto bucketsPerColumn = static_cast<size_t>(std::max(1., std::ceil(1. / (bucketWidth * currentScale))));
+    auto first = static_cast<size_t>(std::max(0., (offset - left) / bucketWidth));
+    first -= first % bucketsPerColumn;
+
+    std::vector<float> column(slotsNumber);
+    QBrush brush(Qt::SolidPattern);
+    QRectF rect;
+
+    _painter->save();
+    _painter->setTransform(QTransform::fromTranslate(0, -y()), true);
+    _painter->setPen(Qt::NoPen);
+
+    for (auto b = first; b < bucketsNumber; b += bucketsPerColumn)
+    {
+        const auto columnLeft = left + b * bucketWidth;
+        if (columnLeft > sceneRight)
+            break;
+
+        const auto n = std::min(bucketsPerColumn, bucketsNumber - b);
+        std::fill(column.begin(), column.end(), 0.f);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto bucket = m_occupancy.data() + (b + i) * slotsNumber;
+            for (size_t k = 0; k < slotsNumber; ++k)
+                column[k] += bucket[k];
+        }
+
+        const auto x = columnLeft * currentScale - dx;
+        const auto w = n * bucketWidth * currentScale;
+        auto bottom = top + height;
+
+        // Stacked bars: total height of the column is the utilization of the group threads
+        for (size_t k = 0; k < slotsNumber; ++k)
+        {
+            const auto h = height * column[k] / n;
+            if (h < 0.5)
+                continue;
+
+            const QRgb color = k < m_topBlocks.size() ? easyDescriptor(m_topBlocks[k]).color() : OTHER_BLOCKS_COLOR;
+            brush.setColor(QColor::fromRgba(color));
+            _painter->setBrush(brush);
+
+            rect.setRect(x, bottom - h, w, h);
+            _painter->drawRect(rect);
+
+            bottom -= h;
+        }
+    }
+
+    _painter->restore();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void GraphicsThreadGroupItem::calculate(profiler::timestamp_t _beginTime, profiler::timestamp_t _endTime)
+{
+    m_worker.dequeue();
+    m_bReady.store(false, std::memory_order_release);
+
+    m_beginTime = _beginTime;
+    m_bucketDuration = std::max(profiler::timestamp_t(1), (_endTime - _beginTime + BUCKETS_NUMBER - 1) / BUCKETS_NUMBER);
+
+    m_worker.enqueue([this, _endTime]
+    {
+        aggregate(_endTime);
+        if (!m_bInterrupt.load(std::memory_order_acquire))
+            m_bReady.store(true, std::memory_order_release);
+    }, m_bInterrupt);
+
+    m_timer.start();
+}
+
+void GraphicsThreadGroupItem::aggregate(profiler::timestamp_t _endTime)
+{
+    // Find the most time-consuming top-level blocks of the group
+    std::unordered_map<profiler::block_id_t, profiler::timestamp_t> durations;
+    for (auto thread : m_threads)
+    {
+        if (m_bInterrupt.load(std::memory_order_acquire))
+            return;
+
+        for (auto i : thread->children)
+        {
+            const auto& node = *easyBlocksTree(i).node;
+            durations[easyDescriptor(node.id()).id()] += node.duration();
+        }
+    }
+
+    std::vector<std::pair<profiler::timestamp_t, profiler::block_id_t> > sorted;
+    sorted.reserve(durations.size());
+    for (const auto& it : durations)
+        sorted.emplace_back(it.second, it.first);
+
+    const auto topNumber = std::min(sorted.size(), MAX_TOP_BLOCKS);
+    std::partial_sort(sorted.begin(), sorted.begin() + topNumber, sorted.end(), [](const std::pair<profiler::timestamp_t, profiler::block_id_t>& a, const std::pair<profiler::timestamp_t, profiler::block_id_t>& b)
+    {
+        return a.first > b.first;
+    });
+
+    m_topBlocks.clear();
+    for (size_t k = 0; k < topNumber; ++k)
+        m_topBlocks.push_back(sorted[k].second);
+
+    // Accumulate busy time of each bucket
+    const auto slotsNumber = m_topBlocks.size() + 1;
+    m_occupancy.assign(BUCKETS_NUMBER * slotsNumber, 0.f);
+
+    const auto norm = 1. / (static_cast<double>(m_bucketDuration) * m_threads.size());
+    for (auto thread : m_threads)
+    {
+        if (m_bInterrupt.load(std::memory_order_acquire))
+            return;
+
+        for (auto i : thread->children)
+        {
+            const auto& node = *easyBlocksTree(i).node;
+
+            const auto id = easyDescriptor(node.id()).id();
+            const auto slot = static_cast<size_t>(std::distance(m_topBlocks.begin(), std::find(m_topBlocks.begin(), m_topBlocks.end(), id)));
+
+            auto begin = std::max(node.begin(), m_beginTime);
+            const auto end = std::min(node.end(), _endTime);
+            for (auto b = (begin - m_beginTime) / m_bucketDuration; begin < end && b < BUCKETS_NUMBER; ++b)
+            {
+                const auto bucketEnd = std::min(end, m_beginTime + (b + 1) * m_bucketDuration);
+                m_occupancy[b * slotsNumber + slot] += static_cast<float>((bucketEnd - begin) * norm);
+                begin = bucketEnd;
+            }
+        }
+    }
+}
+
+void GraphicsThreadGroupItem::onTimeout()
+{
+    if (m_bReady.load(std::memory_order_acquire))
+    {
+        m_timer.stop();
+        update();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::string threadGroupName(const std::string& _threadName)
+{
+    auto end = _threadName.size();
+    while (end > 0 && isdigit(static_cast<unsigned char>(_threadName[end - 1])))
+        --end;
+
+    if (end == _threadName.size())
+        return std::string(); // no numeric suffix
+
+    while (end > 0 && strchr(" #-_.:", _threadName[end - 1]) != nullptr)
+        --end;
+
+    return _threadName.substr(0, end);
+}
+
+//////////////////////////////////////////////////////////////////////////
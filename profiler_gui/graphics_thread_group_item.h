@@ -0,0 +1,151 @@
+/************************************************************************
+* file name         : graphics_thread_group_item.h
+* ----------------- :
+* creation time     : 2026/10/19
+* ----------------- :
+* description       : The file contains declaration of GraphicsThreadGroupItem - an item
+*                   : used to draw one aggregated lane for a group of similar threads.
+* ----------------- :
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights 
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+*                   : of the Software, and to permit persons to whom the Software is furnished 
+*                   : to do so, subject to the following conditions:
+*                   : 
+*                   : The above copyright notice and this permission notice shall be included in all 
+*                   : copies or substantial portions of the Software.
+*                   : 
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   : 
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+#ifndef GRAPHICS_THREAD_GROUP_ITEM_H
+#define GRAPHICS_THREAD_GROUP_ITEM_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <QGraphicsItem>
+#include <QRectF>
+#include <QString>
+
+#include <easy/reader.h>
+
+#include "thread_pool_task.h"
+#include "timer.h"
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+class BlocksGraphicsView;
+
+/** \brief Aggregated lane for a group of similar threads (for example, thread pool workers "Worker 1", "Worker 2", ...).
+
+Folded group is painted as one lane instead of N thread lanes. The lane displays utilization of the group threads
+for each time bucket as stacked bars of the most time-consuming top-level blocks.
+Aggregated values are calculated in ThreadPool, so several groups are calculated in parallel.
+*/
+class GraphicsThreadGroupItem : public QGraphicsItem
+{
+public:
+
+    using Threads = std::vector<const profiler::BlocksTreeRoot*>;
+
+private:
+
+    Threads                            m_threads; ///< Threads of this group
+    std::vector<profiler::block_id_t> m_topBlocks; ///< Descriptors of the most time-consuming top-level blocks
+    std::vector<float>               m_occupancy; ///< Busy fraction for each bucket and each top block (the last one for all other blocks)
+    QRectF                        m_boundingRect; ///< boundingRect (see QGraphicsItem)
+    QString                               m_name; ///< Common name of the group threads
+    ThreadPoolTask                      m_worker; ///< Calculates aggregated values
+    Timer                                m_timer; ///< Checks if m_worker has finished
+    profiler::timestamp_t            m_beginTime; ///< Begin time of the first bucket
+    profiler::timestamp_t       m_bucketDuration; ///< Duration of one bucket
+    uint32_t                         m_firstItem; ///< Index of the first thread item in the list of items of BlocksGraphicsView
+    std::atomic_bool                m_bInterrupt; ///< Interrupts m_worker
+    std::atomic_bool                    m_bReady; ///< Are aggregated values ready to be painted
+    bool                             m_bExpanded; ///< Are group threads displayed as separate lanes
+
+public:
+
+    explicit GraphicsThreadGroupItem(const QString& _name, uint32_t _firstItem, Threads&& _threads);
+    ~GraphicsThreadGroupItem() override;
+
+    // Public virtual methods
+
+    QRectF boundingRect() const override;
+
+    void paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget = nullptr) override;
+
+public:
+
+    // Public non-virtual methods
+
+    void setBoundingRect(qreal x, qreal y, qreal w, qreal h);
+
+    /** \brief Starts calculation of aggregated values for time range [_beginTime, _endTime]. */
+    void calculate(profiler::timestamp_t _beginTime, profiler::timestamp_t _endTime);
+
+    const QString& name() const;
+
+    ///< Returns index of the first thread item in the list of items of BlocksGraphicsView
+    uint32_t firstItem() const;
+
+    ///< Returns number of threads in the group (group threads items are stored one after another)
+    uint32_t itemsNumber() const;
+
+    bool isExpanded() const;
+    void setExpanded(bool _expanded);
+
+private:
+
+    ///< Returns pointer to the BlocksGraphicsView widget.
+    const BlocksGraphicsView* view() const;
+
+    void aggregate(profiler::timestamp_t _endTime);
+    void onTimeout();
+
+}; // END of class GraphicsThreadGroupItem.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** \brief Returns name of the group for the thread name or empty string if thread can not be grouped.
+
+Threads are grouped by their names without numeric suffix: "Worker 12", "Worker-3" and "Worker#7" belong to group "Worker".
+*/
+std::string threadGroupName(const std::string& _threadName);
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+#endif // GRAPHICS_THREAD_GROUP_ITEM_H
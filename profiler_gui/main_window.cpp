@@ -67,6 +67,7 @@
 #include <QAction>
 #include <QCloseEvent>
 #include <QDateTime>
+#include <QDoubleSpinBox>
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDragLeaveEvent>
@@ -77,12 +78,14 @@
 #include <QFont>
 #include <QFontMetrics>
 #include <QFontMetricsF>
+#include <QGridLayout>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListWidget>
 #include <QPushButton>
 #include <QTextCodec>
 #include <QPlainTextEdit>
@@ -403,6 +406,9 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
         m_loadActionMenu->addAction(action);
     }
 
+    action = toolbar->addAction(QIcon(imagePath("crop")), tr("Open range"), this, SLOT(onOpenRangeClicked(bool)));
+    action->setToolTip("Open a part of the file.\nLoad only selected time range\nand selected threads.");
+
     m_saveAction = toolbar->addAction(QIcon(imagePath("save")), tr("Save"), this, SLOT(onSaveFileClicked(bool)));
     m_deleteAction = toolbar->addAction(QIcon(imagePath("delete")), tr("Clear all"), this, SLOT(onDeleteClicked(bool)));
 
@@ -501,6 +507,16 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
     action->setChecked(EASY_GLOBALS.hide_minsize_blocks);
     connect(action, &QAction::triggered, [this] (bool _checked) { EASY_GLOBALS.hide_minsize_blocks = _checked; refreshDiagram(); });
 
+    action = submenu->addAction("Fold thread groups");
+    action->setToolTip("Threads with similar names (like \'Worker 1\', \'Worker 2\', ...)\nare displayed as one aggregated lane.\nDouble click on group name to expand/fold it.");
+    action->setCheckable(true);
+    action->setChecked(EASY_GLOBALS.fold_thread_groups);
+    connect(action, &QAction::triggered, [this] (bool _checked)
+    {
+        EASY_GLOBALS.fold_thread_groups = _checked;
+        static_cast<DiagramWidget*>(m_graphicsView->widget())->view()->foldThreadGroups(_checked);
+    });
+
     action = submenu->addAction("Enable zero duration blocks on diagram");
     action->setToolTip("If checked then allows diagram to paint zero duration blocks\nwith 1px width on each scale. Otherwise, such blocks will be resized\nto 250ns duration.");
     action->setCheckable(true);
@@ -1114,6 +1130,136 @@ void MainWindow::onOpenFileClicked(bool)
     }
 }
 
+void MainWindow::onOpenRangeClicked(bool)
+{
+    const auto filename = QFileDialog::getOpenFileName(this, "Open EasyProfiler File Range",
+        m_lastFiles.empty() ? QString() : m_lastFiles.front(), "EasyProfiler File (*.prof);;All Files (*.*)");
+
+    if (filename.isEmpty())
+        return;
+
+    // Index has thread names and capture time. If the file has no index yet then it is built
+    // during the first loading (for plain files) and only the time range can be chosen.
+    profiler::FileIndex index;
+    std::stringstream log;
+    const bool hasIndex = readFileIndex(filename.toStdString().c_str(), index, log);
+
+    profiler::timestamp_t duration = 0;
+    if (hasIndex && index.end_time > index.begin_time)
+    {
+        duration = index.end_time - index.begin_time;
+        if (index.cpu_frequency != 0)
+            duration = static_cast<profiler::timestamp_t>(duration * 1e9 / index.cpu_frequency);
+    }
+
+    auto content = new QWidget();
+    auto lay = new QGridLayout(content);
+
+    // Tell why there is no index: segmented captures have no index at all, other files may be corrupted
+    QString info;
+    if (duration != 0)
+        info = QString("Capture duration: %1").arg(profiler_gui::autoTimeStringRealNs(duration, 3));
+    else if (!hasIndex && !log.str().empty())
+        info = QString("Threads list is not available:\n%1").arg(QString::fromStdString(log.str()));
+    else
+        info = QString("The file has no index. Threads list is not available.");
+
+    int row = 0;
+    lay->addWidget(new QLabel(info), row++, 0, 1, 2);
+
+    const double maxMs = duration != 0 ? duration * 1e-6 : 1e12;
+
+    auto fromBox = new QDoubleSpinBox();
+    fromBox->setDecimals(3);
+    fromBox->setRange(0, maxMs);
+    fromBox->setSuffix(" ms");
+    fromBox->setValue(0);
+    lay->addWidget(new QLabel("From:"), row, 0);
+    lay->addWidget(fromBox, row++, 1);
+
+    auto toBox = new QDoubleSpinBox();
+    toBox->setDecimals(3);
+    toBox->setRange(0, maxMs);
+    toBox->setSuffix(" ms");
+    toBox->setValue(maxMs);
+    lay->addWidget(new QLabel("To:"), row, 0);
+    lay->addWidget(toBox, row++, 1);
+
+    QListWidget* threadsList = nullptr;
+    if (hasIndex)
+    {
+        threadsList = new QListWidget();
+        for (const auto& thread : index.threads)
+        {
+            auto item = new QListWidgetItem(QString("%1 (%2)").arg(QString::fromStdString(thread.thread_name))
+                                                              .arg(thread.thread_id), threadsList);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Checked);
+            item->setData(Qt::UserRole, static_cast<qulonglong>(thread.thread_id));
+        }
+
+        lay->addWidget(new QLabel("Threads:"), row++, 0, 1, 2);
+        lay->addWidget(threadsList, row++, 0, 1, 2);
+    }
+
+    Dialog dialog(this, "Open range", content, QMessageBox::Ok | QMessageBox::Cancel);
+    if (dialog.exec() != QMessageBox::Ok)
+        return;
+
+    if (fromBox->value() > toBox->value())
+    {
+        Dialog::warning(this, "Warning", "Beginning of the range is after its end", QMessageBox::Close);
+        return;
+    }
+
+    profiler::LoadRange range;
+    range.begin = static_cast<profiler::timestamp_t>(fromBox->value() * 1e6);
+    if (toBox->value() < maxMs)
+        range.end = static_cast<profiler::timestamp_t>(toBox->value() * 1e6);
+
+    if (threadsList != nullptr)
+    {
+        bool all = true;
+        for (int i = 0, count = threadsList->count(); i < count; ++i)
+        {
+            auto item = threadsList->item(i);
+            if (item->checkState() == Qt::Checked)
+                range.threads.push_back(item->data(Qt::UserRole).toULongLong());
+            else
+                all = false;
+        }
+
+        if (range.threads.empty())
+        {
+            Dialog::warning(this, "Warning", "No threads selected", QMessageBox::Close);
+            return;
+        }
+
+        if (all)
+            range.threads.clear();
+    }
+
+    if (m_bNetworkFileRegime)
+    {
+        // Warn user about unsaved network information and suggest to save
+        auto result = Dialog::question(this, "Unsaved session"
+            , "You have unsaved data!\nSave before opening new file?"
+            , QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+
+        if (result == QMessageBox::Yes)
+        {
+            onSaveFileClicked(true);
+        }
+        else if (result != QMessageBox::No)
+        {
+            // User cancelled opening new file
+            return;
+        }
+    }
+
+    loadFile(filename, range);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void MainWindow::addFileToList(const QString& filename, bool changeWindowTitle)
@@ -1186,6 +1332,17 @@ void MainWindow::loadFile(const QString& filename)
     m_reader.load(filename);
 }
 
+void MainWindow::loadFile(const QString& filename, const profiler::LoadRange& range)
+{
+    const auto i = filename.lastIndexOf(QChar('/'));
+    const auto j = filename.lastIndexOf(QChar('\\'));
+
+    createProgressDialog(QString("Loading range of %1...").arg(filename.mid(std::max(i, j) + 1)));
+
+    m_readerTimer.start();
+    m_reader.load(filename, range);
+}
+
 void MainWindow::readStream(std::stringstream& _data)
 {
     createProgressDialog(tr("Reading from stream..."));
@@ -1780,6 +1937,10 @@ void MainWindow::loadSettings()
     if (!flag.isNull())
         EASY_GLOBALS.hide_minsize_blocks = flag.toBool();
 
+    flag = settings.value("fold_thread_groups");
+    if (!flag.isNull())
+        EASY_GLOBALS.fold_thread_groups = flag.toBool();
+
     flag = settings.value("collapse_items_on_tree_close");
     if (!flag.isNull())
         EASY_GLOBALS.collapse_items_on_tree_close = flag.toBool();
@@ -1857,6 +2018,15 @@ void MainWindow::loadSettings()
     if (!flag.isNull())
         EASY_GLOBALS.enable_statistics = flag.toBool();
 
+    auto percentiles = settings.value("stats_percentiles").toList();
+    if (percentiles.size() == profiler::STATS_PERCENTILES_NUMBER)
+    {
+        double values[profiler::STATS_PERCENTILES_NUMBER];
+        for (int i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+            values[i] = percentiles[i].toDouble();
+        profiler::set_stats_percentiles(values);
+    }
+
     QString encoding = settings.value("encoding", "UTF-8").toString();
     auto default_codec_mib = QTextCodec::codecForName(encoding.toStdString().c_str())->mibEnum();
     auto default_codec = QTextCodec::codecForMib(default_codec_mib);
@@ -1941,6 +2111,7 @@ void MainWindow::saveSettingsAndGeometry()
     settings.setValue("draw_histogram_borders", EASY_GLOBALS.draw_histogram_borders);
     settings.setValue("hide_narrow_children", EASY_GLOBALS.hide_narrow_children);
     settings.setValue("hide_minsize_blocks", EASY_GLOBALS.hide_minsize_blocks);
+    settings.setValue("fold_thread_groups", EASY_GLOBALS.fold_thread_groups);
     settings.setValue("collapse_items_on_tree_close", EASY_GLOBALS.collapse_items_on_tree_close);
     settings.setValue("all_items_expanded_by_default", EASY_GLOBALS.all_items_expanded_by_default);
     settings.setValue("only_current_thread_hierarchy", EASY_GLOBALS.only_current_thread_hierarchy);
@@ -1957,6 +2128,12 @@ void MainWindow::saveSettingsAndGeometry()
     settings.setValue("use_decorated_thread_name", EASY_GLOBALS.use_decorated_thread_name);
     settings.setValue("hex_thread_id", EASY_GLOBALS.hex_thread_id);
     settings.setValue("enable_statistics", EASY_GLOBALS.enable_statistics);
+
+    QVariantList percentiles;
+    for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+        percentiles.push_back(profiler::stats_percentile(i));
+    settings.setValue("stats_percentiles", percentiles);
+
     settings.setValue("fps_timer_interval", EASY_GLOBALS.fps_timer_interval);
     settings.setValue("max_fps_history", EASY_GLOBALS.max_fps_history);
     settings.setValue("fps_widget_line_width", EASY_GLOBALS.fps_widget_line_width);
@@ -2270,20 +2447,6 @@ void MainWindow::onLoadingFinish(profiler::block_index_t& _nblocks)
         m_reader.get(serialized_blocks, serialized_descriptors, descriptors, blocks, threads_map,
                      bookmarks, beginEndTime, descriptorsNumberInFile, version, pid, filename);
 
-        if (threads_map.size() > 0xff)
-        {
-            QString message;
-
-            if (m_reader.isFile())
-                message = QString("File %1 contains %2 threads!").arg(filename).arg(threads_map.size());
-            else
-                message = QString("Input stream contains %1 threads!").arg(threads_map.size());
-
-            Dialog::warning(this, "Warning",
-                            QString("%1\nCurrently, maximum number of displayed threads is 255!"
-                                    "\nSome threads will not be displayed.").arg(message), QMessageBox::Close);
-        }
-
         m_bNetworkFileRegime = !m_reader.isFile();
         if (!m_bNetworkFileRegime)
         {
@@ -2367,6 +2530,9 @@ void MainWindow::onFileReaderTimeout()
             profiler::block_index_t nblocks = 0;
 
             onLoadingFinish(nblocks);
+
+            // Reader reports skipped parts of the file (e.g. the end of segmented capture) without failing
+            const auto warning = nblocks != 0 ? m_reader.getError() : QString();
             closeProgressDialogAndClearReader();
 
             if (nblocks != 0)
@@ -2374,6 +2540,9 @@ void MainWindow::onFileReaderTimeout()
                 emit EASY_GLOBALS.events.fileOpened();
                 if (EASY_GLOBALS.all_items_expanded_by_default)
                     onExpandAllClicked(true);
+
+                if (!warning.isEmpty())
+                    Dialog::warning(this, "Warning", QString("File has been read partially.\n\nReason:\n%1").arg(warning), QMessageBox::Close);
             }
         }
         else if (m_reader.isSaving())
@@ -188,6 +188,7 @@ protected slots:
 
     void onThemeChange(bool);
     void onOpenFileClicked(bool);
+    void onOpenRangeClicked(bool);
     void onSaveFileClicked(bool);
     void onDeleteClicked(bool);
     void onExitClicked(bool);
@@ -257,6 +258,7 @@ private:
 
     void addFileToList(const QString& filename, bool changeWindowTitle = true);
     void loadFile(const QString& filename);
+    void loadFile(const QString& filename, const profiler::LoadRange& range);
     void readStream(std::stringstream& data);
 
     void loadSettings();
@@ -43,6 +43,7 @@ The Apache License, Version 2.0 (the "License");
 #include <QDebug>
 
 #include <easy/easy_net.h>
+#include <easy/decompressor.h>
 
 #include "common_functions.h"
 #include "socket_listener.h"
@@ -231,6 +232,10 @@ bool SocketListener::connect(
         if (message->isEasyNetMessage() && message->type == profiler::net::MessageType::Connection_Accepted)
         {
             _reply = *message;
+
+            // Ask for compressed captures. Older profilers ignore this request and keep sending plain data.
+            const profiler::net::CompressionMessage request(static_cast<uint8_t>(profiler::CompressionCodec::LZ4));
+            m_easySocket.send(&request, sizeof(request));
         }
 
         m_address = _ipaddress;
@@ -402,6 +407,11 @@ void SocketListener::listenCapture()
     int seek = 0, bytes = 0;
     auto timeBegin = std::chrono::system_clock::now();
 
+    // Compressed blocks are unpacked by worker threads while the rest of data is being received
+    m_decompressor.reset(new profiler::Decompressor([this](const char* _data, uint64_t _size) {
+        m_receivedData.write(_data, static_cast<std::streamsize>(_size));
+    }));
+
     bool isListen = true, disconnected = false;
     while (isListen && !m_bInterrupt.load(std::memory_order_acquire))
     {
@@ -580,7 +590,7 @@ void SocketListener::listenCapture()
                 {
                     char* buf = buffer + seek;
                     m_receivedSize += bytesNumber;
-                    m_receivedData.write(buf, bytesNumber);
+                    m_decompressor->write(buf, static_cast<uint64_t>(bytesNumber));
 
                     neededSize -= bytesNumber;
                     bytes -= bytesNumber;
@@ -605,7 +615,7 @@ void SocketListener::listenCapture()
 
                     const int toWrite = std::min(bytes, neededSize);
                     m_receivedSize += toWrite;
-                    m_receivedData.write(buffer, toWrite);
+                    m_decompressor->write(buffer, static_cast<uint64_t>(toWrite));
 
                     neededSize -= toWrite;
                     bytes -= toWrite;
@@ -653,6 +663,14 @@ void SocketListener::listenCapture()
         }
     }
 
+    if (!m_decompressor->finish() && !disconnected)
+    {
+        qWarning() << "Warning: Can not unpack received blocks: " << m_decompressor->error();
+        disconnected = true;
+    }
+
+    m_decompressor.reset();
+
     if (disconnected)
     {
         clearData();
@@ -44,6 +44,7 @@ The Apache License, Version 2.0 (the "License");
 #define EASY_PROFILER_SOCKET_LISTENER_H
 
 #include <atomic>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -53,6 +54,7 @@ The Apache License, Version 2.0 (the "License");
 #include <easy/easy_socket.h>
 
 namespace profiler { namespace net { struct EasyProfilerStatus; } }
+namespace profiler { class Decompressor; }
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -69,6 +71,7 @@ class SocketListener Q_DECL_FINAL
     EasySocket            m_easySocket; ///<
     std::string              m_address; ///<
     std::stringstream   m_receivedData; ///<
+    std::unique_ptr<profiler::Decompressor> m_decompressor; ///< Unpacks compressed captured blocks while receiving
     std::thread               m_thread; ///<
     uint64_t            m_receivedSize; ///<
     uint16_t                    m_port; ///<
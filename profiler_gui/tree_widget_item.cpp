@@ -87,6 +87,9 @@ EASY_CONSTEXPR bool HasToolTip[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_FRAME,
     , true  // COL_AVG_PER_FRAME,
     , true  // COL_MEDIAN_PER_FRAME,
+    , true  // COL_PERCENTILE1_PER_FRAME,
+    , true  // COL_PERCENTILE2_PER_FRAME,
+    , true  // COL_PERCENTILE3_PER_FRAME,
     , false // COL_NCALLS_PER_FRAME,
     , true  // COL_TOTAL_TIME_PER_THREAD,
     , false // COL_PERCENT_SUM_PER_THREAD,
@@ -94,6 +97,9 @@ EASY_CONSTEXPR bool HasToolTip[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_THREAD,
     , true  // COL_AVG_PER_THREAD,
     , true  // COL_MEDIAN_PER_THREAD,
+    , true  // COL_PERCENTILE1_PER_THREAD,
+    , true  // COL_PERCENTILE2_PER_THREAD,
+    , true  // COL_PERCENTILE3_PER_THREAD,
     , false // COL_NCALLS_PER_THREAD,
     , false // COL_PERCENT_PER_PARENT,
     , true  // COL_TOTAL_TIME_PER_PARENT,
@@ -102,6 +108,9 @@ EASY_CONSTEXPR bool HasToolTip[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_PARENT,
     , true  // COL_AVG_PER_PARENT,
     , true  // COL_MEDIAN_PER_PARENT,
+    , true  // COL_PERCENTILE1_PER_PARENT,
+    , true  // COL_PERCENTILE2_PER_PARENT,
+    , true  // COL_PERCENTILE3_PER_PARENT,
     , false // COL_NCALLS_PER_PARENT,
     , true  // COL_ACTIVE_TIME,
     , false // COL_ACTIVE_PERCENT,
@@ -112,6 +121,9 @@ EASY_CONSTEXPR bool HasToolTip[COL_COLUMNS_NUMBER] = {
     , true  // COL_MAX_PER_AREA,
     , true  // COL_AVG_PER_AREA,
     , true  // COL_MEDIAN_PER_AREA,
+    , true  // COL_PERCENTILE1_PER_AREA,
+    , true  // COL_PERCENTILE2_PER_AREA,
+    , true  // COL_PERCENTILE3_PER_AREA,
     , false // COL_NCALLS_PER_AREA,
 };
 
@@ -152,7 +164,7 @@ bool TreeWidgetItem::operator < (const Parent& _other) const
         case COL_NCALLS_PER_FRAME:
         case COL_NCALLS_PER_AREA:
         {
-            return data(col, Qt::UserRole).toUInt() < _other.data(col, Qt::UserRole).toUInt();
+            return data(col, Qt::UserRole).toULongLong() < _other.data(col, Qt::UserRole).toULongLong();
         }
 
         case COL_SELF_TIME_PERCENT:
@@ -228,7 +240,7 @@ QVariant TreeWidgetItem::data(int _column, int _role) const
             auto v = Parent::data(_column, _role);
             if (!v.isNull() || parent() == nullptr)
                 return v;
-            return QVariant::fromValue(m_block);
+            return QVariant::fromValue(static_cast<qulonglong>(m_block));
         }
 
         default:
@@ -299,6 +311,18 @@ QVariant TreeWidgetItem::relevantData(int _column, int _role) const
         case COL_MEDIAN_PER_FRAME:
         case COL_MEDIAN_PER_THREAD:
         case COL_MEDIAN_PER_AREA:
+        case COL_PERCENTILE1_PER_PARENT:
+        case COL_PERCENTILE1_PER_FRAME:
+        case COL_PERCENTILE1_PER_THREAD:
+        case COL_PERCENTILE1_PER_AREA:
+        case COL_PERCENTILE2_PER_PARENT:
+        case COL_PERCENTILE2_PER_FRAME:
+        case COL_PERCENTILE2_PER_THREAD:
+        case COL_PERCENTILE2_PER_AREA:
+        case COL_PERCENTILE3_PER_PARENT:
+        case COL_PERCENTILE3_PER_FRAME:
+        case COL_PERCENTILE3_PER_THREAD:
+        case COL_PERCENTILE3_PER_AREA:
         {
             return data(COL_TIME, _role);
         }
@@ -336,13 +360,13 @@ QVariant TreeWidgetItem::partialForeground() const
     {
         case TreeMode::Plain:
         {
-            ncalls = data(COL_NCALLS_PER_FRAME, Qt::UserRole).toUInt();
+            ncalls = static_cast<profiler::calls_number_t>(data(COL_NCALLS_PER_FRAME, Qt::UserRole).toULongLong());
             break;
         }
 
         case TreeMode::SelectedArea:
         {
-            ncalls = data(COL_NCALLS_PER_AREA, Qt::UserRole).toUInt();
+            ncalls = static_cast<profiler::calls_number_t>(data(COL_NCALLS_PER_AREA, Qt::UserRole).toULongLong());
             break;
         }
 
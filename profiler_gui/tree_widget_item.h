@@ -68,7 +68,7 @@ class BlocksTreeWidget;
 
 //////////////////////////////////////////////////////////////////////////
 
-EASY_CONSTEXPR int COLUMNS_VERSION = 3;
+EASY_CONSTEXPR int COLUMNS_VERSION = 4;
 EASY_CONSTEXPR int BlockColorRole = Qt::UserRole + 1;
 EASY_CONSTEXPR int MinMaxBlockIndexRole = Qt::UserRole + 2;
 
@@ -93,6 +93,9 @@ enum EasyColumnsIndexes
     COL_MAX_PER_FRAME,
     COL_AVG_PER_FRAME,
     COL_MEDIAN_PER_FRAME,
+    COL_PERCENTILE1_PER_FRAME,
+    COL_PERCENTILE2_PER_FRAME,
+    COL_PERCENTILE3_PER_FRAME,
     COL_NCALLS_PER_FRAME,
 
     COL_TOTAL_TIME_PER_THREAD,
@@ -101,6 +104,9 @@ enum EasyColumnsIndexes
     COL_MAX_PER_THREAD,
     COL_AVG_PER_THREAD,
     COL_MEDIAN_PER_THREAD,
+    COL_PERCENTILE1_PER_THREAD,
+    COL_PERCENTILE2_PER_THREAD,
+    COL_PERCENTILE3_PER_THREAD,
     COL_NCALLS_PER_THREAD,
 
     COL_PERCENT_PER_PARENT,
@@ -110,6 +116,9 @@ enum EasyColumnsIndexes
     COL_MAX_PER_PARENT,
     COL_AVG_PER_PARENT,
     COL_MEDIAN_PER_PARENT,
+    COL_PERCENTILE1_PER_PARENT,
+    COL_PERCENTILE2_PER_PARENT,
+    COL_PERCENTILE3_PER_PARENT,
     COL_NCALLS_PER_PARENT,
 
     COL_ACTIVE_TIME,
@@ -122,6 +131,9 @@ enum EasyColumnsIndexes
     COL_MAX_PER_AREA,
     COL_AVG_PER_AREA,
     COL_MEDIAN_PER_AREA,
+    COL_PERCENTILE1_PER_AREA,
+    COL_PERCENTILE2_PER_AREA,
+    COL_PERCENTILE3_PER_AREA,
     COL_NCALLS_PER_AREA,
 
     COL_COLUMNS_NUMBER
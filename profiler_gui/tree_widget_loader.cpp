@@ -89,8 +89,12 @@ struct ThreadData
 
 using ThreadDataMap = std::unordered_map<profiler::thread_id_t, ThreadData, estd::hash<profiler::thread_id_t> >;
 
-void calculateMedians(StatsMap::iterator begin, StatsMap::iterator end)
+void calculatePercentiles(StatsMap::iterator begin, StatsMap::iterator end)
 {
+    double quantiles[profiler::STATS_PERCENTILES_NUMBER];
+    for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+        quantiles[i] = profiler::stats_percentile(i) * 0.01;
+
     for (auto it = begin; it != end; ++it)
     {
         auto& durations = it->second.durations;
@@ -99,10 +103,13 @@ void calculateMedians(StatsMap::iterator begin, StatsMap::iterator end)
             continue;
         }
 
-        it->second.stats.median_duration = profiler_gui::calculateMedian(durations);
+        auto& stats = it->second.stats;
+        stats.median_duration = durations.median();
+        for (uint8_t i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+            stats.percentile_durations[i] = durations.quantile(quantiles[i]);
 
         decltype(it->second.durations) dummy;
-        dummy.swap(durations);
+        std::swap(dummy, durations);
     }
 }
 
@@ -116,16 +123,17 @@ static void fillStatsColumns(
     int max_column,
     int avg_column,
     int median_column,
+    int percentile_column,
     int total_column,
     int n_calls_column
 ) {
-    item->setData(n_calls_column, Qt::UserRole, stats->calls_number);
+    item->setData(n_calls_column, Qt::UserRole, static_cast<qulonglong>(stats->calls_number));
     item->setText(n_calls_column, QString::number(stats->calls_number));
 
     if (min_column == COL_MIN_PER_AREA)
     {
-        item->setData(min_column, MinMaxBlockIndexRole, stats->min_duration_block);
-        item->setData(max_column, MinMaxBlockIndexRole, stats->max_duration_block);
+        item->setData(min_column, MinMaxBlockIndexRole, static_cast<qulonglong>(stats->min_duration_block));
+        item->setData(max_column, MinMaxBlockIndexRole, static_cast<qulonglong>(stats->max_duration_block));
     }
 
     if (stats->calls_number < 2)
@@ -143,6 +151,8 @@ static void fillStatsColumns(
     item->setTimeSmart(max_column, units, max_duration);
     item->setTimeSmart(avg_column, units, avg_duration);
     item->setTimeSmart(median_column, units, median_duration);
+    for (int i = 0; i < profiler::STATS_PERCENTILES_NUMBER; ++i)
+        item->setTimeSmart(percentile_column + i, units, stats->percentile_durations[i]);
     item->setTimeSmart(total_column, units, tot_duration);
 
     if (stats->calls_number > 1 && tot_duration != 0)
@@ -168,6 +178,7 @@ inline void fillStatsColumnsThread(TreeWidgetItem* item, const profiler::BlockSt
         COL_MAX_PER_THREAD,
         COL_AVG_PER_THREAD,
         COL_MEDIAN_PER_THREAD,
+        COL_PERCENTILE1_PER_THREAD,
         COL_TOTAL_TIME_PER_THREAD,
         COL_NCALLS_PER_THREAD
     );
@@ -183,6 +194,7 @@ inline void fillStatsColumnsFrame(TreeWidgetItem* item, const profiler::BlockSta
         COL_MAX_PER_FRAME,
         COL_AVG_PER_FRAME,
         COL_MEDIAN_PER_FRAME,
+        COL_PERCENTILE1_PER_FRAME,
         COL_TOTAL_TIME_PER_FRAME,
         COL_NCALLS_PER_FRAME
     );
@@ -198,6 +210,7 @@ inline void fillStatsColumnsParent(TreeWidgetItem* item, const profiler::BlockSt
         COL_MAX_PER_PARENT,
         COL_AVG_PER_PARENT,
         COL_MEDIAN_PER_PARENT,
+        COL_PERCENTILE1_PER_PARENT,
         COL_TOTAL_TIME_PER_PARENT,
         COL_NCALLS_PER_PARENT
     );
@@ -213,6 +226,7 @@ inline void fillStatsColumnsSelection(TreeWidgetItem* item, const profiler::Bloc
         COL_MAX_PER_AREA,
         COL_AVG_PER_AREA,
         COL_MEDIAN_PER_AREA,
+        COL_PERCENTILE1_PER_AREA,
         COL_TOTAL_TIME_PER_AREA,
         COL_NCALLS_PER_AREA
     );
@@ -554,11 +568,11 @@ void TreeWidgetLoader::setTreeInternalTop(
         item->setData(COL_PERCENT_PER_PARENT, Qt::UserRole, percentage_per_thread);
         item->setText(COL_PERCENT_PER_PARENT, QString::number(percentage_per_thread));
 
-        if (tree.per_thread_stats != nullptr) // if there is per_thread_stats then there are other stats also
+        if (tree.per_thread_stats() != nullptr) // if there is per_thread_stats then there are other stats also
         {
-            const auto per_thread_stats = tree.per_thread_stats;
-            const auto per_parent_stats = tree.per_parent_stats;
-            const auto per_frame_stats  = tree.per_frame_stats;
+            const auto per_thread_stats = tree.per_thread_stats();
+            const auto per_parent_stats = tree.per_parent_stats();
+            const auto per_frame_stats  = tree.per_frame_stats();
 
             fillStatsColumnsThread(item, per_thread_stats, _units);
             fillStatsColumnsParent(item, per_parent_stats, _units);
@@ -754,7 +768,7 @@ void TreeWidgetLoader::setTreeInternalPlainTop(
                 }
             }
 
-            if (tree.per_thread_stats != nullptr)
+            if (tree.per_thread_stats() != nullptr)
             {
                 // stats for current selection
                 updateStats(stats, tree.node->id(), block_index, duration, children_duration);
@@ -765,9 +779,9 @@ void TreeWidgetLoader::setTreeInternalPlainTop(
                     const auto self_duration = duration - children_duration + item->data(COL_SELF_TIME, Qt::UserRole).toULongLong();
 
                     int percentage = 100;
-                    if (tree.per_thread_stats->total_duration > 0)
+                    if (tree.per_thread_stats()->total_duration > 0)
                     {
-                        percentage = profiler_gui::percent(self_duration, tree.per_thread_stats->total_duration);
+                        percentage = profiler_gui::percent(self_duration, tree.per_thread_stats()->total_duration);
                     }
 
                     item->setTimeSmart(COL_SELF_TIME, _units, self_duration);
@@ -776,7 +790,7 @@ void TreeWidgetLoader::setTreeInternalPlainTop(
                 }
 
                 auto active_time = duration - idleTime + item->data(COL_ACTIVE_TIME, Qt::UserRole).toULongLong();
-                auto active_percent = tree.per_thread_stats->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, tree.per_thread_stats->total_duration);
+                auto active_percent = tree.per_thread_stats()->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, tree.per_thread_stats()->total_duration);
                 item->setTimeSmart(COL_ACTIVE_TIME, _units, active_time);
                 item->setText(COL_ACTIVE_PERCENT, QString::number(active_percent, 'g', 3));
                 item->setData(COL_ACTIVE_PERCENT, Qt::UserRole, active_percent);
@@ -816,11 +830,11 @@ void TreeWidgetLoader::setTreeInternalPlainTop(
         item->setData(COL_PERCENT_PER_PARENT, Qt::UserRole, percentage_per_thread);
         item->setText(COL_PERCENT_PER_PARENT, QString::number(percentage_per_thread));
 
-        if (tree.per_thread_stats != nullptr) // if there is per_thread_stats then there are other stats also
+        if (tree.per_thread_stats() != nullptr) // if there is per_thread_stats then there are other stats also
         {
-            const auto per_thread_stats = tree.per_thread_stats;
-            const auto per_parent_stats = tree.per_parent_stats;
-            const auto per_frame_stats = tree.per_frame_stats;
+            const auto per_thread_stats = tree.per_thread_stats();
+            const auto per_parent_stats = tree.per_parent_stats();
+            const auto per_frame_stats = tree.per_frame_stats();
 
             fillStatsColumnsThread(item, per_thread_stats, _units);
             fillStatsColumnsParent(item, per_parent_stats, _units);
@@ -1020,7 +1034,7 @@ void TreeWidgetLoader::setTreeInternalAggregateTop(
             const auto total_duration = item->data(COL_TIME, Qt::UserRole).toULongLong() + duration;
             item->setTimeSmart(COL_TIME, _units, total_duration);
 
-            if (tree.per_thread_stats != nullptr)
+            if (tree.per_thread_stats() != nullptr)
             {
                 // stats for current selection
                 updateStats(stats, tree.node->id(), block_index, duration, children_duration);
@@ -1068,7 +1082,7 @@ void TreeWidgetLoader::setTreeInternalAggregateTop(
         item->setText(COL_ACTIVE_PERCENT, QString::number(active_percent, 'g', 3));
         item->setData(COL_ACTIVE_PERCENT, Qt::UserRole, active_percent);
 
-        const auto per_thread_stats = gui_block.tree.per_thread_stats;
+        const auto per_thread_stats = gui_block.tree.per_thread_stats();
         if (per_thread_stats != nullptr)
         {
             fillStatsColumnsThread(item, per_thread_stats, _units);
@@ -1209,11 +1223,11 @@ size_t TreeWidgetLoader::setTreeInternal(
         item->setTimeMs(COL_END, endTime - _beginTime);
         item->setData(COL_PERCENT_SUM_PER_THREAD, Qt::UserRole, 0);
 
-        if (child.per_thread_stats != nullptr) // if there is per_thread_stats then there are other stats also
+        if (child.per_thread_stats() != nullptr) // if there is per_thread_stats then there are other stats also
         {
-            const auto per_thread_stats = child.per_thread_stats;
-            const auto per_parent_stats = child.per_parent_stats;
-            const auto per_frame_stats  = child.per_frame_stats;
+            const auto per_thread_stats = child.per_thread_stats();
+            const auto per_parent_stats = child.per_parent_stats();
+            const auto per_frame_stats  = child.per_frame_stats();
 
             auto parent_duration = _parent->data(COL_TIME, Qt::UserRole).toULongLong();
             auto percentage = duration == 0 ? 0 : profiler_gui::percent(duration, parent_duration);
@@ -1442,7 +1456,7 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
 
             updateStats(statsMap, child.node->id(), child_index, duration, children_duration);
 
-            if (it->second.first != nullptr && child.per_frame_stats != nullptr)
+            if (it->second.first != nullptr && child.per_frame_stats() != nullptr)
             {
                 auto item = it->second.first;
 
@@ -1452,8 +1466,8 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
                     auto self_duration = duration + item->data(COL_SELF_TIME, Qt::UserRole).toULongLong() - children_duration;
 
                     int percentage = 100;
-                    if (child.per_frame_stats->total_duration > 0)
-                        percentage = profiler_gui::percent(self_duration, child.per_frame_stats->total_duration);
+                    if (child.per_frame_stats()->total_duration > 0)
+                        percentage = profiler_gui::percent(self_duration, child.per_frame_stats()->total_duration);
 
                     item->setTimeSmart(COL_SELF_TIME, units, self_duration);
                     item->setData(COL_SELF_TIME_PERCENT, Qt::UserRole, percentage);
@@ -1462,7 +1476,7 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
 
                 const auto idleTime = calculateIdleTime(threadRoot, firstCswitch, startTime, endTime);
                 const auto active_time = duration + item->data(COL_ACTIVE_TIME, Qt::UserRole).toULongLong() - idleTime;
-                const auto active_percent = child.per_frame_stats->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, child.per_frame_stats->total_duration);
+                const auto active_percent = child.per_frame_stats()->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, child.per_frame_stats()->total_duration);
                 item->setTimeSmart(COL_ACTIVE_TIME, units, active_time);
                 item->setText(COL_ACTIVE_PERCENT, QString::number(active_percent, 'g', 3));
                 item->setData(COL_ACTIVE_PERCENT, Qt::UserRole, active_percent);
@@ -1478,10 +1492,10 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
         auto name = *child.node->name() != 0 ? child.node->name() : desc.name();
         item->setText(COL_NAME, profiler_gui::toUnicode(name));
 
-        if (child.per_thread_stats != nullptr) // if there is per_thread_stats then there are other stats also
+        if (child.per_thread_stats() != nullptr) // if there is per_thread_stats then there are other stats also
         {
-            const auto per_thread_stats = child.per_thread_stats;
-            const auto per_frame_stats = child.per_frame_stats;
+            const auto per_thread_stats = child.per_thread_stats();
+            const auto per_frame_stats = child.per_frame_stats();
 
             fillStatsColumnsThread(item, per_thread_stats, units);
             fillStatsColumnsFrame(item, per_frame_stats, units);
@@ -1529,19 +1543,19 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
         iditems[child.node->id()] = std::make_pair(item, depth);
         total_duration += duration;
 
-        if (child.per_frame_stats != nullptr)
+        if (child.per_frame_stats() != nullptr)
         {
             int percentage = 100;
-            auto self_duration = child.per_frame_stats->total_duration - children_duration;
-            if (child.per_frame_stats->total_duration > 0)
-                percentage = profiler_gui::percent(self_duration, child.per_frame_stats->total_duration);
+            auto self_duration = child.per_frame_stats()->total_duration - children_duration;
+            if (child.per_frame_stats()->total_duration > 0)
+                percentage = profiler_gui::percent(self_duration, child.per_frame_stats()->total_duration);
 
             item->setTimeSmart(COL_SELF_TIME, units, self_duration);
             item->setData(COL_SELF_TIME_PERCENT, Qt::UserRole, percentage);
             item->setText(COL_SELF_TIME_PERCENT, QString::number(percentage));
 
-            auto active_time = child.per_frame_stats->total_duration - idleTime;
-            auto active_percent = child.per_frame_stats->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, child.per_frame_stats->total_duration);
+            auto active_time = child.per_frame_stats()->total_duration - idleTime;
+            auto active_percent = child.per_frame_stats()->total_duration == 0 ? 100. : profiler_gui::percentReal(active_time, child.per_frame_stats()->total_duration);
             item->setTimeSmart(COL_ACTIVE_TIME, units, active_time);
             item->setText(COL_ACTIVE_PERCENT, QString::number(active_percent, 'g', 3));
             item->setData(COL_ACTIVE_PERCENT, Qt::UserRole, active_percent);
@@ -1655,9 +1669,9 @@ size_t TreeWidgetLoader::setTreeInternalAggregate(
         item->setText(COL_NAME, profiler_gui::toUnicode(name));
         item->setTimeSmart(COL_TIME, units, duration);
 
-        if (child.per_thread_stats != nullptr) // if there is per_thread_stats then there are other stats also
+        if (child.per_thread_stats() != nullptr) // if there is per_thread_stats then there are other stats also
         {
-            const auto per_thread_stats = child.per_thread_stats;
+            const auto per_thread_stats = child.per_thread_stats();
 
             fillStatsColumnsThread(item, per_thread_stats, units);
 
@@ -1795,7 +1809,7 @@ void TreeWidgetLoader::updateStats(
             stat.min_duration_block = index;
         }
 
-        ++durations[duration].count;
+        durations.add(duration);
     }
 }
 
@@ -1808,7 +1822,7 @@ void TreeWidgetLoader::fillStatsForTree(TreeWidgetItem* root, StatsMap& stats, p
         return;
     }
 
-    calculateMedians(stats.begin(), stats.end());
+    calculatePercentiles(stats.begin(), stats.end());
 
     std::deque<TreeWidgetItem*> queue;
 
@@ -61,6 +61,7 @@
 #include <vector>
 #include <atomic>
 #include <easy/reader.h>
+#include <easy/quantile_sketch.h>
 #include "common_types.h"
 #include "thread_pool_task.h"
 
@@ -73,12 +74,12 @@ namespace loader {
 struct Stats
 {
     profiler::BlockStatistics stats;
-    profiler_gui::DurationsCountMap durations;
+    profiler::QuantileSketch durations;
 
     Stats(profiler::timestamp_t duration, profiler::block_index_t block_index, profiler::block_index_t parent_index)
         : stats(duration, block_index, parent_index)
     {
-        durations[duration].count = 1;
+        durations.add(duration);
     }
 };
 